@@ -0,0 +1,133 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                  Check and benchmark of automatic differentiation
+
+  ==============================================================================*/
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include "../src/symDiff.h"
+
+using namespace std;
+using namespace RITA;
+
+// f(x,y,z) = x^2*sin(y) + exp(x*z) - log(z)/y, its gradient and Hessian
+static const string expr = "x^2*sin(y) + exp(x*z) - log(z)/y";
+
+double f(const double* p)
+{
+   double x=p[0], y=p[1], z=p[2];
+   return x*x*sin(y) + exp(x*z) - log(z)/y;
+}
+
+void grad(const double* p, double* g)
+{
+   double x=p[0], y=p[1], z=p[2], e=exp(x*z);
+   g[0] = 2*x*sin(y) + z*e;
+   g[1] = x*x*cos(y) + log(z)/(y*y);
+   g[2] = x*e - 1./(y*z);
+}
+
+void hess(const double* p, double* h)
+{
+   double x=p[0], y=p[1], z=p[2], e=exp(x*z);
+   h[0] = 2*sin(y) + z*z*e;
+   h[1] = h[3] = 2*x*cos(y);
+   h[2] = h[6] = e + x*z*e;
+   h[4] = -x*x*sin(y) - 2*log(z)/(y*y*y);
+   h[5] = h[7] = 1./(y*y*z);
+   h[8] = x*x*e + 1./(y*z*z);
+}
+
+
+int check(const string& what, double a, double b)
+{
+   if (fabs(a-b)<=1.e-12*(1.+fabs(b)))
+      return 0;
+   cout << "Mismatch of " << what << ": " << a << " instead of " << b << endl;
+   return 1;
+}
+
+
+int main(int argc, char *argv[])
+{
+   const int nb = (argc>1) ? atoi(argv[1]) : 100000;
+   exprAD ad;
+   if (ad.set(expr,{"x","y","z"}) || ad.getNbVar()!=3) {
+      cout << "Unable to parse " << expr << endl;
+      return 1;
+   }
+
+// Values, directional derivatives, gradients and Hessian-vector products are
+// compared with analytic ones at a few points
+   const double pts[3][3] = {{0.5,1.2,2.},{-1.,0.3,0.7},{2.,-2.5,1.5}};
+   const double v[3] = {0.3,-1.,2.};
+   int err = 0;
+   for (const auto& x: pts) {
+      double g[3], h[9], ag[3], hv[3], dv=0.;
+      grad(x,g);
+      hess(x,h);
+      err += check("value",ad(x),f(x));
+      err += check("value",ad.derivative(x,v,dv),f(x));
+      err += check("derivative",dv,g[0]*v[0]+g[1]*v[1]+g[2]*v[2]);
+      err += check("value",ad.gradient(x,ag),f(x));
+      for (int i=0; i<3; ++i)
+         err += check("gradient",ag[i],g[i]);
+      err += check("value",ad.hessVec(x,v,hv),f(x));
+      for (int i=0; i<3; ++i)
+         err += check("Hessian-vector product",hv[i],h[3*i]*v[0]+h[3*i+1]*v[1]+h[3*i+2]*v[2]);
+   }
+   if (err)
+      return 1;
+
+// Timing of a reverse mode gradient against central finite differences
+   double x[3] = {0.5,1.2,2.}, g[3], s[2] = {0.,0.}, t[2];
+   for (int m=0; m<2; ++m) {
+      auto t0 = chrono::steady_clock::now();
+      for (int k=0; k<nb; ++k) {
+         x[0] = 0.5 + 1.e-6*(k%100);
+         if (m)
+            ad.gradient(x,g);
+         else {
+            for (int i=0; i<3; ++i) {
+               double xi=x[i], h=1.e-6*(1.+fabs(xi));
+               x[i] = xi + h;
+               double fp = ad(x);
+               x[i] = xi - h;
+               g[i] = (fp-ad(x))/(2*h);
+               x[i] = xi;
+            }
+         }
+         s[m] += g[0] + g[1] + g[2];
+      }
+      t[m] = chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+   }
+   cout << "Gradients:           " << nb << endl;
+   cout << "Finite differences:  " << t[0] << " s" << endl;
+   cout << "Reverse mode:        " << t[1] << " s" << endl;
+   cout << "Speedup:             " << t[0]/t[1] << endl;
+   return fabs(s[0]-s[1])>1.e-4*fabs(s[1]);
+}
@@ -0,0 +1,161 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                      Benchmark of matrix creation in calc
+
+  ==============================================================================*/
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "../src/rita.h"
+#include "../src/cmd.h"
+#include "../src/calc.h"
+
+using namespace std;
+using namespace RITA;
+
+/*
+ * Commands are run by calc::run as in the calculator mode of rita: the expression
+ * is evaluated and, among the variables it uses, only those flagged as modified
+ * are copied to data, vectors and matrices of unchanged size being filled in place.
+ * A matrix is assigned for increasing sizes: the cost per element must not grow
+ * with the size. An expression that only reads an element of the matrix must not
+ * copy it: its cost must remain small compared to the assignment.
+ * Element-wise functions and operators are then applied to a vector of one
+ * million entries.
+ * Functions defined by define(), one calling another, are checked with scalar and
+ * vector arguments, and calls of a user defined function are timed against calls
+ * of a built-in function.
+ */
+
+double now()
+{
+   return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// Time of nb evaluations of a compiled expression
+double evalTime(ParserX& p, const string& expr, int nb, double& s)
+{
+   p.SetExpr(expr);
+   double t = now();
+   for (int i=0; i<nb; ++i)
+      s += p.Eval().GetFloat();
+   return now() - t;
+}
+
+
+// Read next command of the script and time its execution by calc
+double run(cmd& c, calc& k)
+{
+   int ret;
+   while ((ret=c.readline())<0) {
+      if (ret==-5)
+         return 0.;
+   }
+   double t = now();
+   k.run();
+   return now() - t;
+}
+
+
+int main()
+{
+   const vector<int> sizes {250,500,1000,2000};
+   const int m = 1000000;
+   {
+      ofstream s("calc-bench.rita");
+      for (int n: sizes) {
+         string N = to_string(n);
+//       Temporaries of the assignment are released by the next command, which is not timed
+         s << "A=2*ones(" << N << "," << N << ")\ns=0\ns=A[1,1]\n";
+      }
+      s << "y=2*sin(x)+x^2\n";
+      s << "define(\"f\",\"x^2+1\")\ndefine(\"g\",\"f(x)*y\")\nu=g(2,3)\nw=g({1,2,3},2)" << endl;
+   }
+   ifstream is("calc-bench.rita");
+   rita r;
+   RITA::data &d = *r.getData();
+   cmd c(is);
+   calc k(&r,&c);
+
+   cout << "Size       Assignment (s/element)   Read (s)" << endl;
+   double t0=0., t=0., tr=0., s=0.;
+   bool ok = true;
+   for (int n: sizes) {
+      t = run(c,k)/(double(n)*n);
+      if (n==sizes[0])
+         t0 = t;
+      run(c,k);
+      tr = run(c,k);
+      cout << n << "\t   " << t << "\t\t    " << tr << endl;
+      int i = d.MatrixName["A"];
+      if (i==0 || int(d.theMatrix[i]->getNbRows())!=n || (*d.theMatrix[i])(n,n)!=2. ||
+          d.checkParam("s",s)<0 || s!=2.)
+         return 1;
+      ok = ok && tr<0.1*t*n*n;
+   }
+
+   cout << "\nElement-wise 2*sin(x)+x^2, 10^6 entries:" << endl;
+   OFELI::Vect<double> x(m);
+   for (int i=0; i<m; ++i)
+      x[i] = 1.e-6*i;
+   k.setVector("x",&x);
+   double te = run(c,k);
+   cout << te/m << " s/entry" << endl;
+   int i = d.VectorName["y"];
+   if (i==0 || int(d.theVector[i]->size())!=m ||
+       std::abs((*d.theVector[i])[m-1]-2*std::sin(1.e-6*(m-1))-1.e-12*(m-1)*(m-1))>1.e-12)
+      return 1;
+
+// g(x,y) = (x^2+1)*y
+   for (int j=0; j<4; ++j)
+      run(c,k);
+   i = d.VectorName["w"];
+   if (d.checkParam("u",s)<0 || s!=15. || i==0 || d.theVector[i]->size()!=3 ||
+       (*d.theVector[i])[0]!=4. || (*d.theVector[i])[1]!=10. || (*d.theVector[i])[2]!=20.)
+      return 1;
+
+   cout << "\nUser defined function against built-in function, 10^6 calls:" << endl;
+   ParserX p;
+   p.DefineFun(new FunDefine);
+   p.SetExpr("define(\"sq\",\"x*x+1\")");
+   p.Eval();
+   Value a(0.5);
+   p.DefineVar("a",Variable(&a));
+   double su=0., sb=0.;
+   double tu = evalTime(p,"sq(a)+sq(a)+sq(a)+sq(a)",250000,su);
+   double tb = evalTime(p,"sin(a)+sin(a)+sin(a)+sin(a)",250000,sb);
+   cout << "User defined: " << tu*1.e-6 << " s/call, built-in: " << tb*1.e-6 << " s/call" << endl;
+   if (su!=1.25e6)
+      return 1;
+
+// Linear cost: time per element at size 2000 must stay close to the one at size 250,
+// and reading an element must be cheaper than copying the matrix
+   return t>16*t0 || !ok;
+}
@@ -0,0 +1,120 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                   Benchmark of concurrent evaluation in calc
+
+  ==============================================================================*/
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "../muparserx/mpParser.h"
+
+using namespace std;
+using namespace mup;
+
+/*
+ * An expression of the kind used for boundary conditions is evaluated at the
+ * points of a grid, first by one parser, then by several threads sharing one
+ * compiled program, each with its own evaluation context. Both must give the
+ * same values. Building with -fsanitize=thread turns this into a stress test
+ * for data races.
+ * Usage: eval-bench [threads [points]]
+ */
+
+const char *expr = "r=sqrt(x^2+y^2)\n"
+                   "f=r<0.5 ? exp(-r)*sin(4*x) : {x,y}*{y,x}'\n"
+                   "f+strlen(\"abc\")*t";
+
+double now()
+{
+   return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void point(int i, int m, double& x, double& y)
+{
+   x = double(i%m)/m;
+   y = double(i/m)/m;
+}
+
+
+int main(int argc, char *argv[])
+{
+   int nt = (argc>1) ? atoi(argv[1]) : 4;
+   int np = (argc>2) ? atoi(argv[2]) : 200000;
+   int m = int(sqrt(double(np))) + 1;
+   vector<double> u(np), v(np);
+
+   ParserX p;
+   p.EnableAutoCreateVar(true);
+   Value x(0.), y(0.), t(0.5);
+   p.DefineVar("x",Variable(&x));
+   p.DefineVar("y",Variable(&y));
+   p.DefineVar("t",Variable(&t));
+   p.SetExpr(expr);
+
+   double t1 = now();
+   for (int i=0; i<np; ++i) {
+      double a, b;
+      point(i,m,a,b);
+      x = a, y = b;
+      u[i] = p.Eval().GetFloat();
+   }
+   t1 = now() - t1;
+
+   double t2 = now();
+   ptr_prg_type prg = p.Compile();
+   vector<thread> th;
+   for (int k=0; k<nt; ++k) {
+      th.push_back(thread([&prg,&v,k,nt,np,m]() {
+         EvalContext ctx(prg);
+         int ix=prg->GetVarIdx("x"), iy=prg->GetVarIdx("y");
+         for (int i=k; i<np; i+=nt) {
+            double a, b;
+            point(i,m,a,b);
+            ctx.Var(ix) = a;
+            ctx.Var(iy) = b;
+            v[i] = ctx.Eval().GetFloat();
+         }
+      }));
+   }
+   for (auto& w: th)
+      w.join();
+   t2 = now() - t2;
+
+   cout << "Points: " << np << ", threads: " << nt << endl;
+   cout << "Parser:               " << t1 << " s" << endl;
+   cout << "Program and contexts: " << t2 << " s" << endl;
+   for (int i=0; i<np; ++i) {
+      if (u[i]!=v[i]) {
+         cout << "Mismatch at point " << i << ": " << u[i] << " != " << v[i] << endl;
+         return 1;
+      }
+   }
+   return 0;
+}
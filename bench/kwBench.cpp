@@ -0,0 +1,106 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                         Benchmark of keyword dispatch
+
+  ==============================================================================*/
+
+#include <iostream>
+#include <chrono>
+#include "../src/kwTrie.h"
+
+using namespace std;
+using namespace RITA;
+
+// Keyword tables of the main loop and of the pde module
+static const vector<string> rita_kw {"load","unload","stat$ionary","trans$ient","eigen","optim",
+                                     "approx$imation","integ$ration","algebraic","ode","pde","solve","clear",
+                                     "sweep"};
+static const vector<string> gkw {"?","help","lic$ense","set","end","<"};
+static const vector<string> data_kw {"grid","mesh","vect$or","tab$ulation","func$tion","matr$ix","save",
+                                     "remove","desc$ription","hist$ory","data","list","print","="};
+static const vector<string> pde_kw {"var$iable","vect$or","coef","axi","in$it","bc","bf","source","sf",
+                                    "traction","space","ls","nls","clear","name","save-every","save-file"};
+
+
+// Former sequential scan of tables
+int scan(const vector<string>* t[3], const string& s)
+{
+   for (int k=0; k<3; ++k) {
+      for (auto it=t[k]->begin(); it!=t[k]->end(); it++) {
+         int n = int(it->find("$"));
+         if (it->substr(0,n)==s.substr(0,n))
+            return int(distance(t[k]->begin(),it)) + 100*k;
+      }
+   }
+   return -1;
+}
+
+
+// Prefix trees resolved once per table, as when tables are set in cmd
+int trie(const kwTrie* t[3], const string& s)
+{
+   for (int k=0; k<3; ++k) {
+      int i = t[k]->find(s);
+      if (i>=0)
+         return i + 100*k;
+   }
+   return -1;
+}
+
+
+int main(int argc, char *argv[])
+{
+   const int nb = (argc>1) ? atoi(argv[1]) : 1000000;
+   const vector<string> tokens {"stationary","sweep","help","end","vector","=","print","mesh",
+                                "function","stat","integ","transient","unknown","lic","save",
+                                "solve","clear","approximation","tab","x"};
+   const vector<string>* main_t[3] = {&rita_kw,&gkw,&data_kw};
+   const vector<string>* pde_t[3] = {&pde_kw,&gkw,&data_kw};
+   const kwTrie* main_tr[3] = {&kwTrie::get(rita_kw),&kwTrie::get(gkw),&kwTrie::get(data_kw)};
+   const kwTrie* pde_tr[3] = {&kwTrie::get(pde_kw),&kwTrie::get(gkw),&kwTrie::get(data_kw)};
+
+   for (auto const& s: tokens) {
+      if (scan(main_t,s)!=trie(main_tr,s) || scan(pde_t,s)!=trie(pde_tr,s)) {
+         cout << "Mismatch for keyword " << s << endl;
+         return 1;
+      }
+   }
+
+   long sum[2] = {0,0};
+   double t[2];
+   for (int m=0; m<2; ++m) {
+      auto t0 = chrono::steady_clock::now();
+      for (int i=0; i<nb; ++i) {
+         const string& s = tokens[i%tokens.size()];
+         sum[m] += m ? trie((i&1) ? pde_tr : main_tr,s) : scan((i&1) ? pde_t : main_t,s);
+      }
+      t[m] = chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+   }
+   cout << "Dispatches:        " << nb << endl;
+   cout << "Sequential scan:   " << t[0] << " s" << endl;
+   cout << "Prefix tree:       " << t[1] << " s" << endl;
+   cout << "Speedup:           " << t[0]/t[1] << endl;
+   return sum[0]!=sum[1];
+}
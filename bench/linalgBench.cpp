@@ -0,0 +1,198 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                   Benchmark of dense linear algebra in calc
+
+  ==============================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <functional>
+#include "../muparserx/mpParser.h"
+#include "../muparserx/mpLinAlg.h"
+
+using namespace std;
+using namespace mup;
+
+/*
+ * Dense matrix operations of calc are timed on random matrices of given sizes
+ * (default: 250, 500 and 1000). The product A*B is also timed with the former
+ * entry by entry multiplication of Matrix<Value> for comparison. A residual is
+ * checked for every operation, the program failing if one of them is too large.
+ * Matrices are the identity plus random entries of order 1/n, so that they are
+ * well conditioned and their determinant is of order 1 for any size. Residuals
+ * are normalized by the magnitude of the terms they are made of, and
+ * determinants are compared through the logarithms of the diagonals of the
+ * factors.
+ *
+ * Usage: linalg-bench [n1 n2 ...]
+ */
+
+double now()
+{
+   return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+Value random(int m, int n)
+{
+   Value a(m,n,0.);
+   srand(1);
+   for (int i=0; i<m; ++i)
+      for (int j=0; j<n; ++j)
+         a.At(i,j) = (double(rand())/RAND_MAX - 0.5)/n + (i==j ? 1. : 0.);
+   return a;
+}
+
+
+const matrix_type& get(ParserX& p, const string& name)
+{
+   return ((Variable&)(*p.GetVar().find(name)->second)).GetArray();
+}
+
+
+double at(const matrix_type& a, int i, int j=0)
+{
+   return a.At(i,j).GetFloat();
+}
+
+
+// Largest normalized residual of row i of the product a*b compared with c
+double rowResidual(const matrix_type& a, const matrix_type& b, const matrix_type& c, int i)
+{
+   double r = 0.;
+   for (int j=0; j<b.GetCols(); ++j) {
+      double s=-at(c,i,j), m=std::fabs(at(c,i,j));
+      for (int k=0; k<a.GetCols(); ++k)
+         s += at(a,i,k)*at(b,k,j), m += std::fabs(at(a,i,k)*at(b,k,j));
+      r = std::max(r,std::fabs(s)/(m+1.e-300));
+   }
+   return r;
+}
+
+
+// Logarithm of the absolute value of the product of diagonal entries
+double logDiag(const matrix_type& a)
+{
+   double l = 0.;
+   for (int i=0; i<std::min(a.GetRows(),a.GetCols()); ++i)
+      l += std::log(std::fabs(at(a,i,i)));
+   return l;
+}
+
+
+double run(ParserX& p, const string& e)
+{
+   p.SetExpr(e);
+   double t = now();
+   p.Eval();
+   return now() - t;
+}
+
+
+int main(int argc, char *argv[])
+{
+   vector<int> sizes;
+   for (int i=1; i<argc; ++i)
+      sizes.push_back(atoi(argv[i]));
+   if (sizes.size()==0)
+      sizes = {250,500,1000};
+
+   cout << "Threads: " << LinAlgThreads() << endl;
+   cout << setw(6) << "Size" << setw(12) << "A*B" << setw(12) << "A\\b" << setw(12) << "inv"
+        << setw(12) << "det" << setw(12) << "chol" << setw(12) << "lu" << setw(12) << "qr"
+        << setw(12) << "svd" << "   (s)" << endl;
+
+   int ret = 0;
+   for (int n: sizes) {
+      ParserX p;
+      p.EnableAutoCreateVar(true);
+      Value A=random(n,n), B=random(n,n), b=random(n,1);
+      p.DefineVar("A",Variable(&A));
+      p.DefineVar("B",Variable(&B));
+      p.DefineVar("b",Variable(&b));
+      p.SetExpr("S=A*A'");
+      p.Eval();
+
+//    Each operation is followed by the computation of its residual
+      int l = n - 1;
+      matrix_type I(n,n,0.);
+      for (int i=0; i<n; ++i)
+         I.At(i,i) = 1.;
+      auto lt = [&]() -> matrix_type {
+         const matrix_type& L = get(p,"L");
+         matrix_type Lt(n,n,0.);
+         for (int i=0; i<n; ++i)
+            for (int j=0; j<=i; ++j)
+               Lt.At(j,i) = L.At(i,j);
+         return Lt;
+      };
+      auto scalar = [&](const string& name) { return ((Variable&)(*p.GetVar().find(name)->second)).GetFloat(); };
+      const vector<pair<string,function<double()> > > ops {
+         {"C=A*B",        [&]() { return rowResidual(A.GetArray(),B.GetArray(),get(p,"C"),l); }},
+         {"x=A\\b",       [&]() { return rowResidual(A.GetArray(),get(p,"x"),b.GetArray(),l); }},
+         {"X=inv(A)",     [&]() { return rowResidual(A.GetArray(),get(p,"X"),I,l); }},
+         {"d=det(A)",     [&]() { return (std::isfinite(scalar("d")) && scalar("d")!=0.) ? 0. : 1.; }},
+         {"L=chol(S)",    [&]() { return rowResidual(get(p,"L"),lt(),get(p,"S"),l); }},
+         {"U=lu(A,\"U\")", [&]() { return std::fabs(logDiag(get(p,"U"))-std::log(std::fabs(scalar("d")))); }},
+         {"R=qr(A)",      [&]() { return std::fabs(logDiag(get(p,"R"))-logDiag(get(p,"U"))); }},
+         {"s=svd(A)",     [&]() -> double { run(p,"t=svd(A')");
+                                            return std::fabs(at(get(p,"s"),0)-at(get(p,"t"),0))/at(get(p,"s"),0); }}};
+      cout << setw(6) << n;
+      for (const auto& op: ops) {
+         if (op.first=="s=svd(A)" && n>500) {
+            cout << setw(12) << "-";
+            continue;
+         }
+         double t = run(p,op.first);
+         double r = op.second();
+         cout << setw(12) << t << flush;
+         if (!(r<1.e-10)) {
+            cerr << "\nResidual of " << op.first << " too large: " << r << endl;
+            ret = 1;
+         }
+      }
+      cout << endl;
+   }
+
+   int n = 200;
+   Value A=random(n,n), B=random(n,n);
+   double t = now();
+   Value C = A*B;
+   cout << "\nFormer product of size " << n << ": " << now()-t << " s" << endl;
+   ParserX p;
+   p.DefineVar("A",Variable(&A));
+   p.DefineVar("B",Variable(&B));
+   p.SetExpr("A*B");
+   t = now();
+   p.Eval();
+   cout << "Dense product of size " << n << ":  " << now()-t << " s" << endl;
+   return ret;
+}
@@ -0,0 +1,266 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+
+                  Benchmark of rita on scaled tutorial scenarios
+
+  ==============================================================================*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+using namespace std;
+
+/*
+ * The scenarios listed in the file scenarios.dat of the scenario directory are
+ * scaled-up versions of the tutorial examples. In each script, @N@ is replaced
+ * by the size of the scenario multiplied by the scale factor, the profiler of
+ * rita is turned on, and the script is run in batch mode by the given rita
+ * executable. Wall time, peak resident set size and the timers and counters
+ * of the profiler are saved in a JSON report. When a baseline report is given,
+ * scenarios whose wall time or peak memory exceed the baseline by more than
+ * the tolerance are flagged and the program returns 1.
+ * Usage: rita-bench-run <rita> <scenario-dir> [-s scale] [-o report] [-b baseline] [-t tolerance]
+ */
+
+struct Scenario {
+   string name, script;
+   long size;
+   int status;
+   double wall, rss;
+};
+
+
+int readScenarios(const string& dir, vector<Scenario>& sc)
+{
+   ifstream is(dir+"/scenarios.dat");
+   if (!is.is_open()) {
+      cerr << "Unable to open file: " << dir << "/scenarios.dat" << endl;
+      return 1;
+   }
+   string line;
+   while (getline(is,line)) {
+      if (line.empty() || line[0]=='#')
+         continue;
+      istringstream ss(line);
+      Scenario s;
+      if (ss >> s.name >> s.script >> s.size)
+         sc.push_back(s);
+   }
+   return 0;
+}
+
+
+// Write script of scenario with given size, profiling results go to file prof
+int writeScript(const string& dir, const Scenario& s, const string& file, const string& prof)
+{
+   ifstream is(dir+"/"+s.script);
+   if (!is.is_open()) {
+      cerr << "Unable to open file: " << dir << "/" << s.script << endl;
+      return 1;
+   }
+   ostringstream ss;
+   ss << is.rdbuf();
+   string text = ss.str(), n = to_string(s.size);
+   for (size_t p=text.find("@N@"); p!=string::npos; p=text.find("@N@",p+n.size()))
+      text.replace(p,3,n);
+   ofstream os(file);
+   os << "set profile=1 profile-json=" << prof << "\n" << text;
+   return os.fail() ? 1 : 0;
+}
+
+
+// Run rita in batch mode, standard output and error go to file log
+int run(const string& rita, const string& script, const string& log, double& wall, double& rss)
+{
+   auto t0 = chrono::steady_clock::now();
+   pid_t pid = fork();
+   if (pid<0)
+      return -1;
+   if (pid==0) {
+      int in = open("/dev/null",O_RDONLY), out = open(log.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644);
+      if (in>=0)
+         dup2(in,0);
+      if (out>=0)
+         dup2(out,1), dup2(out,2);
+      execl(rita.c_str(),rita.c_str(),"-b",script.c_str(),(char*)nullptr);
+      _exit(127);
+   }
+   int status = 0;
+   struct rusage ru;
+   if (wait4(pid,&status,0,&ru)<0)
+      return -1;
+   wall = chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+#if defined(__APPLE__)
+   rss = ru.ru_maxrss/1024.;
+#else
+   rss = double(ru.ru_maxrss);
+#endif
+   return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+
+// Value following key after position p in text
+double getValue(const string& text, const string& key, size_t p)
+{
+   p = text.find("\""+key+"\": ",p);
+   if (p==string::npos)
+      return -1.;
+   return atof(text.c_str()+p+key.size()+4);
+}
+
+
+// Wall time and peak memory of scenarios of a report
+int readBaseline(const string& file, map<string,pair<double,double> >& base)
+{
+   ifstream is(file);
+   if (!is.is_open()) {
+      cerr << "Unable to open file: " << file << endl;
+      return 1;
+   }
+   ostringstream ss;
+   ss << is.rdbuf();
+   const string text = ss.str(), key = "\"scenario\": \"";
+   for (size_t p=text.find(key); p!=string::npos; p=text.find(key,p+1)) {
+      size_t q = text.find('"',p+key.size());
+      if (q==string::npos)
+         break;
+      base[text.substr(p+key.size(),q-p-key.size())] = make_pair(getValue(text,"wall",q),getValue(text,"rss",q));
+   }
+   return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+   if (argc<3) {
+      cerr << "Usage: rita-bench-run <rita> <scenario-dir> [-s scale] [-o report] [-b baseline] [-t tolerance]" << endl;
+      return 1;
+   }
+   string rita = argv[1], dir = argv[2], report = "rita-bench.json", baseline = "";
+   double scale = 1., tol = 0.2;
+   for (int i=3; i<argc-1; i+=2) {
+      string opt = argv[i];
+      if (opt=="-s")
+         scale = atof(argv[i+1]);
+      else if (opt=="-o")
+         report = argv[i+1];
+      else if (opt=="-b")
+         baseline = argv[i+1];
+      else if (opt=="-t")
+         tol = atof(argv[i+1]);
+      else {
+         cerr << "Unknown option: " << opt << endl;
+         return 1;
+      }
+   }
+   if (rita[0]!='/') {
+      char *p = realpath(rita.c_str(),nullptr);
+      if (p!=nullptr)
+         rita = p, free(p);
+   }
+
+   vector<Scenario> sc;
+   map<string,pair<double,double> > base;
+   if (readScenarios(dir,sc))
+      return 1;
+   if (baseline!="" && readBaseline(baseline,base))
+      return 1;
+
+   ofstream os(report);
+   if (!os.is_open()) {
+      cerr << "Unable to open file: " << report << endl;
+      return 1;
+   }
+   os << setprecision(8) << "{\n  \"scale\": " << scale << ",\n  \"scenarios\": [";
+   cout << left << setw(18) << "Scenario" << right << setw(10) << "Size" << setw(12) << "Wall (s)"
+        << setw(14) << "Peak RSS (MB)" << "  Status" << endl;
+   int nb_fail=0, nb_reg=0;
+   for (size_t i=0; i<sc.size(); ++i) {
+      Scenario &s = sc[i];
+      s.size = max(1L,lround(s.size*scale));
+      string script = s.name+".rita", prof = s.name+".prof.json";
+      s.wall = s.rss = 0.;
+      remove(prof.c_str());
+      s.status = writeScript(dir,s,script,prof);
+      if (s.status==0)
+         s.status = run(rita,script,s.name+".log",s.wall,s.rss);
+      string state = "ok";
+      if (s.status) {
+         state = "failed (see " + s.name + ".log)";
+         nb_fail++;
+      }
+      else if (base.count(s.name)) {
+         double bw=base[s.name].first, br=base[s.name].second;
+
+//       Differences below 50 ms or 1 MB are noise
+         if (bw>0. && s.wall>bw*(1.+tol) && s.wall-bw>0.05) {
+            state = "REGRESSION: wall time " + to_string(s.wall/bw) + " x baseline";
+            nb_reg++;
+         }
+         else if (br>0. && s.rss>br*(1.+tol) && s.rss-br>1024.) {
+            state = "REGRESSION: peak RSS " + to_string(s.rss/br) + " x baseline";
+            nb_reg++;
+         }
+      }
+      cout << left << setw(18) << s.name << right << setw(10) << s.size << fixed << setprecision(3)
+           << setw(12) << s.wall << setw(14) << s.rss/1024. << "  " << state << defaultfloat << endl;
+
+      os << (i ? "," : "") << "\n    {\"scenario\": \"" << s.name << "\", \"size\": " << s.size
+         << ", \"status\": " << s.status << ", \"wall\": " << s.wall << ", \"rss\": " << s.rss;
+      if (base.count(s.name))
+         os << ", \"baseline-wall\": " << base[s.name].first << ", \"baseline-rss\": " << base[s.name].second;
+      ifstream ip(prof);
+      if (ip.is_open()) {
+         ostringstream ss;
+         ss << ip.rdbuf();
+         string p = ss.str();
+         while (!p.empty() && isspace((unsigned char)p.back()))
+            p.pop_back();
+         os << ",\n     \"profile\": " << p;
+      }
+      os << "}";
+   }
+   os << "\n  ]\n}" << endl;
+   cout << "Report saved in " << report << endl;
+   if (nb_fail)
+      cout << nb_fail << " scenario(s) failed." << endl;
+   if (nb_reg)
+      cout << nb_reg << " regression(s) with respect to " << baseline << "." << endl;
+   return (nb_fail || nb_reg) ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+
+                    Benchmark of parsing long expressions
+
+  ==============================================================================*/
+
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include "../muparserx/mpParser.h"
+
+using namespace std;
+using namespace mup;
+
+/*
+ * Long expressions of the kind produced by scripts (polynomial fits,
+ * piecewise definitions, sums of terms in several variables) are generated
+ * with a given number of terms, parsed and evaluated once. The parse time per
+ * character must not grow with the length of the expression. Each result is
+ * checked against the same formula computed in C++.
+ * Usage: token-bench [max_terms]
+ */
+
+double now()
+{
+   return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// c_0 + c_1*x + c_2*x^2 + ...
+string polynomial(int n, double x, double& r)
+{
+   ostringstream s;
+   s.precision(17);
+   r = 0.;
+   for (int i=0; i<n; ++i) {
+      double c = 1./(i+1);
+      s << (i ? "+" : "") << c << "*x^" << i;
+      r += c*pow(x,i);
+   }
+   return s.str();
+}
+
+
+// (true && x>=0 && x<1 ? 0.5*x-1 : 0) + (true && x>=1 && x<2 ? 1.5*x-1 : 0) + ...
+string piecewise(int n, double x, double& r)
+{
+   ostringstream s;
+   r = 0.;
+   for (int i=0; i<n; ++i) {
+      s << (i ? "+" : "") << "(true && x>=" << i << " && x<" << i+1 << " ? "
+        << i+0.5 << "*x-1 : 0)";
+      if (x>=i && x<i+1)
+         r += (i+0.5)*x - 1;
+   }
+   return s.str();
+}
+
+
+// sin(x*1)*cos(y)+sin(x*2)*cos(y)+...
+string terms(int n, double x, double y, double& r)
+{
+   ostringstream s;
+   r = 0.;
+   for (int i=0; i<n; ++i) {
+      s << (i ? "+" : "") << "sin(x*" << i << ")*cos(y)-abs(-0x" << hex << i << dec << ")";
+      r += sin(x*i)*cos(y) - i;
+   }
+   return s.str();
+}
+
+
+int run(const char *name, int n, const string& e, double r, Value& x, ParserX& p)
+{
+   double t = now();
+   p.SetExpr(e);
+   double v = p.Eval().GetFloat();
+   t = now() - t;
+   cout << name << n << " terms, " << e.size() << " chars: " << t*1.e3 << " ms, "
+        << 1.e9*t/e.size() << " ns/char" << endl;
+   if (fabs(v-r) > 1.e-10*(1.+fabs(r))) {
+      cout << "Wrong result: " << v << " != " << r << endl;
+      return 1;
+   }
+   return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+   int nmax = (argc>1) ? atoi(argv[1]) : 4000;
+   ParserX p;
+   Value x(0.75), y(0.25);
+   p.DefineVar("x",Variable(&x));
+   p.DefineVar("y",Variable(&y));
+
+   int ret = 0;
+   for (int n=nmax/16; n<=nmax; n*=2) {
+      double r;
+      string e = polynomial(n,0.75,r);
+      ret += run("Polynomial, ",n,e,r,x,p);
+      e = piecewise(n,0.75,r);
+      ret += run("Piecewise,  ",n,e,r,x,p);
+      e = terms(n,0.75,0.25,r);
+      ret += run("Terms,      ",n,e,r,x,p);
+   }
+   return ret;
+}
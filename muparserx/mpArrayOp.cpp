@@ -0,0 +1,164 @@
+/** \file
+    \brief Implementation of basic functions used by muParserX.
+
+<pre>
+               __________                                 ____  ___
+    _____  __ _\______   \_____ _______  ______ __________\   \/  /
+   /     \|  |  \     ___/\__  \\_  __ \/  ___// __ \_  __ \     / 
+  |  Y Y  \  |  /    |     / __ \|  | \/\___ \\  ___/|  | \/     \ 
+  |__|_|  /____/|____|    (____  /__|  /____  >\___  >__| /___/\  \
+        \/                     \/           \/     \/           \_/
+                                       Copyright (C) 2016, Ingo Berg
+                                       All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without 
+  modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, 
+     this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright notice, 
+     this list of conditions and the following disclaimer in the documentation 
+     and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+  POSSIBILITY OF SUCH DAMAGE.
+  </pre>
+*/
+#include "mpArrayOp.h"
+#include "mpError.h"
+
+MUP_NAMESPACE_START
+
+  //---------------------------------------------------------------------------
+  /** \brief Copy the entries of a value into contiguous storage.
+
+      A scalar gives a single entry and a matrix its entries row by row.
+      \return false if the value or one of its entries is not a real number.
+  */
+  bool ArrayGet(const IValue &v, std::vector<float_type> &x)
+  {
+    if (v.IsNonComplexScalar())
+    {
+      x.assign(1, v.GetFloat());
+      return true;
+    }
+    if (!v.IsMatrix())
+      return false;
+
+    const matrix_type &a = v.GetArray();
+    int nr = a.GetRows(), nc = a.GetCols();
+    x.resize(std::size_t(nr)*nc);
+    float_type *p = x.data();
+    for (int i=0; i<nr; ++i)
+    {
+      for (int j=0; j<nc; ++j)
+      {
+        const Value &e = a.At(i, j);
+        if (!e.IsNonComplexScalar())
+          return false;
+        *p++ = e.GetFloat();
+      }
+    }
+    return true;
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Copy the entries of a value into contiguous complex storage.
+      \return false if the value or one of its entries is not a number.
+  */
+  bool ArrayGet(const IValue &v, std::vector<cmplx_type> &z)
+  {
+    if (v.IsScalar())
+    {
+      z.assign(1, cmplx_type(v.GetFloat(), v.GetImag()));
+      return true;
+    }
+    if (!v.IsMatrix())
+      return false;
+
+    const matrix_type &a = v.GetArray();
+    int nr = a.GetRows(), nc = a.GetCols();
+    z.resize(std::size_t(nr)*nc);
+    cmplx_type *p = z.data();
+    for (int i=0; i<nr; ++i)
+    {
+      for (int j=0; j<nc; ++j)
+      {
+        const Value &e = a.At(i, j);
+        if (!e.IsScalar())
+          return false;
+        *p++ = cmplx_type(e.GetFloat(), e.GetImag());
+      }
+    }
+    return true;
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Make sure ret is a matrix of given size.
+
+      The storage of ret is kept when it already holds a matrix of this size,
+      which is the case when the stack entry of a previous evaluation is reused.
+      ret is never a variable here, so that its array may be written to.
+  */
+  static matrix_type& ArrayShape(IValue &ret, int nRows, int nCols)
+  {
+    if (!ret.IsMatrix() || ret.GetRows()!=nRows || ret.GetCols()!=nCols)
+      ret = matrix_type(nRows, nCols, Value(0.0));
+    return const_cast<matrix_type&>(ret.GetArray());
+  }
+
+  //---------------------------------------------------------------------------
+  void ArraySet(IValue &ret, int nRows, int nCols, const std::vector<float_type> &y)
+  {
+    matrix_type &a = ArrayShape(ret, nRows, nCols);
+    const float_type *p = y.data();
+    for (int i=0; i<nRows; ++i)
+      for (int j=0; j<nCols; ++j)
+        a.At(i, j) = *p++;
+  }
+
+  //---------------------------------------------------------------------------
+  void ArraySet(IValue &ret, int nRows, int nCols, const std::vector<cmplx_type> &y)
+  {
+    matrix_type &a = ArrayShape(ret, nRows, nCols);
+    const cmplx_type *p = y.data();
+    for (int i=0; i<nRows; ++i)
+      for (int j=0; j<nCols; ++j)
+        a.At(i, j) = *p++;
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Same as ArraySet, a matrix of size 1x1 being stored as a scalar. */
+  void ArrayAssign(IValue &ret, int nRows, int nCols, const std::vector<float_type> &y)
+  {
+    if (nRows==1 && nCols==1)
+      ret = y[0];
+    else
+      ArraySet(ret, nRows, nCols, y);
+  }
+
+  //---------------------------------------------------------------------------
+  void ArrayError(int iStatus, const string_type &sIdent, const IValue &a, const IValue &b)
+  {
+    switch (iStatus)
+    {
+    case asSIZE:
+      throw ParserError(ErrorContext(ecARRAY_SIZE_MISMATCH, -1, sIdent, 'm', 'm', 2));
+    case asARG1:
+      throw ParserError(ErrorContext(ecTYPE_CONFLICT_FUN, -1, sIdent, a.GetType(), 'f', 1));
+    case asARG2:
+      throw ParserError(ErrorContext(ecTYPE_CONFLICT_FUN, -1, sIdent, b.GetType(), 'f', 2));
+    default:
+      break;
+    }
+  }
+
+MUP_NAMESPACE_END
@@ -0,0 +1,252 @@
+/** \file
+    \brief Implementation of basic functions used by muParserX.
+
+<pre>
+               __________                                 ____  ___
+    _____  __ _\______   \_____ _______  ______ __________\   \/  /
+   /     \|  |  \     ___/\__  \\_  __ \/  ___// __ \_  __ \     / 
+  |  Y Y  \  |  /    |     / __ \|  | \/\___ \\  ___/|  | \/     \ 
+  |__|_|  /____/|____|    (____  /__|  /____  >\___  >__| /___/\  \
+        \/                     \/           \/     \/           \_/
+                                       Copyright (C) 2016, Ingo Berg
+                                       All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without 
+  modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, 
+     this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright notice, 
+     this list of conditions and the following disclaimer in the documentation 
+     and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+  POSSIBILITY OF SUCH DAMAGE.
+  </pre>
+*/
+#ifndef MUP_ARRAY_OP_H
+#define MUP_ARRAY_OP_H
+
+/** \file
+    \brief Element-wise evaluation of scalar functions and operators on arrays.
+
+    Entries of matrix values are copied once into contiguous buffers of real or
+    complex numbers, the scalar kernel is applied in a plain loop over these
+    buffers (which the compiler can vectorize) and the results are stored back
+    into the return value. A scalar operand of a binary operation is broadcast to
+    all entries of the other one.
+*/
+
+#include <vector>
+#include <algorithm>
+#include "mpValue.h"
+
+MUP_NAMESPACE_START
+
+  /** \brief Status returned by element-wise array operations. */
+  enum EArrayStatus
+  {
+    asOK = 0,   ///< Result computed
+    asARG1,     ///< First argument (or an entry of it) is not numeric
+    asARG2,     ///< Second argument (or an entry of it) is not numeric
+    asSIZE      ///< Matrix arguments of different sizes
+  };
+
+  bool ArrayGet(const IValue &v, std::vector<float_type> &x);
+  bool ArrayGet(const IValue &v, std::vector<cmplx_type> &z);
+  void ArraySet(IValue &ret, int nRows, int nCols, const std::vector<float_type> &y);
+  void ArraySet(IValue &ret, int nRows, int nCols, const std::vector<cmplx_type> &y);
+  void ArrayAssign(IValue &ret, int nRows, int nCols, const std::vector<float_type> &y);
+
+  //---------------------------------------------------------------------------
+  /** \brief Apply a real function to all entries of a real matrix.
+      \param a Matrix argument, may be the same object as ret
+      \param ret Value receiving the matrix of results
+      \param f Scalar kernel
+  */
+  template<typename F>
+  int ArrayUnary(const IValue &a, IValue &ret, F f)
+  {
+    int nr = a.GetRows(), nc = a.GetCols();
+    std::vector<float_type> x;
+    if (!ArrayGet(a, x))
+      return asARG1;
+    for (std::size_t i=0; i<x.size(); ++i)
+      x[i] = f(x[i]);
+    ArraySet(ret, nr, nc, x);
+    return asOK;
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Apply a function to all entries of a matrix.
+
+      The real kernel fr is used when all entries are real and belong to the
+      domain given by the predicate dom, the complex kernel fc otherwise.
+  */
+  template<typename FR, typename FC, typename D>
+  int ArrayUnaryCmplx(const IValue &a, IValue &ret, FR fr, FC fc, D dom)
+  {
+    int nr = a.GetRows(), nc = a.GetCols();
+    std::vector<float_type> x;
+    if (ArrayGet(a, x))
+    {
+      bool real = true;
+      for (std::size_t i=0; i<x.size(); ++i)
+        real = real && dom(x[i]);
+      if (real)
+      {
+        for (std::size_t i=0; i<x.size(); ++i)
+          x[i] = fr(x[i]);
+        ArraySet(ret, nr, nc, x);
+        return asOK;
+      }
+    }
+
+    std::vector<cmplx_type> z;
+    if (!ArrayGet(a, z))
+      return asARG1;
+    for (std::size_t i=0; i<z.size(); ++i)
+      z[i] = fc(z[i]);
+    ArraySet(ret, nr, nc, z);
+    return asOK;
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Apply a binary kernel entry by entry, broadcasting scalars. */
+  template<typename T, typename F>
+  void ArrayBroadcast(const std::vector<T> &x, const std::vector<T> &y, std::vector<T> &r, F f)
+  {
+    if (x.size()==1)
+    {
+      const T s = x[0];
+      r.resize(y.size());
+      for (std::size_t i=0; i<y.size(); ++i)
+        r[i] = f(s, y[i]);
+    }
+    else if (y.size()==1)
+    {
+      const T s = y[0];
+      r.resize(x.size());
+      for (std::size_t i=0; i<x.size(); ++i)
+        r[i] = f(x[i], s);
+    }
+    else
+    {
+      r.resize(x.size());
+      for (std::size_t i=0; i<x.size(); ++i)
+        r[i] = f(x[i], y[i]);
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Check a predicate on all pairs of entries, broadcasting scalars. */
+  template<typename T, typename D>
+  bool ArrayAll(const std::vector<T> &x, const std::vector<T> &y, D dom)
+  {
+    std::size_t n = std::max(x.size(), y.size());
+    std::size_t dx = (x.size()==1) ? 0 : 1, dy = (y.size()==1) ? 0 : 1;
+    for (std::size_t i=0; i<n; ++i)
+    {
+      if (!dom(x[i*dx], y[i*dy]))
+        return false;
+    }
+    return true;
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Element-wise binary operation on real entries.
+
+      At least one of the arguments is a matrix. Matrix arguments must have the
+      same size, a scalar argument is applied to every entry of the other one.
+      Arguments may be the same object as ret.
+  */
+  template<typename F>
+  int ArrayBinary(const IValue &a, const IValue &b, IValue &ret, F f)
+  {
+    if (a.IsMatrix() && b.IsMatrix() &&
+        (a.GetRows()!=b.GetRows() || a.GetCols()!=b.GetCols()))
+      return asSIZE;
+
+    const IValue &m = (a.IsMatrix()) ? a : b;
+    int nr = m.GetRows(), nc = m.GetCols();
+    std::vector<float_type> x, y, r;
+    if (!ArrayGet(a, x))
+      return asARG1;
+    if (!ArrayGet(b, y))
+      return asARG2;
+    ArrayBroadcast(x, y, r, f);
+    ArraySet(ret, nr, nc, r);
+    return asOK;
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Element-wise binary operation on real or complex entries.
+
+      Same as ArrayBinary, the complex kernel fc being used instead of the real
+      kernel fr when an entry is complex or when a pair of real entries is not
+      in the domain given by the predicate dom.
+  */
+  template<typename FR, typename FC, typename D>
+  int ArrayBinaryCmplx(const IValue &a, const IValue &b, IValue &ret, FR fr, FC fc, D dom)
+  {
+    if (a.IsMatrix() && b.IsMatrix() &&
+        (a.GetRows()!=b.GetRows() || a.GetCols()!=b.GetCols()))
+      return asSIZE;
+
+    const IValue &m = (a.IsMatrix()) ? a : b;
+    int nr = m.GetRows(), nc = m.GetCols();
+    {
+      std::vector<float_type> x, y, r;
+      if (ArrayGet(a, x) && ArrayGet(b, y) && ArrayAll(x, y, dom))
+      {
+        ArrayBroadcast(x, y, r, fr);
+        ArraySet(ret, nr, nc, r);
+        return asOK;
+      }
+    }
+
+    std::vector<cmplx_type> x, y, r;
+    if (!ArrayGet(a, x))
+      return asARG1;
+    if (!ArrayGet(b, y))
+      return asARG2;
+    ArrayBroadcast(x, y, r, fc);
+    ArraySet(ret, nr, nc, r);
+    return asOK;
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Apply a function with real values to all entries of a matrix. */
+  template<typename F>
+  int ArrayUnaryReal(const IValue &a, IValue &ret, F f)
+  {
+    int nr = a.GetRows(), nc = a.GetCols();
+    std::vector<cmplx_type> z;
+    if (!ArrayGet(a, z))
+      return asARG1;
+    std::vector<float_type> x(z.size());
+    for (std::size_t i=0; i<z.size(); ++i)
+      x[i] = f(z[i]);
+    ArraySet(ret, nr, nc, x);
+    return asOK;
+  }
+
+  /** \brief Domain predicate accepting all real arguments */
+  inline bool ArrayAnyReal(float_type) { return true; }
+  inline bool ArrayAnyReal2(float_type, float_type) { return true; }
+
+  //---------------------------------------------------------------------------
+  /** \brief Throw the parser error corresponding to a failed array operation. */
+  void ArrayError(int iStatus, const string_type &sIdent, const IValue &a, const IValue &b);
+
+MUP_NAMESPACE_END
+
+#endif
@@ -29,6 +29,9 @@
 			   POSSIBILITY OF SUCH DAMAGE.
 			   */
 #include "mpError.h"
+
+#include <mutex>
+
 #include "mpIToken.h"
 #include "mpParserMessageProvider.h"
 
@@ -40,11 +43,16 @@ std::unique_ptr<ParserMessageProviderBase> ParserErrorMsg::m_pInstance;
 
 const ParserMessageProviderBase& ParserErrorMsg::Instance()
 {
-	if (!m_pInstance.get())
+	// Errors may be thrown by several threads evaluating at the same time
+	static std::once_flag s_init;
+	std::call_once(s_init, []()
 	{
-		m_pInstance.reset(new ParserMessageProviderEnglish);
-		m_pInstance->Init();
-	}
+		if (!m_pInstance.get())
+		{
+			m_pInstance.reset(new ParserMessageProviderEnglish);
+			m_pInstance->Init();
+		}
+	});
 
 	return *m_pInstance;
 }
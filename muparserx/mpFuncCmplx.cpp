@@ -47,6 +47,7 @@
 //--- Parser framework -----------------------------------------------------
 #include "mpValue.h"
 #include "mpError.h"
+#include "mpArrayOp.h"
 
 
 MUP_NAMESPACE_START
@@ -68,6 +69,13 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxReal::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryReal(*a_pArg[0], *ret, [](cmplx_type z) { return z.real(); });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     float_type v = a_pArg[0]->GetFloat();
     *ret = v;
   }
@@ -97,6 +105,13 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxImag::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryReal(*a_pArg[0], *ret, [](cmplx_type z) { return z.imag(); });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     float_type v = a_pArg[0]->GetImag();
     *ret = v;
   }
@@ -126,6 +141,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxConj::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                               [](float_type x) { return x; },
+                               [](cmplx_type z) { return std::conj(z); },
+                               ArrayAnyReal);
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     *ret = cmplx_type(a_pArg[0]->GetFloat(), -a_pArg[0]->GetImag());
   }
 
@@ -154,6 +179,13 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxArg::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryReal(*a_pArg[0], *ret, [](cmplx_type z) { return std::arg(z); });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     cmplx_type v(a_pArg[0]->GetFloat(), a_pArg[0]->GetImag());
     *ret = std::arg(v);
   }
@@ -183,6 +215,13 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxNorm::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryReal(*a_pArg[0], *ret, [](cmplx_type z) { return std::norm(z); });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     cmplx_type v(a_pArg[0]->GetFloat(), a_pArg[0]->GetImag());
     *ret = std::norm(v);
   }
@@ -216,6 +255,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxCos::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                               [](float_type x) { return std::cos(x); },
+                               [](cmplx_type z) { return std::cos(z); },
+                               ArrayAnyReal);
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     if (a_pArg[0]->IsNonComplexScalar())
     {
       *ret = std::cos(a_pArg[0]->GetFloat());
@@ -252,6 +301,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxSin::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                               [](float_type x) { return std::sin(x); },
+                               [](cmplx_type z) { return std::sin(z); },
+                               ArrayAnyReal);
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     if (a_pArg[0]->IsNonComplexScalar())
     {
       *ret = std::sin(a_pArg[0]->GetFloat());
@@ -288,6 +347,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxCosH::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                               [](float_type x) { return std::cosh(x); },
+                               [](cmplx_type z) { return std::cosh(z); },
+                               ArrayAnyReal);
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     cmplx_type v(a_pArg[0]->GetFloat(), a_pArg[0]->GetImag());
     *ret = cosh(v);
   }
@@ -317,6 +386,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxSinH::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                               [](float_type x) { return std::sinh(x); },
+                               [](cmplx_type z) { return std::sinh(z); },
+                               ArrayAnyReal);
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     cmplx_type v(a_pArg[0]->GetFloat(), a_pArg[0]->GetImag());
     *ret = sinh(v);
   }
@@ -346,6 +425,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxTan::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                               [](float_type x) { return std::tan(x); },
+                               [](cmplx_type z) { return std::tan(z); },
+                               ArrayAnyReal);
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     if (a_pArg[0]->IsNonComplexScalar())
     {
       *ret = std::tan(a_pArg[0]->GetFloat());
@@ -382,6 +471,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxTanH::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                               [](float_type x) { return std::tanh(x); },
+                               [](cmplx_type z) { return std::tanh(z); },
+                               ArrayAnyReal);
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     cmplx_type v(a_pArg[0]->GetFloat(), a_pArg[0]->GetImag());
     *ret = tanh(v);
   }
@@ -411,6 +510,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxSqrt::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                               [](float_type x) { return std::sqrt(x); },
+                               [](cmplx_type z) { return std::sqrt(z); },
+                               [](float_type x) { return x>=0; });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     *ret = sqrt((*a_pArg[0]).GetComplex());
   }
 
@@ -440,6 +549,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxExp::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                               [](float_type x) { return std::exp(x); },
+                               [](cmplx_type z) { return std::exp(z); },
+                               ArrayAnyReal);
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     cmplx_type v(a_pArg[0]->GetFloat(), a_pArg[0]->GetImag());
     *ret = exp(v);
   }
@@ -469,6 +588,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxLn::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                               [](float_type x) { return std::log(x); },
+                               [](cmplx_type z) { return std::log(z); },
+                               [](float_type x) { return x>=0; });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     cmplx_type v(a_pArg[0]->GetFloat(), a_pArg[0]->GetImag());
     *ret = log(v);
   }
@@ -498,6 +627,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxLog::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                               [](float_type x) { return std::log(x); },
+                               [](cmplx_type z) { return std::log(z); },
+                               [](float_type x) { return x>=0; });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     cmplx_type v(a_pArg[0]->GetFloat(), a_pArg[0]->GetImag());
     *ret = log(v);
   }
@@ -528,6 +667,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxLog10::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                               [](float_type x) { return std::log10(x); },
+                               [](cmplx_type z) { return std::log10(z); },
+                               [](float_type x) { return x>=0; });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     cmplx_type v(a_pArg[0]->GetFloat(), a_pArg[0]->GetImag());
     *ret = log10(v);
   }
@@ -557,6 +706,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxLog2::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                               [](float_type x) { return std::log2(x); },
+                               [](cmplx_type z) { return std::log(z)/std::log((float_type)2.0); },
+                               [](float_type x) { return x>=0; });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
     std::complex<float_type> v(a_pArg[0]->GetFloat(), a_pArg[0]->GetImag());
     *ret = std::log(v) * (float_type)1.0/std::log((float_type)2.0);
   }
@@ -586,9 +745,15 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxAbs::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
-    float_type v = sqrt(a_pArg[0]->GetFloat()*a_pArg[0]->GetFloat() + 
-                        a_pArg[0]->GetImag()*a_pArg[0]->GetImag());
-    *ret = v;
+    if (a_pArg[0]->IsMatrix())
+    {
+      int st = ArrayUnaryReal(*a_pArg[0], *ret, [](cmplx_type z) { return std::abs(z); });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
+      return;
+    }
+
+    // hypot does not overflow or underflow for large or small parts
+    *ret = std::hypot(a_pArg[0]->GetFloat(), a_pArg[0]->GetImag());
   }
 
   //-----------------------------------------------------------------------
@@ -616,6 +781,16 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------
   void FunCmplxPow::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
   {
+    if (a_pArg[0]->IsMatrix() || a_pArg[1]->IsMatrix())
+    {
+      int st = ArrayBinaryCmplx(*a_pArg[0], *a_pArg[1], *ret,
+                                [](float_type x, float_type y) { return std::pow(x, y); },
+                                [](cmplx_type x, cmplx_type y) { return std::pow(x, y); },
+                                [](float_type x, float_type y) { return x>=0 || y==std::floor(y); });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[1]);
+      return;
+    }
+
     *ret = std::pow(a_pArg[0]->GetComplex(), a_pArg[1]->GetComplex());
   }
 
@@ -41,10 +41,14 @@
 #include <cassert>
 #include <complex>
 #include <iostream>
+#include <vector>
 
 //--- Parser framework -----------------------------------------------------
 #include "mpValue.h"
 #include "mpError.h"
+#include "mpMatrixError.h"
+#include "mpArrayOp.h"
+#include "mpLinAlg.h"
 
 
 MUP_NAMESPACE_START
@@ -246,4 +250,348 @@ IToken* FunMatrixSize::Clone() const
     return new FunMatrixSize(*this);
 }
 
+namespace
+{
+  //-----------------------------------------------------------------------
+  /** \brief Copy a real matrix argument into flat storage, row by row.
+      \throw ParserError if the argument is not a real matrix or scalar
+  */
+  void GetDense(const IValue &v, std::vector<float_type> &a, int &nRows, int &nCols,
+                const string_type &sIdent, int iArg = 1)
+  {
+    if (!ArrayGet(v, a))
+      throw ParserError(ErrorContext(ecTYPE_CONFLICT_FUN, -1, sIdent, v.GetType(), 'm', iArg));
+    nRows = v.GetRows();
+    nCols = v.GetCols();
+  }
+
+  //-----------------------------------------------------------------------
+  /** \brief Copy a square matrix argument into flat storage.
+      \return Size of the matrix
+  */
+  int GetSquare(const IValue &v, std::vector<float_type> &a, const string_type &sIdent)
+  {
+    int nRows, nCols;
+    GetDense(v, a, nRows, nCols, sIdent);
+    if (nRows != nCols)
+      throw MatrixError("Matrix is not square.");
+    return nRows;
+  }
+
+  //-----------------------------------------------------------------------
+  /** \brief Return the optional string argument selecting a factor. */
+  string_type GetFactor(const ptr_val_type *a_pArg, int argc, const string_type &sIdent)
+  {
+    if (argc < 1 || argc > 2)
+    {
+      ErrorContext err;
+      err.Errc = ecINVALID_NUMBER_OF_PARAMETERS;
+      err.Arg = argc;
+      err.Ident = sIdent;
+      throw ParserError(err);
+    }
+    return (argc == 2) ? a_pArg[1]->GetString() : string_type();
+  }
+
+  //-----------------------------------------------------------------------
+  void InvalidFactor(const string_type &sIdent)
+  {
+    ErrorContext err(ecINVALID_PARAMETER, -1, sIdent);
+    err.Arg = 2;
+    throw ParserError(err);
+  }
+} // namespace
+
+//-----------------------------------------------------------------------
+//
+//  class FunMatrixInv
+//
+//-----------------------------------------------------------------------
+
+FunMatrixInv::FunMatrixInv()
+    :ICallback(cmFUNC, _T("inv"), 1)
+{}
+
+//-----------------------------------------------------------------------
+FunMatrixInv::~FunMatrixInv()
+{}
+
+//-----------------------------------------------------------------------
+void FunMatrixInv::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
+{
+    std::vector<float_type> a;
+    int n = GetSquare(*a_pArg[0], a, GetIdent());
+    std::vector<int> piv(n);
+    if (DenseLU(n, a.data(), piv.data()) == 0)
+        throw ParserError(_T("Matrix is singular."));
+
+    std::vector<float_type> b((std::size_t)n*n, 0.0);
+    for (int i = 0; i < n; ++i)
+        b[(std::size_t)i*n + i] = 1.0;
+    DenseLUSolve(n, a.data(), piv.data(), n, b.data());
+    ArrayAssign(*ret, n, n, b);
+}
+
+//-----------------------------------------------------------------------
+const char_type* FunMatrixInv::GetDesc() const
+{
+    return _T("inv(A) - Returns the inverse of the square matrix A.");
+}
+
+//-----------------------------------------------------------------------
+IToken* FunMatrixInv::Clone() const
+{
+    return new FunMatrixInv(*this);
+}
+
+//-----------------------------------------------------------------------
+//
+//  class FunMatrixDet
+//
+//-----------------------------------------------------------------------
+
+FunMatrixDet::FunMatrixDet()
+    :ICallback(cmFUNC, _T("det"), 1)
+{}
+
+//-----------------------------------------------------------------------
+FunMatrixDet::~FunMatrixDet()
+{}
+
+//-----------------------------------------------------------------------
+void FunMatrixDet::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
+{
+    std::vector<float_type> a;
+    int n = GetSquare(*a_pArg[0], a, GetIdent());
+    std::vector<int> piv(n);
+    float_type d = DenseLU(n, a.data(), piv.data());
+    for (int i = 0; i < n && d != 0; ++i)
+        d *= a[(std::size_t)i*n + i];
+    *ret = d;
+}
+
+//-----------------------------------------------------------------------
+const char_type* FunMatrixDet::GetDesc() const
+{
+    return _T("det(A) - Returns the determinant of the square matrix A.");
+}
+
+//-----------------------------------------------------------------------
+IToken* FunMatrixDet::Clone() const
+{
+    return new FunMatrixDet(*this);
+}
+
+//-----------------------------------------------------------------------
+//
+//  class FunMatrixChol
+//
+//-----------------------------------------------------------------------
+
+FunMatrixChol::FunMatrixChol()
+    :ICallback(cmFUNC, _T("chol"), 1)
+{}
+
+//-----------------------------------------------------------------------
+FunMatrixChol::~FunMatrixChol()
+{}
+
+//-----------------------------------------------------------------------
+void FunMatrixChol::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
+{
+    std::vector<float_type> a;
+    int n = GetSquare(*a_pArg[0], a, GetIdent());
+    if (!DenseChol(n, a.data()))
+        throw ParserError(_T("Matrix is not positive definite."));
+
+    for (int i = 0; i < n; ++i)
+        std::fill(a.begin() + (std::size_t)i*n + i + 1, a.begin() + (std::size_t)(i + 1)*n, 0.0);
+    ArrayAssign(*ret, n, n, a);
+}
+
+//-----------------------------------------------------------------------
+const char_type* FunMatrixChol::GetDesc() const
+{
+    return _T("chol(A) - Returns the lower triangular matrix L such that A = L*L' for a symmetric positive definite matrix A.");
+}
+
+//-----------------------------------------------------------------------
+IToken* FunMatrixChol::Clone() const
+{
+    return new FunMatrixChol(*this);
+}
+
+//-----------------------------------------------------------------------
+//
+//  class FunMatrixLU
+//
+//-----------------------------------------------------------------------
+
+FunMatrixLU::FunMatrixLU()
+    :ICallback(cmFUNC, _T("lu"), -1)
+{}
+
+//-----------------------------------------------------------------------
+FunMatrixLU::~FunMatrixLU()
+{}
+
+//-----------------------------------------------------------------------
+void FunMatrixLU::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int argc)
+{
+    string_type sFactor = GetFactor(a_pArg, argc, GetIdent());
+    if (sFactor != _T("") && sFactor != _T("L") && sFactor != _T("U") && sFactor != _T("P"))
+        InvalidFactor(GetIdent());
+
+    std::vector<float_type> a;
+    int n = GetSquare(*a_pArg[0], a, GetIdent());
+    std::vector<int> piv(n);
+    DenseLU(n, a.data(), piv.data());
+
+    if (sFactor == _T("L"))
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            a[(std::size_t)i*n + i] = 1.0;
+            std::fill(a.begin() + (std::size_t)i*n + i + 1, a.begin() + (std::size_t)(i + 1)*n, 0.0);
+        }
+    }
+    else if (sFactor == _T("U"))
+    {
+        for (int i = 1; i < n; ++i)
+            std::fill(a.begin() + (std::size_t)i*n, a.begin() + (std::size_t)i*n + i, 0.0);
+    }
+    else if (sFactor == _T("P"))
+    {
+        // Permutation matrix such that P*A = L*U
+        std::vector<int> perm(n);
+        for (int i = 0; i < n; ++i)
+            perm[i] = i;
+        for (int i = 0; i < n; ++i)
+            std::swap(perm[i], perm[piv[i]]);
+        std::fill(a.begin(), a.end(), 0.0);
+        for (int i = 0; i < n; ++i)
+            a[(std::size_t)i*n + perm[i]] = 1.0;
+    }
+    ArrayAssign(*ret, n, n, a);
+}
+
+//-----------------------------------------------------------------------
+const char_type* FunMatrixLU::GetDesc() const
+{
+    return _T("lu(A [, \"L\"|\"U\"|\"P\"]) - LU decomposition P*A = L*U with partial pivoting. Returns L and U stored in a single matrix, or the selected factor.");
+}
+
+//-----------------------------------------------------------------------
+IToken* FunMatrixLU::Clone() const
+{
+    return new FunMatrixLU(*this);
+}
+
+//-----------------------------------------------------------------------
+//
+//  class FunMatrixQR
+//
+//-----------------------------------------------------------------------
+
+FunMatrixQR::FunMatrixQR()
+    :ICallback(cmFUNC, _T("qr"), -1)
+{}
+
+//-----------------------------------------------------------------------
+FunMatrixQR::~FunMatrixQR()
+{}
+
+//-----------------------------------------------------------------------
+void FunMatrixQR::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int argc)
+{
+    string_type sFactor = GetFactor(a_pArg, argc, GetIdent());
+    if (sFactor != _T("") && sFactor != _T("Q") && sFactor != _T("R"))
+        InvalidFactor(GetIdent());
+
+    std::vector<float_type> a;
+    int m, n;
+    GetDense(*a_pArg[0], a, m, n, GetIdent());
+    int k = std::min(m, n);
+    std::vector<float_type> tau(k);
+    DenseQR(m, n, a.data(), tau.data());
+
+    if (sFactor == _T("Q"))
+    {
+        std::vector<float_type> q((std::size_t)m*k);
+        DenseQRGetQ(m, n, a.data(), tau.data(), q.data());
+        ArrayAssign(*ret, m, k, q);
+    }
+    else
+    {
+        std::vector<float_type> r((std::size_t)k*n, 0.0);
+        for (int i = 0; i < k; ++i)
+            std::copy(a.begin() + (std::size_t)i*n + i, a.begin() + (std::size_t)(i + 1)*n, r.begin() + (std::size_t)i*n + i);
+        ArrayAssign(*ret, k, n, r);
+    }
+}
+
+//-----------------------------------------------------------------------
+const char_type* FunMatrixQR::GetDesc() const
+{
+    return _T("qr(A [, \"Q\"|\"R\"]) - Economy size QR decomposition A = Q*R. Returns R, or the selected factor.");
+}
+
+//-----------------------------------------------------------------------
+IToken* FunMatrixQR::Clone() const
+{
+    return new FunMatrixQR(*this);
+}
+
+//-----------------------------------------------------------------------
+//
+//  class FunMatrixSVD
+//
+//-----------------------------------------------------------------------
+
+FunMatrixSVD::FunMatrixSVD()
+    :ICallback(cmFUNC, _T("svd"), -1)
+{}
+
+//-----------------------------------------------------------------------
+FunMatrixSVD::~FunMatrixSVD()
+{}
+
+//-----------------------------------------------------------------------
+void FunMatrixSVD::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int argc)
+{
+    string_type sFactor = GetFactor(a_pArg, argc, GetIdent());
+    if (sFactor != _T("") && sFactor != _T("S") && sFactor != _T("U") && sFactor != _T("V"))
+        InvalidFactor(GetIdent());
+
+    std::vector<float_type> a;
+    int m, n;
+    GetDense(*a_pArg[0], a, m, n, GetIdent());
+    int k = std::min(m, n);
+    std::vector<float_type> s(k), u, v;
+    if (sFactor == _T("U"))
+        u.resize((std::size_t)m*k);
+    if (sFactor == _T("V"))
+        v.resize((std::size_t)n*k);
+    DenseSVD(m, n, a.data(), s.data(), u.empty() ? nullptr : u.data(), v.empty() ? nullptr : v.data());
+
+    if (sFactor == _T("U"))
+        ArrayAssign(*ret, m, k, u);
+    else if (sFactor == _T("V"))
+        ArrayAssign(*ret, n, k, v);
+    else
+        ArrayAssign(*ret, k, 1, s);
+}
+
+//-----------------------------------------------------------------------
+const char_type* FunMatrixSVD::GetDesc() const
+{
+    return _T("svd(A [, \"S\"|\"U\"|\"V\"]) - Economy size singular value decomposition A = U*S*V'. Returns the vector of singular values in decreasing order, or the selected factor.");
+}
+
+//-----------------------------------------------------------------------
+IToken* FunMatrixSVD::Clone() const
+{
+    return new FunMatrixSVD(*this);
+}
+
 MUP_NAMESPACE_END
@@ -98,6 +98,90 @@ MUP_NAMESPACE_START
     virtual const char_type* GetDesc() const override;
     virtual IToken* Clone() const override;
   };
+
+  //-----------------------------------------------------------------------
+  /** \brief Computes the inverse of a square matrix.
+      \ingroup functions
+  */
+  class FunMatrixInv : public ICallback
+  {
+  public:
+    FunMatrixInv();
+    virtual ~FunMatrixInv();
+    virtual void Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int a_iArgc) override;
+    virtual const char_type* GetDesc() const override;
+    virtual IToken* Clone() const override;
+  };
+
+  //-----------------------------------------------------------------------
+  /** \brief Computes the determinant of a square matrix.
+      \ingroup functions
+  */
+  class FunMatrixDet : public ICallback
+  {
+  public:
+    FunMatrixDet();
+    virtual ~FunMatrixDet();
+    virtual void Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int a_iArgc) override;
+    virtual const char_type* GetDesc() const override;
+    virtual IToken* Clone() const override;
+  };
+
+  //-----------------------------------------------------------------------
+  /** \brief Cholesky factor of a symmetric positive definite matrix.
+      \ingroup functions
+  */
+  class FunMatrixChol : public ICallback
+  {
+  public:
+    FunMatrixChol();
+    virtual ~FunMatrixChol();
+    virtual void Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int a_iArgc) override;
+    virtual const char_type* GetDesc() const override;
+    virtual IToken* Clone() const override;
+  };
+
+  //-----------------------------------------------------------------------
+  /** \brief Factors of the LU decomposition of a square matrix.
+      \ingroup functions
+  */
+  class FunMatrixLU : public ICallback
+  {
+  public:
+    FunMatrixLU();
+    virtual ~FunMatrixLU();
+    virtual void Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int a_iArgc) override;
+    virtual const char_type* GetDesc() const override;
+    virtual IToken* Clone() const override;
+  };
+
+  //-----------------------------------------------------------------------
+  /** \brief Factors of the QR decomposition of a matrix.
+      \ingroup functions
+  */
+  class FunMatrixQR : public ICallback
+  {
+  public:
+    FunMatrixQR();
+    virtual ~FunMatrixQR();
+    virtual void Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int a_iArgc) override;
+    virtual const char_type* GetDesc() const override;
+    virtual IToken* Clone() const override;
+  };
+
+  //-----------------------------------------------------------------------
+  /** \brief Singular values and vectors of a matrix.
+      \ingroup functions
+  */
+  class FunMatrixSVD : public ICallback
+  {
+  public:
+    FunMatrixSVD();
+    virtual ~FunMatrixSVD();
+    virtual void Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int a_iArgc) override;
+    virtual const char_type* GetDesc() const override;
+    virtual IToken* Clone() const override;
+  };
 }  // namespace mu
 
 #endif
@@ -42,6 +42,7 @@
 //--- muParserX framework --------------------------------------------------
 #include "mpValue.h"
 #include "mpError.h"
+#include "mpArrayOp.h"
 
 #undef log
 #undef log2
@@ -55,6 +56,13 @@ MUP_NAMESPACE_START
                                                                      \
     void CLASS::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)        \
     {                                                                \
+      if (a_pArg[0]->IsMatrix())                                     \
+      {                                                              \
+        int st = ArrayUnary(*a_pArg[0], *ret,                        \
+                            [](float_type x) { return FUNC(x); });   \
+        ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);          \
+        return;                                                      \
+      }                                                              \
       *ret = FUNC(a_pArg[0]->GetFloat());                            \
     }                                                                \
                                                                      \
@@ -103,6 +111,13 @@ MUP_NAMESPACE_START
                                                                      \
     void CLASS::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)        \
     {                                                                \
+      if (a_pArg[0]->IsMatrix() || a_pArg[1]->IsMatrix())            \
+      {                                                              \
+        int st = ArrayBinary(*a_pArg[0], *a_pArg[1], *ret,           \
+                  [](float_type x, float_type y) { return FUNC(x, y); }); \
+        ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[1]);          \
+        return;                                                      \
+      }                                                              \
       *ret = FUNC(a_pArg[0]->GetFloat(), a_pArg[1]->GetFloat());     \
     }                                                                \
                                                                      \
@@ -71,7 +71,8 @@ MUP_NAMESPACE_START
     enum EFlags
     {
       flNONE = 0,
-      flVOLATILE = 1
+      flVOLATILE = 1,
+      flMODIFIED = 2   ///< Value written through a variable since the flag was last cleared
     };
 
     virtual IToken* Clone() const = 0;
@@ -0,0 +1,758 @@
+/** \file
+    \brief Dense linear algebra kernels used by muParserX.
+
+<pre>
+               __________                                 ____  ___
+    _____  __ _\______   \_____ _______  ______ __________\   \/  /
+   /     \|  |  \     ___/\__  \\_  __ \/  ___// __ \_  __ \     / 
+  |  Y Y  \  |  /    |     / __ \|  | \/\___ \\  ___/|  | \/     \ 
+  |__|_|  /____/|____|    (____  /__|  /____  >\___  >__| /___/\  \
+        \/                     \/           \/     \/           \_/
+                                       Copyright (C) 2016, Ingo Berg
+                                       All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without 
+  modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, 
+     this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright notice, 
+     this list of conditions and the following disclaimer in the documentation 
+     and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+  POSSIBILITY OF SUCH DAMAGE.
+  </pre>
+*/
+#include "mpLinAlg.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#if !defined(_WIN32)
+  #include <unistd.h>
+#endif
+
+MUP_NAMESPACE_START
+
+  namespace
+  {
+    //---------------------------------------------------------------------------
+    /** \brief Pool of worker threads running the dense kernels.
+
+        A call to Run splits a range of iterations into one chunk per thread,
+        the calling thread computing the first chunk. Concurrent calls and
+        calls from a forked process are run by the calling thread alone. The
+        number of threads can be set by the environment variable
+        MUP_NUM_THREADS.
+    */
+    class LinAlgPool
+    {
+    public:
+      LinAlgPool()
+        :m_nGen(0)
+        ,m_nBusy(0)
+        ,m_nIter(0)
+        ,m_bStop(false)
+        ,m_pJob(nullptr)
+#if !defined(_WIN32)
+        ,m_pid(getpid())
+#endif
+      {
+        int nt = (int)std::thread::hardware_concurrency();
+        const char *szThreads = std::getenv("MUP_NUM_THREADS");
+        if (szThreads)
+          nt = std::atoi(szThreads);
+        for (int i=1; i<std::min(nt, 32); ++i)
+          m_vThreads.emplace_back(&LinAlgPool::Work, this, i);
+      }
+
+      ~LinAlgPool()
+      {
+        {
+          std::lock_guard<std::mutex> lk(m_mtx);
+          m_bStop = true;
+        }
+        m_cvJob.notify_all();
+        for (auto &t : m_vThreads)
+          t.join();
+      }
+
+      int Size() const
+      {
+        return (int)m_vThreads.size() + 1;
+      }
+
+      void Run(int n, const std::function<void(int, int)> &f)
+      {
+        std::unique_lock<std::mutex> run(m_run, std::try_to_lock);
+        bool bSerial = !run.owns_lock() || m_vThreads.empty();
+#if !defined(_WIN32)
+        bSerial = bSerial || getpid()!=m_pid;
+#endif
+        if (bSerial)
+        {
+          f(0, n);
+          return;
+        }
+
+        {
+          std::lock_guard<std::mutex> lk(m_mtx);
+          m_pJob = &f;
+          m_nIter = n;
+          m_nBusy = (int)m_vThreads.size();
+          ++m_nGen;
+        }
+        m_cvJob.notify_all();
+
+        int i1 = (int)((long long)n/Size());
+        if (i1>0)
+          f(0, i1);
+
+        std::unique_lock<std::mutex> lk(m_mtx);
+        m_cvDone.wait(lk, [this] { return m_nBusy==0; });
+      }
+
+    private:
+      void Work(int id)
+      {
+        unsigned gen = 0;
+        for (;;)
+        {
+          const std::function<void(int, int)> *job;
+          int n;
+          {
+            std::unique_lock<std::mutex> lk(m_mtx);
+            m_cvJob.wait(lk, [&] { return m_bStop || m_nGen!=gen; });
+            if (m_bStop)
+              return;
+            gen = m_nGen;
+            job = m_pJob;
+            n = m_nIter;
+          }
+
+          int i0 = (int)((long long)n*id/Size()),
+              i1 = (int)((long long)n*(id + 1)/Size());
+          if (i0<i1)
+            (*job)(i0, i1);
+
+          std::lock_guard<std::mutex> lk(m_mtx);
+          if (--m_nBusy==0)
+            m_cvDone.notify_one();
+        }
+      }
+
+      std::vector<std::thread> m_vThreads;
+      std::mutex m_mtx, m_run;
+      std::condition_variable m_cvJob, m_cvDone;
+      unsigned m_nGen;
+      int m_nBusy, m_nIter;
+      bool m_bStop;
+      const std::function<void(int, int)> *m_pJob;
+#if !defined(_WIN32)
+      pid_t m_pid;
+#endif
+    };
+
+    LinAlgPool& Pool()
+    {
+      static LinAlgPool pool;
+      return pool;
+    }
+
+    // Block sizes of the matrix product and of the factorizations
+    const int GEMM_KB = 128, GEMM_NB = 512, FACT_NB = 64;
+
+    // Below this number of operations a loop is not worth distributing
+    const double PAR_MIN_WORK = 2.e5;
+
+    float_type Dot(const float_type *x, const float_type *y, int n)
+    {
+      float_type s = 0;
+      for (int i=0; i<n; ++i)
+        s += x[i]*y[i];
+      return s;
+    }
+  } // namespace
+
+  //---------------------------------------------------------------------------
+  int LinAlgThreads()
+  {
+    return Pool().Size();
+  }
+
+  //---------------------------------------------------------------------------
+  void LinAlgParallel(int n, double work, const std::function<void(int, int)> &f)
+  {
+    if (n<=0)
+      return;
+    if (n==1 || work<PAR_MIN_WORK)
+      f(0, n);
+    else
+      Pool().Run(n, f);
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Matrix product update c += alpha*a*b.
+
+      a is a m x k matrix, b a k x n matrix and c a m x n matrix. Rows of c are
+      distributed among threads by groups of four. For each block of b fitting
+      in cache, four rows of c are updated at once so that every entry of b
+      loaded is used four times; the inner loops run over contiguous entries.
+  */
+  void DenseGemm(int m, int n, int k, float_type alpha,
+                 const float_type *a, int lda, const float_type *b, int ldb,
+                 float_type *c, int ldc)
+  {
+    if (m<=0 || n<=0 || k<=0)
+      return;
+
+    LinAlgParallel((m + 3)/4, 2.0*m*n*k, [=](int g0, int g1)
+    {
+      int r0 = 4*g0, r1 = std::min(m, 4*g1);
+      for (int p0=0; p0<k; p0+=GEMM_KB)
+      {
+        int p1 = std::min(k, p0 + GEMM_KB);
+        for (int j0=0; j0<n; j0+=GEMM_NB)
+        {
+          int nj = std::min(n, j0 + GEMM_NB) - j0;
+          int i = r0;
+          for (; i+4<=r1; i+=4)
+          {
+            float_type *c0 = c + (std::size_t)i*ldc + j0, *c1 = c0 + ldc,
+                       *c2 = c1 + ldc, *c3 = c2 + ldc;
+            const float_type *a0 = a + (std::size_t)i*lda, *a1 = a0 + lda,
+                             *a2 = a1 + lda, *a3 = a2 + lda;
+            for (int p=p0; p<p1; ++p)
+            {
+              const float_type *bp = b + (std::size_t)p*ldb + j0;
+              float_type s0 = alpha*a0[p], s1 = alpha*a1[p], s2 = alpha*a2[p], s3 = alpha*a3[p];
+              for (int j=0; j<nj; ++j)
+              {
+                float_type x = bp[j];
+                c0[j] += s0*x;
+                c1[j] += s1*x;
+                c2[j] += s2*x;
+                c3[j] += s3*x;
+              }
+            }
+          }
+          for (; i<r1; ++i)
+          {
+            float_type *ci = c + (std::size_t)i*ldc + j0;
+            const float_type *ai = a + (std::size_t)i*lda;
+            for (int p=p0; p<p1; ++p)
+            {
+              const float_type *bp = b + (std::size_t)p*ldb + j0;
+              float_type s = alpha*ai[p];
+              for (int j=0; j<nj; ++j)
+                ci[j] += s*bp[j];
+            }
+          }
+        }
+      }
+    });
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Matrix product c = a*b of a m x k matrix by a k x n matrix. */
+  void DenseMul(int m, int n, int k, const float_type *a, const float_type *b, float_type *c)
+  {
+    std::fill(c, c + (std::size_t)m*n, (float_type)0);
+    DenseGemm(m, n, k, 1, a, k, b, n, c, n);
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief LU factorization with partial pivoting, PA = LU.
+
+      The factorization is blocked: a panel of columns is factorized, the
+      corresponding block row of U is computed and the trailing matrix is
+      updated by a matrix product.
+      \param n Size of the square matrix a, overwritten by L (unit lower part)
+             and U (upper part)
+      \param piv On return, row i was interchanged with row piv[i]
+      \return Sign of the permutation, 0 if the matrix is singular
+  */
+  int DenseLU(int n, float_type *a, int *piv)
+  {
+    int sign = 1;
+    bool bSingular = false;
+    for (int k0=0; k0<n; k0+=FACT_NB)
+    {
+      int k1 = std::min(n, k0 + FACT_NB);
+
+      // Panel factorization, row interchanges are applied to whole rows
+      for (int k=k0; k<k1; ++k)
+      {
+        int p = k;
+        float_type vmax = std::fabs(a[(std::size_t)k*n + k]);
+        for (int i=k+1; i<n; ++i)
+        {
+          float_type v = std::fabs(a[(std::size_t)i*n + k]);
+          if (v>vmax)
+          {
+            vmax = v;
+            p = i;
+          }
+        }
+        piv[k] = p;
+        if (vmax==0)
+        {
+          bSingular = true;
+          continue;
+        }
+        if (p!=k)
+        {
+          std::swap_ranges(a + (std::size_t)k*n, a + (std::size_t)(k + 1)*n, a + (std::size_t)p*n);
+          sign = -sign;
+        }
+
+        const float_type *rk = a + (std::size_t)k*n;
+        float_type d = 1/rk[k];
+        for (int i=k+1; i<n; ++i)
+        {
+          float_type *ri = a + (std::size_t)i*n;
+          float_type l = (ri[k] *= d);
+          for (int j=k+1; j<k1; ++j)
+            ri[j] -= l*rk[j];
+        }
+      }
+
+      if (k1==n)
+        break;
+
+      // Block row of U: forward substitution with the unit lower block
+      int nr = n - k1;
+      LinAlgParallel(nr, (double)(k1 - k0)*(k1 - k0)*nr, [=](int j0, int j1)
+      {
+        for (int k=k0; k<k1; ++k)
+        {
+          const float_type *rk = a + (std::size_t)k*n + k1;
+          for (int i=k+1; i<k1; ++i)
+          {
+            float_type *ri = a + (std::size_t)i*n + k1;
+            float_type l = a[(std::size_t)i*n + k];
+            for (int j=j0; j<j1; ++j)
+              ri[j] -= l*rk[j];
+          }
+        }
+      });
+
+      // Trailing matrix update
+      DenseGemm(nr, nr, k1 - k0, -1, a + (std::size_t)k1*n + k0, n,
+                a + (std::size_t)k0*n + k1, n, a + (std::size_t)k1*n + k1, n);
+    }
+    return bSingular ? 0 : sign;
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Solve LU X = P B for nrhs right hand sides.
+      \param b n x nrhs matrix of right hand sides, overwritten by the solution
+  */
+  void DenseLUSolve(int n, const float_type *lu, const int *piv, int nrhs, float_type *b)
+  {
+    for (int k=0; k<n; ++k)
+    {
+      if (piv[k]!=k)
+        std::swap_ranges(b + (std::size_t)k*nrhs, b + (std::size_t)(k + 1)*nrhs, b + (std::size_t)piv[k]*nrhs);
+    }
+
+    LinAlgParallel(nrhs, 2.0*n*n*nrhs, [=](int j0, int j1)
+    {
+      for (int i=1; i<n; ++i)
+      {
+        float_type *bi = b + (std::size_t)i*nrhs;
+        const float_type *li = lu + (std::size_t)i*n;
+        for (int k=0; k<i; ++k)
+        {
+          const float_type *bk = b + (std::size_t)k*nrhs;
+          for (int j=j0; j<j1; ++j)
+            bi[j] -= li[k]*bk[j];
+        }
+      }
+      for (int i=n-1; i>=0; --i)
+      {
+        float_type *bi = b + (std::size_t)i*nrhs;
+        const float_type *ui = lu + (std::size_t)i*n;
+        for (int k=i+1; k<n; ++k)
+        {
+          const float_type *bk = b + (std::size_t)k*nrhs;
+          for (int j=j0; j<j1; ++j)
+            bi[j] -= ui[k]*bk[j];
+        }
+        float_type d = 1/ui[i];
+        for (int j=j0; j<j1; ++j)
+          bi[j] *= d;
+      }
+    });
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Blocked Cholesky factorization A = L L'.
+
+      Only the lower part of a is used, it is overwritten by L.
+      \return false if the matrix is not positive definite
+  */
+  bool DenseChol(int n, float_type *a)
+  {
+    std::vector<float_type> t;
+    for (int k0=0; k0<n; k0+=FACT_NB)
+    {
+      int k1 = std::min(n, k0 + FACT_NB), kb = k1 - k0;
+
+      // Diagonal block
+      for (int j=k0; j<k1; ++j)
+      {
+        float_type *rj = a + (std::size_t)j*n;
+        float_type d = rj[j] - Dot(rj + k0, rj + k0, j - k0);
+        if (!(d>0))
+          return false;
+        rj[j] = std::sqrt(d);
+        for (int i=j+1; i<k1; ++i)
+        {
+          float_type *ri = a + (std::size_t)i*n;
+          ri[j] = (ri[j] - Dot(ri + k0, rj + k0, j - k0))/rj[j];
+        }
+      }
+
+      int nr = n - k1;
+      if (nr==0)
+        break;
+
+      // Panel below the diagonal block
+      LinAlgParallel(nr, (double)kb*kb*nr, [=](int i0, int i1)
+      {
+        for (int i=k1+i0; i<k1+i1; ++i)
+        {
+          float_type *ri = a + (std::size_t)i*n;
+          for (int j=k0; j<k1; ++j)
+          {
+            const float_type *rj = a + (std::size_t)j*n;
+            ri[j] = (ri[j] - Dot(ri + k0, rj + k0, j - k0))/rj[j];
+          }
+        }
+      });
+
+      // Lower part of the trailing matrix, using the transposed panel
+      t.resize((std::size_t)kb*nr);
+      for (int i=0; i<nr; ++i)
+        for (int p=0; p<kb; ++p)
+          t[(std::size_t)p*nr + i] = a[(std::size_t)(k1 + i)*n + k0 + p];
+      const float_type *pt = t.data();
+      LinAlgParallel(nr, (double)kb*nr*nr, [=](int i0, int i1)
+      {
+        for (int j0=0; j0<i1; j0+=GEMM_NB)
+        {
+          for (int i=std::max(i0, j0); i<i1; ++i)
+          {
+            float_type *ri = a + (std::size_t)(k1 + i)*n + k1;
+            const float_type *li = a + (std::size_t)(k1 + i)*n + k0;
+            int j1 = std::min(i + 1, j0 + GEMM_NB);
+            for (int p=0; p<kb; ++p)
+            {
+              const float_type *tp = pt + (std::size_t)p*nr;
+              float_type l = li[p];
+              for (int j=j0; j<j1; ++j)
+                ri[j] -= l*tp[j];
+            }
+          }
+        }
+      });
+    }
+    return true;
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Householder QR factorization of a m x n matrix.
+
+      On return, the upper part of a holds R and the part below the diagonal
+      the Householder vectors (with an implicit unit first entry).
+      \param tau min(m,n) Householder coefficients
+  */
+  void DenseQR(int m, int n, float_type *a, float_type *tau)
+  {
+    int k = std::min(m, n);
+    for (int j=0; j<k; ++j)
+    {
+      float_type sigma = 0;
+      for (int i=j+1; i<m; ++i)
+        sigma += a[(std::size_t)i*n + j]*a[(std::size_t)i*n + j];
+      float_type alpha = a[(std::size_t)j*n + j];
+      if (sigma==0)
+      {
+        tau[j] = 0;
+        continue;
+      }
+
+      float_type nrm = std::sqrt(alpha*alpha + sigma),
+                 beta = (alpha>=0) ? -nrm : nrm, s = 1/(alpha - beta);
+      tau[j] = (beta - alpha)/beta;
+      a[(std::size_t)j*n + j] = beta;
+      for (int i=j+1; i<m; ++i)
+        a[(std::size_t)i*n + j] *= s;
+
+      // Apply the reflection to the remaining columns
+      int nc = n - j - 1;
+      float_type t = tau[j];
+      LinAlgParallel(nc, 4.0*(m - j)*nc, [=](int c0, int c1)
+      {
+        int j1 = j + 1;
+        std::vector<float_type> w(a + (std::size_t)j*n + j1 + c0, a + (std::size_t)j*n + j1 + c1);
+        for (int i=j+1; i<m; ++i)
+        {
+          const float_type *ri = a + (std::size_t)i*n + j1;
+          float_type v = ri[-1];
+          for (int c=c0; c<c1; ++c)
+            w[c - c0] += v*ri[c];
+        }
+        float_type *rj = a + (std::size_t)j*n + j1;
+        for (int c=c0; c<c1; ++c)
+          rj[c] -= t*w[c - c0];
+        for (int i=j+1; i<m; ++i)
+        {
+          float_type *ri = a + (std::size_t)i*n + j1;
+          float_type v = t*ri[-1];
+          for (int c=c0; c<c1; ++c)
+            ri[c] -= v*w[c - c0];
+        }
+      });
+    }
+  }
+
+  namespace
+  {
+    //---------------------------------------------------------------------------
+    /** \brief Apply the Householder reflection j of a QR factorization to the
+               rows j..m-1 of the m x nc matrix b, columns [c0,c1).
+    */
+    void ApplyHouseholder(int m, int n, const float_type *qr, float_type t, int j,
+                          float_type *b, int nc, int c0, int c1)
+    {
+      std::vector<float_type> w(b + (std::size_t)j*nc + c0, b + (std::size_t)j*nc + c1);
+      for (int i=j+1; i<m; ++i)
+      {
+        const float_type *bi = b + (std::size_t)i*nc;
+        float_type v = qr[(std::size_t)i*n + j];
+        for (int c=c0; c<c1; ++c)
+          w[c - c0] += v*bi[c];
+      }
+      float_type *bj = b + (std::size_t)j*nc;
+      for (int c=c0; c<c1; ++c)
+        bj[c] -= t*w[c - c0];
+      for (int i=j+1; i<m; ++i)
+      {
+        float_type *bi = b + (std::size_t)i*nc;
+        float_type v = t*qr[(std::size_t)i*n + j];
+        for (int c=c0; c<c1; ++c)
+          bi[c] -= v*w[c - c0];
+      }
+    }
+  } // namespace
+
+  //---------------------------------------------------------------------------
+  /** \brief Form the m x min(m,n) matrix Q with orthonormal columns from a
+             QR factorization computed by DenseQR.
+  */
+  void DenseQRGetQ(int m, int n, const float_type *qr, const float_type *tau, float_type *q)
+  {
+    int k = std::min(m, n);
+    std::fill(q, q + (std::size_t)m*k, (float_type)0);
+    for (int i=0; i<k; ++i)
+      q[(std::size_t)i*k + i] = 1;
+
+    for (int j=k-1; j>=0; --j)
+    {
+      if (tau[j]==0)
+        continue;
+      float_type t = tau[j];
+      LinAlgParallel(k - j, 4.0*(m - j)*(k - j), [=](int c0, int c1)
+      {
+        ApplyHouseholder(m, n, qr, t, j, q, k, j + c0, j + c1);
+      });
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Least squares solution of A X = B, m >= n, from a QR factorization.
+      \param b m x nrhs matrix; on return its first n rows hold the solution
+      \return false if R is singular
+  */
+  bool DenseQRSolve(int m, int n, const float_type *qr, const float_type *tau, int nrhs, float_type *b)
+  {
+    for (int j=0; j<n; ++j)
+    {
+      if (qr[(std::size_t)j*n + j]==0)
+        return false;
+    }
+
+    LinAlgParallel(nrhs, 4.0*m*n*nrhs, [=](int c0, int c1)
+    {
+      for (int j=0; j<n; ++j)
+      {
+        if (tau[j]!=0)
+          ApplyHouseholder(m, n, qr, tau[j], j, b, nrhs, c0, c1);
+      }
+      for (int i=n-1; i>=0; --i)
+      {
+        float_type *bi = b + (std::size_t)i*nrhs;
+        const float_type *ri = qr + (std::size_t)i*n;
+        for (int k=i+1; k<n; ++k)
+        {
+          const float_type *bk = b + (std::size_t)k*nrhs;
+          for (int c=c0; c<c1; ++c)
+            bi[c] -= ri[k]*bk[c];
+        }
+        for (int c=c0; c<c1; ++c)
+          bi[c] /= ri[i];
+      }
+    });
+    return true;
+  }
+
+  //---------------------------------------------------------------------------
+  /** \brief Singular value decomposition A = U S V' of a m x n matrix.
+
+      One sided Jacobi method: pairs of columns of A are orthogonalized by
+      plane rotations until all columns are mutually orthogonal. Columns are
+      stored as rows of a work array so that rotations run over contiguous
+      entries, and the disjoint pairs of a round robin ordering are processed
+      in parallel.
+      \param s k = min(m,n) singular values, in decreasing order
+      \param u m x k matrix of left singular vectors (may be null)
+      \param v n x k matrix of right singular vectors (may be null)
+  */
+  void DenseSVD(int m, int n, const float_type *a, float_type *s, float_type *u, float_type *v)
+  {
+    // The smaller dimension is the number of columns to orthogonalize
+    bool bTrans = (m<n);
+    int nr = bTrans ? n : m, nc = bTrans ? m : n;
+    if (bTrans)
+    {
+      std::swap(u, v);
+    }
+
+    // w: columns of the (possibly transposed) matrix, z: columns of V
+    std::vector<float_type> w((std::size_t)nc*nr), z((std::size_t)nc*nc, 0);
+    for (int i=0; i<m; ++i)
+    {
+      for (int j=0; j<n; ++j)
+      {
+        float_type x = a[(std::size_t)i*n + j];
+        if (bTrans)
+          w[(std::size_t)i*nr + j] = x;
+        else
+          w[(std::size_t)j*nr + i] = x;
+      }
+    }
+    for (int j=0; j<nc; ++j)
+      z[(std::size_t)j*nc + j] = 1;
+
+    // Round robin ordering of the pairs of columns
+    int np = nc + (nc%2), nPair = np/2;
+    std::vector<int> slot(np);
+    for (int i=0; i<np; ++i)
+      slot[i] = i;
+    std::vector<float_type> off(nPair);
+    const float_type tol = 1.e-15;
+    float_type *pw = w.data(), *pz = z.data();
+
+    for (int sweep=0; sweep<60 && nc>1; ++sweep)
+    {
+      float_type offMax = 0;
+      for (int r=0; r<np-1; ++r)
+      {
+        const int *ps = slot.data();
+        float_type *poff = off.data();
+        LinAlgParallel(nPair, 10.0*nr*nPair, [=](int p0, int p1)
+        {
+          for (int p=p0; p<p1; ++p)
+          {
+            poff[p] = 0;
+            int i = ps[p], j = ps[np - 1 - p];
+            if (i>=nc || j>=nc)
+              continue;
+            if (i>j)
+              std::swap(i, j);
+
+            float_type *wi = pw + (std::size_t)i*nr, *wj = pw + (std::size_t)j*nr;
+            float_type alpha = 0, beta = 0, gamma = 0;
+            for (int k=0; k<nr; ++k)
+            {
+              alpha += wi[k]*wi[k];
+              beta += wj[k]*wj[k];
+              gamma += wi[k]*wj[k];
+            }
+            if (gamma==0)
+              continue;
+            float_type o = std::fabs(gamma)/std::sqrt(alpha*beta);
+            poff[p] = o;
+            if (!(o>tol))
+              continue;
+
+            float_type zeta = (beta - alpha)/(2*gamma),
+                       t = ((zeta>=0) ? 1 : -1)/(std::fabs(zeta) + std::sqrt(1 + zeta*zeta)),
+                       c = 1/std::sqrt(1 + t*t), sn = c*t;
+            for (int k=0; k<nr; ++k)
+            {
+              float_type x = wi[k], y = wj[k];
+              wi[k] = c*x - sn*y;
+              wj[k] = sn*x + c*y;
+            }
+            float_type *zi = pz + (std::size_t)i*nc, *zj = pz + (std::size_t)j*nc;
+            for (int k=0; k<nc; ++k)
+            {
+              float_type x = zi[k], y = zj[k];
+              zi[k] = c*x - sn*y;
+              zj[k] = sn*x + c*y;
+            }
+          }
+        });
+        for (int p=0; p<nPair; ++p)
+          offMax = std::max(offMax, off[p]);
+        std::rotate(slot.begin() + 1, slot.end() - 1, slot.end());
+      }
+      if (!(offMax>tol))
+        break;
+    }
+
+    // Singular values in decreasing order
+    std::vector<float_type> nrm(nc);
+    std::vector<int> idx(nc);
+    for (int j=0; j<nc; ++j)
+    {
+      nrm[j] = std::sqrt(Dot(pw + (std::size_t)j*nr, pw + (std::size_t)j*nr, nr));
+      idx[j] = j;
+    }
+    std::stable_sort(idx.begin(), idx.end(), [&](int i, int j) { return nrm[i]>nrm[j]; });
+
+    for (int c=0; c<nc; ++c)
+    {
+      int j = idx[c];
+      s[c] = nrm[j];
+      if (u)
+      {
+        float_type d = (nrm[j]>0) ? 1/nrm[j] : 0;
+        for (int k=0; k<nr; ++k)
+          u[(std::size_t)k*nc + c] = pw[(std::size_t)j*nr + k]*d;
+      }
+      if (v)
+      {
+        for (int k=0; k<nc; ++k)
+          v[(std::size_t)k*nc + c] = pz[(std::size_t)j*nc + k];
+      }
+    }
+  }
+
+MUP_NAMESPACE_END
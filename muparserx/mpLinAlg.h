@@ -0,0 +1,80 @@
+/** \file
+    \brief Dense linear algebra kernels used by muParserX.
+
+<pre>
+               __________                                 ____  ___
+    _____  __ _\______   \_____ _______  ______ __________\   \/  /
+   /     \|  |  \     ___/\__  \\_  __ \/  ___// __ \_  __ \     / 
+  |  Y Y  \  |  /    |     / __ \|  | \/\___ \\  ___/|  | \/     \ 
+  |__|_|  /____/|____|    (____  /__|  /____  >\___  >__| /___/\  \
+        \/                     \/           \/     \/           \_/
+                                       Copyright (C) 2016, Ingo Berg
+                                       All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without 
+  modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, 
+     this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright notice, 
+     this list of conditions and the following disclaimer in the documentation 
+     and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+  POSSIBILITY OF SUCH DAMAGE.
+  </pre>
+*/
+#ifndef MUP_LIN_ALG_H
+#define MUP_LIN_ALG_H
+
+/** \file
+    \brief Cache blocked and multithreaded kernels for dense matrices.
+
+    Matrices are stored row by row in flat arrays of float_type, a leading
+    dimension giving the distance between two consecutive rows. Loops are
+    distributed among the threads of a pool created on first use; small
+    problems are computed by the calling thread.
+*/
+
+#include <functional>
+#include "mpTypes.h"
+
+MUP_NAMESPACE_START
+
+  /** \brief Number of threads used by the kernels, including the caller */
+  int LinAlgThreads();
+
+  /** \brief Split the range [0,n) among the threads of the pool.
+      \param n Number of independent iterations
+      \param work Number of floating point operations of the whole loop. The
+             loop is run by the calling thread if it is too small.
+      \param f Function computing iterations [i0,i1)
+  */
+  void LinAlgParallel(int n, double work, const std::function<void(int, int)> &f);
+
+  void DenseGemm(int m, int n, int k, float_type alpha,
+                 const float_type *a, int lda, const float_type *b, int ldb,
+                 float_type *c, int ldc);
+  void DenseMul(int m, int n, int k, const float_type *a, const float_type *b, float_type *c);
+
+  int  DenseLU(int n, float_type *a, int *piv);
+  void DenseLUSolve(int n, const float_type *lu, const int *piv, int nrhs, float_type *b);
+  bool DenseChol(int n, float_type *a);
+
+  void DenseQR(int m, int n, float_type *a, float_type *tau);
+  void DenseQRGetQ(int m, int n, const float_type *qr, const float_type *tau, float_type *q);
+  bool DenseQRSolve(int m, int n, const float_type *qr, const float_type *tau, int nrhs, float_type *b);
+
+  void DenseSVD(int m, int n, const float_type *a, float_type *s, float_type *u, float_type *v);
+
+MUP_NAMESPACE_END
+
+#endif
@@ -33,6 +33,7 @@
                POSSIBILITY OF SUCH DAMAGE.
                */
 #include "mpOprtBinCommon.h"
+#include "mpArrayOp.h"
 #include <cmath>
 #include <limits>
 
@@ -140,6 +141,15 @@ OprtLT::OprtLT()
 //-----------------------------------------------------------------------------------------------
 void OprtLT::Eval(ptr_val_type& ret, const ptr_val_type *a_pArg, int)
 {
+    if (a_pArg[0]->IsMatrix() || a_pArg[1]->IsMatrix())
+    {
+        // Element-wise comparison, entries of the result are 1 or 0
+        int st = ArrayBinary(*a_pArg[0], *a_pArg[1], *ret,
+                             [](float_type x, float_type y) { return (x < y) ? 1.0 : 0.0; });
+        ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[1]);
+        return;
+    }
+
     *ret = *a_pArg[0] < *a_pArg[1];
 }
 
@@ -167,6 +177,15 @@ OprtGT::OprtGT()
 //-----------------------------------------------------------------------------------------------
 void OprtGT::Eval(ptr_val_type& ret, const ptr_val_type *a_pArg, int)
 {
+    if (a_pArg[0]->IsMatrix() || a_pArg[1]->IsMatrix())
+    {
+        // Element-wise comparison, entries of the result are 1 or 0
+        int st = ArrayBinary(*a_pArg[0], *a_pArg[1], *ret,
+                             [](float_type x, float_type y) { return (x > y) ? 1.0 : 0.0; });
+        ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[1]);
+        return;
+    }
+
     *ret = *a_pArg[0] > *a_pArg[1];
 }
 
@@ -195,6 +214,15 @@ OprtLE::OprtLE()
 //-----------------------------------------------------------------------------------------------
 void OprtLE::Eval(ptr_val_type& ret, const ptr_val_type *a_pArg, int)
 {
+    if (a_pArg[0]->IsMatrix() || a_pArg[1]->IsMatrix())
+    {
+        // Element-wise comparison, entries of the result are 1 or 0
+        int st = ArrayBinary(*a_pArg[0], *a_pArg[1], *ret,
+                             [](float_type x, float_type y) { return (x <= y) ? 1.0 : 0.0; });
+        ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[1]);
+        return;
+    }
+
     *ret = *a_pArg[0] <= *a_pArg[1];
 }
 
@@ -223,6 +251,15 @@ OprtGE::OprtGE()
 //-----------------------------------------------------------------------------------------------
 void OprtGE::Eval(ptr_val_type& ret, const ptr_val_type *a_pArg, int)
 {
+    if (a_pArg[0]->IsMatrix() || a_pArg[1]->IsMatrix())
+    {
+        // Element-wise comparison, entries of the result are 1 or 0
+        int st = ArrayBinary(*a_pArg[0], *a_pArg[1], *ret,
+                             [](float_type x, float_type y) { return (x >= y) ? 1.0 : 0.0; });
+        ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[1]);
+        return;
+    }
+
     *ret = *a_pArg[0] >= *a_pArg[1];
 }
 
@@ -33,6 +33,9 @@
                POSSIBILITY OF SUCH DAMAGE.
                */
 #include "mpOprtCmplx.h"
+#include "mpArrayOp.h"
+#include "mpLinAlg.h"
+#include "mpMatrixError.h"
 #include <iomanip>
 #include <limits>
 
@@ -67,14 +70,14 @@ void OprtSignCmplx::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int a_iA
         cmplx_type v((re == 0) ? 0 : -re, (im == 0) ? 0 : -im);
         *ret = v;
     }
-    else if (a_pArg[0]->GetType() == 'm')
+    else if (a_pArg[0]->IsMatrix())
     {
-        Value v(a_pArg[0]->GetRows(), 0);
-        for (int i = 0; i < a_pArg[0]->GetRows(); ++i)
-        {
-            v.At(i) = a_pArg[0]->At(i).GetComplex() * (float_type)-1.0;
-        }
-        *ret = v;
+        int st = ArrayUnaryCmplx(*a_pArg[0], *ret,
+                                 [](float_type x) { return (x == 0) ? 0 : -x; },
+                                 [](cmplx_type z) { return cmplx_type((z.real() == 0) ? 0 : -z.real(),
+                                                                      (z.imag() == 0) ? 0 : -z.imag()); },
+                                 ArrayAnyReal);
+        ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
     }
     else
     {
@@ -125,6 +128,15 @@ void OprtAddCmplx::Eval(ptr_val_type& ret, const ptr_val_type *a_pArg, int num)
         // Matrix + Matrix
         *ret = arg1->GetArray() + arg2->GetArray();
     }
+    else if (arg1->IsMatrix() != arg2->IsMatrix())
+    {
+        // Matrix + scalar, entry by entry
+        int st = ArrayBinaryCmplx(*arg1, *arg2, *ret,
+                                  [](float_type x, float_type y) { return x + y; },
+                                  [](cmplx_type x, cmplx_type y) { return x + y; },
+                                  ArrayAnyReal2);
+        ArrayError(st, GetIdent(), *arg1, *arg2);
+    }
     else
     {
         if (!arg1->IsScalar())
@@ -176,6 +188,15 @@ void OprtSubCmplx::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int num)
         // Matrix + Matrix
         *ret = arg1->GetArray() - arg2->GetArray();
     }
+    else if (a_pArg[0]->IsMatrix() != a_pArg[1]->IsMatrix())
+    {
+        // Matrix - scalar, entry by entry
+        int st = ArrayBinaryCmplx(*a_pArg[0], *a_pArg[1], *ret,
+                                  [](float_type x, float_type y) { return x - y; },
+                                  [](cmplx_type x, cmplx_type y) { return x - y; },
+                                  ArrayAnyReal2);
+        ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[1]);
+    }
     else
     {
         if (!a_pArg[0]->IsScalar())
@@ -217,6 +238,30 @@ void OprtMulCmplx::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int num)
     assert(num == 2);
     IValue *arg1 = a_pArg[0].Get();
     IValue *arg2 = a_pArg[1].Get();
+    if (arg1->IsMatrix() != arg2->IsMatrix())
+    {
+        // Matrix times scalar, entry by entry
+        int st = ArrayBinaryCmplx(*arg1, *arg2, *ret,
+                                  [](float_type x, float_type y) { return x * y; },
+                                  [](cmplx_type x, cmplx_type y) { return x * y; },
+                                  ArrayAnyReal2);
+        ArrayError(st, GetIdent(), *arg1, *arg2);
+        return;
+    }
+
+    std::vector<float_type> a, b;
+    if (arg1->IsMatrix() && ArrayGet(*arg1, a) && ArrayGet(*arg2, b))
+    {
+        // Product of real matrices
+        int m = arg1->GetRows(), k = arg1->GetCols(), n = arg2->GetCols();
+        if (arg2->GetRows() != k)
+            throw MatrixError("Matrix dimensions do not match.");
+        std::vector<float_type> c((std::size_t)m*n);
+        DenseMul(m, n, k, a.data(), b.data(), c.data());
+        ArrayAssign(*ret, m, n, c);
+        return;
+    }
+
     *ret = (*arg1) * (*arg2);
 }
 
@@ -257,6 +302,15 @@ void OprtDivCmplx::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int num)
     {
         *ret = a_pArg[0]->GetFloat() / a_pArg[1]->GetFloat();
     }
+    else if (a_pArg[0]->IsMatrix() || a_pArg[1]->IsMatrix())
+    {
+        // Element-wise division
+        int st = ArrayBinaryCmplx(*a_pArg[0], *a_pArg[1], *ret,
+                                  [](float_type x, float_type y) { return x / y; },
+                                  [](cmplx_type x, cmplx_type y) { return x / y; },
+                                  ArrayAnyReal2);
+        ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[1]);
+    }
     else
     {
         // multiplication of two imaginary numbers      
@@ -296,7 +350,16 @@ void OprtPowCmplx::Eval(ptr_val_type& ret, const ptr_val_type *arg, int argc)
 {
     assert(argc == 2);
 
-    if (arg[0]->IsComplex() || arg[1]->IsComplex() || (arg[0]->GetFloat() < 0 && !arg[1]->IsInteger()))
+    if (arg[0]->IsMatrix() || arg[1]->IsMatrix())
+    {
+        // Element-wise power, complex for negative entries and non integer exponents
+        int st = ArrayBinaryCmplx(*arg[0], *arg[1], *ret,
+                                  [](float_type x, float_type y) { return std::pow(x, y); },
+                                  [](cmplx_type x, cmplx_type y) { return std::pow(x, y); },
+                                  [](float_type x, float_type y) { return x >= 0 || y == std::floor(y); });
+        ArrayError(st, GetIdent(), *arg[0], *arg[1]);
+    }
+    else if (arg[0]->IsComplex() || arg[1]->IsComplex() || (arg[0]->GetFloat() < 0 && !arg[1]->IsInteger()))
     {
         *ret = std::pow(arg[0]->GetComplex(), arg[1]->GetComplex());;
     }
@@ -58,6 +58,9 @@ MUP_NAMESPACE_START
             int cols = a_pArg[-1]->GetCols();
             bool bArgIsVariable = a_pArg[-1]->IsVariable();
 
+            // Variables returned for elements flag the matrix when they are written to
+            IValue *pOwner = (bArgIsVariable) ? static_cast<Variable*>(a_pArg[-1].Get())->GetPtr() : nullptr;
+
             // If the index operator is applied to a variable the return value is also a variable
             // pointing to a specific cell in the matrix. If the operator is applied to a value
             // the return value is also a value.
@@ -67,14 +70,14 @@ MUP_NAMESPACE_START
                 if (cols == 1)
                 {
                     if (bArgIsVariable) 
-                        ret.Reset(new Variable(&(ret->At(*a_pArg[0], Value(0.0)))));
+                        ret.Reset(new Variable(&(ret->At(*a_pArg[0], Value(0.0))), pOwner));
                     else
                         *ret = ret->At(*a_pArg[0], Value(0.0));
                 }
                 else if (rows == 1)
                 {
                     if (bArgIsVariable) 
-                        ret.Reset(new Variable(&(ret->At(Value(0.0), *a_pArg[0]))));
+                        ret.Reset(new Variable(&(ret->At(Value(0.0), *a_pArg[0])), pOwner));
                     else
                         *ret = ret->At(Value(0.0), *a_pArg[0]);
                 }
@@ -86,7 +89,7 @@ MUP_NAMESPACE_START
 
             case 2:
                 if (bArgIsVariable)
-                    ret.Reset(new Variable(&(ret->At(*a_pArg[0], *a_pArg[1]))));
+                    ret.Reset(new Variable(&(ret->At(*a_pArg[0], *a_pArg[1])), pOwner));
                 else
 	                *ret = ret->At(*a_pArg[0], *a_pArg[1]);
                 break;
@@ -29,6 +29,10 @@
   POSSIBILITY OF SUCH DAMAGE.
 */
 #include "mpOprtMatrix.h"
+#include <vector>
+#include "mpMatrixError.h"
+#include "mpArrayOp.h"
+#include "mpLinAlg.h"
 
 
 MUP_NAMESPACE_START
@@ -68,6 +72,64 @@ MUP_NAMESPACE_START
     return new OprtTranspose(*this); 
   }
 
+//-------------------------------------------------------------------------------------------------
+//
+//  class  OprtSolve
+//
+//-------------------------------------------------------------------------------------------------
+
+  OprtSolve::OprtSolve()
+    :IOprtBin(_T("\\"), (int)prMUL_DIV, oaLEFT)
+  {}
+
+  //-------------------------------------------------------------------------------------------------
+  void OprtSolve::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int)
+  {
+    std::vector<float_type> a, b;
+    if (!ArrayGet(*a_pArg[0], a))
+      throw ParserError(ErrorContext(ecTYPE_CONFLICT_FUN, -1, GetIdent(), a_pArg[0]->GetType(), 'm', 1));
+    if (!ArrayGet(*a_pArg[1], b))
+      throw ParserError(ErrorContext(ecTYPE_CONFLICT_FUN, -1, GetIdent(), a_pArg[1]->GetType(), 'm', 2));
+
+    int m = a_pArg[0]->GetRows(), n = a_pArg[0]->GetCols(), nrhs = a_pArg[1]->GetCols();
+    if (a_pArg[1]->GetRows() != m)
+      throw MatrixError("Incompatible dimensions of matrix and right hand side.");
+
+    if (m == n)
+    {
+      std::vector<int> piv(n);
+      if (DenseLU(n, a.data(), piv.data()) == 0)
+        throw ParserError(_T("Matrix is singular."));
+      DenseLUSolve(n, a.data(), piv.data(), nrhs, b.data());
+    }
+    else if (m > n)
+    {
+      // Least squares solution
+      std::vector<float_type> tau(n);
+      DenseQR(m, n, a.data(), tau.data());
+      if (!DenseQRSolve(m, n, a.data(), tau.data(), nrhs, b.data()))
+        throw ParserError(_T("Matrix does not have full rank."));
+      b.resize((std::size_t)n*nrhs);
+    }
+    else
+    {
+      throw ParserError(_T("Underdetermined systems are not supported."));
+    }
+    ArrayAssign(*ret, n, nrhs, b);
+  }
+
+  //-------------------------------------------------------------------------------------------------
+  const char_type* OprtSolve::GetDesc() const
+  {
+    return _T("A\\b - Solution of the linear system A*x = b, in the least squares sense if A has more rows than columns.");
+  }
+
+  //-------------------------------------------------------------------------------------------------
+  IToken* OprtSolve::Clone() const
+  {
+    return new OprtSolve(*this); 
+  }
+
   //-----------------------------------------------------------------------------------------------
   //
   //  class  OprtCreateArray
@@ -54,6 +54,21 @@ MUP_NAMESPACE_START
     virtual IToken* Clone() const override;
   }; 
 
+  //-----------------------------------------------------------------------------------------------
+  /** \brief Solution of linear systems, A\\b.
+
+      Square systems are solved by LU factorization, overdetermined systems in
+      the least squares sense by QR factorization.
+  */
+  class OprtSolve : public IOprtBin
+  {
+  public:
+    OprtSolve();
+    virtual void Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int a_iArgc) override;
+    virtual const char_type* GetDesc() const override;
+    virtual IToken* Clone() const override;
+  };
+
   //-----------------------------------------------------------------------------------------------
   /** \brief On the fly array creation using the curly bracket operator.
   */
@@ -33,6 +33,7 @@
   POSSIBILITY OF SUCH DAMAGE.
 */
 #include "mpOprtNonCmplx.h"
+#include "mpArrayOp.h"
 
 MUP_NAMESPACE_START
 
@@ -55,14 +56,10 @@ MUP_NAMESPACE_START
     {
       *ret = -a_pArg[0]->GetFloat();
     }
-    else if (a_pArg[0]->GetType()=='m')
+    else if (a_pArg[0]->IsMatrix())
     {
-      Value v(a_pArg[0]->GetRows(), 0);
-      for (int i=0; i<a_pArg[0]->GetRows(); ++i)
-      {
-        v.At(i) = -a_pArg[0]->At(i).GetFloat();
-      }
-      *ret = v;
+      int st = ArrayUnary(*a_pArg[0], *ret, [](float_type x) { return -x; });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
     }
     else
     {
@@ -105,14 +102,10 @@ MUP_NAMESPACE_START
     {
       *ret = a_pArg[0]->GetFloat();
     }
-    else if (a_pArg[0]->GetType()=='m')
+    else if (a_pArg[0]->IsMatrix())
     {
-      Value v(a_pArg[0]->GetRows(), 0);
-      for (int i=0; i<a_pArg[0]->GetRows(); ++i)
-      {
-        v.At(i) = a_pArg[0]->At(i).GetFloat();
-      }
-      *ret = v;
+      int st = ArrayUnary(*a_pArg[0], *ret, [](float_type x) { return x; });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[0]);
     }
     else
     {
@@ -153,27 +146,11 @@ MUP_NAMESPACE_START
 
     const IValue *arg1 = a_pArg[0].Get();
     const IValue *arg2 = a_pArg[1].Get();
-    if (arg1->GetType()=='m' && arg2->GetType()=='m')
+    if (arg1->IsMatrix() || arg2->IsMatrix())
     {
-      // Vector + Vector
-      const matrix_type &a1 = arg1->GetArray(),
-                       &a2 = arg2->GetArray();
-      if (a1.GetRows()!=a2.GetRows())
-        throw ParserError(ErrorContext(ecARRAY_SIZE_MISMATCH, -1, GetIdent(), 'm', 'm', 2));
-      
-      matrix_type rv(a1.GetRows());
-      for (int i=0; i<a1.GetRows(); ++i)
-      {
-        if (!a1.At(i).IsNonComplexScalar())
-          throw ParserError( ErrorContext(ecTYPE_CONFLICT_FUN, -1, GetIdent(), a1.At(i).GetType(), 'f', 1)); 
-
-        if (!a2.At(i).IsNonComplexScalar())
-          throw ParserError( ErrorContext(ecTYPE_CONFLICT_FUN, -1, GetIdent(), a2.At(i).GetType(), 'f', 1)); 
-
-        rv.At(i) = a1.At(i).GetFloat() + a2.At(i).GetFloat();
-      }
-
-      *ret = rv; 
+      // Vector + Vector, Vector + Scalar
+      int st = ArrayBinary(*arg1, *arg2, *ret, [](float_type x, float_type y) { return x + y; });
+      ArrayError(st, GetIdent(), *arg1, *arg2);
     }
     else
     {
@@ -214,27 +191,11 @@ MUP_NAMESPACE_START
   { 
     assert(num==2);
 
-    if (a_pArg[0]->GetType()=='m' && a_pArg[1]->GetType()=='m')
+    if (a_pArg[0]->IsMatrix() || a_pArg[1]->IsMatrix())
     {
-      const matrix_type &a1 = a_pArg[0]->GetArray(),
-                       &a2 = a_pArg[1]->GetArray();
-      if (a1.GetRows()!=a2.GetRows())
-        throw ParserError(ErrorContext(ecARRAY_SIZE_MISMATCH, -1, GetIdent(), 'm', 'm', 2));
-      
-      matrix_type rv(a1.GetRows());
-      for (int i=0; i<a1.GetRows(); ++i)
-      {
-        if (!a1.At(i).IsNonComplexScalar())
-          throw ParserError( ErrorContext(ecTYPE_CONFLICT_FUN, -1, GetIdent(), a1.At(i).GetType(), 'f', 1)); 
-
-        if (!a2.At(i).IsNonComplexScalar())
-          throw ParserError( ErrorContext(ecTYPE_CONFLICT_FUN, -1, GetIdent(), a2.At(i).GetType(), 'f', 1)); 
-
-        rv.At(i) = cmplx_type(a1.At(i).GetFloat() - a2.At(i).GetFloat(),
-                              a1.At(i).GetImag()  - a2.At(i).GetImag());
-      }
-
-      *ret = rv;
+      // Vector - Vector, Vector - Scalar
+      int st = ArrayBinary(*a_pArg[0], *a_pArg[1], *ret, [](float_type x, float_type y) { return x - y; });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[1]);
     }
     else
     {
@@ -291,23 +252,11 @@ MUP_NAMESPACE_START
 
       *ret = val;
     }
-    else if (arg1->GetType()=='m' && arg2->IsNonComplexScalar())
-    {
-      // Skalar * Vector
-      matrix_type out(a_pArg[0]->GetArray());
-      for (int i=0; i<out.GetRows(); ++i)
-        out.At(i) = out.At(i).GetFloat() * arg2->GetFloat();
-
-      *ret = out; 
-    }
-    else if (arg2->GetType()=='m' && arg1->IsNonComplexScalar())
+    else if (arg1->IsMatrix() || arg2->IsMatrix())
     {
-      // Vector * Skalar
-      matrix_type out(arg2->GetArray());
-      for (int i=0; i<out.GetRows(); ++i)
-        out.At(i) = out.At(i).GetFloat() * arg1->GetFloat();
-
-      *ret = out; 
+      // Vector * Skalar, Skalar * Vector
+      int st = ArrayBinary(*arg1, *arg2, *ret, [](float_type x, float_type y) { return x * y; });
+      ArrayError(st, GetIdent(), *arg1, *arg2);
     }
     else
     {
@@ -354,6 +303,13 @@ MUP_NAMESPACE_START
   { 
     assert(num==2);
 
+    if (a_pArg[0]->IsMatrix() || a_pArg[1]->IsMatrix())
+    {
+      int st = ArrayBinary(*a_pArg[0], *a_pArg[1], *ret, [](float_type x, float_type y) { return x / y; });
+      ArrayError(st, GetIdent(), *a_pArg[0], *a_pArg[1]);
+      return;
+    }
+
     if (!a_pArg[0]->IsNonComplexScalar())
       throw ParserError( ErrorContext(ecTYPE_CONFLICT_FUN, -1, GetIdent(), a_pArg[0]->GetType(), 'f', 1)); 
 
@@ -389,6 +345,13 @@ MUP_NAMESPACE_START
   void OprtPow::Eval(ptr_val_type& ret, const ptr_val_type *arg, int argc)
   {
     assert(argc==2);
+    if (arg[0]->IsMatrix() || arg[1]->IsMatrix())
+    {
+      int st = ArrayBinary(*arg[0], *arg[1], *ret, [](float_type x, float_type y) { return std::pow(x, y); });
+      ArrayError(st, GetIdent(), *arg[0], *arg[1]);
+      return;
+    }
+
     float_type a = arg[0]->GetFloat();
     float_type b = arg[1]->GetFloat();
     
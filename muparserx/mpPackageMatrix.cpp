@@ -58,9 +58,18 @@ void PackageMatrix::AddToParser(ParserXBase *pParser)
   pParser->DefineFun(new FunMatrixZeros());
   pParser->DefineFun(new FunMatrixEye());
   pParser->DefineFun(new FunMatrixSize());
+
+  // Dense linear algebra
+  pParser->DefineFun(new FunMatrixInv());
+  pParser->DefineFun(new FunMatrixDet());
+  pParser->DefineFun(new FunMatrixChol());
+  pParser->DefineFun(new FunMatrixLU());
+  pParser->DefineFun(new FunMatrixQR());
+  pParser->DefineFun(new FunMatrixSVD());
   
   // Matrix Operators
   pParser->DefinePostfixOprt(new OprtTranspose());
+  pParser->DefineOprt(new OprtSolve());
 
   // Colon operator
 //pParser->DefineOprt(new OprtColon());
@@ -118,6 +118,7 @@ ParserXBase::ParserXBase()
 	, m_sNameChars()
 	, m_sOprtChars()
 	, m_sInfixOprtChars()
+	, m_nDefVer(1)
 	, m_bIsQueryingExprVar(false)
 	, m_bAutoCreateVar(false)
 	, m_rpn()
@@ -145,6 +146,7 @@ ParserXBase::ParserXBase(const ParserXBase& a_Parser)
 	, m_sNameChars()
 	, m_sOprtChars()
 	, m_sInfixOprtChars()
+	, m_nDefVer(1)
 	, m_bAutoCreateVar()
 	, m_rpn()
 	, m_vStackBuffer()
@@ -213,6 +215,7 @@ void ParserXBase::Assign(const ParserXBase& ref)
 	m_sInfixOprtChars = ref.m_sInfixOprtChars;
 
 	m_bAutoCreateVar = ref.m_bAutoCreateVar;
+	++m_nDefVer;
 
 	// Things that should not be copied:
 	// - m_vStackBuffer
@@ -239,6 +242,23 @@ const IValue& ParserXBase::Eval() const
 	return (this->*m_pParserEngine)();
 }
 
+//---------------------------------------------------------------------------
+/** \brief Compile the expression into a program that can be shared between threads.
+	  \pre A formula must be set.
+	  \return A new immutable program, see #Program and #EvalContext.
+	  \throw ParseException if the expression contains a syntax error.
+
+	  The expression is not evaluated. Each EvalContext of the program starts
+	  with the current values of the expression variables.
+	  */
+ptr_prg_type ParserXBase::Compile() const
+{
+	if (m_pParserEngine != &ParserXBase::ParseFromRPN)
+		PrepareRPN();
+
+	return std::make_shared<const Program>(m_rpn, m_pTokenReader->GetExpr());
+}
+
 //---------------------------------------------------------------------------
 /** \brief Return the strings of all Operator identifiers.
 	  \return Returns a pointer to the c_DefaultOprt array of const char *.
@@ -258,6 +278,7 @@ const char_type** ParserXBase::GetOprtDef() const
 void ParserXBase::DefineNameChars(const char_type* a_szCharset)
 {
 	m_sNameChars = a_szCharset;
+	++m_nDefVer;
 }
 
 //---------------------------------------------------------------------------
@@ -269,6 +290,7 @@ void ParserXBase::DefineNameChars(const char_type* a_szCharset)
 void ParserXBase::DefineOprtChars(const char_type* a_szCharset)
 {
 	m_sOprtChars = a_szCharset;
+	++m_nDefVer;
 }
 
 //---------------------------------------------------------------------------
@@ -280,6 +302,7 @@ void ParserXBase::DefineOprtChars(const char_type* a_szCharset)
 void ParserXBase::DefineInfixOprtChars(const char_type* a_szCharset)
 {
 	m_sInfixOprtChars = a_szCharset;
+	++m_nDefVer;
 }
 
 //---------------------------------------------------------------------------
@@ -383,10 +406,14 @@ void ParserXBase::CheckName(const string_type& a_strName,
 	  \throw ParserException in case of syntax errors.
 
 	  Triggers first time calculation thus the creation of the bytecode and
-	  scanning of used variables.
+	  scanning of used variables. Setting the expression that is already 
+	  compiled keeps the bytecode.
 	  */
 void ParserXBase::SetExpr(const string_type& a_sExpr)
 {
+	if (m_pParserEngine == &ParserXBase::ParseFromRPN && a_sExpr == m_pTokenReader->GetExpr())
+		return;
+
 	m_pTokenReader->SetExpr(a_sExpr);
 	ReInit();
 }
@@ -403,6 +430,7 @@ void ParserXBase::DefineVar(const string_type& ident, const Variable& var)
 	CheckForEntityExistence(ident, ecVARIABLE_DEFINED);
 
 	m_varDef[ident] = ptr_tok_type(var.Clone());
+	++m_nDefVer;
 }
 
 void ParserXBase::CheckForEntityExistence(const string_type& ident, EErrorCodes error_code)
@@ -432,6 +460,7 @@ void ParserXBase::DefineConst(const string_type& ident, const Value& val)
 	CheckForEntityExistence(ident, ecCONSTANT_DEFINED);
 
 	m_valDef[ident] = ptr_tok_type(val.Clone());
+	++m_nDefVer;
 }
 
 //---------------------------------------------------------------------------
@@ -449,6 +478,7 @@ void ParserXBase::DefineFun(const ptr_cal_type& fun)
 
 	fun->SetParent(this);
 	m_FunDef[fun->GetIdent()] = ptr_tok_type(fun->Clone());
+	++m_nDefVer;
 }
 
 //---------------------------------------------------------------------------
@@ -462,6 +492,7 @@ void ParserXBase::DefineOprt(const TokenPtr<IOprtBin>& oprt)
 
 	oprt->SetParent(this);
 	m_OprtDef[oprt->GetIdent()] = ptr_tok_type(oprt->Clone());
+	++m_nDefVer;
 }
 
 //---------------------------------------------------------------------------
@@ -478,6 +509,7 @@ void ParserXBase::DefinePostfixOprt(const TokenPtr<IOprtPostfix>& oprt)
 	// Operator is not added yet, add it.
 	oprt->SetParent(this);
 	m_PostOprtDef[oprt->GetIdent()] = ptr_tok_type(oprt->Clone());
+	++m_nDefVer;
 }
 
 //---------------------------------------------------------------------------
@@ -493,12 +525,14 @@ void ParserXBase::DefineInfixOprt(const TokenPtr<IOprtInfix>& oprt)
 	// Function is not added yet, add it.
 	oprt->SetParent(this);
 	m_InfixOprtDef[oprt->GetIdent()] = ptr_tok_type(oprt->Clone());
+	++m_nDefVer;
 }
 
 //---------------------------------------------------------------------------
 void ParserXBase::RemoveVar(const string_type& ident)
 {
 	m_varDef.erase(ident);
+	++m_nDefVer;
 	ReInit();
 }
 
@@ -506,6 +540,7 @@ void ParserXBase::RemoveVar(const string_type& ident)
 void ParserXBase::RemoveConst(const string_type& ident)
 {
 	m_valDef.erase(ident);
+	++m_nDefVer;
 	ReInit();
 }
 
@@ -513,6 +548,7 @@ void ParserXBase::RemoveConst(const string_type& ident)
 void ParserXBase::RemoveFun(const string_type& ident)
 {
 	m_FunDef.erase(ident);
+	++m_nDefVer;
 	ReInit();
 }
 
@@ -520,6 +556,7 @@ void ParserXBase::RemoveFun(const string_type& ident)
 void ParserXBase::RemoveOprt(const string_type& ident)
 {
 	m_OprtDef.erase(ident);
+	++m_nDefVer;
 	ReInit();
 }
 
@@ -527,6 +564,7 @@ void ParserXBase::RemoveOprt(const string_type& ident)
 void ParserXBase::RemovePostfixOprt(const string_type& ident)
 {
 	m_PostOprtDef.erase(ident);
+	++m_nDefVer;
 	ReInit();
 }
 
@@ -534,6 +572,7 @@ void ParserXBase::RemovePostfixOprt(const string_type& ident)
 void ParserXBase::RemoveInfixOprt(const string_type& ident)
 {
 	m_InfixOprtDef.erase(ident);
+	++m_nDefVer;
 	ReInit();
 }
 
@@ -585,6 +624,18 @@ const var_maptype& ParserXBase::GetExprVar() const
 	return m_pTokenReader->GetUsedVar();
 }
 
+//---------------------------------------------------------------------------
+/** \brief Return the variables found when the expression was last tokenized.
+
+	Unlike GetExprVar this does not create the RPN again. After a call to Eval
+	the map contains all variables of the expression, including the ones created
+	automatically.
+*/
+const var_maptype& ParserXBase::GetUsedVar() const
+{
+	return m_pTokenReader->GetUsedVar();
+}
+
 //---------------------------------------------------------------------------
 /** \brief Return a map containing the used variables only. */
 const var_maptype& ParserXBase::GetVar() const
@@ -961,14 +1012,8 @@ void ParserXBase::CreateRPN() const
 }
 
 //---------------------------------------------------------------------------
-/** \brief One of the two main parse functions.
-	  \sa ParseCmdCode(), ParseValue()
-
-	  Parse expression from input string. Perform syntax checking and create bytecode.
-	  After parsing the string and creating the bytecode the function pointer
-	  #m_pParseFormula will be changed to the second parse routine the uses bytecode instead of string parsing.
-	  */
-const IValue& ParserXBase::ParseFromString() const
+/** \brief Create the RPN and the stack buffer and switch to RPN parsing mode. */
+void ParserXBase::PrepareRPN() const
 {
 	CreateRPN();
 
@@ -982,168 +1027,32 @@ const IValue& ParserXBase::ParseFromString() const
 	}
 
 	m_pParserEngine = &ParserXBase::ParseFromRPN;
+}
 
+//---------------------------------------------------------------------------
+/** \brief One of the two main parse functions.
+	  \sa ParseCmdCode(), ParseValue()
+
+	  Parse expression from input string. Perform syntax checking and create bytecode.
+	  After parsing the string and creating the bytecode the function pointer
+	  #m_pParseFormula will be changed to the second parse routine the uses bytecode instead of string parsing.
+	  */
+const IValue& ParserXBase::ParseFromString() const
+{
+	PrepareRPN();
 	return (this->*m_pParserEngine)();
 }
 
 //---------------------------------------------------------------------------
 const IValue& ParserXBase::ParseFromRPN() const
 {
-	ptr_val_type* pStack = &m_vStackBuffer[0];
-	if (m_rpn.GetSize() == 0)
-	{
-		// Passiert bei leeren strings oder solchen, die nur Leerzeichen enthalten
-		ErrorContext err;
-		err.Expr = m_pTokenReader->GetExpr();
-		err.Errc = ecUNEXPECTED_EOF;
-		err.Pos = 0;
-		throw ParserError(err);
-	}
-
-	const ptr_tok_type* pRPN = &(m_rpn.GetData()[0]);
-
-	int sidx = -1;
-	std::size_t lenRPN = m_rpn.GetSize();
-	for (std::size_t i = 0; i < lenRPN; ++i)
-	{
-		IToken* pTok = pRPN[i].Get();
-		ECmdCode eCode = pTok->GetCode();
-
-		switch (eCode)
-		{
-		case cmSCRIPT_NEWLINE:
-			sidx = -1;
-			continue;
-
-		case cmVAL:
-		{
-			IValue* pVal = static_cast<IValue*>(pTok);
-
-			sidx++;
-			MUP_VERIFY(sidx < (int)m_vStackBuffer.size());
-			if (pVal->IsVariable())
-			{
-				pStack[sidx].Reset(pVal);
-			}
-			else
-			{
-				ptr_val_type& val = pStack[sidx];
-				if (val->IsVariable())
-					val.Reset(m_cache.CreateFromCache());
-
-				*val = *(static_cast<IValue*>(pTok));
-			}
-		}
-		continue;
-
-		case  cmIC:
-		{
-			ICallback* pIdxOprt = static_cast<ICallback*>(pTok);
-			int nArgs = pIdxOprt->GetArgsPresent();
-			sidx -= nArgs - 1;
-			MUP_VERIFY(sidx >= 0);
-
-			ptr_val_type& idx = pStack[sidx];   // Pointer to the first index
-			ptr_val_type& val = pStack[--sidx];   // Pointer to the variable or value beeing indexed
-			pIdxOprt->Eval(val, &idx, nArgs);
-		}
-		continue;
-
-		case cmCBC:
-		case cmOPRT_POSTFIX:
-		case cmFUNC:
-		case cmOPRT_BIN:
-		case cmOPRT_INFIX:
-		{
-			ICallback* pFun = static_cast<ICallback*>(pTok);
-			int nArgs = pFun->GetArgsPresent();
-			sidx -= nArgs - 1;
-
-			// most likely cause: Comma in if-then-else sum(false?1,0,0:3)
-			if (sidx < 0)
-			{
-				ErrorContext err;
-				err.Expr = m_pTokenReader->GetExpr();
-				err.Errc = ecUNEXPECTED_COMMA;
-				err.Pos = m_pTokenReader->GetPos();
-				throw ParserError(err);
-			}
-
-			ptr_val_type& val = pStack[sidx];
-			try
-			{
-				if (val->IsVariable())
-				{
-					ptr_val_type buf(m_cache.CreateFromCache());
-					pFun->Eval(buf, &val, nArgs);
-					val = buf;
-				}
-				else
-				{
-					pFun->Eval(val, &val, nArgs);
-				}
-			}
-			catch (ParserError& exc)
-			{
-				// <ibg 20130131> Not too happy about that:
-				// Multiarg functions may throw specific error codes when evaluating.
-				// These codes would be converted to ecEVAL here. I omit the conversion
-				// for certain handpicked errors. (The reason this catch block exists is
-				// that not all exceptions contain proper metadata when thrown out of
-				// a function.)
-				if (exc.GetCode() == ecTOO_FEW_PARAMS ||
-					exc.GetCode() == ecDOMAIN_ERROR ||
-					exc.GetCode() == ecOVERFLOW ||
-					exc.GetCode() == ecINVALID_NUMBER_OF_PARAMETERS ||
-					exc.GetCode() == ecASSIGNEMENT_TO_VALUE)
-				{
-					exc.GetContext().Pos = pFun->GetExprPos();
-					throw;
-				}
-				// </ibg>
-				else
-				{
-					ErrorContext err;
-					err.Expr = m_pTokenReader->GetExpr();
-					err.Ident = pFun->GetIdent();
-					err.Errc = ecEVAL;
-					err.Pos = pFun->GetExprPos();
-					err.Hint = exc.GetMsg();
-					throw ParserError(err);
-				}
-			}
-			catch (MatrixError& /*exc*/)
-			{
-				ErrorContext err;
-				err.Expr = m_pTokenReader->GetExpr();
-				err.Ident = pFun->GetIdent();
-				err.Errc = ecMATRIX_DIMENSION_MISMATCH;
-				err.Pos = pFun->GetExprPos();
-				throw ParserError(err);
-			}
-		}
-		continue;
-
-		case cmIF:
-			MUP_VERIFY(sidx >= 0);
-			if (pStack[sidx--]->GetBool() == false)
-				i += static_cast<TokenIfThenElse*>(pTok)->GetOffset();
-			continue;
-
-		case cmELSE:
-		case cmJMP:
-			i += static_cast<TokenIfThenElse*>(pTok)->GetOffset();
-			continue;
-
-		case cmENDIF:
-			continue;
-
-		default:
-			Error(ecINTERNAL_ERROR);
-		} // switch token
-	} // for all RPN tokens
-
-	return *pStack[0];
+	return ExecRPN(m_rpn.GetData(),
+		nullptr,
+		nullptr,
+		m_vStackBuffer.data(),
+		static_cast<int>(m_vStackBuffer.size()),
+		m_cache,
+		m_pTokenReader->GetExpr());
 }
 
 //---------------------------------------------------------------------------
@@ -1167,6 +1076,7 @@ void ParserXBase::ClearVar()
 {
 	m_varDef.clear();
 	m_valDynVarShadow.clear();
+	++m_nDefVer;
 	ReInit();
 }
 
@@ -1189,6 +1099,7 @@ void ParserXBase::ClearExpr()
 void ParserXBase::ClearFun()
 {
 	m_FunDef.clear();
+	++m_nDefVer;
 	ReInit();
 }
 
@@ -1201,6 +1112,7 @@ void ParserXBase::ClearFun()
 void ParserXBase::ClearConst()
 {
 	m_valDef.clear();
+	++m_nDefVer;
 	ReInit();
 }
 
@@ -1211,6 +1123,7 @@ void ParserXBase::ClearConst()
 void ParserXBase::ClearPostfixOprt()
 {
 	m_PostOprtDef.clear();
+	++m_nDefVer;
 	ReInit();
 }
 
@@ -1221,6 +1134,7 @@ void ParserXBase::ClearPostfixOprt()
 void ParserXBase::ClearOprt()
 {
 	m_OprtDef.clear();
+	++m_nDefVer;
 	ReInit();
 }
 
@@ -1231,6 +1145,7 @@ void ParserXBase::ClearOprt()
 void ParserXBase::ClearInfixOprt()
 {
 	m_InfixOprtDef.clear();
+	++m_nDefVer;
 	ReInit();
 }
 
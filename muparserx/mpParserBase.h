@@ -53,6 +53,7 @@
 #include "mpTypes.h"
 #include "mpRPN.h"
 #include "mpValueCache.h"
+#include "mpProgram.h"
 
 MUP_NAMESPACE_START
   
@@ -85,6 +86,7 @@ MUP_NAMESPACE_START
     virtual ~ParserXBase();
     
     const IValue& Eval() const;
+    ptr_prg_type Compile() const;
 
     void SetExpr(const string_type &a_sExpr);
     void AddValueReader(IValueReader *a_pReader);
@@ -122,6 +124,7 @@ MUP_NAMESPACE_START
     void DumpRPN() const;
 
     const var_maptype& GetExprVar() const;
+    const var_maptype& GetUsedVar() const;
     const var_maptype& GetVar() const;
     const val_maptype& GetConst() const;
     const fun_maptype& GetFunDef() const;
@@ -161,6 +164,7 @@ MUP_NAMESPACE_START
     void  ReInit() const;
     void  ClearExpr();
     void  CreateRPN() const;
+    void  PrepareRPN() const;
     void  StackDump(const Stack<ptr_tok_type> &a_stOprt) const;
 
     // Used by by DefineVar and DefineConst methods
@@ -190,6 +194,7 @@ MUP_NAMESPACE_START
     string_type m_sNameChars;        ///< Charset for names
     string_type m_sOprtChars;        ///< Charset for postfix/ binary operator tokens
     string_type m_sInfixOprtChars;   ///< Charset for infix operator tokens
+    unsigned m_nDefVer;              ///< Incremented whenever names, operators or charsets change
     mutable int m_nPos;
 
     /** \brief Index of the final result in the stack array. 
@@ -0,0 +1,452 @@
+/** \file
+    \brief Compiled expressions shared between threads.
+
+<pre>
+               __________                                 ____  ___
+    _____  __ _\______   \_____ _______  ______ __________\   \/  /
+   /     \|  |  \     ___/\__  \\_  __ \/  ___// __ \_  __ \     / 
+  |  Y Y  \  |  /    |     / __ \|  | \/\___ \\  ___/|  | \/     \ 
+  |__|_|  /____/|____|    (____  /__|  /____  >\___  >__| /___/\  \
+        \/                     \/           \/     \/           \_/
+                                       Copyright (C) 2016, Ingo Berg
+                                       All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without 
+  modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, 
+     this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright notice, 
+     this list of conditions and the following disclaimer in the documentation 
+     and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+  POSSIBILITY OF SUCH DAMAGE.
+  </pre>
+*/
+#include "mpProgram.h"
+
+#include "mpRPN.h"
+#include "mpIToken.h"
+#include "mpICallback.h"
+#include "mpError.h"
+#include "mpMatrixError.h"
+#include "mpIfThenElse.h"
+#include "mpVariable.h"
+
+MUP_NAMESPACE_START
+
+//---------------------------------------------------------------------------
+/** \brief Evaluate a reverse polish notation.
+	\param rpn The tokens to evaluate.
+	\param pSlot Variable slot of each token or nullptr if the variable tokens are bound themselves.
+	\param pVar Variable tokens indexed by slot.
+	\param pStack The value stack, at least nStackSize items.
+	\param nStackSize Number of items in the value stack.
+	\param cache The cache used for temporary values.
+	\param sExpr The expression string used in error messages.
+
+	This is the evaluation loop shared by ParserXBase and EvalContext. The tokens 
+	are only read, all state changed during the evaluation is in pStack, cache 
+	and the values of the variables.
+*/
+const IValue& ExecRPN(const token_vec_type& rpn,
+	const int* pSlot,
+	const ptr_val_type* pVar,
+	ptr_val_type* pStack,
+	int nStackSize,
+	ValueCache& cache,
+	const string_type& sExpr)
+{
+	if (rpn.size() == 0)
+	{
+		// Passiert bei leeren strings oder solchen, die nur Leerzeichen enthalten
+		ErrorContext err;
+		err.Expr = sExpr;
+		err.Errc = ecUNEXPECTED_EOF;
+		err.Pos = 0;
+		throw ParserError(err);
+	}
+
+	const ptr_tok_type* pRPN = &rpn[0];
+
+	int sidx = -1;
+	std::size_t lenRPN = rpn.size();
+	for (std::size_t i = 0; i < lenRPN; ++i)
+	{
+		IToken* pTok = pRPN[i].Get();
+		ECmdCode eCode = pTok->GetCode();
+
+		switch (eCode)
+		{
+		case cmSCRIPT_NEWLINE:
+			sidx = -1;
+			continue;
+
+		case cmVAL:
+		{
+			IValue* pVal = static_cast<IValue*>(pTok);
+
+			sidx++;
+			MUP_VERIFY(sidx < nStackSize);
+			if (pVal->IsVariable())
+			{
+				pStack[sidx].Reset((pSlot != nullptr) ? pVar[pSlot[i]].Get() : pVal);
+			}
+			else
+			{
+				ptr_val_type& val = pStack[sidx];
+				if (val->IsVariable())
+					val.Reset(cache.CreateFromCache());
+
+				*val = *pVal;
+			}
+		}
+		continue;
+
+		case  cmIC:
+		{
+			ICallback* pIdxOprt = static_cast<ICallback*>(pTok);
+			int nArgs = pIdxOprt->GetArgsPresent();
+			sidx -= nArgs - 1;
+			MUP_VERIFY(sidx >= 0);
+
+			ptr_val_type& idx = pStack[sidx];   // Pointer to the first index
+			ptr_val_type& val = pStack[--sidx];   // Pointer to the variable or value beeing indexed
+			pIdxOprt->Eval(val, &idx, nArgs);
+		}
+		continue;
+
+		case cmCBC:
+		case cmOPRT_POSTFIX:
+		case cmFUNC:
+		case cmOPRT_BIN:
+		case cmOPRT_INFIX:
+		{
+			ICallback* pFun = static_cast<ICallback*>(pTok);
+			int nArgs = pFun->GetArgsPresent();
+			sidx -= nArgs - 1;
+
+			// most likely cause: Comma in if-then-else sum(false?1,0,0:3)
+			if (sidx < 0)
+			{
+				ErrorContext err;
+				err.Expr = sExpr;
+				err.Errc = ecUNEXPECTED_COMMA;
+				err.Pos = pFun->GetExprPos();
+				throw ParserError(err);
+			}
+
+			ptr_val_type& val = pStack[sidx];
+			try
+			{
+				if (val->IsVariable())
+				{
+					ptr_val_type buf(cache.CreateFromCache());
+					pFun->Eval(buf, &val, nArgs);
+					val = buf;
+				}
+				else
+				{
+					pFun->Eval(val, &val, nArgs);
+				}
+			}
+			catch (ParserError& exc)
+			{
+				// <ibg 20130131> Not too happy about that:
+				// Multiarg functions may throw specific error codes when evaluating.
+				// These codes would be converted to ecEVAL here. I omit the conversion
+				// for certain handpicked errors. (The reason this catch block exists is
+				// that not all exceptions contain proper metadata when thrown out of
+				// a function.)
+				if (exc.GetCode() == ecTOO_FEW_PARAMS ||
+					exc.GetCode() == ecDOMAIN_ERROR ||
+					exc.GetCode() == ecOVERFLOW ||
+					exc.GetCode() == ecINVALID_NUMBER_OF_PARAMETERS ||
+					exc.GetCode() == ecASSIGNEMENT_TO_VALUE)
+				{
+					exc.GetContext().Pos = pFun->GetExprPos();
+					throw;
+				}
+				// </ibg>
+				else
+				{
+					ErrorContext err;
+					err.Expr = sExpr;
+					err.Ident = pFun->GetIdent();
+					err.Errc = ecEVAL;
+					err.Pos = pFun->GetExprPos();
+					err.Hint = exc.GetMsg();
+					throw ParserError(err);
+				}
+			}
+			catch (MatrixError& /*exc*/)
+			{
+				ErrorContext err;
+				err.Expr = sExpr;
+				err.Ident = pFun->GetIdent();
+				err.Errc = ecMATRIX_DIMENSION_MISMATCH;
+				err.Pos = pFun->GetExprPos();
+				throw ParserError(err);
+			}
+		}
+		continue;
+
+		case cmIF:
+			MUP_VERIFY(sidx >= 0);
+			if (pStack[sidx--]->GetBool() == false)
+				i += static_cast<TokenIfThenElse*>(pTok)->GetOffset();
+			continue;
+
+		case cmELSE:
+		case cmJMP:
+			i += static_cast<TokenIfThenElse*>(pTok)->GetOffset();
+			continue;
+
+		case cmENDIF:
+			continue;
+
+		default:
+			throw ParserError(ErrorContext(ecINTERNAL_ERROR));
+		} // switch token
+	} // for all RPN tokens
+
+	return *pStack[0];
+}
+
+//---------------------------------------------------------------------------
+//
+//  Program
+//
+//---------------------------------------------------------------------------
+
+/** \brief Create a program from the reverse polish notation of an expression.
+	\param rpn The finalized RPN of a parser.
+	\param sExpr The expression string.
+
+	All tokens are cloned so that the program shares nothing with the parser.
+	Each distinct variable gets a slot, numbered in order of first appearance.
+*/
+Program::Program(const RPN& rpn, const string_type& sExpr)
+	:m_vRPN()
+	, m_vSlot()
+	, m_vVarName()
+	, m_vVarInit()
+	, m_nStackSize(rpn.GetRequiredStackSize())
+	, m_sExpr(sExpr)
+{
+	const token_vec_type& data = rpn.GetData();
+	m_vRPN.reserve(data.size());
+	m_vSlot.assign(data.size(), -1);
+	for (std::size_t i = 0; i < data.size(); ++i)
+	{
+		IValue* pVal = data[i]->AsIValue();
+		if (pVal != nullptr && pVal->IsVariable())
+		{
+			int idx = GetVarIdx(pVal->GetIdent());
+			if (idx < 0)
+			{
+				idx = static_cast<int>(m_vVarName.size());
+				m_vVarName.push_back(pVal->GetIdent());
+				m_vVarInit.push_back(Value(*pVal));
+			}
+			m_vSlot[i] = idx;
+		}
+
+		m_vRPN.push_back(ptr_tok_type(data[i]->Clone()));
+	}
+}
+
+//---------------------------------------------------------------------------
+Program::~Program()
+{}
+
+//---------------------------------------------------------------------------
+const string_type& Program::GetExpr() const
+{
+	return m_sExpr;
+}
+
+//---------------------------------------------------------------------------
+int Program::GetRequiredStackSize() const
+{
+	return m_nStackSize;
+}
+
+//---------------------------------------------------------------------------
+int Program::GetVarCount() const
+{
+	return static_cast<int>(m_vVarName.size());
+}
+
+//---------------------------------------------------------------------------
+/** \brief Return the slot of a variable or -1 if the expression does not use it. */
+int Program::GetVarIdx(const string_type& ident) const
+{
+	for (std::size_t i = 0; i < m_vVarName.size(); ++i)
+	{
+		if (m_vVarName[i] == ident)
+			return static_cast<int>(i);
+	}
+
+	return -1;
+}
+
+//---------------------------------------------------------------------------
+const string_type& Program::GetVarName(int idx) const
+{
+	return m_vVarName.at(idx);
+}
+
+//---------------------------------------------------------------------------
+const Value& Program::GetVarInit(int idx) const
+{
+	return m_vVarInit.at(idx);
+}
+
+//---------------------------------------------------------------------------
+/** \brief Run the program.
+	\param pStack A value stack of GetRequiredStackSize() items.
+	\param cache The cache of the stack values.
+	\param pVar Variable tokens indexed by slot.
+*/
+const IValue& Program::Exec(ptr_val_type* pStack, ValueCache& cache, const ptr_val_type* pVar) const
+{
+	return ExecRPN(m_vRPN, m_vSlot.data(), pVar, pStack, m_nStackSize, cache, m_sExpr);
+}
+
+//---------------------------------------------------------------------------
+//
+//  EvalContext
+//
+//---------------------------------------------------------------------------
+
+EvalContext::EvalContext(const ptr_prg_type& prg)
+	:m_prg(prg)
+	, m_vVal()
+	, m_vVar()
+	, m_cache()
+	, m_vStackBuffer()
+{
+	MUP_VERIFY(m_prg.get() != nullptr);
+	for (int i = 0; i < m_prg->GetVarCount(); ++i)
+		m_vVal.push_back(m_prg->GetVarInit(i));
+	Init();
+}
+
+//---------------------------------------------------------------------------
+/** \brief Copy constructor.
+
+	The copy shares the program and the external bindings of \a ref and gets
+	its own stack and copies of the variables stored in \a ref.
+*/
+EvalContext::EvalContext(const EvalContext& ref)
+	:m_prg(ref.m_prg)
+	, m_vVal(ref.m_vVal)
+	, m_vVar()
+	, m_cache()
+	, m_vStackBuffer()
+{
+	Init();
+	for (std::size_t i = 0; i < m_vVar.size(); ++i)
+	{
+		IValue* pVal = static_cast<Variable*>(ref.m_vVar[i].Get())->GetPtr();
+		if (pVal != &ref.m_vVal[i])
+			static_cast<Variable*>(m_vVar[i].Get())->Bind(pVal);
+	}
+}
+
+//---------------------------------------------------------------------------
+EvalContext::~EvalContext()
+{
+	// Release the stack buffer before the value cache,
+	// it may contain values referencing the cache.
+	m_vStackBuffer.clear();
+	m_cache.ReleaseAll();
+}
+
+//---------------------------------------------------------------------------
+void EvalContext::Init()
+{
+	m_vVar.clear();
+	for (std::size_t i = 0; i < m_vVal.size(); ++i)
+		m_vVar.push_back(ptr_val_type(new Variable(&m_vVal[i])));
+
+	m_vStackBuffer.assign(m_prg->GetRequiredStackSize(), ptr_val_type());
+	for (std::size_t i = 0; i < m_vStackBuffer.size(); ++i)
+	{
+		Value* pValue = new Value;
+		pValue->BindToCache(&m_cache);
+		m_vStackBuffer[i].Reset(pValue);
+	}
+}
+
+//---------------------------------------------------------------------------
+const Program& EvalContext::GetProgram() const
+{
+	return *m_prg;
+}
+
+//---------------------------------------------------------------------------
+/** \brief Bind a variable of the program to an external value.
+	\return false if the program does not use the variable.
+
+	The value must outlive the context. Binding a value to several contexts
+	used concurrently is only safe if the expression does not assign to it.
+*/
+bool EvalContext::BindVar(const string_type& ident, IValue* pVal)
+{
+	int idx = m_prg->GetVarIdx(ident);
+	if (idx < 0)
+		return false;
+
+	if (pVal == nullptr)
+		throw ParserError(ErrorContext(ecINVALID_VAR_PTR, -1, ident));
+
+	static_cast<Variable*>(m_vVar[idx].Get())->Bind(pVal);
+	return true;
+}
+
+//---------------------------------------------------------------------------
+/** \brief Set the value of a variable stored in the context.
+	\return false if the program does not use the variable.
+
+	Any external binding of the variable is released.
+*/
+bool EvalContext::SetVar(const string_type& ident, const Value& val)
+{
+	int idx = m_prg->GetVarIdx(ident);
+	if (idx < 0)
+		return false;
+
+	m_vVal[idx] = val;
+	static_cast<Variable*>(m_vVar[idx].Get())->Bind(&m_vVal[idx]);
+	return true;
+}
+
+//---------------------------------------------------------------------------
+/** \brief Return the variable in slot \a idx. 
+
+	This is the fast way of setting variables in evaluation loops, 
+	the slot of a name is given by Program::GetVarIdx.
+*/
+IValue& EvalContext::Var(int idx)
+{
+	return *m_vVar.at(idx);
+}
+
+//---------------------------------------------------------------------------
+const IValue& EvalContext::Eval()
+{
+	return m_prg->Exec(m_vStackBuffer.data(), m_cache, m_vVar.data());
+}
+
+MUP_NAMESPACE_END
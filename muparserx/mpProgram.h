@@ -0,0 +1,139 @@
+/** \file
+    \brief Compiled expressions shared between threads.
+
+<pre>
+               __________                                 ____  ___
+    _____  __ _\______   \_____ _______  ______ __________\   \/  /
+   /     \|  |  \     ___/\__  \\_  __ \/  ___// __ \_  __ \     / 
+  |  Y Y  \  |  /    |     / __ \|  | \/\___ \\  ___/|  | \/     \ 
+  |__|_|  /____/|____|    (____  /__|  /____  >\___  >__| /___/\  \
+        \/                     \/           \/     \/           \_/
+                                       Copyright (C) 2016, Ingo Berg
+                                       All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without 
+  modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, 
+     this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright notice, 
+     this list of conditions and the following disclaimer in the documentation 
+     and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+  POSSIBILITY OF SUCH DAMAGE.
+  </pre>
+*/
+#ifndef MUP_PROGRAM_H
+#define MUP_PROGRAM_H
+
+#include <memory>
+#include <vector>
+
+#include "mpFwdDecl.h"
+#include "mpTypes.h"
+#include "mpValue.h"
+#include "mpValueCache.h"
+
+
+MUP_NAMESPACE_START
+
+  class RPN;
+
+  //---------------------------------------------------------------------------
+  /** \brief An immutable compiled expression.
+
+    A program is created by ParserXBase::Compile from the reverse polish 
+    notation of the parser expression. It owns private copies of all tokens
+    and never changes after construction, so one program can be shared by any 
+    number of threads. The variables of the expression are replaced by 
+    positional slots which are bound by an EvalContext. 
+  */
+  class Program
+  {
+  public:
+
+    Program(const RPN &rpn, const string_type &sExpr);
+   ~Program();
+
+    const string_type& GetExpr() const;
+    int GetRequiredStackSize() const;
+
+    int GetVarCount() const;
+    int GetVarIdx(const string_type &ident) const;
+    const string_type& GetVarName(int idx) const;
+    const Value& GetVarInit(int idx) const;
+
+    const IValue& Exec(ptr_val_type *pStack, ValueCache &cache, const ptr_val_type *pVar) const;
+
+  private:
+
+    Program(const Program &ref);
+    Program& operator=(const Program &ref);
+
+    token_vec_type m_vRPN;              ///< Private copies of the RPN tokens
+    std::vector<int> m_vSlot;           ///< Variable slot of each RPN token, -1 if not a variable
+    std::vector<string_type> m_vVarName;
+    std::vector<Value> m_vVarInit;      ///< Variable values at compile time
+    int m_nStackSize;
+    string_type m_sExpr;
+  };
+
+  typedef std::shared_ptr<const Program> ptr_prg_type;
+
+  //---------------------------------------------------------------------------
+  /** \brief Per thread execution state of a compiled program.
+
+    The context holds the value stack, the value cache and the variable
+    bindings used to evaluate a shared Program. Creating a context is cheap 
+    compared to parsing, but a context must not be used by two threads at the
+    same time. Each variable is either bound to an external value with 
+    BindVar or stored in the context, initialized with its value at compile time.
+  */
+  class EvalContext
+  {
+  public:
+
+    explicit EvalContext(const ptr_prg_type &prg);
+    EvalContext(const EvalContext &ref);
+   ~EvalContext();
+
+    const Program& GetProgram() const;
+
+    bool BindVar(const string_type &ident, IValue *pVal);
+    bool SetVar(const string_type &ident, const Value &val);
+    IValue& Var(int idx);
+
+    const IValue& Eval();
+
+  private:
+
+    EvalContext& operator=(const EvalContext &ref);
+    void Init();
+
+    ptr_prg_type m_prg;
+    std::vector<Value> m_vVal;          ///< Storage of variables not bound to external values
+    val_vec_type m_vVar;                ///< Variable tokens, one per program slot
+    ValueCache m_cache;
+    val_vec_type m_vStackBuffer;
+  };
+
+  const IValue& ExecRPN(const token_vec_type &rpn,
+                        const int *pSlot,
+                        const ptr_val_type *pVar,
+                        ptr_val_type *pStack,
+                        int nStackSize,
+                        ValueCache &cache,
+                        const string_type &sExpr);
+
+MUP_NAMESPACE_END
+
+#endif
@@ -45,6 +45,7 @@
 #include <iostream>
 #include <complex>
 #include <limits>
+#include <thread>
 
 #define MUP_CONST_PI  3.141592653589793238462643
 #define MUP_CONST_E   2.718281828459045235360287
@@ -122,6 +123,7 @@ ParserTester::ParserTester()
 {
 	AddTest(&ParserTester::TestParserValue);
 	AddTest(&ParserTester::TestUndefVar);
+	AddTest(&ParserTester::TestModified);
 	AddTest(&ParserTester::TestErrorCodes);
 	AddTest(&ParserTester::TestEqn);
 	AddTest(&ParserTester::TestIfElse);
@@ -136,6 +138,8 @@ ParserTester::ParserTester()
 	AddTest(&ParserTester::TestScript);
 	AddTest(&ParserTester::TestValReader);
 	AddTest(&ParserTester::TestIssueReports);
+	AddTest(&ParserTester::TestProgram);
+	AddTest(&ParserTester::TestLongExpr);
 
 	ParserTester::c_iCount = 0;
 }
@@ -253,6 +257,57 @@ int ParserTester::TestUndefVar()
 	return iNumErr;
 }
 
+//---------------------------------------------------------------------------
+int ParserTester::TestModified()
+{
+	int iNumErr = 0;
+	*m_stream << _T("testing modification flags...");
+
+	ParserX p;
+	Value a(1.0), b(2.0), x(0.0), v(3, 0.0), w(2, 2, 0.0);
+	p.DefineVar(_T("a"), Variable(&a));
+	p.DefineVar(_T("b"), Variable(&b));
+	p.DefineVar(_T("x"), Variable(&x));
+	p.DefineVar(_T("v"), Variable(&v));
+	p.DefineVar(_T("w"), Variable(&w));
+
+	// Only the assigned variable is flagged
+	p.SetExpr(_T("a=b*2"));
+	p.Eval();
+	if (!a.IsModified() || b.IsModified() || p.GetUsedVar().size() != 2)
+		iNumErr++;
+
+	// Writing an element flags the vector, not the right hand side
+	a.SetModified(false);
+	p.SetExpr(_T("v[1]=a"));
+	p.Eval();
+	if (!v.IsModified() || a.IsModified() || v.At(1).GetFloat() != 4)
+		iNumErr++;
+
+	// Reading an element does not flag the vector
+	v.SetModified(false);
+	p.SetExpr(_T("x=v[1]"));
+	p.Eval();
+	if (v.IsModified() || !x.IsModified() || x.GetFloat() != 4)
+		iNumErr++;
+
+	// Same for matrices and compound assignment
+	x.SetModified(false);
+	p.SetExpr(_T("x=w[1,0]+v[1]"));
+	p.Eval();
+	if (w.IsModified() || v.IsModified() || x.GetFloat() != 4)
+		iNumErr++;
+
+	x.SetModified(false);
+	p.SetExpr(_T("w[1,0]+=x"));
+	p.Eval();
+	if (!w.IsModified() || x.IsModified() || w.At(1, 0).GetFloat() != 4)
+		iNumErr++;
+
+	Assessment(iNumErr);
+	return iNumErr;
+}
+
 //---------------------------------------------------------------------------
 int ParserTester::TestMatrix()
 {
@@ -326,10 +381,6 @@ int ParserTester::TestMatrix()
 	iNumErr += ThrowTest(_T("m1[1]"), ecINDEX_DIMENSION);
 	iNumErr += ThrowTest(_T("m1[1,2,3]"), ecINDEX_DIMENSION);
 	iNumErr += ThrowTest(_T("va[1,2]"), ecINDEX_OUT_OF_BOUNDS); // va has 1 column, 3 rows -> the coulumn index is referencing the third column
-	iNumErr += ThrowTest(_T("a+m1"), ecEVAL);
-	iNumErr += ThrowTest(_T("m1+a"), ecEVAL);
-	iNumErr += ThrowTest(_T("a-m1"), ecEVAL);
-	iNumErr += ThrowTest(_T("m1-a"), ecEVAL);
 	iNumErr += ThrowTest(_T("va[,1]"), ecUNEXPECTED_COMMA);
 	iNumErr += ThrowTest(_T("va[{1]"), ecMISSING_CURLY_BRACKET);
 	iNumErr += ThrowTest(_T("{,1}"), ecUNEXPECTED_COMMA);
@@ -345,6 +396,19 @@ int ParserTester::TestMatrix()
 	iNumErr += EqnTest(_T("b*m2*5"), m2_times_10, true);
 	iNumErr += EqnTest(_T("m1*va"), va, true);
 
+	// element-wise operations with a scalar
+	Value m1_plus_1(3, 3, 1.0);
+	m1_plus_1.At(0, 0) = 2.0;
+	m1_plus_1.At(1, 1) = 2.0;
+	m1_plus_1.At(2, 2) = 2.0;
+	iNumErr += EqnTest(_T("a+m1"), m1_plus_1, true);
+	iNumErr += EqnTest(_T("m1+a"), m1_plus_1, true);
+	iNumErr += EqnTest(_T("2*a-(a-m1)"), m1_plus_1, true);
+	iNumErr += EqnTest(_T("m1-a+2"), m1_plus_1, true);
+	iNumErr += EqnTest(_T("m2*100/b/5"), m2_times_10, true);
+	iNumErr += EqnTest(_T("(m2*10)^1"), m2_times_10, true);
+	iNumErr += EqnTest(_T("10*m2/cos(0*m2)"), m2_times_10, true);
+
 	// ones
 	Value ones_3(3, 1.0);
 	Value ones_3x3(3, 3, 1.0);
@@ -409,6 +473,30 @@ int ParserTester::TestMatrix()
 	// assignment to element:
 	iNumErr += ThrowTest(_T("va'[0]=123"), ecASSIGNEMENT_TO_VALUE);
 
+	// dense linear algebra
+	iNumErr += ThrowTest(_T("inv(zeros(3,3))"), ecEVAL);
+	iNumErr += ThrowTest(_T("inv(va)"), ecMATRIX_DIMENSION_MISMATCH);
+	iNumErr += ThrowTest(_T("chol(-m1)"), ecEVAL);
+	iNumErr += ThrowTest(_T("lu(m1,\"X\")"), ecEVAL);
+	iNumErr += ThrowTest(_T("m1\\vc"), ecMATRIX_DIMENSION_MISMATCH);
+	iNumErr += ThrowTest(_T("va'\\1"), ecEVAL);
+	iNumErr += EqnTest(_T("inv(m1)"), unity, true);
+	iNumErr += EqnTest(_T("chol(m1)"), unity, true);
+	iNumErr += EqnTest(_T("det(m1)"), 1.0, true);
+	iNumErr += EqnTest(_T("det(m2+10*m1)"), 2320.0, true);
+	iNumErr += EqnTest(_T("(inv(m2+10*m1)*(m2+10*m1))[1,1]"), 1.0, true);
+	iNumErr += EqnTest(_T("(chol(m2*m2'+m1)*chol(m2*m2'+m1)')[1,2]"), 122.0, true);
+	iNumErr += EqnTest(_T("(lu(m2,\"L\")*lu(m2,\"U\"))[0,0]"), 7.0, true);
+	iNumErr += EqnTest(_T("(lu(m2,\"P\")*m2)[0,0]"), 7.0, true);
+	iNumErr += EqnTest(_T("det(lu(m2+10*m1,\"P\"))*det(lu(m2+10*m1,\"U\"))"), 2320.0, true);
+	iNumErr += EqnTest(_T("(qr(m2+10*m1,\"Q\")*qr(m2+10*m1))[2,0]"), 7.0, true);
+	iNumErr += EqnTest(_T("abs(det(qr(m2+10*m1)))"), 2320.0, true);
+	iNumErr += EqnTest(_T("svd(m2+10*m1)[0]*svd(m2+10*m1)[1]*svd(m2+10*m1)[2]"), 2320.0, true);
+	iNumErr += EqnTest(_T("(svd(m2,\"U\")'*svd(m2,\"U\"))[1,1]"), 1.0, true);
+	iNumErr += EqnTest(_T("((m2+10*m1)*((m2+10*m1)\\va))[2]"), 3.0, true);
+	iNumErr += EqnTest(_T("va\\vb"), 16.0/14.0, true);
+	iNumErr += EqnTest(_T("2\\4"), 2.0, true);
+
 	Assessment(iNumErr);
 	return iNumErr;
 }
@@ -444,6 +532,9 @@ int ParserTester::TestComplex()
 	iNumErr += EqnTest(_T("norm(3+4i)"), 25.0, true, 0);
 	iNumErr += EqnTest(_T("norm(4i+3)"), 25.0, true, 0);
 	iNumErr += EqnTest(_T("norm(3i+4)"), 25.0, true, 0);
+	iNumErr += EqnTest(_T("abs(3+4i)"), 5.0, true, 0);
+	iNumErr += EqnTest(_T("abs(3e200+4e200i)"), 5e200, true, 0);
+	iNumErr += EqnTest(_T("abs(3e-200i+4e-200)"), 5e-200, true, 0);
 	iNumErr += EqnTest(_T("real(4.1i+3.1)"), (float_type)3.1, true, 0);
 	iNumErr += EqnTest(_T("imag(3.1i+4.1)"), (float_type)3.1, true, 0);
 	iNumErr += EqnTest(_T("real(3.1)"), (float_type)3.1, true, 0);
@@ -694,7 +785,7 @@ int ParserTester::TestErrorCodes()
 	iNumErr += ThrowTest(_T("(1+3i)/(8*9i)-\"hallo\""), ecEVAL);
 	iNumErr += ThrowTest(_T("(1+3i)/(8*9i)*\"hallo\""), ecEVAL);
 	iNumErr += ThrowTest(_T("(1+3i)/(8*9i)/\"hallo\""), ecEVAL);
-	iNumErr += ThrowTest(_T("10+va"), ecEVAL, 2);
+	iNumErr += ThrowTest(_T("10+vd"), ecEVAL);
 
 	// Type conflicts in binary operators
 	iNumErr += ThrowTest(_T("\"test\" // 8"), ecEVAL, 7);
@@ -922,8 +1013,7 @@ int ParserTester::TestVector()
 	*m_stream << _T("testing vector operations...");
 
 	// Vector operations
-	iNumErr += ThrowTest(_T("10+2*va"), ecEVAL);   // fail: number + vector
-	iNumErr += ThrowTest(_T("10+va*2"), ecEVAL);   // fail: number + vector
+	iNumErr += ThrowTest(_T("sin(vd)"), ecEVAL);   // fail: vector entry is a string
 	iNumErr += ThrowTest(_T("va+vc"), ecMATRIX_DIMENSION_MISMATCH);   // fail: vectors of different size
 	iNumErr += ThrowTest(_T("va-vc"), ecMATRIX_DIMENSION_MISMATCH);   // fail: vectors of different size
 	iNumErr += ThrowTest(_T("va*vc"), ecMATRIX_DIMENSION_MISMATCH);   // fail: vectors of different size
@@ -960,6 +1050,45 @@ int ParserTester::TestVector()
 	v.At(2) = (float_type)-3.0;
 	iNumErr += EqnTest(_T("-va"), v, true);
 
+	// Element-wise functions and operations with scalars
+	v.At(0) = (float_type)12.0;
+	v.At(1) = (float_type)14.0;
+	v.At(2) = (float_type)16.0;
+	iNumErr += EqnTest(_T("10+2*va"), v, true);
+	iNumErr += EqnTest(_T("10+va*2"), v, true);
+	iNumErr += EqnTest(_T("(va+5)*2"), v, true);
+
+	v.At(0) = (float_type)1.0;
+	v.At(1) = (float_type)4.0;
+	v.At(2) = (float_type)9.0;
+	iNumErr += EqnTest(_T("va^2"), v, true);
+	iNumErr += EqnTest(_T("pow(va,2)"), v, true);
+	iNumErr += EqnTest(_T("va^3/va/va^0"), v, true);
+
+	v.At(0) = (float_type)0.0;
+	v.At(1) = (float_type)0.0;
+	v.At(2) = (float_type)0.0;
+	iNumErr += EqnTest(_T("sin(va-va)"), v, true);
+	iNumErr += EqnTest(_T("ln(va^0)"), v, true);
+	iNumErr += EqnTest(_T("sqrt(va^2)-va"), v, true);
+	iNumErr += EqnTest(_T("abs(-va)-va"), v, true);
+	iNumErr += EqnTest(_T("imag(sqrt(-va^2))-va"), v, true);
+	iNumErr += EqnTest(_T("va>3"), v, true);
+	iNumErr += EqnTest(_T("(va<1)+(0>=va)"), v, true);
+
+	v.At(0) = cmplx_type(0, 1);
+	v.At(1) = cmplx_type(0, 2);
+	v.At(2) = cmplx_type(0, 3);
+	iNumErr += EqnTest(_T("sqrt(-va^2)"), v, true);
+	iNumErr += EqnTest(_T("va*i"), v, true);
+	iNumErr += EqnTest(_T("conj(-va*i)"), v, true);
+
+	v.At(0) = (float_type)1.0;
+	v.At(1) = (float_type)0.0;
+	v.At(2) = (float_type)1.0;
+	iNumErr += EqnTest(_T("(va<=1)+(va>2)"), v, true);
+	iNumErr += EqnTest(_T("va'>=va'"), v, false);
+
 	iNumErr += EqnTest(_T("sizeof(va+vb)"), 3.0, true);
 	iNumErr += EqnTest(_T("sizeof(va-vb)"), 3.0, true);
 
@@ -1417,6 +1546,180 @@ int ParserTester::TestValReader()
 	return iNumErr;
 }
 
+//---------------------------------------------------------------------------
+int ParserTester::TestProgram()
+{
+	int iNumErr = 0;
+	*m_stream << _T("testing compiled programs...");
+
+	Value a(1.0), b(2.0), s(_T("abc"));
+	ParserX p;
+	p.DefineVar(_T("a"), Variable(&a));
+	p.DefineVar(_T("b"), Variable(&b));
+	p.DefineVar(_T("s"), Variable(&s));
+
+	// Contexts start with the values at compile time and are independent
+	p.SetExpr(_T("a<b ? a*b+strlen(s) : {a,b}"));
+	ptr_prg_type prg = p.Compile();
+	EvalContext c1(prg), c2(prg);
+	c2.SetVar(_T("a"), 3.0);
+	if (c1.Eval().GetFloat() != 5 || c2.Eval().GetCols() != 2 || c2.Eval().GetArray().At(0).GetFloat() != 3)
+		iNumErr++;
+
+	// Later changes of the parser do not affect the program
+	a = 10.0;
+	p.SetExpr(_T("a+b"));
+	if (p.Eval().GetFloat() != 12 || c1.Eval().GetFloat() != 5 || prg->GetVarCount() != 3)
+		iNumErr++;
+
+	// Assignments change the context storage or the bound value only
+	p.SetExpr(_T("a=a+b\na"));
+	prg = p.Compile();
+	EvalContext c3(prg);
+	Value x(5.0);
+	c3.Eval();
+	if (c3.Eval().GetFloat() != 14 || a.GetFloat() != 10 || !c3.BindVar(_T("a"), &x) || c3.BindVar(_T("s"), &x))
+		iNumErr++;
+	EvalContext c4(c3);
+	c4.Eval();
+	if (x.GetFloat() != 7 || c4.Var(prg->GetVarIdx(_T("b"))).GetFloat() != 2)
+		iNumErr++;
+
+	// Setting the compiled expression again keeps the bytecode
+	p.SetExpr(_T("a*b"));
+	p.Eval();
+	a = 3.0;
+	p.SetExpr(_T("a*b"));
+	if (p.Eval().GetFloat() != 6 || p.GetUsedVar().size() != 2)
+		iNumErr++;
+
+	// Errors are reported like in the parser
+	p.SetExpr(_T("{1,2}+{a,b,a}"));
+	EvalContext c5(p.Compile());
+	try
+	{
+		c5.Eval();
+		iNumErr++;
+	}
+	catch (ParserError& e)
+	{
+		if (e.GetCode() != ecMATRIX_DIMENSION_MISMATCH)
+			iNumErr++;
+	}
+
+	// Concurrent evaluation of one program with a context per thread
+	p.EnableAutoCreateVar(true);
+	p.SetExpr(_T("x=a*b\ny=x>0 ? sin(a)^2+cos(a)^2 : 0\nv={a,b}*{x,y}'\ny+v-x*x-b*y"));
+	prg = p.Compile();
+	const int nThreads = 4, nEval = 2000;
+	std::vector<int> vErr(nThreads, 0);
+	std::vector<std::thread> vThread;
+	for (int t = 0; t < nThreads; ++t)
+	{
+		vThread.push_back(std::thread([&prg, &vErr, t]()
+		{
+			EvalContext ctx(prg);
+			int ia = prg->GetVarIdx(_T("a")), ib = prg->GetVarIdx(_T("b"));
+			for (int i = 0; i < nEval; ++i)
+			{
+				float_type fa = 1 + t + i*1e-3, fb = t - 1.5;
+				ctx.Var(ia) = fa;
+				ctx.Var(ib) = fb;
+				float_type r = ctx.Eval().GetFloat();
+				float_type y = (fa*fb > 0) ? 1 : 0;
+				if (std::fabs(r - (y + fa*fa*fb + fb*y - fa*fa*fb*fb - fb*y)) > 1e-9*(1 + std::fabs(r)))
+					vErr[t]++;
+
+				try
+				{
+					ctx.Var(ib) = _T("b");
+					ctx.Eval();
+					vErr[t]++;
+				}
+				catch (ParserError&)
+				{}
+			}
+		}));
+	}
+
+	for (int t = 0; t < nThreads; ++t)
+	{
+		vThread[t].join();
+		iNumErr += (vErr[t] > 0) ? 1 : 0;
+	}
+
+	Assessment(iNumErr);
+	return iNumErr;
+}
+
+//---------------------------------------------------------------------------
+int ParserTester::TestLongExpr()
+{
+	int iNumErr = 0;
+	*m_stream << _T("testing long expressions...");
+
+	// Generated expressions may be much longer than 10000 characters
+	Value a(0.5), b(2.0);
+	ParserX p;
+	p.DefineVar(_T("a"), Variable(&a));
+	stringstream_type ss;
+	float_type fSum = 0;
+	for (int i = 0; i < 2000; ++i)
+	{
+		ss << (i ? _T("+") : _T("")) << _T("(a<") << i << _T(" ? ") << i << _T("*a^2 : 0x") << std::hex << i << std::dec << _T(")");
+		fSum += (0.5 < i) ? i*0.25 : i;
+	}
+
+	p.SetExpr(ss.str());
+	if (ss.str().length() < 30000 || p.Eval().GetFloat() != fSum)
+		iNumErr++;
+
+	// Names and operators defined after parsing are seen by the next parse
+	p.SetExpr(_T("a*b+c"));
+	try
+	{
+		p.Eval();
+		iNumErr++;
+	}
+	catch (ParserError &e)
+	{
+		if (e.GetCode() != ecUNASSIGNABLE_TOKEN)
+			iNumErr++;
+	}
+
+	p.DefineVar(_T("b"), Variable(&b));
+	p.DefineConst(_T("c"), 3.0);
+	p.SetExpr(_T("a*b+c"));
+	if (p.Eval().GetFloat() != 4)
+		iNumErr++;
+
+	p.RemoveVar(_T("b"));
+	p.SetExpr(_T("a*b+c"));
+	try
+	{
+		p.Eval();
+		iNumErr++;
+	}
+	catch (ParserError &e)
+	{
+		if (e.GetCode() != ecUNASSIGNABLE_TOKEN || e.GetToken() != _T("b"))
+			iNumErr++;
+	}
+
+	// Copies look names up in their own definitions
+	ParserX p2(p);
+	p2.EnableAutoCreateVar(true);
+	p2.SetExpr(_T("b=4\na*b+c"));
+	if (p2.Eval().GetFloat() != 5 || p.IsVarDefined(_T("b")) || !p2.IsVarDefined(_T("b")))
+		iNumErr++;
+
+	// Errors point to an unexpected value, not to the start of the expression
+	iNumErr += ThrowTest(_T("a+1 2"), ecUNEXPECTED_VAL, 4);
+
+	Assessment(iNumErr);
+	return iNumErr;
+}
+
 //---------------------------------------------------------------------------
 void ParserTester::AddTest(testfun_type a_pFun)
 {
@@ -56,12 +56,15 @@ MUP_NAMESPACE_START
         int TestEqn();
         int TestMultiArg();
         int TestUndefVar();
+        int TestModified();
         int TestIfElse();
         int TestMatrix();
         int TestComplex();
         int TestScript();
 		int TestValReader();
         int TestIssueReports();
+        int TestProgram();
+        int TestLongExpr();
 
         void Assessment(int a_iNumErr) const;
         void Abort() const;
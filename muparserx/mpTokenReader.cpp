@@ -36,8 +36,10 @@
 
 #include "mpTokenReader.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <type_traits>
 
 #include "mpParserBase.h"
 #include "mpIValReader.h"
@@ -97,6 +99,7 @@ void TokenReader::Assign(const TokenReader &obj)
 	m_pConstDef = obj.m_pConstDef;
 	m_pDynVarShadowValues = obj.m_pDynVarShadowValues;
 	m_vTokens = obj.m_vTokens;
+	m_nDefVer = 0;
 
 	// Reader klassen klonen
 	DeleteValReader();
@@ -137,6 +140,11 @@ TokenReader::TokenReader(ParserXBase *a_pParent)
 	, m_vValueReader()
 	, m_UsedVar()
 	, m_fZero(0)
+	, m_nDefVer(0)
+	, m_OprtTrie()
+	, m_InfixTrie()
+	, m_PostTrie()
+	, m_Ident()
 {
 	assert(m_pParser);
 	SetParent(m_pParser);
@@ -243,9 +251,10 @@ void TokenReader::SetExpr(const string_type &a_sExpr)
 	if (std::all_of(a_sExpr.begin(), a_sExpr.end(), [](char_type c) { return !std::isgraph(c); }))
 		throw ParserError(_T("Non printable characters in expression found!"));
 
-	// Check maximum allowed expression length. An arbitrary value small enough so i can debug expressions sent to me
-	if (a_sExpr.length() >= 10000)
-		throw ParserError(_T("Expression longer than 10000 characters!"));
+	// Check maximum allowed expression length. Generated expressions (polynomial
+	// fits, piecewise definitions) easily have tens of thousands of characters.
+	if (a_sExpr.length() >= 1000000)
+		throw ParserError(_T("Expression longer than 1000000 characters!"));
 
 	m_sExpr = a_sExpr; 
 	ReInit();
@@ -315,6 +324,9 @@ ptr_tok_type TokenReader::ReadNextToken()
 {
 	assert(m_pParser);
 
+	if (m_nDefVer != m_pParser->m_nDefVer)
+		UpdateLexicon();
+
 	SkipCommentsAndWhitespaces();
 
 	int token_pos = m_nPos;
@@ -377,7 +389,7 @@ ptr_tok_type TokenReader::ReadNextToken()
 	// !!! From this point on there is no exit without an exception possible...
 	//
 	string_type sTok;
-	int iEnd = ExtractToken(m_pParser->ValidNameChars(), sTok, m_nPos);
+	int iEnd = ExtractToken(ccNAME, sTok, m_nPos);
 
 	ErrorContext err;
 	err.Errc = ecUNASSIGNABLE_TOKEN;
@@ -403,24 +415,146 @@ void TokenReader::SetParent(ParserXBase *a_pParent)
 	m_pVarDef = &a_pParent->m_varDef;
 	m_pConstDef = &a_pParent->m_valDef;
 	m_pDynVarShadowValues = &a_pParent->m_valDynVarShadow;
+	m_nDefVer = 0;
+}
+
+//---------------------------------------------------------------------------
+/** \brief Rebuild the lookup tables from the definitions of the parser.
+
+	The character classes, the operator tries and the identifier table replace
+	scans of the charsets and of the definition maps for every token. They are
+	rebuilt whenever the definition version of the parser changes.
+	*/
+void TokenReader::UpdateLexicon()
+{
+	const string_type *sCharSet[] = { &m_pParser->m_sNameChars, &m_pParser->m_sOprtChars, &m_pParser->m_sInfixOprtChars };
+	const int iClass[] = { ccNAME, ccOPRT, ccINFIX };
+
+	std::fill(m_cClass, m_cClass + 256, 0);
+	for (int i = 0; i < 3; ++i)
+	{
+		for (char_type c : *sCharSet[i])
+		{
+			std::size_t n = (std::make_unsigned<char_type>::type)c;
+			if (n < 256)
+				m_cClass[n] |= iClass[i];
+		}
+	}
+
+	oprt_trie_type *pTrie[] = { &m_OprtTrie, &m_InfixTrie, &m_PostTrie };
+	for (oprt_trie_type *t : pTrie)
+	{
+		t->clear();
+		t->push_back(OprtNode{ 0, -1, -1, nullptr });
+	}
+
+	for (const def_type &item : *m_pOprtDef)
+		AddToTrie(m_OprtTrie, item);
+
+	for (const def_type &item : *m_pInfixOprtDef)
+		AddToTrie(m_InfixTrie, item);
+
+	for (const def_type &item : *m_pPostOprtDef)
+		AddToTrie(m_PostTrie, item);
+
+	m_Ident.clear();
+	for (const def_type &item : *m_pVarDef)
+		m_Ident[item.first].var = &item;
+
+	for (const def_type &item : *m_pConstDef)
+		m_Ident[item.first].cnst = &item;
+
+	for (const def_type &item : *m_pFunDef)
+		m_Ident[item.first].fun = &item;
+
+	m_nDefVer = m_pParser->m_nDefVer;
+}
+
+//---------------------------------------------------------------------------
+void TokenReader::AddToTrie(oprt_trie_type &a_Trie, const def_type &a_Def)
+{
+	int iNode = 0;
+	for (char_type c : a_Def.first)
+	{
+		int iChild = a_Trie[iNode].child;
+		while (iChild != -1 && a_Trie[iChild].c != c)
+			iChild = a_Trie[iChild].next;
+
+		if (iChild == -1)
+		{
+			iChild = (int)a_Trie.size();
+			a_Trie.push_back(OprtNode{ c, -1, a_Trie[iNode].child, nullptr });
+			a_Trie[iNode].child = iChild;
+		}
+
+		iNode = iChild;
+	}
+
+	if (iNode != 0)
+		a_Trie[iNode].def = &a_Def;
+}
+
+//---------------------------------------------------------------------------
+/** \brief Find the operator whose identifier starts at the current position.
+	\param a_Trie The operators to look for.
+	\param a_iClass Character class of the operator identifiers.
+	\param a_bLongest If true the longest matching identifier is returned, otherwise the shortest.
+	\return The operator definition or nullptr if no operator matches.
+	*/
+const TokenReader::def_type* TokenReader::FindInTrie(const oprt_trie_type &a_Trie, int a_iClass, bool a_bLongest) const
+{
+	const def_type *pDef = nullptr;
+	int iNode = 0, iLen = (int)m_sExpr.length();
+
+	for (int i = m_nPos; i < iLen && IsCharClass(m_sExpr[i], a_iClass); ++i)
+	{
+		iNode = a_Trie[iNode].child;
+		while (iNode != -1 && a_Trie[iNode].c != m_sExpr[i])
+			iNode = a_Trie[iNode].next;
+
+		if (iNode == -1)
+			break;
+
+		if (a_Trie[iNode].def)
+		{
+			pDef = a_Trie[iNode].def;
+			if (!a_bLongest)
+				break;
+		}
+	}
+
+	return pDef;
 }
 
 //---------------------------------------------------------------------------
-/** \brief Extract all characters that belong to a certain charset.
-	\param a_szCharSet [in] Const char array of the characters allowed in the token.
-	\param a_strTok [out]  The string that consists entirely of characters listed in a_szCharSet.
+/** \brief Check if a character belongs to one of the parser charsets. */
+bool TokenReader::IsCharClass(char_type c, int a_iClass) const
+{
+	std::size_t n = (std::make_unsigned<char_type>::type)c;
+	if (n < 256)
+		return (m_cClass[n] & a_iClass) != 0;
+
+	// Wide characters beyond the table
+	const string_type &sCharSet = (a_iClass == ccNAME) ? m_pParser->m_sNameChars :
+		(a_iClass == ccOPRT) ? m_pParser->m_sOprtChars : m_pParser->m_sInfixOprtChars;
+	return sCharSet.find(c) != string_type::npos;
+}
+
+//---------------------------------------------------------------------------
+/** \brief Extract all characters that belong to a certain character class.
+	\param a_iClass [in] Class of the characters allowed in the token.
+	\param a_strTok [out]  The string that consists entirely of characters of this class.
 	\param a_iPos [in] Position in the string from where to start reading.
-	\return The Position of the first character not listed in a_szCharSet.
+	\return The Position of the first character not in the class.
 	\throw nothrow
 	*/
-int TokenReader::ExtractToken(const char_type *a_szCharSet,
+int TokenReader::ExtractToken(int a_iClass,
 	string_type &a_sTok,
 	int a_iPos) const
 {
-	int iEnd = (int)m_sExpr.find_first_not_of(a_szCharSet, a_iPos);
-
-	if (iEnd == (int)string_type::npos)
-		iEnd = (int)m_sExpr.length();
+	int iEnd = a_iPos, iLen = (int)m_sExpr.length();
+	while (iEnd < iLen && IsCharClass(m_sExpr[iEnd], a_iClass))
+		++iEnd;
 
 	if (iEnd != a_iPos)
 		a_sTok.assign(m_sExpr.begin() + a_iPos, m_sExpr.begin() + iEnd);
@@ -433,8 +567,7 @@ int TokenReader::ExtractToken(const char_type *a_szCharSet,
 */
 bool TokenReader::IsBuiltIn(ptr_tok_type &a_Tok)
 {
-	const char_type **pOprtDef = m_pParser->GetOprtDef(),
-		*szFormula = m_sExpr.c_str();
+	const char_type **pOprtDef = m_pParser->GetOprtDef();
 	int i;
 
 	try
@@ -444,7 +577,7 @@ bool TokenReader::IsBuiltIn(ptr_tok_type &a_Tok)
 		for (i = 0; pOprtDef[i]; i++)
 		{
 			std::size_t len(std::char_traits<char_type>::length(pOprtDef[i]));
-			if (string_type(pOprtDef[i]) == string_type(szFormula + m_nPos, szFormula + m_nPos + len))
+			if (m_sExpr.compare(m_nPos, len, pOprtDef[i]) == 0)
 			{
 				switch (i)
 				{
@@ -669,32 +802,22 @@ bool TokenReader::IsEOF(ptr_tok_type &a_Tok)
 	*/
 bool TokenReader::IsInfixOpTok(ptr_tok_type &a_Tok)
 {
-	string_type sTok;
-	int iEnd = ExtractToken(m_pParser->ValidInfixOprtChars(), sTok, m_nPos);
-
-	if (iEnd == m_nPos)
+	// Infix operators are stored in alphabetical order, the first one whose
+	// identifier starts here is the shortest one.
+	const def_type *pDef = FindInTrie(m_InfixTrie, ccINFIX, false);
+	if (!pDef)
 		return false;
 
 	try
 	{
-		// iteraterate over all infix operator strings
-		oprt_ifx_maptype::const_iterator item = m_pInfixOprtDef->begin();
-		for (item = m_pInfixOprtDef->begin(); item != m_pInfixOprtDef->end(); ++item)
-		{
-			if (sTok.find(item->first) != 0)
-				continue;
-
-			a_Tok = ptr_tok_type(item->second->Clone());
-			m_nPos += (int)item->first.length();
+		a_Tok = ptr_tok_type(pDef->second->Clone());
+		m_nPos += (int)pDef->first.length();
 
-			if (m_nSynFlags & noIFX)
-				throw ecUNEXPECTED_OPERATOR;
-
-			m_nSynFlags = noPFX | noIFX | noOPT | noBC | noIC | noIO | noEND | noCOMMA | noNEWLINE | noIF | noELSE;
-			return true;
-		}
+		if (m_nSynFlags & noIFX)
+			throw ecUNEXPECTED_OPERATOR;
 
-		return false;
+		m_nSynFlags = noPFX | noIFX | noOPT | noBC | noIC | noIO | noEND | noCOMMA | noNEWLINE | noIF | noELSE;
+		return true;
 	}
 	catch (EErrorCodes e)
 	{
@@ -715,18 +838,18 @@ bool TokenReader::IsFunTok(ptr_tok_type &a_Tok)
 		return false;
 
 	string_type sTok;
-	int iEnd = ExtractToken(m_pParser->ValidNameChars(), sTok, m_nPos);
+	int iEnd = ExtractToken(ccNAME, sTok, m_nPos);
 	if (iEnd == m_nPos)
 		return false;
 
 	try
 	{
-		fun_maptype::iterator item = m_pFunDef->find(sTok);
-		if (item == m_pFunDef->end())
+		ident_maptype::const_iterator item = m_Ident.find(sTok);
+		if (item == m_Ident.end() || !item->second.fun)
 			return false;
 
 		m_nPos = (int)iEnd;
-		a_Tok = ptr_tok_type(item->second->Clone());
+		a_Tok = ptr_tok_type(item->second.fun->second->Clone());
 		a_Tok->Compile(_T("xxx"));
 
 		if (m_nSynFlags & noFUN)
@@ -767,32 +890,22 @@ bool TokenReader::IsPostOpTok(ptr_tok_type &a_Tok)
 	// This is a special case so this routine slightly differs from the other
 	// token readers.
 
-	// Test if there could be a postfix operator
-	string_type sTok;
-	int iEnd = ExtractToken(m_pParser->ValidOprtChars(), sTok, m_nPos);
-	if (iEnd == m_nPos)
+	// Test if there could be a postfix operator. As for infix operators the
+	// shortest identifier starting here wins.
+	const def_type *pDef = FindInTrie(m_PostTrie, ccOPRT, false);
+	if (!pDef)
 		return false;
 
 	try
 	{
-		// iteraterate over all postfix operator strings
-		oprt_pfx_maptype::const_iterator item;
-		for (item = m_pPostOprtDef->begin(); item != m_pPostOprtDef->end(); ++item)
-		{
-			if (sTok.find(item->first) != 0)
-				continue;
+		a_Tok = ptr_tok_type(pDef->second->Clone());
+		m_nPos += (int)pDef->first.length();
 
-			a_Tok = ptr_tok_type(item->second->Clone());
-			m_nPos += (int)item->first.length();
-
-			if (m_nSynFlags & noPFX)
-				throw ecUNEXPECTED_OPERATOR;
-
-			m_nSynFlags = noVAL | noVAR | noFUN | noBO | noPFX /*| noIO*/ | noIF;
-			return true;
-		}
+		if (m_nSynFlags & noPFX)
+			throw ecUNEXPECTED_OPERATOR;
 
-		return false;
+		m_nSynFlags = noVAL | noVAR | noFUN | noBO | noPFX /*| noIO*/ | noIF;
+		return true;
 	}
 	catch (EErrorCodes e)
 	{
@@ -809,57 +922,45 @@ bool TokenReader::IsPostOpTok(ptr_tok_type &a_Tok)
 /** \brief Check if a string position contains a binary operator. */
 bool TokenReader::IsOprt(ptr_tok_type &a_Tok)
 {
-	string_type sTok;
-	int iEnd = ExtractToken(m_pParser->ValidOprtChars(), sTok, m_nPos);
-	if (iEnd == m_nPos)
+	// Note:
+	// Long operators must come first! Otherwise short names (like: "add") that
+	// are part of long token names (like: "add123") will be found instead
+	// of the long ones.
+	const def_type *pDef = FindInTrie(m_OprtTrie, ccOPRT, true);
+	if (!pDef)
 		return false;
 
-	oprt_bin_maptype::reverse_iterator item;
 	try
 	{
-		// Note:
-		// All tokens in oprt_bin_maptype are have been sorted by their length
-		// Long operators must come first! Otherwise short names (like: "add") that
-		// are part of long token names (like: "add123") will be found instead
-		// of the long ones.
-		// Length sorting is done with ascending length so we use a reverse iterator here.
-		for (item = m_pOprtDef->rbegin(); item != m_pOprtDef->rend(); ++item)
+		// operator found, check if we expect one...
+		if (m_nSynFlags & noOPT)
 		{
-			if (sTok.find(item->first) != 0)
-				continue;
-
-			// operator found, check if we expect one...
-			if (m_nSynFlags & noOPT)
-			{
-				// An operator was found but is not expected to occur at
-				// this position of the formula, maybe it is an infix
-				// operator, not a binary operator. Both operator types
-				// can use the same characters in their identifiers.
-				if (IsInfixOpTok(a_Tok))
-					return true;
-
-				// nope, it's no infix operator and we dont expect
-				// an operator
-				throw ecUNEXPECTED_OPERATOR;
-			}
-			else
-			{
-				a_Tok = ptr_tok_type(item->second->Clone());
-
-				m_nPos += (int)a_Tok->GetIdent().length();
-				m_nSynFlags = noBC | noIO | noIC | noOPT | noCOMMA | noEND | noNEWLINE | noPFX | noIF | noELSE;
+			// An operator was found but is not expected to occur at
+			// this position of the formula, maybe it is an infix
+			// operator, not a binary operator. Both operator types
+			// can use the same characters in their identifiers.
+			if (IsInfixOpTok(a_Tok))
 				return true;
-			}
+
+			// nope, it's no infix operator and we dont expect
+			// an operator
+			throw ecUNEXPECTED_OPERATOR;
 		}
+		else
+		{
+			a_Tok = ptr_tok_type(pDef->second->Clone());
 
-		return false;
+			m_nPos += (int)a_Tok->GetIdent().length();
+			m_nSynFlags = noBC | noIO | noIC | noOPT | noCOMMA | noEND | noNEWLINE | noPFX | noIF | noELSE;
+			return true;
+		}
 	}
 	catch (EErrorCodes e)
 	{
 		ErrorContext err;
 		err.Errc = e;
-		err.Pos = m_nPos; // - (int)item->first.length();
-		err.Ident = item->first;
+		err.Pos = m_nPos; // - (int)pDef->first.length();
+		err.Ident = pDef->first;
 		err.Expr = m_sExpr;
 		throw ParserError(err);
 	}
@@ -878,7 +979,6 @@ bool TokenReader::IsValTok(ptr_tok_type &a_Tok)
 	if (m_vValueReader.size() == 0)
 		return false;
 
-	stringstream_type stream(m_sExpr.c_str() + m_nPos);
 	string_type sTok;
 
 	try
@@ -892,13 +992,13 @@ bool TokenReader::IsValTok(ptr_tok_type &a_Tok)
 			int iStart = m_nPos;
 			if (m_vValueReader[i]->IsValue(m_sExpr.c_str(), m_nPos, val))
 			{
-				sTok.assign(m_sExpr.c_str(), iStart, m_nPos);
+				sTok.assign(m_sExpr, iStart, m_nPos - iStart);
 				if (m_nSynFlags & noVAL)
 					throw ecUNEXPECTED_VAL;
 
 				m_nSynFlags = noVAL | noVAR | noFUN | noBO | noIFX | noIO;
 				a_Tok = ptr_tok_type(val.Clone());
-				a_Tok->SetIdent(string_type(sTok.begin(), sTok.begin() + (m_nPos - iStart)));
+				a_Tok->SetIdent(sTok);
 				return true;
 			}
 		}
@@ -924,20 +1024,24 @@ bool TokenReader::IsValTok(ptr_tok_type &a_Tok)
 	*/
 bool TokenReader::IsVarOrConstTok(ptr_tok_type &a_Tok)
 {
-	if (!m_pVarDef->size() && !m_pConstDef->size() && !m_pFunDef->size())
+	if (m_Ident.empty())
 		return false;
 
 	string_type sTok;
 	int iEnd;
 	try
 	{
-		iEnd = ExtractToken(m_pParser->ValidNameChars(), sTok, m_nPos);
+		iEnd = ExtractToken(ccNAME, sTok, m_nPos);
 		if (iEnd == m_nPos || (sTok.size() > 0 && sTok[0] >= _T('0') && sTok[0] <= _T('9')))
 			return false;
 
+		ident_maptype::const_iterator ident = m_Ident.find(sTok);
+		if (ident == m_Ident.end())
+			return false;
+
 		// Check for variables
-		var_maptype::const_iterator item = m_pVarDef->find(sTok);
-		if (item != m_pVarDef->end())
+		const def_type *item = ident->second.var;
+		if (item)
 		{
 			if (m_nSynFlags & noVAR)
 				throw ecUNEXPECTED_VAR;
@@ -951,8 +1055,8 @@ bool TokenReader::IsVarOrConstTok(ptr_tok_type &a_Tok)
 		}
 
 		// Check for constants
-		item = m_pConstDef->find(sTok);
-		if (item != m_pConstDef->end())
+		item = ident->second.cnst;
+		if (item)
 		{
 			if (m_nSynFlags & noVAL)
 				throw ecUNEXPECTED_VAL;
@@ -992,7 +1096,7 @@ bool TokenReader::IsComment()
 bool TokenReader::IsUndefVarTok(ptr_tok_type &a_Tok)
 {
 	string_type sTok;
-	int iEnd = ExtractToken(m_pParser->ValidNameChars(), sTok, m_nPos);
+	int iEnd = ExtractToken(ccNAME, sTok, m_nPos);
 	if (iEnd == m_nPos || (sTok.size() > 0 && sTok[0] >= _T('0') && sTok[0] <= _T('9')))
 		return false;
 
@@ -1013,6 +1117,7 @@ bool TokenReader::IsUndefVarTok(ptr_tok_type &a_Tok)
 		m_pDynVarShadowValues->push_back(val);         // push to the vector of shadow values
 		a_Tok = ptr_tok_type(new Variable(val.Get())); // bind variable to the new value item
 		(*m_pVarDef)[sTok] = a_Tok;                    // add new variable to the variable list
+		m_Ident[sTok].var = &*m_pVarDef->find(sTok);   // and to the identifier table
 	}
 	else
 		a_Tok = ptr_tok_type(new Variable(nullptr));      // bind variable to empty variable
@@ -41,6 +41,8 @@
 #include <cstdio>
 #include <cstring>
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include <stack>
 #include <string>
 #include <list>
@@ -64,13 +66,52 @@ MUP_NAMESPACE_START
 
   private:
 
+    /** \brief A name or operator definition of the parser. */
+    typedef var_maptype::value_type def_type;
+
+    /** \brief Node of a trie holding operator identifiers.
+    
+      Children of a node form a list linked by their sibling index.
+    */
+    struct OprtNode
+    {
+      char_type c;          ///< Character leading to this node
+      int child;            ///< Index of the first child, -1 if there is none
+      int next;             ///< Index of the next sibling, -1 if there is none
+      const def_type *def;  ///< Operator whose identifier ends here or nullptr
+    };
+
+    typedef std::vector<OprtNode> oprt_trie_type;
+
+    /** \brief Definitions sharing one identifier, nullptr where there is none. */
+    struct IdentDef
+    {
+      const def_type *var;
+      const def_type *cnst;
+      const def_type *fun;
+    };
+
+    typedef std::unordered_map<string_type, IdentDef> ident_maptype;
+
+    /** \brief Character classes of the parser charsets. */
+    enum ECharClass
+    {
+      ccNAME  = 1,  ///< Character allowed in names
+      ccOPRT  = 2,  ///< Character allowed in binary and postfix operators
+      ccINFIX = 4   ///< Character allowed in infix operators
+    };
+
     TokenReader(const TokenReader &a_Reader);
     TokenReader& operator=(const TokenReader &a_Reader);
     void Assign(const TokenReader &a_Reader);
     void DeleteValReader();
     void SetParent(ParserXBase *a_pParent);
 
-    int ExtractToken(const char_type *a_szCharSet, string_type &a_sTok, int a_iPos) const;
+    void UpdateLexicon();
+    static void AddToTrie(oprt_trie_type &a_Trie, const def_type &a_Def);
+    const def_type* FindInTrie(const oprt_trie_type &a_Trie, int a_iClass, bool a_bLongest) const;
+    bool IsCharClass(char_type c, int a_iClass) const;
+    int ExtractToken(int a_iClass, string_type &a_sTok, int a_iPos) const;
 
     void SkipCommentsAndWhitespaces();
     bool IsBuiltIn(ptr_tok_type &t);
@@ -112,6 +153,14 @@ MUP_NAMESPACE_START
     var_maptype m_UsedVar;
     float_type m_fZero;             ///< Dummy value of zero, referenced by undefined variables
 
+    // Lookup tables built from the parser definitions, see UpdateLexicon
+    unsigned m_nDefVer;             ///< Definition version of the parser the tables belong to, 0 if not built
+    unsigned char m_cClass[256];    ///< Character class bits of the first 256 characters
+    oprt_trie_type m_OprtTrie;      ///< Binary operators
+    oprt_trie_type m_InfixTrie;     ///< Infix operators
+    oprt_trie_type m_PostTrie;      ///< Postfix operators
+    ident_maptype m_Ident;          ///< Variables, constants and functions by name
+
   public:
 
     TokenReader(ParserXBase *a_pParent);
@@ -38,6 +38,37 @@
 
 MUP_NAMESPACE_START
 
+//------------------------------------------------------------------------------
+/** \brief Check if a null terminated string starts with a given prefix. */
+static bool StartsWith(const char_type *a_szExpr, const char_type *a_szPrefix)
+{
+    for (; *a_szPrefix; ++a_szExpr, ++a_szPrefix)
+    {
+        if (*a_szExpr != *a_szPrefix)
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static bool IsSpace(char_type c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+//------------------------------------------------------------------------------
+static bool IsDigit(char_type c)
+{
+    return c >= '0' && c <= '9';
+}
+
+//------------------------------------------------------------------------------
+static bool IsHexDigit(char_type c)
+{
+    return IsDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
 //------------------------------------------------------------------------------
 //
 //  Reader for floating point values
@@ -55,7 +86,43 @@ DblValReader::~DblValReader()
 //------------------------------------------------------------------------------
 bool DblValReader::IsValue(const char_type *a_szExpr, int &a_iPos, Value &a_Val)
 {
-    stringstream_type stream(a_szExpr + a_iPos);
+    // Only the characters a number can be made of are handed to the stream,
+    // followed by the one that ends it. Copying the rest of the expression
+    // would make parsing quadratic in the expression length.
+    const char_type *szNum = a_szExpr + a_iPos, *p = szNum;
+    while (IsSpace(*p))
+        ++p;
+
+    if (*p == '+' || *p == '-')
+        ++p;
+
+    const char_type *szMantissa = p;
+    while (IsDigit(*p))
+        ++p;
+
+    if (*p == '.')
+    {
+        for (++p; IsDigit(*p); ++p);
+    }
+
+    // Without a digit this is no number, don't bother the stream
+    if (p == szMantissa || (p == szMantissa + 1 && *szMantissa == '.'))
+        return false;
+
+    if (*p == 'e' || *p == 'E')
+    {
+        ++p;
+        if (*p == '+' || *p == '-')
+            ++p;
+
+        while (IsDigit(*p))
+            ++p;
+    }
+
+    if (*p != 0)
+        ++p;
+
+    stringstream_type stream(string_type(szNum, p));
     float_type fVal(0);
     std::streamoff iEnd(0);
 
@@ -69,7 +136,7 @@ bool DblValReader::IsValue(const char_type *a_szExpr, int &a_iPos, Value &a_Val)
         // This part sucks but tellg will return -1 if eof is set,
         // so i need a special treatment for the case that the number
         // just read here is the last part of the string
-        for (; a_szExpr[a_iPos] != 0; ++a_iPos);
+        a_iPos += (int)(p - szNum);
     }
     else
     {
@@ -119,15 +186,15 @@ BoolValReader::~BoolValReader()
 //------------------------------------------------------------------------------
 bool BoolValReader::IsValue(const char_type *a_szExpr, int &a_iPos, Value &a_Val)
 {
-    string_type sExpr(a_szExpr + a_iPos);
+    const char_type *szExpr = a_szExpr + a_iPos;
 
-    if (sExpr.find(_T("true")) == 0)
+    if (StartsWith(szExpr, _T("true")))
     {
         a_Val = true;
         a_iPos += 4;
         return true;
     }
-    else if (sExpr.find(_T("false")) == 0)
+    else if (StartsWith(szExpr, _T("false")))
     {
         a_Val = false;
         a_iPos += 5;
@@ -167,14 +234,31 @@ HexValReader::HexValReader()
     */
 bool HexValReader::IsValue(const char_type *a_szExpr, int &a_iPos, Value &a_val)
 {
-    std::size_t len = std::char_traits<char_type>::length(a_szExpr);
-    if (a_iPos >= (int)len || a_szExpr[a_iPos + 1] != 'x' || a_szExpr[a_iPos + 1] == 0 || a_szExpr[a_iPos] != '0')
-        return 0;
+    if (a_szExpr[a_iPos] != '0' || a_szExpr[a_iPos + 1] != 'x')
+        return false;
 
     unsigned iVal(0);
 
+    // As for floating point values only the number itself and the character
+    // that ends it go to the stream.
+    const char_type *szNum = a_szExpr + a_iPos + 2, *p = szNum;
+    while (IsSpace(*p))
+        ++p;
+
+    if (*p == '+' || *p == '-')
+        ++p;
+
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+        p += 2;
+
+    while (IsHexDigit(*p))
+        ++p;
+
+    if (*p != 0)
+        ++p;
+
     stringstream_type::pos_type nPos(0);
-    stringstream_type ss(a_szExpr + a_iPos + 2);
+    stringstream_type ss(string_type(szNum, p));
     ss >> std::hex >> iVal;
 
     if (ss.fail())
@@ -184,7 +268,7 @@ bool HexValReader::IsValue(const char_type *a_szExpr, int &a_iPos, Value &a_val)
     {
         // This part sucks but tellg will return -1 if eof is set,
         // so i need a special treatment for those cases.
-        for (; a_szExpr[a_iPos] != 0; ++a_iPos);
+        a_iPos += (int)(2 + (p - szNum));
     }
     else
     {
@@ -286,7 +286,7 @@ void Value::Assign(const Value& ref)
 
 	m_val = ref.m_val;
 	m_cType = ref.m_cType;
-	m_iFlags = ref.m_iFlags;
+	m_iFlags = (EFlags)(ref.m_iFlags & ~flMODIFIED);
 
 	// allocate room for a string
 	if (ref.m_psVal)
@@ -778,6 +778,24 @@ void Value::BindToCache(ValueCache* pCache)
 	m_pCache = pCache;
 }
 
+//---------------------------------------------------------------------------
+/** \brief Set or clear the modification flag.
+
+	The flag is set by the Variable objects bound to this value whenever they
+	write to it. It lets a host application synchronize only the variables that
+	were assigned by the last evaluated expression.
+*/
+void Value::SetModified(bool bModified)
+{
+	m_iFlags = (EFlags)((bModified) ? (m_iFlags | flMODIFIED) : (m_iFlags & ~flMODIFIED));
+}
+
+//---------------------------------------------------------------------------
+bool Value::IsModified() const
+{
+	return (m_iFlags & flMODIFIED) != 0;
+}
+
 //-----------------------------------------------------------------------------------------------
 Value::operator cmplx_type ()
 {
@@ -108,6 +108,10 @@ MUP_NAMESPACE_START
 
     virtual string_type AsciiDump() const override;
     void BindToCache(ValueCache *pCache);
+
+    // Dirty tracking: set when the value is written through a Variable
+    void SetModified(bool bModified);
+    bool IsModified() const;
 	
     // Conversion operators
     operator cmplx_type();
@@ -51,6 +51,22 @@ MUP_NAMESPACE_START
   Variable::Variable(IValue *pVal)
     :IValue(cmVAL)
     ,m_pVal(pVal)
+    ,m_pOwner(nullptr)
+  {
+    AddFlags(IToken::flVOLATILE);
+  }
+
+  //-----------------------------------------------------------------------------------------------
+  /** \brief Create a variable bound to an element of a matrix.
+      \param pVal Pointer of the element to bind to this variable.
+      \param pOwner Pointer of the matrix containing the element.
+
+    Writing through the variable flags the matrix as modified, reading does not.
+  */
+  Variable::Variable(IValue *pVal, IValue *pOwner)
+    :IValue(cmVAL)
+    ,m_pVal(pVal)
+    ,m_pOwner(pOwner)
   {
     AddFlags(IToken::flVOLATILE);
   }
@@ -58,6 +74,7 @@ MUP_NAMESPACE_START
   //-----------------------------------------------------------------------------------------------
   Variable::Variable(const Variable &obj)
     :IValue(cmVAL)
+    ,m_pOwner(nullptr)
   {
     Assign(obj);
     AddFlags(IToken::flVOLATILE);
@@ -78,6 +95,7 @@ MUP_NAMESPACE_START
   {
     assert(m_pVal);
     *m_pVal = ref;
+    SetModified();
     return *this;
   }
 
@@ -85,63 +103,81 @@ MUP_NAMESPACE_START
   IValue& Variable::operator=(int_type val)
   {
     assert(m_pVal);
-    return m_pVal->operator=(val);
+    m_pVal->operator=(val);
+    SetModified();
+    return *m_pVal;
   }
 
   //-----------------------------------------------------------------------------------------------
   IValue& Variable::operator=(float_type val)
   {
     assert(m_pVal);
-    return m_pVal->operator=(val);
+    m_pVal->operator=(val);
+    SetModified();
+    return *m_pVal;
   }
 
   //-----------------------------------------------------------------------------------------------
   IValue& Variable::operator=(string_type val)
   {
     assert(m_pVal);
-    return m_pVal->operator=(val);
+    m_pVal->operator=(val);
+    SetModified();
+    return *m_pVal;
   }
 
   //-----------------------------------------------------------------------------------------------
   IValue& Variable::operator=(bool_type val)
   {
     assert(m_pVal);
-    return m_pVal->operator=(val);
+    m_pVal->operator=(val);
+    SetModified();
+    return *m_pVal;
   }
 
   //-----------------------------------------------------------------------------------------------
   IValue& Variable::operator=(const matrix_type &val)
   {
     assert(m_pVal);
-    return m_pVal->operator=(val);
+    m_pVal->operator=(val);
+    SetModified();
+    return *m_pVal;
   }
 
   //-----------------------------------------------------------------------------------------------
   IValue& Variable::operator=(const cmplx_type &val)
   {
     assert(m_pVal);
-    return m_pVal->operator=(val);
+    m_pVal->operator=(val);
+    SetModified();
+    return *m_pVal;
   }
 
   //-----------------------------------------------------------------------------------------------
   IValue& Variable::operator+=(const IValue &val)
   {
     assert(m_pVal);
-    return m_pVal->operator+=(val);
+    m_pVal->operator+=(val);
+    SetModified();
+    return *m_pVal;
   }
 
   //-----------------------------------------------------------------------------------------------
   IValue& Variable::operator-=(const IValue &val)
   {
     assert(m_pVal);
-    return m_pVal->operator-=(val);
+    m_pVal->operator-=(val);
+    SetModified();
+    return *m_pVal;
   }
 
   //-----------------------------------------------------------------------------------------------
   IValue& Variable::operator*=(const IValue &val)
   {
     assert(m_pVal);
-    return m_pVal->operator*=(val);
+    m_pVal->operator*=(val);
+    SetModified();
+    return *m_pVal;
   }
 
   //-----------------------------------------------------------------------------------------------
@@ -176,6 +212,7 @@ MUP_NAMESPACE_START
       return;
 
     m_pVal = ref.m_pVal;
+    m_pOwner = ref.m_pOwner;
   }
 
   //-----------------------------------------------------------------------------------------------
@@ -327,6 +364,7 @@ MUP_NAMESPACE_START
   {
     assert(m_pVal);
     *m_pVal = a_fVal;
+    SetModified();
   }
 
   //-----------------------------------------------------------------------------------------------
@@ -334,6 +372,7 @@ MUP_NAMESPACE_START
   {
     assert(m_pVal);
     *m_pVal = a_sVal;
+    SetModified();
   }
 
   //-----------------------------------------------------------------------------------------------
@@ -341,6 +380,18 @@ MUP_NAMESPACE_START
   {
     assert(m_pVal);
     *m_pVal = a_bVal;
+    SetModified();
+  }
+
+  //-----------------------------------------------------------------------------------------------
+  /** \brief Mark the bound value, and the matrix containing it if any, as modified. */
+  void Variable::SetModified()
+  {
+    Value *pVal = m_pVal->AsValue();
+    if (pVal)
+      pVal->SetModified(true);
+    if (m_pOwner && (pVal = m_pOwner->AsValue()))
+      pVal->SetModified(true);
   }
 
   //-----------------------------------------------------------------------------------------------
@@ -53,6 +53,7 @@ MUP_NAMESPACE_START
   public:
 
     Variable(IValue *pVal);
+    Variable(IValue *pVal, IValue *pOwner);
 
     Variable(const Variable &a_Var);
     Variable& operator=(const Variable &a_Var);
@@ -101,9 +102,11 @@ MUP_NAMESPACE_START
   private:
 
     IValue *m_pVal;    ///< Pointer to the value object bound to this variable
+    IValue *m_pOwner;  ///< Matrix containing the bound value if it is an element, or nullptr
 
     void Assign(const Variable &a_Var);
     void CheckType(char_type a_cType) const;
+    void SetModified();
   }; // class Variable
 
 MUP_NAMESPACE_END
@@ -0,0 +1,372 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                       Implementation of class 'adaptODE'
+
+  ==============================================================================*/
+
+#include "adaptODE.h"
+#include <cmath>
+#include <algorithm>
+
+namespace RITA {
+
+adaptODE::adaptODE(int    n,
+                   Method m,
+                   RHS    f)
+         : _n(n), _nb_accept(0), _nb_reject(0), _nb_prev(0), _nb_jac(0), _nb_lu(0), _method(m), _f(f),
+           _t(0.), _h(0.), _hmax(1.e30), _hprev(0.), _atol(1.e-6), _rtol(1.e-4), _lu_c(0.), _nb_eval(0),
+           _fsal(false), _jac_ok(false), _lu_ok(false)
+{
+   _y.resize(_n), _y1.resize(_n), _y2.resize(_n), _e.resize(_n), _k1.resize(_n), _r.resize(_n);
+   if (_method==RK45) {
+      _k2.resize(_n), _k3.resize(_n), _k4.resize(_n);
+      _k5.resize(_n), _k6.resize(_n), _k7.resize(_n);
+   }
+   else {
+      _jac.resize(_n*_n), _a.resize(_n*_n), _piv.resize(_n);
+      _k2.resize(_n), _k3.resize(_n), _k4.resize(_n);
+   }
+}
+
+
+void adaptODE::setInitial(double        t,
+                          const double* y)
+{
+   _t = t;
+   for (int i=0; i<_n; ++i)
+      _y[i] = y[i];
+   _fsal = _jac_ok = _lu_ok = false;
+   _nb_prev = 0;
+}
+
+
+void adaptODE::eval(double        t,
+                    const double* y,
+                    double*       f)
+{
+   _f(t,y,f);
+   _nb_eval++;
+}
+
+
+double adaptODE::norm(const vector<double>& e,
+                      const vector<double>& y0,
+                      const vector<double>& y1) const
+{
+   double s = 0.;
+   for (int i=0; i<_n; ++i) {
+      double sc = _atol + _rtol*std::max(fabs(y0[i]),fabs(y1[i]));
+      s += (e[i]/sc)*(e[i]/sc);
+   }
+   return sqrt(s/_n);
+}
+
+
+double adaptODE::initialStep()
+{
+// Starting step selection from Hairer, Norsett and Wanner
+   int p = (_method==RK45) ? 5 : 1;
+   double d0 = norm(_y,_y,_y), d1 = norm(_k1,_y,_y);
+   double h0 = (d0<1.e-5 || d1<1.e-5) ? 1.e-6 : 0.01*d0/d1;
+   h0 = std::min(h0,_hmax);
+   for (int i=0; i<_n; ++i)
+      _y2[i] = _y[i] + h0*_k1[i];
+   eval(_t+h0,&_y2[0],&_r[0]);
+   for (int i=0; i<_n; ++i)
+      _e[i] = _r[i] - _k1[i];
+   double d2 = norm(_e,_y,_y)/h0;
+   double d = std::max(d1,d2);
+   double h1 = (d<=1.e-15) ? std::max(1.e-6,1.e-3*h0) : pow(0.01/d,1./(p+1));
+   return std::min(std::min(100*h0,h1),_hmax);
+}
+
+
+int adaptODE::advance(double tout)
+{
+   if (!_fsal) {
+      eval(_t,&_y[0],&_k1[0]);
+      _fsal = true;
+   }
+   if (_h<=0.)
+      _h = initialStep();
+   double q = (_method==RK45) ? 5. : 3., gmax = (_method==RK45) ? 5. : 2.;
+   while (_t<tout-1.e-12*std::max(1.,fabs(tout))) {
+      if (!_fsal) {
+         eval(_t,&_y[0],&_k1[0]);
+         _fsal = true;
+      }
+      double h = std::min(_h,_hmax), err = 0.;
+      bool last = false;
+      if (_t+h>=tout)
+         h = tout - _t, last = true;
+      if (h<1.e-14*std::max(1.,fabs(_t)))
+         return 1;
+      int ret = (_method==RK45) ? stepRK45(h,err) : stepBDF(h,err);
+      if (ret) {
+         _nb_reject++;
+         if (_monitor)
+            _monitor(_t,h,err,false);
+         _h = 0.25*h;
+         if (_h<1.e-14*std::max(1.,fabs(_t)))
+            return 2;
+         continue;
+      }
+      bool ok = err<=1.;
+      if (_monitor)
+         _monitor(_t,h,err,ok);
+      double fac = std::min(gmax,std::max(0.2,0.9*pow(std::max(err,1.e-10),-1./q)));
+      if (ok) {
+         _nb_accept++;
+         if (_method==RK45)
+            _k1.swap(_k7);
+         else {
+            _y1 = _y;
+            _hprev = h, _nb_prev = 1;
+            _fsal = false;
+            q = 3.;
+         }
+         _y.swap(_y2);
+         _t += h;
+         if (!last || fac<1.)
+            _h = last ? std::min(_h,h*fac) : h*fac;
+      }
+      else {
+         _nb_reject++;
+         _h = h*std::min(1.,fac);
+      }
+   }
+   return 0;
+}
+
+
+int adaptODE::stepRK45(double  h,
+                       double& err)
+{
+// Dormand-Prince coefficients
+   static const double
+      c2=1./5., c3=3./10., c4=4./5., c5=8./9.,
+      a21=1./5.,
+      a31=3./40., a32=9./40.,
+      a41=44./45., a42=-56./15., a43=32./9.,
+      a51=19372./6561., a52=-25360./2187., a53=64448./6561., a54=-212./729.,
+      a61=9017./3168., a62=-355./33., a63=46732./5247., a64=49./176., a65=-5103./18656.,
+      a71=35./384., a73=500./1113., a74=125./192., a75=-2187./6784., a76=11./84.,
+      e1=71./57600., e3=-71./16695., e4=71./1920., e5=-17253./339200., e6=22./525., e7=-1./40.;
+   double *y=&_y[0], *r=&_r[0], *k1=&_k1[0], *k2=&_k2[0], *k3=&_k3[0], *k4=&_k4[0];
+   double *k5=&_k5[0], *k6=&_k6[0], *k7=&_k7[0], *y2=&_y2[0];
+   for (int i=0; i<_n; ++i)
+      r[i] = y[i] + h*a21*k1[i];
+   eval(_t+c2*h,r,k2);
+   for (int i=0; i<_n; ++i)
+      r[i] = y[i] + h*(a31*k1[i] + a32*k2[i]);
+   eval(_t+c3*h,r,k3);
+   for (int i=0; i<_n; ++i)
+      r[i] = y[i] + h*(a41*k1[i] + a42*k2[i] + a43*k3[i]);
+   eval(_t+c4*h,r,k4);
+   for (int i=0; i<_n; ++i)
+      r[i] = y[i] + h*(a51*k1[i] + a52*k2[i] + a53*k3[i] + a54*k4[i]);
+   eval(_t+c5*h,r,k5);
+   for (int i=0; i<_n; ++i)
+      r[i] = y[i] + h*(a61*k1[i] + a62*k2[i] + a63*k3[i] + a64*k4[i] + a65*k5[i]);
+   eval(_t+h,r,k6);
+   for (int i=0; i<_n; ++i)
+      y2[i] = y[i] + h*(a71*k1[i] + a73*k3[i] + a74*k4[i] + a75*k5[i] + a76*k6[i]);
+   eval(_t+h,y2,k7);
+   for (int i=0; i<_n; ++i)
+      _e[i] = h*(e1*k1[i] + e3*k3[i] + e4*k4[i] + e5*k5[i] + e6*k6[i] + e7*k7[i]);
+   err = norm(_e,_y,_y2);
+   return 0;
+}
+
+
+int adaptODE::stepBDF(double  h,
+                      double& err)
+{
+// The first step uses the backward Euler scheme, the next ones the variable step
+// BDF2 formula. The local error is estimated by the difference with an explicit
+// predictor
+   double c=h, ce=0.5;
+   if (_nb_prev==0) {
+      for (int i=0; i<_n; ++i)
+         _k3[i] = _y[i], _y2[i] = _y[i] + h*_k1[i];
+   }
+   else {
+      double w = h/_hprev, d = 1./(1.+2*w);
+      c = h*(1.+w)*d, ce = 0.4;
+      for (int i=0; i<_n; ++i) {
+         _k3[i] = d*((1.+w)*(1.+w)*_y[i] - w*w*_y1[i]);
+         _y2[i] = _y[i] + h*_k1[i] + w*w*(_y1[i] - _y[i] + _hprev*_k1[i]);
+      }
+   }
+   _e = _y2;
+   if (Newton(_t+h,c,_k3))
+      return 1;
+   for (int i=0; i<_n; ++i)
+      _e[i] = ce*(_y2[i] - _e[i]);
+   err = norm(_e,_y,_y2);
+   return 0;
+}
+
+
+int adaptODE::Newton(double                t,
+                     double                c,
+                     const vector<double>& b)
+{
+// Solve y - c*f(t,y) = b, starting from the predicted value in _y2.
+// The iteration matrix I - c*J is refactored only if c changed significantly.
+// If the iterations fail with an old Jacobian, it is updated and they are restarted
+   bool fresh = false;
+   _k4 = _y2;
+   for (int attempt=0; attempt<2; ++attempt) {
+      if (attempt) {
+         if (fresh)
+            return 1;
+         _y2 = _k4;
+         _jac_ok = false;
+      }
+      if (!_jac_ok) {
+         jacobian(t);
+         _jac_ok = fresh = true;
+         _lu_ok = false;
+      }
+      if (!_lu_ok || fabs(c-_lu_c)>0.2*_lu_c) {
+         for (int i=0; i<_n; ++i) {
+            for (int j=0; j<_n; ++j)
+               _a[i*_n+j] = -c*_jac[i*_n+j];
+            _a[i*_n+i] += 1.;
+         }
+         _nb_lu++;
+         _lu_ok = !factor();
+         if (!_lu_ok)
+            continue;
+         _lu_c = c;
+      }
+
+      double old=0., rate=0.;
+      for (int it=0; it<7; ++it) {
+         eval(t,&_y2[0],&_k2[0]);
+         for (int i=0; i<_n; ++i)
+            _r[i] = b[i] + c*_k2[i] - _y2[i];
+         solve(&_r[0]);
+         for (int i=0; i<_n; ++i)
+            _y2[i] += _r[i];
+         double dn = norm(_r,_y2,_y2);
+         if (it>0) {
+            rate = dn/old;
+            if (rate>0.9)
+               break;
+         }
+         if (dn<1.e-3) {
+
+//          Slow convergence: update the Jacobian at next step
+            if (rate>0.5)
+               _jac_ok = false;
+            return 0;
+         }
+         old = dn;
+      }
+   }
+   return 1;
+}
+
+
+void adaptODE::jacobian(double t)
+{
+   _nb_jac++;
+   if (_jfn) {
+      _jfn(t,&_y2[0],&_jac[0]);
+      return;
+   }
+
+// Finite difference approximation
+   eval(t,&_y2[0],&_k2[0]);
+   for (int j=0; j<_n; ++j) {
+      double yj = _y2[j], d = sqrt(1.e-16)*std::max(1.e-5,fabs(yj));
+      _y2[j] += d;
+      eval(t,&_y2[0],&_r[0]);
+      _y2[j] = yj;
+      for (int i=0; i<_n; ++i)
+         _jac[i*_n+j] = (_r[i] - _k2[i])/d;
+   }
+}
+
+
+int adaptODE::factor()
+{
+   for (int k=0; k<_n; ++k) {
+      int p = k;
+      for (int i=k+1; i<_n; ++i)
+         if (fabs(_a[i*_n+k])>fabs(_a[p*_n+k]))
+            p = i;
+      _piv[k] = p;
+      if (_a[p*_n+k]==0.)
+         return 1;
+      if (p!=k) {
+         for (int j=0; j<_n; ++j)
+            std::swap(_a[k*_n+j],_a[p*_n+j]);
+      }
+      for (int i=k+1; i<_n; ++i) {
+         double m = _a[i*_n+k] /= _a[k*_n+k];
+         for (int j=k+1; j<_n; ++j)
+            _a[i*_n+j] -= m*_a[k*_n+j];
+      }
+   }
+   return 0;
+}
+
+
+void adaptODE::solve(double* x)
+{
+   for (int k=0; k<_n; ++k) {
+      std::swap(x[k],x[_piv[k]]);
+      for (int i=k+1; i<_n; ++i)
+         x[i] -= _a[i*_n+k]*x[k];
+   }
+   for (int k=_n-1; k>=0; --k) {
+      for (int j=k+1; j<_n; ++j)
+         x[k] -= _a[k*_n+j]*x[j];
+      x[k] /= _a[k*_n+k];
+   }
+}
+
+
+void adaptODE::get(double* y) const
+{
+   for (int i=0; i<_n; ++i)
+      y[i] = _y[i];
+}
+
+
+void adaptODE::getDerivative(double* f)
+{
+   if (!_fsal) {
+      eval(_t,&_y[0],&_k1[0]);
+      _fsal = true;
+   }
+   for (int i=0; i<_n; ++i)
+      f[i] = _k1[i];
+}
+
+} /* namespace RITA */
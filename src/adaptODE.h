@@ -0,0 +1,142 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                         Definition of class 'adaptODE'
+
+  ==============================================================================*/
+
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+using std::vector;
+
+namespace RITA {
+
+/*! \class adaptODE
+ *  \brief Integrator of an ODE system with adaptive time stepping.
+ *
+ *  Two methods are available: the embedded Runge-Kutta pair of Dormand and Prince
+ *  (RK45) for nonstiff systems and the variable step BDF formula of order 2 for
+ *  stiff ones. The local error is estimated at each step and compared to the tolerance
+ *  <tt>atol + rtol*|y|</tt>. Steps are rejected and retried with a smaller step
+ *  when the error is too large.
+ *  The BDF method solves the implicit equations by simplified Newton iterations.
+ *  The Jacobian matrix and the LU factorization of the iteration matrix are kept
+ *  from a step to the next one and only recomputed when convergence degrades.
+ *
+ * \author Rachid Touzani
+ * \copyright GNU Public License
+ */
+
+class adaptODE
+{
+
+ public:
+
+    enum Method {
+       RK45,
+       BDF
+    };
+
+/// \brief Right-hand side of the system: f = F(t,y)
+    typedef std::function<void(double t, const double *y, double *f)> RHS;
+
+/// \brief Jacobian matrix of the right-hand side: J(i*n+j) = dF_i/dy_j (t,y)
+    typedef std::function<void(double t, const double *y, double *J)> JAC;
+
+/// \brief Function called after each attempted step with step size, error norm
+/// and acceptance flag
+    typedef std::function<void(double t, double h, double err, bool accepted)> Monitor;
+
+    adaptODE(int n, Method m, RHS f);
+    ~adaptODE() { }
+
+/// \brief Set absolute and relative tolerances
+    void setTolerance(double atol, double rtol) { _atol = atol, _rtol = rtol; }
+
+/// \brief Set initial time and state
+    void setInitial(double t, const double *y);
+
+/// \brief Set first time step. By default it is computed from the initial data
+    void setInitialStep(double h) { _h = h; }
+
+/// \brief Set maximal time step
+    void setMaxStep(double h) { _hmax = h; }
+
+/// \brief Set Jacobian matrix of the right-hand side for the BDF method.
+/// By default it is computed by finite differences
+    void setJacobian(JAC j) { _jfn = j; }
+
+/// \brief Set function to call after each attempted step
+    void setMonitor(Monitor m) { _monitor = m; }
+
+/// \brief Integrate up to time \c tout
+/// \return 0 on success, 1 if error control made the time step too small, 2 if
+/// it became too small after failures of the Newton iterations of the implicit
+/// method (a failed step is retried with a time step divided by 4)
+    int advance(double tout);
+
+/// \brief Copy current state in \c y
+    void get(double *y) const;
+
+/// \brief Copy time derivative at current state in \c f
+    void getDerivative(double *f);
+
+    double getTime() const { return _t; }
+    double getTimeStep() const { return _h; }
+    int getSize() const { return _n; }
+    int getNbAccepted() const { return _nb_accept; }
+    int getNbRejected() const { return _nb_reject; }
+    size_t getNbEval() const { return _nb_eval; }
+    int getNbJacobian() const { return _nb_jac; }
+    int getNbFactor() const { return _nb_lu; }
+
+ private:
+
+    int _n, _nb_accept, _nb_reject, _nb_prev, _nb_jac, _nb_lu;
+    Method _method;
+    RHS _f;
+    JAC _jfn;
+    Monitor _monitor;
+    double _t, _h, _hmax, _hprev, _atol, _rtol, _lu_c;
+    size_t _nb_eval;
+    bool _fsal, _jac_ok, _lu_ok;
+    vector<double> _y, _y1, _y2, _e, _k1, _k2, _k3, _k4, _k5, _k6, _k7, _r, _jac, _a;
+    vector<int> _piv;
+
+    void eval(double t, const double *y, double *f);
+    double norm(const vector<double>& e, const vector<double>& y0, const vector<double>& y1) const;
+    double initialStep();
+    int stepRK45(double h, double& err);
+    int stepBDF(double h, double& err);
+    int Newton(double t, double c, const vector<double>& b);
+    void jacobian(double t);
+    int factor();
+    void solve(double *x);
+};
+
+} /* namespace RITA */
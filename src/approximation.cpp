@@ -29,6 +29,7 @@
 
 #include "approximation.h"
 #include "data.h"
+#include "calc.h"
 
 namespace RITA {
 
@@ -38,6 +39,8 @@ approximation::approximation(rita* r, cmd* command, configure* config)
    _data = _rita->_data;
    _tab = nullptr;
    _verb = _configure->getVerbose();
+   _degree = 3;
+   _nb_coef = _nb_points = 0;
 }
 
 
@@ -55,8 +58,13 @@ int approximation::run()
    int nb=0, key=0;
    int file_count=0, lagrange_count=0, bspline_count=0, fitting_count=0, bezier_count=0;
    int nurbs_count=0, approx_count=0;
+   _degree = 3;
+   _nb_coef = _nb_points = 0;
+   _weights = "";
+   _init.clear();
    static const vector<string> kw {"file","name","lagrange","piecewise$-lagrange","hermite",
-                                   "fitting","bspline","bezier","nurbs"};
+                                   "fitting","bspline","bezier","nurbs","degree","weights","points",
+                                   "init"};
    _cmd->set(kw,_rita->_gkw);
    int nb_args = _cmd->getNbArgs();
    for (int k=0; k<nb_args; ++k) {
@@ -88,32 +96,48 @@ int approximation::run()
          case 4:
             approx_count++;
             _method = HERMITE;
-            _rita->msg("approximation>","This approximation is not implemented yet.");
-            return 1;
+            break;
 
          case 5:
+            _model = _cmd->string_token(0);
+            for (int i=1; i<nb; ++i)
+               _model += "," + _cmd->string_token(i);
+            setFitType(_model);
             fitting_count++, approx_count++;
             _method = FITTING;
-            _rita->msg("approximation>","This approximation is not implemented yet.");
-            return 1;
+            break;
 
          case 6:
             bspline_count++, approx_count++;
             _method = BSPLINE;
-            _rita->msg("approximation>","This approximation is not implemented yet.");
-            return 1;
+            break;
 
          case 7:
             bezier_count++, approx_count++;
             _method = BEZIER;
-            _rita->msg("approximation>","This approximation is not implemented yet.");
-            return 1;
+            break;
 
          case 8:
             nurbs_count++, approx_count++;
             _method = NURBS;
-            _rita->msg("approximation>","This approximation is not implemented yet.");
-            return 1;
+            break;
+
+         case 9:
+            _degree = _cmd->int_token(0);
+            break;
+
+         case 10:
+            _weights = _cmd->string_token(0);
+            break;
+
+         case 11:
+            _nb_points = _cmd->int_token(0);
+            break;
+
+         case 12:
+            for (int i=0; i<nb; ++i)
+               _init.push_back(_cmd->double_token(i));
+            break;
 
          default:
             _rita->msg("approximation>","Unknown argument: "+_cmd->Arg());
@@ -130,13 +154,40 @@ int approximation::run()
          _rita->msg("approximation>","More than one approximation method given.");
          return 1;
       }
+      if (approx_count==0) {
+         _rita->msg("approximation>","No approximation method given.");
+         return 1;
+      }
+      if (_method==FITTING && ft==SPLINE && _nb_coef<2) {
+         _rita->msg("approximation>","Illegal number of fitting coefficients: "+to_string(_nb_coef));
+         return 1;
+      }
+      if (_degree<1) {
+         _rita->msg("approximation>","Illegal degree: "+to_string(_degree));
+         return 1;
+      }
       *_rita->ofh << "approximation";
       *_rita->ofh << " file=" << file;
+      if (name!="")
+         *_rita->ofh << " name=" << name;
       if (lagrange_count++)
          *_rita->ofh << " lagrange=" << _lagrange_degree;
+      else if (_method==FITTING)
+         *_rita->ofh << " fitting=" << _model;
+      else
+         *_rita->ofh << " " << rApp[_method];
+      if (_method==BSPLINE || _method==FITTING || _method==NURBS)
+         *_rita->ofh << " degree=" << _degree;
+      if (_weights!="")
+         *_rita->ofh << " weights=" << _weights;
+      for (size_t i=0; i<_init.size(); ++i)
+         *_rita->ofh << ((i==0) ? " init=" : ",") << _init[i];
+      if (_nb_points>0)
+         *_rita->ofh << " points=" << _nb_points;
       *_rita->ofh << endl;
       _tab = new OFELI::Tabulation(file);
       _data->addTab(_tab,name);
+      _name = (name=="") ? "approx" : name;
    }
    else {
       *_rita->ofh << "approximation " << endl;
@@ -153,10 +204,17 @@ int approximation::run()
                cout << "name:         \n";
                cout << "lagrange:           Lagrange interpolation\n";
                cout << "piecewise-lagrange: Piecewise Lagrange interpolation\n";
-               cout << "fitting:            Least Square fitting\n";
-               cout << "bspline:            \n";
-               cout << "bezier\n";
-               cout << "nurbs\n";
+               cout << "hermite:            Monotone piecewise cubic Hermite interpolation\n";
+               cout << "fitting:            Least Square fitting by a B-spline with given number of coefficients,\n";
+               cout << "                    or by a model: polynomial (of given degree), exponential (a*exp(b*x))\n";
+               cout << "                    or an expression of x and parameters\n";
+               cout << "bspline:            B-spline interpolation\n";
+               cout << "bezier:             Bezier curve with data as control values\n";
+               cout << "nurbs:              NURBS curve with data as control values\n";
+               cout << "degree:             Degree of B-spline, fitting and NURBS approximations (default 3)\n";
+               cout << "weights:            Vector of NURBS weights (default 1)\n";
+               cout << "points:             Number of points where the approximation is evaluated\n";
+               cout << "init:               Initial values of parameters of fitting model\n";
                cout << "summary:            Summary of approximation problem attributes\n";
                cout << "clear:              Remove problem\n";
                cout << "end or <:           go back to higher level" << endl;
@@ -191,6 +249,7 @@ int approximation::run()
                else
                   _tab = new OFELI::Tabulation(file);
                _data->addTab(_tab,name);
+               _name = (name=="") ? "approx" : name;
                _rita->_ret = 0;
                return 0;
 
@@ -228,27 +287,74 @@ int approximation::run()
                break;
 
             case 4:
+               approx_count++;
+               _method = HERMITE;
+               *_rita->ofh << "  hermite" << endl;
                _rita->_ret = 0;
                break;
 
             case 5:
+               if (!_cmd->get(_model)) {
+                  fitting_count++, approx_count++;
+                  *_rita->ofh << "  fitting " << _model << endl;
+                  setFitType(_model);
+                  _method = FITTING;
+               }
+               _rita->_ret = 0;
+               break;
+
+            case 6:
+               bspline_count++, approx_count++;
+               _method = BSPLINE;
+               *_rita->ofh << "  bspline" << endl;
                _rita->_ret = 0;
                break;
 
             case 7:
+               bezier_count++, approx_count++;
+               _method = BEZIER;
+               *_rita->ofh << "  bezier" << endl;
+               _rita->_ret = 0;
                break;
 
             case 8:
+               nurbs_count++, approx_count++;
+               _method = NURBS;
+               *_rita->ofh << "  nurbs" << endl;
                _rita->_ret = 0;
                break;
 
             case 9:
+               if (!_cmd->get(_degree))
+                  *_rita->ofh << "  degree " << _degree << endl;
+               break;
+
+            case 10:
+               if (!_cmd->get(_weights))
+                  *_rita->ofh << "  weights " << _weights << endl;
+               break;
+
+            case 11:
+               if (!_cmd->get(_nb_points))
+                  *_rita->ofh << "  points " << _nb_points << endl;
+               break;
+
+            case 12:
+               {
+                  double v = 0.;
+                  while (!_cmd->get(v))
+                     _init.push_back(v);
+                  *_rita->ofh << "  init";
+                  for (double w: _init)
+                     *_rita->ofh << " " << w;
+                  *_rita->ofh << endl;
+               }
                break;
 
             default:
                cout << "Unknown Command: " << _cmd->token() << endl;
                cout << "Available commands: file, name, lagrange, piecewise-lagrange, hermite, fitting, bspline" << endl;
-               cout << "                    bezier, nurbs, summary, clear, end, <" << endl;
+               cout << "                    bezier, nurbs, degree, weights, points, init, summary, clear, end, <" << endl;
                cout << "Global commands:    help, ?, set, quit, exit" << endl;
                break;
          }
@@ -264,50 +370,37 @@ int approximation::go()
    switch (_method) {
 
       case LAGRANGE:
-         lagrange();
-         break;
+         return lagrange();
 
       case PIECEWISE_LAGRANGE:
-         piecewise_lagrange();
-         break;
+         return piecewise_lagrange();
 
       case HERMITE:
-         hermite();
-         break;
+         return hermite();
 
       case FITTING:
-         fitting();
-         break;
+         return fitting();
 
       case BSPLINE:
-         bspline();
-         break;
+         return bspline();
 
       case BEZIER:
-         bezier();
-         break;
+         return bezier();
 
       case NURBS:
-         nurbs();
-         break;
+         return nurbs();
    }
    return 0;
 }
 
 
-int approximation::lagrange()
+int approximation::getData()
 {
-   if (_lagrange_degree>4)
-      _rita->msg("approximation>","Polynomial degree is too large.");
    if (_tab->getNbVar(1)>1) { 
       _rita->msg("approximation>","This approximation method is available for one-variable cases only.");
       return 1;
    }
    int np = _tab->getSize(1,1);
-   if (np != _lagrange_degree+1) {
-      _rita->msg("approximation>","Required interpolation degree is incompatible with number of points in tabulation.");
-      return 1;
-   }
    _x.resize(np);
    _y.resize(np);
    double h = (_tab->getMaxVar(1,1)-_tab->getMinVar(1,1))/(np-1);
@@ -317,51 +410,64 @@ int approximation::lagrange()
       _x[i] = _x[i-1] + h;
       _y[i] = _tab->Funct[0].Val(i+1);
    }
-   
-// Lagrange polynomial
-   string p="";
-   for (int i=0; i<np; ++i) {
-      double d = 1;
-      for (int j=0; j<np; ++j) {
-         if (i!=j) {
-            d *= (_x[i]-_x[j]);
-            p = p + "(x-" + to_string(_x[j]) + ")*";
-         }
-      }
-      p = p + "(" + to_string(_y[i]/d) + ")";
-      if (i<np-1)
-         p = p + " + ";
+   return 0;
+}
+
+
+template<class A>
+int approximation::setFunction(const string& method,
+                               const A&      s)
+{
+   if (_rita->_calc->setFunction(_name,s)) {
+      _rita->msg("approximation>","Illegal function name: "+_name);
+      return 1;
    }
-   vector<string> var;
-   var.push_back("x");
-   _data->addFunction(p,var,"");
-   _data->setTab2Grid(_tab);
-   _data->setTab2Vector(_tab);
    if (_verb)
-      cout << "Lagrange interpolation created. Lagrange polynomial is: " 
-           << _data->NameFct[_data->iFct] << endl;
+      cout << method << " created. Function is: " << _name << "(x)" << endl;
+
+// Evaluation at uniformly distributed points
+   if (_nb_points>1) {
+      string vn = _name + "-values";
+      _data->addVector(vn,0.,_nb_points);
+      OFELI::Vect<double> &v = *_data->theVector[_data->VectorName[vn]];
+      vector<double> x(_nb_points);
+      double h = (_x.back()-_x[0])/(_nb_points-1);
+      for (int i=0; i<_nb_points; ++i)
+         x[i] = _x[0] + i*h;
+      s.eval(x.data(),&v[0],_nb_points);
+      if (_verb)
+         cout << "Values at " << _nb_points << " points stored in vector: " << vn << endl;
+   }
    return 0;
 }
 
 
-int approximation::piecewise_lagrange()
+int approximation::lagrange()
 {
-   if (_tab->getNbVar(1)>1) { 
-      _rita->msg("approximation>","This approximation method is available for one-variable cases only.");
+   if (getData())
+      return 1;
+   int np = int(_x.size());
+   if (np != _lagrange_degree+1) {
+      _rita->msg("approximation>","Required interpolation degree is incompatible with number of points in tabulation.");
       return 1;
    }
-   int np = _tab->getSize(1,1);
-   _x.resize(np);
-   _y.resize(np);
-   double h = (_tab->getMaxVar(1,1)-_tab->getMinVar(1,1))/(np-1);
-   _x[0] = _tab->getMinVar(1,1);
-   _y[0] = _tab->Funct[0].Val(1);
-   for (int i=1; i<np; ++i) {
-      _x[i] = _x[i-1] + h;
-      _y[i] = _tab->Funct[0].Val(i+1);
+   if (_sp.setLagrange(_x,_y)) {
+      _rita->msg("approximation>","Interpolation points must be distinct.");
+      return 1;
    }
    _data->setTab2Grid(_tab);
    _data->setTab2Vector(_tab);
+   _data->addFunction(_sp.getExpression(),{"x"},_name);
+   return setFunction("Lagrange interpolation",_sp);
+}
+
+
+int approximation::piecewise_lagrange()
+{
+   if (getData())
+      return 1;
+   _data->setTab2Grid(_tab);
+   _data->setTab2Vector(_tab);
    if (_verb)
       cout << "Piecewise Lagrange interpolation created. Interpolated vector is: " 
            << _data->Vector[_data->iVector] << endl;
@@ -371,31 +477,154 @@ int approximation::piecewise_lagrange()
 
 int approximation::hermite()
 {
-   return 0;
+   if (getData())
+      return 1;
+   if (_sp.setHermite(_x,_y)) {
+      _rita->msg("approximation>","Interpolation points must be distinct.");
+      return 1;
+   }
+   return setFunction("Hermite interpolation",_sp);
+}
+
+
+void approximation::setFitType(const string& s)
+{
+   _nb_coef = 0;
+   if (s=="polynomial")
+      ft = POLYNOMIAL;
+   else if (s=="exponential")
+      ft = EXPONENTIAL;
+   else if (s.find_first_not_of("0123456789")==string::npos) {
+      ft = SPLINE;
+      _nb_coef = stoi(s);
+   }
+   else
+      ft = DEFINED;
 }
 
 
 int approximation::fitting()
 {
-   return 0;
+   if (ft==SPLINE) {
+      if (getData())
+         return 1;
+      int ret = _sp.setFitting(_x,_y,_nb_coef,_degree);
+      if (ret==1) {
+         _rita->msg("approximation>","Number of coefficients larger than number of points.");
+         return 1;
+      }
+      if (ret==2) {
+         _rita->msg("approximation>","Singular least squares problem: use less coefficients.");
+         return 1;
+      }
+      if (_verb)
+         cout << "Root mean square of residual: " << _sp.getResidual() << endl;
+      return setFunction("Least squares fitting",_sp);
+   }
+
+   if (_tab->getNbVar(1)>1) { 
+      _rita->msg("approximation>","This approximation method is available for one-variable cases only.");
+      return 1;
+   }
+   if (ft==POLYNOMIAL)
+      _fit.setPolynomial(_degree);
+   else if (ft==EXPONENTIAL)
+      _fit.setExponential();
+   else {
+      vector<string> par = freeVariables({_model},{"x"});
+      if (_init.size()==0)
+         _init.assign(par.size(),1.);
+      if (par.size()==0 || _init.size()!=par.size()) {
+         _rita->msg("approximation>","Model "+_model+" must depend on parameters given initial values by init.");
+         return 1;
+      }
+      if (_fit.setModel(_model,par,_init)) {
+         _rita->msg("approximation>","Model "+_model+" cannot be differentiated.");
+         return 1;
+      }
+   }
+
+// Samples are read from the tabulation by chunks
+   size_t np = _tab->getSize(1,1);
+   double xmin=_tab->getMinVar(1,1), xmax=_tab->getMaxVar(1,1);
+   double h = (np>1) ? (xmax-xmin)/(np-1) : 0.;
+   OFELI::Tabulation *tab = _tab;
+   int ret = _fit.run(np,[tab,xmin,h](size_t first, size_t n, double *x, double *y) {
+                            for (size_t i=0; i<n; ++i) {
+                               x[i] = xmin + (first+i)*h;
+                               y[i] = tab->Funct[0].Val(first+i+1);
+                            }
+                         },xmin,xmax);
+   if (ret==2) {
+      _rita->msg("approximation>","Singular least squares problem.");
+      return 1;
+   }
+   if (ret==1)
+      _rita->msg("approximation>","Maximum number of iterations reached.");
+   _x = {xmin,xmax};
+   if (_verb) {
+      cout << "Least squares fitting of " << _fit.getNbSamples() << " samples in "
+           << _fit.getNbIter() << " iterations, time: " << _fit.getTime() << " s" << endl;
+      if (ft==POLYNOMIAL) {
+         vector<double> c = _fit.getPolynomial();
+         cout << "Coefficients of increasing powers of x:";
+         for (double v: c)
+            cout << " " << v;
+         cout << endl;
+      }
+      else {
+         for (size_t i=0; i<_fit.getParameters().size(); ++i)
+            cout << _fit.getParameterNames()[i] << " = " << _fit.getParameters()[i] << endl;
+      }
+      cout << "Root mean square of residual: " << _fit.getRMS() << ", R2: " << _fit.getR2() << endl;
+   }
+   return setFunction("Least squares fitting",_fit);
 }
 
 
 int approximation::bspline()
 {
-   return 0;
+   if (getData())
+      return 1;
+   if (_sp.setBSpline(_x,_y,_degree)) {
+      _rita->msg("approximation>","B-spline interpolation failed.");
+      return 1;
+   }
+   return setFunction("B-spline interpolation",_sp);
 }
 
 
 int approximation::bezier()
 {
-   return 0;
+   if (getData())
+      return 1;
+   if (_sp.setBezier(_x,_y)) {
+      _rita->msg("approximation>","Bezier approximation failed.");
+      return 1;
+   }
+   return setFunction("Bezier approximation",_sp);
 }
 
 
 int approximation::nurbs()
 {
-   return 0;
+   if (getData())
+      return 1;
+   vector<double> w(_x.size(),1.);
+   if (_weights!="") {
+      int k = _data->checkName(_weights,DataType::VECTOR);
+      if (k<=0 || _data->theVector[k]->size()!=w.size()) {
+         _rita->msg("approximation>","Vector "+_weights+" undefined or of wrong size.");
+         return 1;
+      }
+      for (size_t i=0; i<w.size(); ++i)
+         w[i] = (*_data->theVector[k])[i];
+   }
+   if (_sp.setNURBS(_x,_y,w,_degree)) {
+      _rita->msg("approximation>","NURBS weights must be positive.");
+      return 1;
+   }
+   return setFunction("NURBS approximation",_sp);
 }
 
 
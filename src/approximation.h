@@ -33,6 +33,8 @@
 #include "rita.h"
 #include "cmd.h"
 #include "configure.h"
+#include "spline.h"
+#include "lsqFit.h"
 #include <map>
 
 namespace RITA {
@@ -53,6 +55,7 @@ class approximation
     };
 
     enum FitType {
+       SPLINE,
        POLYNOMIAL,
        EXPONENTIAL,
        DEFINED
@@ -74,8 +77,15 @@ class approximation
     ApproxType _method;
     FitType ft;
     vector<double> _x, _y;
+    spline _sp;
+    lsqFit _fit;
+    string _name, _weights, _model;
+    vector<double> _init;
     int eval(double x);
-    int _verb, _lagrange_degree, _hermite_degree;
+    int _verb, _lagrange_degree, _hermite_degree, _degree, _nb_coef, _nb_points;
+    int getData();
+    void setFitType(const string& s);
+    template<class A> int setFunction(const string& method, const A& s);
     int lagrange();
     int piecewise_lagrange();
     int hermite();
@@ -87,6 +97,8 @@ class approximation
     const vector<string> _kw {"help","?","set","file","lagrange","fitting","bspline","bezier","nurbs"
                               "end","<","quit","exit"};
     map<ApproxType,string> rApp = {{LAGRANGE,"lagrange"},
+                                   {PIECEWISE_LAGRANGE,"piecewise-lagrange"},
+                                   {HERMITE,"hermite"},
                                    {FITTING,"fitting"},
                                    {BSPLINE,"bspline"},
                                    {BEZIER,"bezier"},
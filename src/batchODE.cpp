@@ -0,0 +1,182 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                       Implementation of class 'batchODE'
+
+  ==============================================================================*/
+
+#include "batchODE.h"
+
+namespace RITA {
+
+batchODE::batchODE()
+         : _time(0.), _nb_eval(0)
+{
+}
+
+
+int batchODE::add(int           n,
+                  Scheme        s,
+                  const double* y0,
+                  RHS           f)
+{
+   size_t k = 0;
+   for (; k<_groups.size(); ++k) {
+      if (_groups[k].size==n && _groups[k].scheme==s)
+         break;
+   }
+   if (k==_groups.size()) {
+      Group g;
+      g.size = n, g.nb = 0, g.scheme = s, g.packed = false;
+      _groups.push_back(g);
+   }
+   Group &g = _groups[k];
+
+// Systems added after a step: states go back to system-major storage
+   if (g.packed) {
+      g.y0.resize(size_t(n)*g.nb);
+      for (int j=0; j<g.nb; ++j)
+         for (int i=0; i<n; ++i)
+            g.y0[j*n+i] = g.y[i*g.nb+j];
+      g.packed = false;
+   }
+   g.y0.insert(g.y0.end(),y0,y0+n);
+   g.rhs.push_back(f);
+   Location l;
+   l.group = k, l.pos = g.nb++;
+   _loc.push_back(l);
+   return int(_loc.size())-1;
+}
+
+
+void batchODE::pack(Group& g)
+{
+   int n=g.size, nb=g.nb;
+   size_t m = size_t(n)*nb;
+   g.y.resize(m);
+   for (int s=0; s<nb; ++s)
+      for (int i=0; i<n; ++i)
+         g.y[i*nb+s] = g.y0[s*n+i];
+   g.y0.clear();
+   g.w.resize(m), g.k1.resize(m), g.u.resize(n), g.v.resize(n);
+   if (g.scheme==HEUN || g.scheme==RK4)
+      g.k2.resize(m);
+   if (g.scheme==RK4)
+      g.k3.resize(m), g.k4.resize(m);
+   g.packed = true;
+}
+
+
+void batchODE::eval(Group&                g,
+                    double                t,
+                    const vector<double>& y,
+                    vector<double>&       f)
+{
+   int n=g.size, nb=g.nb;
+   for (int s=0; s<nb; ++s) {
+      for (int i=0; i<n; ++i)
+         g.u[i] = y[i*nb+s];
+      g.rhs[s](t,g.u.data(),g.v.data());
+      for (int i=0; i<n; ++i)
+         f[i*nb+s] = g.v[i];
+   }
+   _nb_eval += nb;
+}
+
+
+void batchODE::step(double dt)
+{
+   double t = _time;
+   for (auto &g: _groups) {
+      if (!g.packed)
+         pack(g);
+      size_t m = g.y.size();
+      double *y=g.y.data(), *w=g.w.data(), *k1=g.k1.data();
+      switch (g.scheme) {
+
+         case FORWARD_EULER:
+            eval(g,t,g.y,g.k1);
+            for (size_t j=0; j<m; ++j)
+               y[j] += dt*k1[j];
+            break;
+
+         case HEUN:
+            {
+               double *k2 = g.k2.data();
+               eval(g,t,g.y,g.k1);
+               for (size_t j=0; j<m; ++j)
+                  w[j] = y[j] + dt*k1[j];
+               eval(g,t+dt,g.w,g.k2);
+               for (size_t j=0; j<m; ++j)
+                  y[j] += 0.5*dt*(k1[j]+k2[j]);
+            }
+            break;
+
+         case RK4:
+            {
+               double *k2=g.k2.data(), *k3=g.k3.data(), *k4=g.k4.data();
+               eval(g,t,g.y,g.k1);
+               for (size_t j=0; j<m; ++j)
+                  w[j] = y[j] + 0.5*dt*k1[j];
+               eval(g,t+0.5*dt,g.w,g.k2);
+               for (size_t j=0; j<m; ++j)
+                  w[j] = y[j] + 0.5*dt*k2[j];
+               eval(g,t+0.5*dt,g.w,g.k3);
+               for (size_t j=0; j<m; ++j)
+                  w[j] = y[j] + dt*k3[j];
+               eval(g,t+dt,g.w,g.k4);
+               for (size_t j=0; j<m; ++j)
+                  y[j] += dt/6.*(k1[j]+2.*(k2[j]+k3[j])+k4[j]);
+            }
+            break;
+      }
+   }
+   _time += dt;
+}
+
+
+void batchODE::get(int     i,
+                   double* y) const
+{
+   const Group &g = _groups[_loc[i].group];
+   int s = _loc[i].pos;
+   for (int j=0; j<g.size; ++j)
+      y[j] = g.packed ? g.y[j*g.nb+s] : g.y0[s*g.size+j];
+}
+
+
+void batchODE::getDerivative(int     i,
+                             double* f)
+{
+   Group &g = _groups[_loc[i].group];
+   int s = _loc[i].pos;
+   if (!g.packed)
+      pack(g);
+   for (int j=0; j<g.size; ++j)
+      g.u[j] = g.y[j*g.nb+s];
+   g.rhs[s](_time,g.u.data(),f);
+   _nb_eval++;
+}
+
+} /* namespace RITA */
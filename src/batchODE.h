@@ -0,0 +1,111 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                         Definition of class 'batchODE'
+
+  ==============================================================================*/
+
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+using std::vector;
+
+namespace RITA {
+
+/*! \class batchODE
+ *  \brief Integrator advancing a set of independent ODE systems in lockstep.
+ *
+ *  Systems sharing the same size and scheme are grouped, and the states of a group
+ *  are stored in structure-of-arrays layout: component \c i of system \c s is stored
+ *  at <tt>y[i*nb+s]</tt> where \c nb is the number of systems in the group. Stage
+ *  combinations of the Runge-Kutta schemes are then plain loops over contiguous
+ *  arrays that the compiler vectorizes across systems.
+ *
+ * \author Rachid Touzani
+ * \copyright GNU Public License
+ */
+
+class batchODE
+{
+
+ public:
+
+    enum Scheme {
+       FORWARD_EULER,
+       HEUN,
+       RK4
+    };
+
+/// \brief Right-hand side of a system: f = F(t,y)
+    typedef std::function<void(double t, const double *y, double *f)> RHS;
+
+    batchODE();
+    ~batchODE() { }
+
+/// \brief Add a system of size \c n with initial state \c y0. Return its index (starting from 0)
+    int add(int n, Scheme s, const double *y0, RHS f);
+
+/// \brief Set time of all systems
+    void setTime(double t) { _time = t; }
+
+/// \brief Advance all systems by one time step
+    void step(double dt);
+
+/// \brief Copy state of system \c i in \c y
+    void get(int i, double *y) const;
+
+/// \brief Copy time derivative of system \c i at current state in \c f
+    void getDerivative(int i, double *f);
+
+    double getTime() const { return _time; }
+    int getNbSystems() const { return int(_loc.size()); }
+    int getSize(int i) const { return _groups[_loc[i].group].size; }
+    size_t getNbEval() const { return _nb_eval; }
+
+ private:
+
+/*  Systems added since the last step are kept system by system in y0 and laid
+    out in structure-of-arrays storage once, before the next step */
+    struct Group {
+       int size, nb;
+       Scheme scheme;
+       bool packed;
+       vector<RHS> rhs;
+       vector<double> y0, y, w, k1, k2, k3, k4, u, v;
+    };
+    struct Location { int group, pos; };
+
+    double _time;
+    size_t _nb_eval;
+    vector<Group> _groups;
+    vector<Location> _loc;
+
+    void eval(Group& g, double t, const vector<double>& y, vector<double>& f);
+    void pack(Group& g);
+};
+
+} /* namespace RITA */
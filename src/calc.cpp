@@ -48,6 +48,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <cmath>
+#include <iterator>
+#include <unordered_map>
 #include <string>
 #include <iostream>
 #include <locale>
@@ -59,6 +61,7 @@
 #include "rita.h"
 #include "cmd.h"
 #include "data.h"
+#include "profiler.h"
 
 namespace RITA {
 
@@ -289,32 +292,68 @@ IToken* FunEnableDebugDump::Clone() const
 }
 
 
-FunGeneric::FunGeneric(string_type sIdent, string_type sFunction)
+FunGeneric::FunGeneric(string_type        sIdent,
+                       string_type        sFunction,
+                       const ParserXBase* parent)
            : ICallback(cmFUNC, sIdent.c_str())
-            ,m_parser()
-            ,m_vars()
-            ,m_val()
-{
-   m_parser.SetExpr(sFunction);
-   m_vars = m_parser.GetExprVar();
-   SetArgc(m_vars.size());
-
-// Create values for the undefined variables and bind them
-// to the variables
-   for (const auto& v: m_vars) {
-      ptr_val_type val(new Value());
-      m_val.push_back(val);
-      m_parser.DefineVar(v.second->GetIdent(), Variable(val.Get()));
+            ,m_prg(std::make_shared<Compiled>())
+{
+   ParserX& p = m_prg->parser;
+   if (parent!=nullptr) {
+      for (const auto& f: parent->GetFunDef()) {
+         if (!p.IsFunDefined(f.first))
+            p.DefineFun(ptr_cal_type(static_cast<ICallback*>(f.second->Clone())));
+      }
+   }
+   p.SetExpr(sFunction);
+   var_maptype vars = p.GetExprVar();
+   SetArgc(vars.size());
+
+// Define the arguments as variables, their values are set in each context
+   for (const auto& v: vars) {
+      m_prg->arg.push_back(ptr_val_type(new Value()));
+      p.DefineVar(v.second->GetIdent(),Variable(m_prg->arg.back().Get()));
    }
+   m_prg->prg = p.Compile();
+   for (const auto& v: vars)
+      m_prg->slot.push_back(m_prg->prg->GetVarIdx(v.second->GetIdent()));
 }
 
 
 void FunGeneric::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int a_iArgc)
 {
-// Set the variables
-   for (std::size_t i=0; i<(std::size_t)a_iArgc; ++i)
-      *m_val[i] = *a_pArg[i];
-   *ret = m_parser.Eval();
+// Free contexts of this thread for each compiled expression. The weak pointer keeps
+// the address of a removed function from being reused, its entry is dropped when
+// contexts of a new function are created
+   struct Contexts {
+      std::weak_ptr<Compiled> owner;
+      std::vector<std::unique_ptr<EvalContext> > free;
+   };
+   static thread_local std::unordered_map<const Compiled*,Contexts> contexts;
+   auto it = contexts.find(m_prg.get());
+   if (it==contexts.end()) {
+      for (auto i=contexts.begin(); i!=contexts.end();)
+         i = i->second.owner.expired() ? contexts.erase(i) : std::next(i);
+      it = contexts.emplace(m_prg.get(),Contexts{m_prg,{}}).first;
+   }
+   std::vector<std::unique_ptr<EvalContext> > &pool = it->second.free;
+   std::unique_ptr<EvalContext> ctx;
+   if (pool.size()) {
+      ctx = std::move(pool.back());
+      pool.pop_back();
+   }
+   else
+      ctx.reset(new EvalContext(m_prg->prg));
+
+   for (std::size_t i=0; i<(std::size_t)a_iArgc; ++i) {
+      IValue& v = ctx->Var(m_prg->slot[i]);
+      if (a_pArg[i]->GetType()=='f')
+         v = a_pArg[i]->GetFloat();
+      else
+         v = *a_pArg[i];
+   }
+   *ret = ctx->Eval();
+   pool.push_back(std::move(ctx));
 }
 
 
@@ -326,6 +365,7 @@ const char_type* FunGeneric::GetDesc() const
 
 IToken* FunGeneric::Clone() const
 {
+// The compiled expression is shared, not copied
    return new FunGeneric(*this);
 }
 
@@ -335,7 +375,9 @@ void FunDefine::Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int a_iArgc)
    string_type sFun = a_pArg[0]->GetString();
    string_type sDef = a_pArg[1]->GetString();
    ParserXBase &parser = *GetParent();
-   parser.DefineFun(new FunGeneric(sFun, sDef));
+   if (parser.IsFunDefined(sFun))
+      parser.RemoveFun(sFun);
+   parser.DefineFun(new FunGeneric(sFun,sDef,&parser));
 }
 
 
@@ -437,6 +479,7 @@ calc::calc(rita* r,
    _parser.EnableAutoCreateVar(true);
    _parser.DefineFun(new FctMatrix);
    _parser.DefineFun(new FctVector);
+   _parser.DefineFun(new FunDefine);
 }
 
 
@@ -460,43 +503,58 @@ Value calc::Help()
 
 void calc::setData()
 {
-   var_maptype variables = _parser.GetVar();
-   if (!variables.size())
-      return;
-   for (const auto& v: variables) {
-      Variable &w = (Variable&)(*v.second);
-      switch (w.GetType()) {
+   for (const auto& v: _parser.GetVar())
+      sync(v.first,(Variable&)(*v.second));
+}
 
-         case 'i': 
-         case 'f': 
-            {
-               _rita->_data->addParam(v.first,w.GetFloat());
-               break;
-            }
 
-         case 'm':
-            {
-               int nr=w.GetRows(), nc=w.GetCols();
-               if (nr==1 || nc==1) {
-                  OFELI::Vect<double> *u = _rita->_data->theVector[_rita->_data->iVector];
-                  _rita->_data->addVector(v.first,0.,std::max(nr,nc),"",true);
-                  for (int i=1; i<=std::max(nr,nc); ++i)
-                     (*u)(i,1) = w.GetArray().At(i-1,0).GetFloat();
-                  _rita->_data->theVector[_rita->_data->iVector] = u;
+void calc::sync(const string&   name,
+                const Variable& w)
+{
+   switch (w.GetType()) {
+
+      case 'i': 
+      case 'f': 
+         _rita->_data->addParam(name,w.GetFloat());
+         break;
+
+      case 'v': 
+         _rita->_data->print(name);
+         break;
+
+      case 'm':
+         {
+//          Existing vectors and matrices of same size are updated in place
+            data *d = _rita->_data;
+            const matrix_type& a = w.GetArray();
+            int nr=w.GetRows(), nc=w.GetCols(), n=std::max(nr,nc);
+            if (nr==1 || nc==1) {
+               int k = d->VectorName[name];
+               if (k==0 || !d->aVector[k] || int(d->theVector[k]->size())!=n) {
+                  d->addVector(name,0.,n,"",true);
+                  k = d->iVector;
                }
-               else {
-                  _rita->_data->addMatrix(v.first,nr,nc,"","dense",true);
-                  OFELI::Matrix<double> *M = _rita->_data->theMatrix[_rita->_data->iMatrix];
-                  for (int i=1; i<=nr; ++i)
-                     for (int j=1; j<=nc; ++j)
-                        (*M)(i,j) = w.GetArray().At(i-1,j-1).GetFloat();
+               OFELI::Vect<double>& u = *d->theVector[k];
+               for (int i=0; i<n; ++i)
+                  u[i] = (nc==1 ? a.At(i,0) : a.At(0,i)).GetFloat();
+            }
+            else {
+               int k = d->MatrixName[name];
+               if (k==0 || int(d->theMatrix[k]->getNbRows())!=nr ||
+                   int(d->theMatrix[k]->getNbColumns())!=nc) {
+                  d->addMatrix(name,nr,nc,"","dense",true);
+                  k = d->iMatrix;
                }
-               break;
+               OFELI::Matrix<double>& M = *d->theMatrix[k];
+               for (int i=1; i<=nr; ++i)
+                  for (int j=1; j<=nc; ++j)
+                     M(i,j) = a.At(i-1,j-1).GetFloat();
             }
-
-         default:
             break;
-      }
+         }
+
+      default:
+         break;
    }
 }
 
@@ -537,6 +595,18 @@ int calc::setVector(const string&        name,
 }
 
 
+int calc::setParam(const string& name,
+                   double        value)
+{
+   _v = new Value(value);
+   _theV.push_back(_v);
+   if (_parser.IsVarDefined(name))
+      _parser.RemoveVar(name);
+   _parser.DefineVar(name,Variable(_v));
+   return 0;
+}
+
+
 int calc::setMatrix(const string&          name,
                     OFELI::Matrix<double>* M)
 {
@@ -633,6 +703,8 @@ int calc::run()
          case  1: break;
          case -1: return -1;
       }
+      profiler::scope ps("calc:evaluate");
+      profiler::get().count("calc:commands");
       parse();
 //      if (verb)
 //         cout << std::setprecision(12) << "= " << _parser.Eval() << endl;
@@ -646,6 +718,7 @@ int calc::run()
       }
       cout << "Error: " << e.GetMsg() << std::dec << endl;
       *_rita->ofl << "In " << sPrompt << e.GetMsg() << std::dec << endl;
+      _rita->error();
    }
    return 0;
 }
@@ -655,43 +728,15 @@ void calc::parse()
 {
    _parser.SetExpr(_sLine);
    _parser.Eval();
-   var_maptype var = _parser.GetVar();
-   for (auto const& v: var) {
 
+// Only variables of the expression that were written to are sent to data
+   for (auto const& v: _parser.GetUsedVar()) {
       Variable &w = (Variable&)(*(v.second));
-      switch (w.GetType()) {
-
-         case 'i': 
-         case 'f': 
-            _rita->_data->addParam(v.first,w.GetFloat());
-            break;
-
-         case 'v': 
-            _rita->_data->print(v.first);
-            break;
-
-         case 'm':
-            {
-               int nr=w.GetRows(), nc=w.GetCols();
-               if (nr==1 || nc==1) {
-                  _rita->_data->addVector(v.first,0.,std::max(nr,nc),"",true);
-                  OFELI::Vect<double> *u = _rita->_data->theVector[_rita->_data->iVector];
-                  for (int i=1; i<=std::max(nr,nc); ++i)
-                     (*u)(i) = w.GetArray().At(i-1,0).GetFloat();
-               }
-               else {
-                  _rita->_data->addMatrix(v.first,nr,nc,"","dense",true);
-                  OFELI::Matrix<double> *M = _rita->_data->theMatrix[_rita->_data->iMatrix];
-                  for (int i=1; i<=nr; ++i)
-                     for (int j=1; j<=nc; ++j)
-                        (*M)(i,j) = w.GetArray().At(i-1,j-1).GetFloat();
-               }
-               break;
-            }
-
-         default:
-            break;
-      }
+      Value *val = w.GetPtr()->AsValue();
+      if (val==nullptr || !val->IsModified())
+         continue;
+      val->SetModified(false);
+      sync(v.first,w);
    }
 }
 
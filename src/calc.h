@@ -31,6 +31,7 @@
 #include "../muparserx/mpParser.h"
 #include "../muparserx/mpDefines.h"
 #include "../muparserx/mpTest.h"
+#include <memory>
 #include "linear_algebra/Vect.h"
 #include "linear_algebra/Matrix.h"
 
@@ -136,19 +137,30 @@ class FunEnableDebugDump : public ICallback
 };
 
 
+/// \brief Parser function defined by an expression.
+/// \details The expression is compiled once and shared by all copies of the
+/// function. Arguments are copied into the variables of the expression, taken
+/// in alphabetical order. Functions of \c parent that are not built-in (e.g.
+/// other user defined functions) can be called. Evaluation contexts are kept per
+/// thread and taken for the time of an evaluation, so the function can be called
+/// recursively and from several threads without locking.
 class FunGeneric : public ICallback
 {
  public:
-    FunGeneric(string_type sIdent, string_type sFunction);
+    FunGeneric(string_type sIdent, string_type sFunction, const ParserXBase* parent=nullptr);
     virtual ~FunGeneric() {}
     virtual void Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int a_iArgc);
     virtual const char_type* GetDesc() const;
     virtual IToken* Clone() const;
 
  private:
-    ParserX m_parser;
-    mup::var_maptype m_vars;
-    val_vec_type m_val;
+    struct Compiled {
+       ParserX parser;
+       val_vec_type arg;
+       ptr_prg_type prg;
+       std::vector<int> slot;
+    };
+    std::shared_ptr<Compiled> m_prg;
 };
 
 
@@ -162,6 +174,47 @@ class FunDefine : public ICallback
 };
 
 
+/// \brief Parser function defined by a native approximation of tabulated data. Class
+/// A provides operator()(double) and eval(const double*,double*,size_t)
+template<class A>
+class FunApprox : public ICallback
+{
+ public:
+    FunApprox(const string_type& sIdent, const A& s) : ICallback(cmFUNC, sIdent.c_str(), 1), _s(s) { }
+    virtual ~FunApprox() {}
+
+    virtual void Eval(ptr_val_type &ret, const ptr_val_type *a_pArg, int /*a_iArgc*/) override
+    {
+       if (!a_pArg[0]->IsMatrix()) {
+          *ret = _s(a_pArg[0]->GetFloat());
+          return;
+       }
+
+//     Vector or matrix argument: evaluate all entries at once
+       const matrix_type &a = a_pArg[0]->GetArray();
+       int nr=a.GetRows(), nc=a.GetCols();
+       std::vector<double> x(nr*nc), y(nr*nc);
+       for (int i=0; i<nr; ++i)
+          for (int j=0; j<nc; ++j)
+             x[i*nc+j] = a.At(i,j).GetFloat();
+       _s.eval(x.data(),y.data(),x.size());
+       matrix_type b(nr,nc,0.0);
+       for (int i=0; i<nr; ++i)
+          for (int j=0; j<nc; ++j)
+             b.At(i,j) = y[i*nc+j];
+       *ret = b;
+    }
+
+    virtual const char_type* GetDesc() const override
+    { return _T("xxx(x) - Function defined by approximation of tabulated data"); }
+
+    virtual IToken* Clone() const override { return new FunApprox(*this); }
+
+ private:
+    A _s;
+};
+
+
 class FctVector : public ICallback
 {
  public:
@@ -184,6 +237,8 @@ class calc {
     int getVar(string_type& s);
     int setVector(const string& name, OFELI::Vect<double> *u);
     int setMatrix(const string& name, OFELI::Matrix<double> *M);
+    template<class A> int setFunction(const string& name, const A& s);
+    int setParam(const string& name, double value);
 
  private:
  
@@ -201,10 +256,27 @@ class calc {
     void ListConst();
     void ListExprVar();
     void setData();
+    void sync(const string& name, const Variable& w);
     void parse();
 
     void addVar();
 
 };
 
+
+template<class A>
+int calc::setFunction(const string& name,
+                      const A&      s)
+{
+   try {
+      if (_parser.IsFunDefined(name))
+         _parser.RemoveFun(name);
+      _parser.DefineFun(new FunApprox<A>(name,s));
+   }
+   catch(ParserError &e) {
+      return 1;
+   }
+   return 0;
+}
+
 } /* namespace RITA */
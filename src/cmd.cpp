@@ -27,13 +27,16 @@
   ==============================================================================*/
 
 #include "cmd.h"
+#include "kwTrie.h"
 #include "rita.h"
 #include <algorithm>
+#include <iterator>
 
 namespace RITA {
 
 cmd::cmd(rita *r)
-    : _rita(r), _is(nullptr), _gkw(nullptr)
+    : _rita(r), _is(nullptr), _batch(false), _cur(0), _kw(nullptr), _gkw(nullptr), _dkw(nullptr),
+      _tkw(nullptr), _tgkw(nullptr), _tdkw(nullptr)
 {
 #ifdef USE_CTRL_D
    setvbuf(stdout,nullptr,_IONBF,0);
@@ -47,7 +50,8 @@ cmd::cmd(rita *r)
 
 
 cmd::cmd(ifstream& is)
-    : _is(&is), _gkw(nullptr)
+    : _is(&is), _batch(false), _cur(0), _kw(nullptr), _gkw(nullptr), _dkw(nullptr),
+      _tkw(nullptr), _tgkw(nullptr), _tdkw(nullptr)
 {
 }
 
@@ -70,6 +74,36 @@ void cmd::handler(int sig)
 #endif
 
 
+int cmd::setBatch(const string& file)
+{
+   ifstream in(file,std::ios::binary);
+   if (!in.is_open())
+      return 1;
+   string text((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+   _lines.clear(), _line_nb.clear();
+   size_t b=0;
+   for (int n=1; b<text.size(); ++n) {
+      size_t e = text.find('\n',b);
+      if (e==string::npos)
+         e = text.size();
+      string line = text.substr(b,e-b);
+      b = e + 1;
+      trim(line);
+      if (line.size()==0 || line[0]=='#')
+         continue;
+      _lines.push_back(line);
+      _line_nb.push_back(n);
+   }
+   _cur = 0;
+   _batch = true;
+#ifdef USE_CTRL_D
+   tcsetattr(0,TCSANOW,&_old_termios);
+   signal(SIGINT,SIG_DFL);
+#endif
+   return 0;
+}
+
+
 int cmd::readline(string p)
 {
    _comment = _command = false;
@@ -78,10 +112,17 @@ int cmd::readline(string p)
       _script_line_nb++;
       if (_is->eof()) {
          _is = nullptr;
-         return -5;
+         if (!_batch)
+            return -5;
       }
    }
-   else {
+   if (_is==nullptr && _batch) {
+      if (_cur>=_lines.size())
+         return -5;
+      _buffer = _lines[_cur];
+      _script_line_nb = _line_nb[_cur++];
+   }
+   else if (_is==nullptr) {
       cout << p;
       getline(std::cin,_buffer);
       for (char const &c: _buffer)
@@ -95,8 +136,13 @@ int cmd::readline(string p)
 // Execute a system command
    if (_buffer[0]=='!') {
       _command = true;
-      if (system(_buffer.substr(1,_buffer.size()).c_str()))
+      if (_batch)
+         _rita->flush();
+      if (system(_buffer.substr(1,_buffer.size()).c_str())) {
          cout << "Error in system command." << endl;
+         if (_batch)
+            _rita->error();
+      }
       return -3;
    }
 
@@ -114,14 +160,8 @@ int cmd::readline(string p)
    bool q = false;
    if (_buffer.find('\"')<_buffer.size())
       q = true;
-   istringstream is(_buffer);
    _comment = _command = false;
-   _word.clear();
-   string token;
-   while (!is.fail()) {
-      is >> token;
-      _word.push_back(token);
-   }
+   tokenize();
    _ind = 0;
    _mup = "";
    if (_word[0].substr(0,5)=="param" || _word[0].substr(0,1)=="@") {
@@ -130,7 +170,6 @@ int cmd::readline(string p)
       _mup = _buffer.substr(_word[0].size()+1,_buffer.size());
       return 0;
    }
-   _word.pop_back();
    _nb_args = _word.size() - 1;
    if (q)
       return split();
@@ -138,6 +177,23 @@ int cmd::readline(string p)
 }
 
 
+void cmd::tokenize()
+{
+   _word.clear();
+   size_t i=0, n=_buffer.size();
+   while (i<n) {
+      while (i<n && isspace(static_cast<unsigned char>(_buffer[i])))
+         i++;
+      size_t j = i;
+      while (j<n && !isspace(static_cast<unsigned char>(_buffer[j])))
+         j++;
+      if (j>i)
+         _word.emplace_back(_buffer,i,j-i);
+      i = j;
+   }
+}
+
+
 int cmd::split()
 {
    int k=0;
@@ -194,7 +250,7 @@ int cmd::setNbArg(int n, const string& s, int opt)
 
 int cmd::get(const vector<string>& kw, string& s)
 {
-   _kw = &kw;
+   setTrie(_kw,_tkw,kw);
    get(s);
    auto it = find(_kw->begin(),_kw->end(),s);
    if (it != _kw->end())
@@ -206,8 +262,8 @@ int cmd::get(const vector<string>& kw, string& s)
 
 int cmd::getKW(const vector<string> &kw1, const vector<string> &kw2)
 {
-   _kw = &kw1;
-   _gkw = &kw2;
+   setTrie(_kw,_tkw,kw1);
+   setTrie(_gkw,_tgkw,kw2);
    if (++_ind>_word.size())
       return -1;
    return find_kw(_word[_ind-1]);
@@ -216,9 +272,9 @@ int cmd::getKW(const vector<string> &kw1, const vector<string> &kw2)
 
 int cmd::getKW(const vector<string> &kw1, const vector<string> &kw2, const vector<string> &kw3)
 {
-   _kw = &kw1;
-   _gkw = &kw2;
-   _dkw = &kw3;
+   setTrie(_kw,_tkw,kw1);
+   setTrie(_gkw,_tgkw,kw2);
+   setTrie(_dkw,_tdkw,kw3);
    if (++_ind>_word.size())
       return -1;
    return find_kw(_word[_ind-1]);
@@ -227,7 +283,7 @@ int cmd::getKW(const vector<string> &kw1, const vector<string> &kw2, const vecto
 
 int cmd::getKW(const vector<string> &kw)
 {
-   _kw = &kw;
+   setTrie(_kw,_tkw,kw);
    if (++_ind>_word.size())
       return -1;
    return find_kw(_word[_ind-1]);
@@ -236,15 +292,15 @@ int cmd::getKW(const vector<string> &kw)
 
 void cmd::set(const vector<string>& arg)
 {
-   _kw = &arg;
+   setTrie(_kw,_tkw,arg);
    _with_kw = true;
 }
 
 
 void cmd::set(const vector<string>& arg1, const vector<string>& arg2)
 {
-   _kw = &arg1;
-   _gkw = &arg2;
+   setTrie(_kw,_tkw,arg1);
+   setTrie(_gkw,_tgkw,arg2);
    _with_kw = true;
 }
 
@@ -253,34 +309,38 @@ void cmd::set(const vector<string>& arg1,
               const vector<string>& arg2,
               const vector<string>& arg3)
 {
-   _kw = &arg1;
-   _gkw = &arg2;
-   _dkw = &arg3;
+   setTrie(_kw,_tkw,arg1);
+   setTrie(_gkw,_tgkw,arg2);
+   setTrie(_dkw,_tdkw,arg3);
    _with_kw = true;
 }
 
 
+// Keyword tables are compiled into prefix trees when they are set, the tree being
+// looked up again only if the table differs from the previous one of the same rank
+void cmd::setTrie(const vector<string>*& kw,
+                  const kwTrie*&         t,
+                  const vector<string>&  table)
+{
+   if (kw!=&table || t==nullptr || t->size()!=table.size())
+      t = &kwTrie::get(table);
+   kw = &table;
+}
+
+
 int cmd::find_kw(const string &s)
 {
-   for (auto it=_kw->begin(); it!=_kw->end(); it++) {
-      int n = int(it->find(SHORT_HAND));
-      if (it->substr(0,n)==s.substr(0,n))
-         return distance(_kw->begin(),it);
-   }
+   int k = _tkw->find(s);
+   if (k>=0)
+      return k;
    if (_gkw==nullptr)
       return -1;
-   for (auto it=_gkw->begin(); it!=_gkw->end(); it++) {
-      int n = int(it->find(SHORT_HAND));
-      if (it->substr(0,n)==s.substr(0,n))
-         return distance(_gkw->begin(),it)+100;
-   }
+   if ((k=_tgkw->find(s))>=0)
+      return k+100;
    if (_dkw==nullptr)
       return -1;
-   for (auto it=_dkw->begin(); it!=_dkw->end(); it++) {
-      int n = int(it->find(SHORT_HAND));
-      if (it->substr(0,n)==s.substr(0,n))
-         return distance(_dkw->begin(),it)+200;
-   }
+   if ((k=_tdkw->find(s))>=0)
+      return k+200;
    return -1;
 }
 
@@ -373,7 +433,8 @@ int cmd::getArgs(int &nb, string del1, string del2)
 
 int cmd::get(string& s)
 {
-   cout << _prompt;
+   if (!_batch)
+      cout << _prompt;
    if (++_ind>_word.size()) 
       return -1;
    if (_word[_ind-1][0]=='\"') {
@@ -400,7 +461,8 @@ int cmd::get(int& i)
 {
    if (++_ind>_word.size()) 
       return -1;
-   cout << _prompt;
+   if (!_batch)
+      cout << _prompt;
    if (!isValidNumber(_word[_ind-1])) {
       cout << "Error in input: Expecting an integer. " << endl;
       return 1;
@@ -414,7 +476,8 @@ int cmd::get(double& d)
 {
    if (++_ind>_word.size())
       return -1;
-   cout << _prompt;
+   if (!_batch)
+      cout << _prompt;
    if (!isNumeric(_word[_ind-1])) {
       cout << "Error in input: Expecting a number. " << endl;
       return 1;
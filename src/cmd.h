@@ -72,6 +72,44 @@ namespace RITA {
  */
 
 class rita;
+class kwTrie;
+
+/*
+ * Output buffer used in batch mode: characters are accumulated in a large block
+ * and handed to the underlying stream buffer only when the block is full or when
+ * flush() is called, so that 'endl' no longer triggers a write per line.
+ */
+class batchBuffer : public std::streambuf {
+
+ public:
+   batchBuffer(std::streambuf* sb, size_t size=1<<16) : _sb(sb), _b(size)
+   { setp(_b.data(),_b.data()+_b.size()); }
+   ~batchBuffer() { flush(); }
+   std::streambuf* target() const { return _sb; }
+   void flush()
+   {
+      _sb->sputn(pbase(),pptr()-pbase());
+      setp(_b.data(),_b.data()+_b.size());
+      _sb->pubsync();
+   }
+
+ protected:
+   int overflow(int c) override
+   {
+      flush();
+      if (c!=traits_type::eof()) {
+         *pptr() = traits_type::to_char_type(c);
+         pbump(1);
+      }
+      return traits_type::not_eof(c);
+   }
+   int sync() override { return 0; }
+
+ private:
+   std::streambuf* _sb;
+   vector<char> _b;
+};
+
 
 class cmd {
 
@@ -84,7 +122,12 @@ class cmd {
    vector<string> _word;
    size_t _ind;
    int _nb_args, _script_line_nb;
+   bool _batch;
+   vector<string> _lines;
+   vector<int> _line_nb;
+   size_t _cur;
    int split();
+   void tokenize();
 #ifdef USE_CTRL_D
    struct termios _old_termios, _new_termios;
    static void handler(int sig);
@@ -95,7 +138,10 @@ class cmd {
    cmd(rita *r);
    cmd(ifstream& is);
    ~cmd();
-   bool isInputFile() const { return (_is!=nullptr); }
+   bool isInputFile() const { return (_is!=nullptr || _batch); }
+   bool isBatch() const { return _batch; }
+   int setBatch(const string& file);
+   void endBatch() { _cur = _lines.size(); }
    void setIFStream(ifstream *is) { _is = is; _script_line_nb = 0; }
    ifstream *getIFStream() const { return _is; }
    int readline(string p="");
@@ -130,6 +176,8 @@ class cmd {
    void set(const vector<string>& arg1, const vector<string>& arg2);
    void set(const vector<string>& arg1, const vector<string>& arg2, const vector<string>& arg3);
    const vector<string> *_kw, *_gkw, *_dkw;
+   const kwTrie *_tkw, *_tgkw, *_tdkw;
+   void setTrie(const vector<string>*& kw, const kwTrie*& t, const vector<string>& table);
    string& trim(string& s, const string& chars = "\t\n\v\f\r ");
    int find_kw(const string &arg);
    bool isValidNumber(const string& s);
@@ -138,6 +186,7 @@ class cmd {
    bool isNumeric(const string& s, int& d);
 
    friend class rita;
+class kwTrie;
 };
 
 } /* namespace RITA */
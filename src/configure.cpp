@@ -28,12 +28,14 @@
 
 #include "configure.h"
 #include "rita.h"
+#include "fctCache.h"
+#include "profiler.h"
 
 namespace RITA {
 
 configure::configure(rita *r, cmd *command)
-          : _rita(r), _verb(1), _save_results(1), _his_file(".rita.his"),
-            _log_file(".rita.log"), _cmd(command)
+          : _rita(r), _verb(1), _save_results(1), _mesh_cache(1), _fct_cache(256), _profile(0),
+            _his_file(".rita.his"), _log_file(".rita.log"), _cmd(command)
 {
    init();
 }
@@ -54,6 +56,13 @@ void configure::save()
    _ocf << "save-results " << _save_results << endl;
    _ocf << "history-file " << _his_file << endl;
    _ocf << "log-file " << _log_file << endl;
+   _ocf << "mesh-cache " << _mesh_cache << endl;
+   _ocf << "fct-cache " << _fct_cache << endl;
+   _ocf << "profile " << _profile << endl;
+   if (_prof_json!="")
+      _ocf << "profile-json " << _prof_json << endl;
+   if (_prof_trace!="")
+      _ocf << "profile-trace " << _prof_trace << endl;
    _ocf << "end" << endl;
    _ocf.close();
 }
@@ -71,6 +80,12 @@ void configure::init()
       read();
       _ocf.open((_HOME+"/.rita.backup").c_str());
    }
+   if (_fct_cache<0)
+      _fct_cache = 0;
+   fctCache::get().setCapacity(_fct_cache);
+   if (_profile<0)
+      _profile = 0;
+   profiler::get().setLevel(_profile);
    save();
    _ofl.open(_log_file);
    _ofl << "# rita log file" << endl;
@@ -106,12 +121,33 @@ int configure::read()
             break;
 
          case 4:
+            com.get(_mesh_cache);
+            break;
+
+         case 5:
+            com.get(_fct_cache);
+            break;
+
+         case 6:
+            com.get(_prof_json);
+            break;
+
+         case 7:
+            com.get(_prof_trace);
+            break;
+
+         case 8:
+            com.get(_profile);
+            break;
+
+         case 9:
             _icf.close();
             return 0;
 
          default:
             _rita->msg("set>:","Unknown setting: "+com.token(),
-                       "Available settings: verbosity, save-results, history, log, end");
+                       "Available settings: verbosity, save-results, history, log, mesh-cache, fct-cache,\n"
+                       "                    profile, profile-json, profile-trace, end");
             return 1;
       }
    }
@@ -121,7 +157,8 @@ int configure::read()
 
 int configure::run()
 {
-   bool verb_ok=false, hist_ok=false, log_ok=false, save_ok=false;
+   bool verb_ok=false, hist_ok=false, log_ok=false, save_ok=false, cache_ok=false, fct_ok=false,
+        prof_ok=false, json_ok=false, trace_ok=false;
    string hfile, lfile, buffer;
    ifstream is;
    _cmd->set(_kw,_rita->_gkw);
@@ -130,7 +167,13 @@ int configure::run()
       return 1;
    if (nb_args==0) {
       cout << "In " + sPrompt + " set>: No argument for command! " << endl;
-      cout << "Available settings: verbosity, save-results, history, log" << endl;
+      cout << "Available settings: verbosity, save-results, history, log, mesh-cache, fct-cache,\n"
+              "                    profile, profile-json, profile-trace" << endl;
+      fctCache& fc = fctCache::get();
+      cout << "Function cache: " << fc.size() << "/" << fc.getCapacity() << " expressions, "
+           << fc.getHits() << " hits, " << fc.getMisses() << " misses" << endl;
+      if (_profile)
+         profiler::get().report(cout);
       return 0;
    }
    for (int i=0; i<nb_args; ++i) {
@@ -158,6 +201,31 @@ int configure::run()
             _log_file = _cmd->string_token();
             break;
 
+         case 4:
+            _mesh_cache = _cmd->int_token();
+            cache_ok = true;
+            break;
+
+         case 5:
+            _fct_cache = _cmd->int_token();
+            fct_ok = true;
+            break;
+
+         case 6:
+            _prof_json = _cmd->string_token();
+            json_ok = true;
+            break;
+
+         case 7:
+            _prof_trace = _cmd->string_token();
+            trace_ok = true;
+            break;
+
+         case 8:
+            _profile = _cmd->int_token();
+            prof_ok = true;
+            break;
+
          case 106:
          case 107:
             return 0;
@@ -174,7 +242,8 @@ int configure::run()
 
          default:
             _rita->msg("set>","Unknown setting: "+_cmd->token(),
-                       "Available settings: verbosity, save-results, history, log");
+                       "Available settings: verbosity, save-results, history, log, mesh-cache, fct-cache,\n"
+                       "                    profile, profile-json, profile-trace");
             return 1;
        }
    }
@@ -194,6 +263,28 @@ int configure::run()
          }
          _ofh << " save-results=" << _save_results;
       }
+      if (cache_ok)
+         _ofh << " mesh-cache=" << _mesh_cache;
+      if (fct_ok) {
+         if (_fct_cache<0) {
+            _rita->msg("set>","Illegal value of fct-cache: "+to_string(_fct_cache));
+            return 1;
+         }
+         fctCache::get().setCapacity(_fct_cache);
+         _ofh << " fct-cache=" << _fct_cache;
+      }
+      if (prof_ok) {
+         if (_profile<0 || _profile>2) {
+            _rita->msg("set>","Illegal value of profile: "+to_string(_profile));
+            return 1;
+         }
+         profiler::get().setLevel(_profile);
+         _ofh << " profile=" << _profile;
+      }
+      if (json_ok)
+         _ofh << " profile-json=" << _prof_json;
+      if (trace_ok)
+         _ofh << " profile-trace=" << _prof_trace;
       if (hist_ok) {
          _ofh.close();
          is.open(hfile);
@@ -56,6 +56,11 @@ class configure
     std::ofstream* getOStreamLog() { return &_ofl; }
     std::ofstream* getOStreamHistory() { return &_ofh; }
     int getSaveResults() const { return _save_results; }
+    int getMeshCache() const { return _mesh_cache; }
+    int getFctCache() const { return _fct_cache; }
+    int getProfile() const { return _profile; }
+    string getProfileJSON() const { return _prof_json; }
+    string getProfileTrace() const { return _prof_trace; }
     void set(cmd* command) { _cmd = command; }
     void set(string cf);
     int read();
@@ -74,11 +79,12 @@ class configure
     }
 
     rita *_rita;
-    int _verb, _key, _save_results;
-    string _HOME, _his_file, _log_file;
+    int _verb, _key, _save_results, _mesh_cache, _fct_cache, _profile;
+    string _HOME, _his_file, _log_file, _prof_json, _prof_trace;
     ofstream _ofh, _ofl, _ocf;
     ifstream _icf;
-    const vector<string> _kw {"verb$osity","save$-results","history$-file","log$-file","end"};
+    const vector<string> _kw {"verb$osity","save$-results","history$-file","log$-file","mesh$-cache",
+                               "fct$-cache","profile-j$son","profile-t$race","prof$ile","end"};
     cmd *_cmd;
 };
 
@@ -33,6 +33,7 @@
 #include "linear_algebra/Matrix.h"
 #include "io/IOField.h"
 #include "calc.h"
+#include "profiler.h"
 
 using std::cout;
 using std::endl;
@@ -51,6 +52,7 @@ data::data(rita*      r,
    nb_vectors = nb_params = nb_fcts = nb_meshes = nb_tabs = nb_grids = nb_matrices = 0;
    nb_pde = nb_ode = nb_ae = nb_int = nb_eigen = nb_eq = 0;
    iMesh = iVector = iHVector = iMatrix = iGrid = iParam = iFct = iTab = iAE = iODE = iPDE = iEq = 0;
+   obj = integral = 0.;
    theParam.push_back(nullptr), theVector.push_back(nullptr), VectorTime.push_back(0.), theFct.push_back(nullptr);
    theMatrix.push_back(nullptr), theMesh.push_back(nullptr), theGrid.push_back(nullptr), theHVector.push_back(nullptr);
    theAE.push_back(nullptr), theODE.push_back(nullptr), thePDE.push_back(nullptr), theTab.push_back(nullptr);
@@ -630,6 +632,7 @@ int data::addVector(const string& name,
          _u = new OFELI::Vect<double>;
       else
          _u = new OFELI::Vect<double>(n);
+      profiler::get().count("data:allocations");
       if (file!="") {
          OFELI::XMLParser xml(file,OFELI::XMLParser::FIELD);
          xml.get(*_u);
@@ -788,6 +791,7 @@ int data::addMatrix(string name,
    if (file!="")
       nr = 1, nc = 1;
    _theMatrix = new DMatrix<double>(nr,nc);
+   profiler::get().count("data:allocations");
    if (file!="") {
       ifstream f(file.c_str());
       if (!f.good()) {
@@ -841,15 +845,17 @@ int data::addTab(OFELI::Tabulation* tab,
 
 int data::addMeshVector(const string& name,
                         DataSize      s,
-                        int           nb_dof)
+                        int           nb_dof,
+                        OFELI::Mesh*  ms)
 {
-   _theMesh = theMesh[iMesh];
+   _theMesh = (ms!=nullptr) ? ms : theMesh[iMesh];
    if (_theMesh==nullptr) {
       _rita->msg("data>","No mesh data available.");
       _ret = -1;
       return _ret;
    }
    _u = new OFELI::Vect<double>;
+   profiler::get().count("data:allocations");
    _nb_dof = nb_dof;
    if (VectorName[name]==0) {
       iVector = ++nb_vectors;
@@ -920,6 +926,7 @@ int data::addGridVector(const string& name,
       return _ret;
    }
    _u = new OFELI::Vect<double>(*_theGrid);
+   profiler::get().count("data:allocations");
    _nb_dof = nb_dof;
    _theGrid->setNbDOF(_nb_dof);
    if (VectorName[name]==0) {
@@ -1544,6 +1551,8 @@ int data::save()
       _rita->msg("save>","No file given.");
       return 1;
    }
+   profiler::scope ps("data:save");
+   profiler::output po(file);
 
 // Case of a parameter
    int k = checkName(name,DataType::PARAM);
@@ -2154,6 +2163,9 @@ odae::odae()
      : isSet(false), log(false), isFct(false), vect(-1)
 {
    every = 1;
+   adapt = 0;
+   atol = 1.e-6, rtol = 1.e-4;
+   max_it = 100, toler = 1.e-8;
 }
 
 
@@ -2189,7 +2201,8 @@ ostream& operator<<(ostream& s, const odae& e)
          s << e.vars[e.size-1] << endl;
       }
       s << "Nonlinear iteration procedure: " << Nls[e.nls] << endl;
-
+      s << "Maximal number of iterations: " << e.max_it << endl;
+      s << "Tolerance: " << e.toler << endl;
    }
    else if (e.type==DataType::ODE) {
       s << "Ordinary Differential Equation Name: " << e.name << endl;
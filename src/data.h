@@ -56,11 +56,11 @@ struct odae {
    vector<OFELI::Fct> theFct;
    OFELI::Vect<double> y, ph;
    OFELI::Vect<string> J;
-   double init_time, final_time, time_step;
+   double init_time, final_time, time_step, atol, rtol, toler;
    OFELI::TimeScheme scheme;
-   int size, vect, ind_fct, every;
+   int size, vect, ind_fct, every, adapt, max_it;
    NonLinearIter nls;
-   string fn, name, phase;
+   string fn, name, phase, steps;
    odae();
    void setVars(int opt);
 };
@@ -82,7 +82,7 @@ class data
     ~data();
     int addVector(const string& name, double t=0., int n=1, string file="", bool opt=true);
     int remove(const string& name);
-    int addMeshVector(const string& name, DataSize s, int nb_dof=1);
+    int addMeshVector(const string& name, DataSize s, int nb_dof=1, OFELI::Mesh* ms=nullptr);
     int addGridVector(const string& name, int nb_dof=1);
     int addParam(const string& name, double value);
     int addAE(odae *ae, string name="");
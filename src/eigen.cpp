@@ -29,6 +29,7 @@
 #include "data.h"
 #include "configure.h"
 #include "eigen.h"
+#include "equa.h"
 #include "linear_algebra/Matrix_impl.h"
 
 namespace RITA {
@@ -45,6 +46,10 @@ eigen::eigen(rita*      r,
    _data = _rita->_data;
    solved = false;
    log = true;
+   sparse = shift_ok = false;
+   shift = 0.;
+   tol = 1.e-8;
+   pde = nullptr;
 }
 
 
@@ -56,16 +61,18 @@ eigen::~eigen()
 int eigen::run()
 {
    _rita->_analysis_type = EIGEN;
-   string mat_name="", method="qr";
+   string mat_name="", pde_name="", method="qr";
    evect = "";
-   symm = eig_vec = false;
+   pde = nullptr;
+   symm = eig_vec = sparse = shift_ok = false;
    nb_eigv = 0;
+   tol = 1.e-8;
 
-   static const vector<string> kw {"matrix","symm$etric","method","nb","eigv","evect"};
+   static const vector<string> kw {"matrix","symm$etric","method","nb","eigv","evect","shift","tol","pde"};
    _cmd->set(kw,_rita->_gkw);
    int nb_args = _cmd->getNbArgs();
    if (nb_args==0) {
-      _rita->msg("eigen>","No argument to command.\nAvailable arguments: matrix, symmetric, method, nb, eigv, evect, summary","");
+      _rita->msg("eigen>","No argument to command.\nAvailable arguments: matrix, pde, symmetric, method, nb, eigv, evect, shift, tol, summary","");
       NO_EIGEN
       return 0;
    }
@@ -98,10 +105,27 @@ int eigen::run()
             evect = _cmd->string_token();
             break;
 
+         case 6:
+            shift = _cmd->double_token();
+            shift_ok = true;
+            break;
+
+         case 7:
+            tol = _cmd->double_token();
+            break;
+
+         case 8:
+            pde_name = _cmd->string_token();
+            break;
+
          case 100:
          case 101:
             cout << "\nAvailable Commands:\n";
-            cout << "matrix, symmetric, method, nb, eigv, evect, summary\n";
+            cout << "matrix, pde, symmetric, method, nb, eigv, evect, shift, tol, summary\n";
+            cout << "Methods lanczos (symmetric matrices) and arnoldi compute the nb eigenvalues of largest\n";
+            cout << "modulus, or the nb eigenvalues closest to shift if given, to tolerance tol\n";
+            cout << "pde=<name> solves K x = lambda M x for the finite element operators of a pde\n";
+            cout << "(nb eigenvalues closest to shift, default 0), eigenvectors are stored as mesh vectors\n";
             break;
 
          default:
@@ -111,7 +135,35 @@ int eigen::run()
       }
    }
 
-   if (nb_args>0) {
+   if (pde_name!="") {
+      int k = _data->checkName(pde_name,DataType::PDE);
+      if (k<=0) {
+         _rita->msg("eigen>","PDE "+pde_name+" not defined.");
+         NO_EIGEN
+         return 1;
+      }
+      pde = _data->thePDE[k];
+      if (nb_eigv<0 || tol<=0.) {
+         _rita->msg("eigen>","Illegal number of eigen values or tolerance.");
+         NO_EIGEN
+         return 1;
+      }
+      if (nb_eigv==0)
+         nb_eigv = 6;
+      sparse = symm = eig_vec = shift_ok = true;
+      *_rita->ofh << "eigen pde=" << pde_name << " nb=" << nb_eigv << " shift=" << shift
+                  << " tol=" << tol;
+      if (evect!="")
+         *_rita->ofh << " evect=" << evect;
+      *_rita->ofh << endl;
+      if (evect=="")
+         evect = pde_name+"-mode";
+      eval = pde_name + "-ev";
+      _data->addVector(eval+"-r");
+      _data->addVector(eval+"-i");
+   }
+
+   else if (nb_args>0) {
       if (mat_name=="") {
          _rita->msg("eigen>","No matrix given.");
          NO_EIGEN
@@ -136,12 +188,24 @@ int eigen::run()
          NO_EIGEN
          return 1;
       }
+      if (method=="lanczos" || method=="arnoldi") {
+         sparse = true;
+         if (method=="lanczos")
+            symm = true;
+         if (nb_eigv==0)
+            nb_eigv = std::min(size,6);
+         if (tol<=0.) {
+            _rita->msg("eigen>","Illegal tolerance: "+to_string(tol));
+            NO_EIGEN
+            return 1;
+         }
+      }
       if (nb_eigv==0)
          nb_eigv = size;
       Alg = meth[method];
       if (Alg==OFELI::SUBSPACE)
          eig_vec = true;
-      if (Alg!=OFELI::SUBSPACE && Alg!=OFELI::QR) {
+      if (!sparse && Alg!=OFELI::SUBSPACE && Alg!=OFELI::QR) {
          _rita->msg("eigen>","Method "+to_string(Alg)+" not available");
          NO_EIGEN
          return 1;
@@ -151,7 +215,12 @@ int eigen::run()
          *_rita->ofh << " symmetric";
       if (nb_eigv<size)
          *_rita->ofh << " nb=" << nb_eigv;
-      *_rita->ofh << " method=" << method << endl;
+      *_rita->ofh << " method=" << method;
+      if (shift_ok)
+         *_rita->ofh << " shift=" << shift;
+      if (sparse)
+         *_rita->ofh << " tol=" << tol;
+      *_rita->ofh << endl;
       if (evect=="")
          evect = mat_name+"-ev";
       if (eig_vec) {
@@ -49,9 +49,11 @@ class eigen
     int run();
     OFELI::EigenMethod Alg;
     int size, nb_eigv, verbose;
-    bool eig_vec, symm, log, solved;
+    bool eig_vec, symm, log, solved, sparse, shift_ok;
+    double shift, tol;
     string evect, eval;
     OFELI::Matrix<double> *M;
+    equa *pde;
     void print(ostream& s) const;
 
  private:
@@ -26,9 +26,12 @@
 
   ==============================================================================*/
 
+#include <algorithm>
 #include "equa.h"
 #include "cmd.h"
 #include "rita.h"
+#include "fctCache.h"
+#include "profiler.h"
 
 namespace RITA {
 
@@ -553,14 +556,163 @@ int equa::setBF()
 void equa::setNodeBC(int code, string exp, double t, Vect<double>& v)
 {
    const static vector<string> var {"x","y","z","t"};
-   _theFct.set(exp,var);
+   std::shared_ptr<OFELI::Fct> f = fctCache::get().fct(exp,var);
+   if (f==nullptr)
+      return;
+   size_t nb_eval = 0;
    for (size_t n=1; n<=_theMesh->getNbNodes(); ++n) {
       Node *nd = (*_theMesh)[n];
       for (size_t i=1; i<=nd->getNbDOF(); ++i) {
-         if (nd->getCode(i)==code)
-            v(nd->n(),i) = _theFct(nd->getCoord());
+         if (nd->getCode(i)==code) {
+            v(nd->n(),i) = (*f)(nd->getCoord());
+            nb_eval++;
+         }
+      }
+   }
+   profiler::get().count("bc:fills");
+   profiler::get().count("bc:expression-evaluations",double(nb_eval));
+}
+
+
+// Assemble stiffness and mass matrices of P1 finite elements for the eigenproblem
+// K x = lambda M x. Degrees of freedom with positive codes (Dirichlet conditions)
+// are eliminated; eqn receives the equation number of each degree of freedom (-1 if
+// eliminated). Coefficients are evaluated at element centers
+int equa::getOperators(CSR&         K,
+                       CSR&         M,
+                       vector<int>& eqn,
+                       int&         nb_dof)
+{
+   if (_theMesh==nullptr || Sdm!=FE_P1 || (ieq!=LAPLACE && ieq!=HEAT && ieq!=LINEAR_ELASTICITY)) {
+      _rita->msg("eigen>","Eigenproblem available for P1 finite elements for laplace, heat and "
+                 "linear-elasticity equations only.");
+      return 1;
+   }
+   int d=_dim, nn=int(_theMesh->getNbNodes()), ne=d+1;
+   nb_dof = (ieq==LINEAR_ELASTICITY) ? d : 1;
+   int nd=nb_dof, ndof=ne*nd;
+   eqn.assign(nn*nd,-1);
+   int n = 0;
+   node_loop(_theMesh) {
+      for (int i=1; i<=nd; ++i) {
+         if (int(The_node.getNbDOF())<i || The_node.getCode(i)<=0)
+            eqn[(node_label-1)*nd+i-1] = n++;
+      }
+   }
+
+// Sparsity pattern from node connectivity
+   vector<vector<int> > adj(nn);
+   element_loop(_theMesh) {
+      if (int(The_element.getNbNodes())!=ne) {
+         _rita->msg("eigen>","Eigenproblem available for simplicial elements only.");
+         return 1;
+      }
+      for (int k=1; k<=ne; ++k) {
+         for (int l=1; l<=ne; ++l)
+            adj[The_element(k)->n()-1].push_back(The_element(l)->n()-1);
+      }
+   }
+   K = CSR(n);
+   for (int p=0; p<nn; ++p) {
+      std::sort(adj[p].begin(),adj[p].end());
+      adj[p].erase(std::unique(adj[p].begin(),adj[p].end()),adj[p].end());
+      for (int a=0; a<nd; ++a) {
+         if (eqn[p*nd+a]<0)
+            continue;
+         for (int q: adj[p]) {
+            for (int b=0; b<nd; ++b) {
+               if (eqn[q*nd+b]>=0)
+                  K.col.push_back(eqn[q*nd+b]), K.val.push_back(0.);
+            }
+         }
+         K.ptr.push_back(int(K.col.size()));
+      }
+      vector<int>().swap(adj[p]);
+   }
+   M = K;
+
+   OFELI::Fct fk, fm, fE, fnu;
+   const static vector<string> var {"x","y","z"};
+   string ek=(ieq==HEAT && _kappa_set) ? _kappa_exp : "1", em="1";
+   if (ieq==HEAT)
+      em = ((_rho_set) ? "("+_rho_exp+")" : "1") + "*" + ((_Cp_set) ? "("+_Cp_exp+")" : "1");
+   else if (ieq==LINEAR_ELASTICITY && _rho_set)
+      em = _rho_exp;
+   fk.set(ek,var), fm.set(em,var);
+   fE.set((_young_set) ? _young_exp : "1",var);
+   fnu.set((_poisson_set) ? _poisson_exp : "0.3",var);
+
+   vector<double> ke(ndof*ndof), me(ndof*ndof), J(d*d), G(ne*d);
+   vector<int> dof(ndof);
+   element_loop(_theMesh) {
+
+//    Gradients of barycentric coordinates: rows of the inverse of the Jacobian
+      OFELI::Point<double> c;
+      for (int k=1; k<=ne; ++k)
+         c += The_element(k)->getCoord()/double(ne);
+      for (int i=0; i<d; ++i) {
+         for (int j=0; j<d; ++j)
+            J[i*d+j] = The_element(j+2)->getCoord(i+1) - The_element(1)->getCoord(i+1);
+      }
+      double det=0., vol=0.;
+      if (d==1)
+         det = J[0], G[1] = 1./det;
+      else if (d==2) {
+         det = J[0]*J[3] - J[1]*J[2];
+         G[2] =  J[3]/det, G[3] = -J[1]/det;
+         G[4] = -J[2]/det, G[5] =  J[0]/det;
+      }
+      else {
+         det = J[0]*(J[4]*J[8]-J[5]*J[7]) - J[1]*(J[3]*J[8]-J[5]*J[6]) + J[2]*(J[3]*J[7]-J[4]*J[6]);
+         G[3]  = (J[4]*J[8]-J[5]*J[7])/det, G[4]  = (J[2]*J[7]-J[1]*J[8])/det, G[5]  = (J[1]*J[5]-J[2]*J[4])/det;
+         G[6]  = (J[5]*J[6]-J[3]*J[8])/det, G[7]  = (J[0]*J[8]-J[2]*J[6])/det, G[8]  = (J[2]*J[3]-J[0]*J[5])/det;
+         G[9]  = (J[3]*J[7]-J[4]*J[6])/det, G[10] = (J[1]*J[6]-J[0]*J[7])/det, G[11] = (J[0]*J[4]-J[1]*J[3])/det;
+      }
+      vol = fabs(det)/((d==3) ? 6. : double(d));
+      for (int j=0; j<d; ++j) {
+         G[j] = 0.;
+         for (int k=1; k<ne; ++k)
+            G[j] -= G[k*d+j];
+      }
+
+      double kap=fk(c), rho=fm(c), E=fE(c), nu=fnu(c);
+      double lam=E*nu/((1.+nu)*(1.-2*nu)), mu=0.5*E/(1.+nu);
+      for (int k=0; k<ne; ++k) {
+         for (int l=0; l<ne; ++l) {
+            double gg=0., m=rho*vol*((k==l) ? 2. : 1.)/((d+1)*(d+2));
+            for (int j=0; j<d; ++j)
+               gg += G[k*d+j]*G[l*d+j];
+            for (int a=0; a<nd; ++a) {
+               for (int b=0; b<nd; ++b) {
+                  double v = 0.;
+                  if (nd==1)
+                     v = kap*gg;
+                  else
+                     v = lam*G[k*d+a]*G[l*d+b] + mu*G[k*d+b]*G[l*d+a] + ((a==b) ? mu*gg : 0.);
+                  ke[(k*nd+a)*ndof+l*nd+b] = vol*v;
+                  me[(k*nd+a)*ndof+l*nd+b] = (a==b) ? m : 0.;
+               }
+            }
+         }
+      }
+      for (int k=0; k<ne; ++k) {
+         for (int a=0; a<nd; ++a)
+            dof[k*nd+a] = eqn[(The_element(k+1)->n()-1)*nd+a];
+      }
+      for (int i=0; i<ndof; ++i) {
+         int r = dof[i];
+         if (r<0)
+            continue;
+         for (int j=0; j<ndof; ++j) {
+            if (dof[j]<0)
+               continue;
+            int p = int(std::lower_bound(K.col.begin()+K.ptr[r],K.col.begin()+K.ptr[r+1],dof[j]) - K.col.begin());
+            K.val[p] += ke[i*ndof+j];
+            M.val[p] += me[i*ndof+j];
+         }
       }
    }
+   return 0;
 }
 
 
@@ -35,6 +35,7 @@
 using std::map;
 
 #include "data.h"
+#include "sparseLU.h"
 
 #include "Laplace.h"
 #include "Therm.h"
@@ -135,6 +136,8 @@ class equa
     void check();
     void set(cmd* cmd) { _cmd = cmd; }
     void setNodeBC(int code, string exp, double t, Vect<double>& v);
+    int getOperators(CSR& K, CSR& M, vector<int>& eqn, int& nb_dof);
+    Mesh *getMesh() const { return _theMesh; }
     void setSize(Vect<double>& v, data::DataSize s);
     Log log;
     bool set_u, set_bc, set_bf, set_sf, set_in, set_coef;
@@ -166,7 +169,6 @@ class equa
     Grid *_theGrid;
     string _rho_exp, _Cp_exp, _kappa_exp, _mu_exp,_sigma_exp, _Mu_exp, _epsilon_exp, _omega_exp;
     string _beta_exp, _v_exp, _young_exp, _poisson_exp;
-    OFELI::Fct _theFct;
 };
 
 ostream& operator<<(ostream& s, const equa& e);
@@ -0,0 +1,134 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                       Implementation of class 'fctCache'
+
+  ==============================================================================*/
+
+#include "fctCache.h"
+
+namespace RITA {
+
+fctCache::fctCache()
+         : _capacity(256), _hits(0), _misses(0)
+{
+}
+
+
+fctCache& fctCache::get()
+{
+   static fctCache cache;
+   return cache;
+}
+
+
+std::shared_ptr<OFELI::Fct> fctCache::fct(const string&         exp,
+                                          const vector<string>& var)
+{
+   string key = exp + '\n';
+   for (const auto& v: var)
+      key += v + ',';
+   {
+      std::lock_guard<std::mutex> guard(_lock);
+      auto it = _map.find(key);
+      if (it!=_map.end()) {
+         _hits++;
+         _lru.splice(_lru.begin(),_lru,it->second);
+         return it->second->second;
+      }
+      _misses++;
+   }
+
+// Compile outside of the lock, parsing is the slow part
+   std::shared_ptr<OFELI::Fct> f = std::make_shared<OFELI::Fct>();
+   int ret = var.size() ? f->set(exp,var) : f->set(exp);
+   if (ret)
+      return nullptr;
+
+   std::lock_guard<std::mutex> guard(_lock);
+   if (_capacity==0)
+      return f;
+   auto it = _map.find(key);
+   if (it!=_map.end())
+      return it->second->second;
+   _lru.push_front(entry_type(key,f));
+   _map[key] = _lru.begin();
+   trim();
+   return f;
+}
+
+
+void fctCache::trim()
+{
+   while (_lru.size()>_capacity) {
+      _map.erase(_lru.back().first);
+      _lru.pop_back();
+   }
+}
+
+
+void fctCache::setCapacity(size_t n)
+{
+   std::lock_guard<std::mutex> guard(_lock);
+   _capacity = n;
+   trim();
+}
+
+
+void fctCache::clear()
+{
+   std::lock_guard<std::mutex> guard(_lock);
+   _lru.clear();
+   _map.clear();
+}
+
+
+size_t fctCache::getCapacity() const
+{
+   std::lock_guard<std::mutex> guard(_lock);
+   return _capacity;
+}
+
+
+size_t fctCache::size() const
+{
+   std::lock_guard<std::mutex> guard(_lock);
+   return _lru.size();
+}
+
+
+size_t fctCache::getHits() const
+{
+   std::lock_guard<std::mutex> guard(_lock);
+   return _hits;
+}
+
+
+size_t fctCache::getMisses() const
+{
+   std::lock_guard<std::mutex> guard(_lock);
+   return _misses;
+}
+
+} /* namespace RITA */
@@ -0,0 +1,96 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                         Definition of class 'fctCache'
+
+  ==============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "io/Fct.h"
+
+using std::string;
+using std::vector;
+
+namespace RITA {
+
+/*! \class fctCache
+ *  \brief Process-wide cache of compiled functions.
+ *
+ *  Functions are keyed by their expression and their list of variables, so that
+ *  setting up the same expression again (boundary conditions at each time step,
+ *  error evaluation for each component, ...) returns the already compiled
+ *  function instead of parsing the expression again. The least recently used
+ *  functions are dropped when the cache holds more than its capacity.
+ *  A function returned by the cache may be shared by several callers: it must be
+ *  evaluated by one thread at a time and must not be redefined with \c set.
+ *
+ * \author Rachid Touzani
+ * \copyright GNU Public License
+ */
+
+class fctCache
+{
+
+ public:
+
+/// \brief Return the cache of the process
+    static fctCache& get();
+
+/// \brief Return function of expression \c exp with variables \c var
+/// \details If \c var is empty, the default variables of OFELI::Fct are used.
+/// Return nullptr if the expression cannot be compiled.
+    std::shared_ptr<OFELI::Fct> fct(const string& exp, const vector<string>& var);
+
+/// \brief Set maximal number of cached functions, 0 disables caching
+    void setCapacity(size_t n);
+
+/// \brief Remove all functions from the cache
+    void clear();
+
+    size_t getCapacity() const;
+    size_t size() const;
+    size_t getHits() const;
+    size_t getMisses() const;
+
+ private:
+
+    fctCache();
+    void trim();
+
+    typedef std::pair<string,std::shared_ptr<OFELI::Fct> > entry_type;
+    std::list<entry_type> _lru;
+    std::unordered_map<string,std::list<entry_type>::iterator> _map;
+    size_t _capacity, _hits, _misses;
+    mutable std::mutex _lock;
+};
+
+} /* namespace RITA */
@@ -38,12 +38,15 @@ const string H0 = "rita is an interactive application for numerical analysis and
                    "General purpose commands: help or ?, license, set, load, unload, end or <, exit or quit.\n"
                    "Data commands: grid, mesh, vector, matrix, tabulation, function, data, =\n"
                    "Modelling commands: approximation, integration, algebraic, ode, pde, stationary,\n"
-                   "                    transient, optim, eigen, solve\n";
+                   "                    transient, optim, eigen, solve, sweep\n";
 const string H1 =  "rita is an interactive application to solve main numerical analysis problems and in particular\n"
                    "scientific computing problems governed by partial differential equations.\n"
                    "The numerical solution is based on the OFELI library.\n"
                    "rita can be either run interactively by typing a series of commands or by using a shell script file.\n"
                    "The latter option can be chosen either by executing\n   'rita script-file'\n"
+                   "or, for a non interactive run without prompts where output is buffered until exit,\n"
+                   "   'rita --batch script-file'\n"
+                   "which returns a nonzero exit status if a command of the script fails\n"
                    "or once in the rita execution (without argument) by typing\n   'load script-file'\n"
                    "The file script-file must contain all commands to be executed, one on each line.\n\n"
                    "rita execution consists in defining specific modelling problems to solve (partial differential equations,\n" 
@@ -82,7 +85,8 @@ const string H1 =  "rita is an interactive application to solve main numerical a
                    "transient: Set problem to solve as transien (time-dependent)\n"
                    "optim: Define an optimization problem\n"
                    "eigen: Define an eigenvalue problem\n"
-                   "solve: Solve defined problem\n";
+                   "solve: Solve defined problem\n"
+                   "sweep: Run a script for a list or a grid of parameter values\n";
 
 class help
 {
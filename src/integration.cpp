@@ -260,6 +260,7 @@ int integration::go()
       }
    }
    cout << "Approximate Integral: " << res << endl;
+   _rita->_data->integral = res;
    return 0;
 }
 
@@ -0,0 +1,112 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                        Implementation of class 'kwTrie'
+
+  ==============================================================================*/
+
+#include "kwTrie.h"
+#include <map>
+#include <unordered_map>
+
+namespace RITA {
+
+kwTrie::kwTrie(const vector<string>& kw)
+       : _size(kw.size())
+{
+// Build a pointer based tree, then flatten it with sorted edges
+   struct TNode {
+      int exact=-1, prefix=-1;
+      std::map<char,int> child;
+   };
+   vector<TNode> t(1);
+   for (size_t i=0; i<kw.size(); ++i) {
+      size_t n = kw[i].find('$');
+      string stem = kw[i].substr(0,n);
+      int k = 0;
+      for (char c: stem) {
+         auto it = t[k].child.find(c);
+         if (it==t[k].child.end()) {
+            t[k].child[c] = int(t.size());
+            k = int(t.size());
+            t.push_back(TNode());
+         }
+         else
+            k = it->second;
+      }
+      int& m = (n==string::npos) ? t[k].exact : t[k].prefix;
+      if (m<0)
+         m = int(i);
+   }
+   _node.resize(t.size());
+   for (size_t k=0; k<t.size(); ++k) {
+      _node[k].exact = t[k].exact;
+      _node[k].prefix = t[k].prefix;
+      _node[k].first = _c.size();
+      _node[k].nb = t[k].child.size();
+      for (auto const& e: t[k].child)
+         _c.push_back(e.first), _next.push_back(e.second);
+   }
+}
+
+
+int kwTrie::find(const string& s) const
+{
+   int ret=-1;
+   size_t k=0;
+   for (size_t i=0; ; ++i) {
+      const Node& nd = _node[k];
+      if (nd.prefix>=0 && (ret<0 || nd.prefix<ret))
+         ret = nd.prefix;
+      if (i==s.size()) {
+         if (nd.exact>=0 && (ret<0 || nd.exact<ret))
+            ret = nd.exact;
+         break;
+      }
+      size_t j=nd.first, e=nd.first+nd.nb;
+      while (j<e && _c[j]<s[i])
+         j++;
+      if (j==e || _c[j]!=s[i])
+         break;
+      k = _next[j];
+   }
+   return ret;
+}
+
+
+const kwTrie& kwTrie::get(const vector<string>& kw)
+{
+// Tables are identified by their contents: many of them are members of objects,
+// whose addresses may be reused by other tables once the objects are deleted
+   static std::unordered_map<string,kwTrie> tables;
+   string key;
+   for (auto const& w: kw)
+      key += w, key += '\0';
+   auto it = tables.find(key);
+   if (it==tables.end())
+      it = tables.emplace(key,kwTrie(kw)).first;
+   return it->second;
+}
+
+} /* namespace RITA */
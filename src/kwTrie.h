@@ -0,0 +1,87 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                          Definition of class 'kwTrie'
+
+  ==============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace RITA {
+
+/*! \class kwTrie
+ *  \brief Keyword table compiled into a prefix tree.
+ *
+ *  A keyword either matches a token exactly or, when it contains the short-hand
+ *  character '$', matches any token starting with the part of the keyword that
+ *  precedes '$' (e.g. "stat$ionary" matches "stat", "stationary", ...). When
+ *  several keywords match, the one with the smallest index in the table is
+ *  retained, as with a sequential scan of the table.
+ *  A token is matched by a single walk along the tree, so that the cost does not
+ *  depend on the number of keywords.
+ *
+ * \author Rachid Touzani
+ * \copyright GNU Public License
+ */
+
+class kwTrie
+{
+
+ public:
+
+    kwTrie() : _size(0) { }
+    kwTrie(const vector<string>& kw);
+
+/// \brief Return index of the keyword matching \c s, -1 if none
+    int find(const string& s) const;
+
+/// \brief Number of keywords in table
+    size_t size() const { return _size; }
+
+/// \brief Return the tree compiled for table \c kw
+/// \details Tables are compiled at first use and shared by all modules. They are
+/// identified by their contents, so that identical tables of different objects
+/// share the same tree. As this costs a pass over the table, the returned tree is
+/// to be kept while the table is used rather than looked up for each token.
+    static const kwTrie& get(const vector<string>& kw);
+
+ private:
+
+    struct Node {
+       int exact, prefix;
+       size_t first, nb;
+    };
+    vector<Node> _node;
+    vector<char> _c;
+    vector<int> _next;
+    size_t _size;
+};
+
+} /* namespace RITA */
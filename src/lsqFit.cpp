@@ -0,0 +1,385 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                        Implementation of class 'lsqFit'
+
+  ==============================================================================*/
+
+#include "lsqFit.h"
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+namespace RITA {
+
+namespace {
+
+enum { LINEAR, LOG_LINEAR, JACOBIAN, RESIDUAL };
+
+// Solve the symmetric positive definite system a x = b (a is n x n, full storage)
+// by Cholesky factorization. Return 1 if the matrix is not positive definite
+int cholSolve(vector<double> a, vector<double>& b, int n)
+{
+   for (int j=0; j<n; ++j) {
+      double d = a[j*n+j];
+      for (int k=0; k<j; ++k)
+         d -= a[j*n+k]*a[j*n+k];
+      if (d<=1.e-14*std::fabs(a[j*n+j]) || d<=0.)
+         return 1;
+      d = a[j*n+j] = std::sqrt(d);
+      for (int i=j+1; i<n; ++i) {
+         double s = a[i*n+j];
+         for (int k=0; k<j; ++k)
+            s -= a[i*n+k]*a[j*n+k];
+         a[i*n+j] = s/d;
+      }
+   }
+   for (int i=0; i<n; ++i) {
+      for (int k=0; k<i; ++k)
+         b[i] -= a[i*n+k]*b[k];
+      b[i] /= a[i*n+i];
+   }
+   for (int i=n-1; i>=0; --i) {
+      for (int k=i+1; k<n; ++k)
+         b[i] -= a[k*n+i]*b[k];
+      b[i] /= a[i*n+i];
+   }
+   return 0;
+}
+
+
+// Values phi[0..m-1] of Legendre polynomials at s
+void legendre(double s, int m, double *phi)
+{
+   phi[0] = 1.;
+   if (m>1)
+      phi[1] = s;
+   for (int k=1; k<m-1; ++k)
+      phi[k+1] = ((2*k+1)*s*phi[k] - k*phi[k-1])/(k+1);
+}
+
+
+// Sum of p[k]*P_k(s) by Clenshaw's recurrence
+double legendreSum(const vector<double>& p, double s)
+{
+   double b1=0., b2=0.;
+   for (int k=int(p.size())-1; k>=1; --k) {
+      double b = p[k] + (2*k+1)*s*b1/(k+1) - (k+1)*b2/(k+2);
+      b2 = b1, b1 = b;
+   }
+   return p[0] + s*b1 - 0.5*b2;
+}
+
+} /* namespace */
+
+
+lsqFit::lsqFit()
+       : _model(POLYNOMIAL), _deg(1), _nb_threads(0), _max_it(100), _it(0), _chunk(65536),
+         _n(0), _tol(1.e-10), _x0(0.), _xs(1.), _rms(0.), _r2(0.), _time(0.)
+{
+}
+
+
+int lsqFit::setPolynomial(int d)
+{
+   if (d<0)
+      return 1;
+   _model = POLYNOMIAL;
+   _deg = d;
+   _par.clear();
+   _p.assign(d+1,0.);
+   return 0;
+}
+
+
+int lsqFit::setExponential()
+{
+   _model = EXPONENTIAL;
+   _expr = "a*exp(b*x)";
+   _par = {"a","b"};
+   _p.assign(2,0.);
+   return _f.set(_expr,{"x","a","b"});
+}
+
+
+int lsqFit::setModel(const string&         expr,
+                     const vector<string>& par,
+                     const vector<double>& init)
+{
+   if (par.size()==0 || init.size()!=par.size())
+      return 1;
+   _model = DEFINED;
+   _expr = expr;
+   _par = par;
+   _p = init;
+   vector<string> var {"x"};
+   var.insert(var.end(),par.begin(),par.end());
+   return _f.set(expr,var);
+}
+
+
+// Accumulate over all samples, for parameters p:
+//  LINEAR:     normal equations of polynomial fitting in the Legendre basis of the
+//              scaled variable
+//  LOG_LINEAR: normal equations of linear fitting of log|y| in the scaled variable
+//  JACOBIAN:   Gauss-Newton system J^T J, J^T r of model
+//  RESIDUAL:   sum of squared residuals of model, sums of deviations of samples
+//              from ym and of their squares
+int lsqFit::pass(int                   mode,
+                 const vector<double>& p,
+                 const Source&         src,
+                 Acc&                  a,
+                 double                ym) const
+{
+   int m = (mode==LINEAR) ? _deg+1 : (mode==LOG_LINEAR) ? 2 : int(p.size());
+   size_t nc = (_n+_chunk-1)/_chunk;
+   int nt = (_nb_threads>0) ? _nb_threads : std::max(1,int(std::thread::hardware_concurrency()));
+   nt = int(std::min(size_t(nt),std::max(nc,size_t(1))));
+   vector<Acc> acc(nt);
+
+   auto work = [&](int t) {
+      Acc &c = acc[t];
+      c.G.assign(m*m,0.), c.b.assign(m,0.);
+      c.ssr = c.sy = c.syy = 0., c.n = 0;
+      vector<double> x(_chunk), y(_chunk), phi(m), v(m+1), g(m+1);
+      exprAD f;
+      if (mode>=JACOBIAN && _model!=POLYNOMIAL) {
+         f = _f;
+         std::copy(p.begin(),p.end(),v.begin()+1);
+      }
+      for (size_t k=t; k<nc; k+=nt) {
+         size_t first=k*_chunk, len=std::min(_chunk,_n-first);
+         src(first,len,x.data(),y.data());
+         for (size_t i=0; i<len; ++i) {
+            double yy=y[i], r=0.;
+            if (mode==LINEAR)
+               legendre((x[i]-_x0)/_xs,m,phi.data());
+            else if (mode==LOG_LINEAR) {
+               if (yy==0.)
+                  continue;
+               phi[0] = 1., phi[1] = (x[i]-_x0)/_xs;
+               yy = std::log(std::fabs(yy));
+            }
+            else {
+               v[0] = x[i];
+               if (mode==RESIDUAL) {
+                  if (_model==POLYNOMIAL)
+                     r = legendreSum(p,(x[i]-_x0)/_xs) - yy;
+                  else
+                     r = f(v.data()) - yy;
+                  c.ssr += r*r;
+                  c.sy += yy-ym, c.syy += (yy-ym)*(yy-ym), c.n++;
+                  continue;
+               }
+               r = f.gradient(v.data(),g.data()) - yy;
+               std::copy(g.begin()+1,g.end(),phi.begin());
+               c.ssr += r*r;
+               yy = -r;
+            }
+            for (int j=0; j<m; ++j) {
+               c.b[j] += phi[j]*yy;
+               for (int l=0; l<=j; ++l)
+                  c.G[j*m+l] += phi[j]*phi[l];
+            }
+            c.sy += y[i], c.syy += y[i]*y[i], c.n++;
+         }
+      }
+   };
+   vector<std::thread> th;
+   for (int t=1; t<nt; ++t)
+      th.push_back(std::thread(work,t));
+   work(0);
+   for (auto& t: th)
+      t.join();
+
+   a = acc[0];
+   for (int t=1; t<nt; ++t) {
+      for (int j=0; j<m*m; ++j)
+         a.G[j] += acc[t].G[j];
+      for (int j=0; j<m; ++j)
+         a.b[j] += acc[t].b[j];
+      a.ssr += acc[t].ssr, a.sy += acc[t].sy, a.syy += acc[t].syy, a.n += acc[t].n;
+   }
+   for (int j=0; j<m; ++j) {
+      for (int l=j+1; l<m; ++l)
+         a.G[j*m+l] = a.G[l*m+j];
+   }
+   return m;
+}
+
+
+int lsqFit::solveLM(const Source& src)
+{
+   Acc a, r;
+   int m = int(_p.size());
+   double lambda = 1.e-3;
+   pass(JACOBIAN,_p,src,a);
+   for (_it=1; _it<=_max_it; ++_it) {
+      vector<double> d, q(m);
+      double ssr = a.ssr;
+      while (1) {
+         vector<double> A(a.G);
+         for (int j=0; j<m; ++j)
+            A[j*m+j] += lambda*std::max(a.G[j*m+j],1.e-12);
+         d = a.b;
+         if (!cholSolve(A,d,m)) {
+            for (int j=0; j<m; ++j)
+               q[j] = _p[j] + d[j];
+            pass(RESIDUAL,q,src,r);
+            if (r.ssr<=ssr)
+               break;
+         }
+         lambda *= 10.;
+         if (lambda>1.e16)
+            return 2;
+      }
+      lambda = std::max(0.1*lambda,1.e-12);
+      double dn=0., pn=0.;
+      for (int j=0; j<m; ++j)
+         dn += d[j]*d[j], pn += q[j]*q[j];
+      _p = q;
+      pass(JACOBIAN,_p,src,a);
+      if (std::sqrt(dn)<=_tol*(std::sqrt(pn)+_tol) || ssr-r.ssr<=_tol*ssr)
+         break;
+   }
+   return (_it>_max_it) ? 1 : 0;
+}
+
+
+int lsqFit::run(size_t        n,
+                const Source& src,
+                double        xmin,
+                double        xmax)
+{
+   auto t0 = std::chrono::steady_clock::now();
+   _n = n;
+   _it = 0;
+   if (n==0)
+      return 2;
+   _x0 = 0.5*(xmin+xmax);
+   _xs = (xmax>xmin) ? 0.5*(xmax-xmin) : 1.;
+   int ret = 0;
+   Acc a;
+   if (_model==POLYNOMIAL) {
+      int m = pass(LINEAR,_p,src,a);
+      _p = a.b;
+      if (size_t(m)>n || cholSolve(a.G,_p,m))
+         ret = 2;
+      _it = 1;
+   }
+   else {
+
+//    Initial guess of exponential model by linear fitting of log|y|
+      if (_model==EXPONENTIAL) {
+         pass(LOG_LINEAR,_p,src,a);
+         vector<double> c(a.b);
+         if (a.n>=2 && !cholSolve(a.G,c,2))
+            _p[0] = ((a.sy<0.) ? -1. : 1.)*std::exp(c[0]-c[1]*_x0/_xs), _p[1] = c[1]/_xs;
+         else
+            _p[0] = 1., _p[1] = 0.;
+      }
+      ret = solveLM(src);
+   }
+
+// Residuals are summed in a last pass rather than derived from the normal equations,
+// which would lose all digits by cancellation for good fits. Deviations of samples are
+// taken from the first one for the same reason
+   if (ret!=2) {
+      double x, y;
+      src(0,1,&x,&y);
+      pass(RESIDUAL,_p,src,a,y);
+      double sv = a.syy - a.sy*a.sy/n;
+      _rms = std::sqrt(a.ssr/n);
+      _r2 = (sv>0.) ? 1. - a.ssr/sv : 1.;
+   }
+   _time = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+   return ret;
+}
+
+
+double lsqFit::operator()(double x) const
+{
+   if (_model==POLYNOMIAL)
+      return legendreSum(_p,(x-_x0)/_xs);
+   vector<double> v(_p.size()+1);
+   v[0] = x;
+   std::copy(_p.begin(),_p.end(),v.begin()+1);
+   return _f(v.data());
+}
+
+
+void lsqFit::eval(const double* x,
+                  double*       y,
+                  size_t        n) const
+{
+   if (_model==POLYNOMIAL) {
+      for (size_t i=0; i<n; ++i)
+         y[i] = (*this)(x[i]);
+      return;
+   }
+   vector<double> v(_p.size()+1);
+   std::copy(_p.begin(),_p.end(),v.begin()+1);
+   for (size_t i=0; i<n; ++i) {
+      v[0] = x[i];
+      y[i] = _f(v.data());
+   }
+}
+
+
+vector<double> lsqFit::getPolynomial() const
+{
+   if (_model!=POLYNOMIAL)
+      return vector<double>();
+
+// Expand sum_k p_k P_k(s) in powers of s, P_k being computed by the recurrence
+// (k+1) P_{k+1} = (2k+1) s P_k - k P_{k-1}
+   vector<double> q(_deg+1,0.), P0(1,1.), P1 {0.,1.};
+   for (int k=0; k<=_deg; ++k) {
+      for (int j=0; j<=k; ++j)
+         q[j] += _p[k]*P0[j];
+      vector<double> P2(k+3,0.);
+      for (int j=0; j<=k+1; ++j)
+         P2[j+1] += (2*k+3)*P1[j]/(k+2);
+      for (int j=0; j<=k; ++j)
+         P2[j] -= (k+1)*P0[j]/(k+2);
+      P0 = P1, P1 = P2;
+   }
+
+// Expand sum_k q_k ((x-x0)/xs)^k in powers of x
+   vector<double> c(_deg+1,0.), t(1,1.);
+   for (int k=0; k<=_deg; ++k) {
+      for (int j=0; j<=k; ++j)
+         c[j] += q[k]*t[j];
+      vector<double> u(k+2,0.);
+      for (int j=0; j<=k; ++j) {
+         u[j+1] += t[j]/_xs;
+         u[j] -= t[j]*_x0/_xs;
+      }
+      t = u;
+   }
+   return c;
+}
+
+} /* namespace RITA */
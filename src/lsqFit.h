@@ -0,0 +1,135 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                          Definition of class 'lsqFit'
+
+  ==============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include "symDiff.h"
+
+using std::string;
+using std::vector;
+
+namespace RITA {
+
+/*! \class lsqFit
+ *  \brief Least squares fitting of a model to a large set of samples.
+ *
+ *  Samples are read by chunks through a user given function and are never stored:
+ *  each pass over the data accumulates the normal equations (Gram matrix of the
+ *  model derivatives and right-hand side) and the residual statistics. Chunks are
+ *  processed by several threads, each one with its own accumulator; accumulators
+ *  are summed in a fixed order so that results do not depend on scheduling.
+ *  Polynomial models are fitted in one pass in the basis of Legendre polynomials of
+ *  the abscissa scaled to [-1,1], whose Gram matrix stays well conditioned for
+ *  samples spread over the interval, unlike the one of monomials. A last pass sums
+ *  the squared residuals of the fitted model.
+ *  Exponential and user defined models are fitted by the Levenberg-Marquardt method,
+ *  derivatives with respect to parameters being computed by automatic differentiation.
+ *
+ * \author Rachid Touzani
+ * \copyright GNU Public License
+ */
+
+class lsqFit
+{
+
+ public:
+
+    enum Model {
+       POLYNOMIAL,
+       EXPONENTIAL,
+       DEFINED
+    };
+
+/// \brief Function that stores in \c x and \c y the \c n samples starting at \c first
+    typedef std::function<void(size_t first, size_t n, double *x, double *y)> Source;
+
+    lsqFit();
+
+/// \brief Polynomial model of degree \c d
+    int setPolynomial(int d);
+
+/// \brief Model a*exp(b*x)
+    int setExponential();
+
+/// \brief Model given by an expression of \c x and of parameters \c par with initial
+/// values \c init
+/// \return 0 on success, 1 if the expression cannot be differentiated
+    int setModel(const string& expr, const vector<string>& par, const vector<double>& init);
+
+    void setNbThreads(int n) { _nb_threads = n; }
+    void setChunkSize(size_t n) { _chunk = n; }
+    void setMaxIter(int n) { _max_it = n; }
+    void setTolerance(double tol) { _tol = tol; }
+
+/// \brief Fit the model to \c n samples with abscissae in [\c xmin,\c xmax]
+/// \return 0 on success, 1 if the iterations did not converge, 2 if the normal
+/// equations are singular
+    int run(size_t n, const Source& src, double xmin, double xmax);
+
+/// \brief Evaluate fitted model
+    double operator()(double x) const;
+    void eval(const double* x, double* y, size_t n) const;
+
+    Model getModel() const { return _model; }
+    const vector<double>& getParameters() const { return _p; }
+    const vector<string>& getParameterNames() const { return _par; }
+
+/// \brief Coefficients of the fitted polynomial in increasing powers of x
+    vector<double> getPolynomial() const;
+
+    int getNbIter() const { return _it; }
+    size_t getNbSamples() const { return _n; }
+    double getRMS() const { return _rms; }
+    double getR2() const { return _r2; }
+    double getTime() const { return _time; }
+
+ private:
+
+    struct Acc {
+       vector<double> G, b;
+       double ssr, sy, syy;
+       size_t n;
+    };
+
+    Model _model;
+    int _deg, _nb_threads, _max_it, _it;
+    size_t _chunk, _n;
+    double _tol, _x0, _xs, _rms, _r2, _time;
+    string _expr;
+    vector<string> _par;
+    vector<double> _p;
+    mutable exprAD _f;
+    int pass(int mode, const vector<double>& p, const Source& src, Acc& a, double ym=0.) const;
+    int solveLM(const Source& src);
+};
+
+} /* namespace RITA */
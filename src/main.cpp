@@ -54,6 +54,21 @@ using namespace mup;
 
 int main(int argc, char *argv[])
 {
+   bool batch = argc>1 && (string(argv[1])=="-b" || string(argv[1])=="--batch");
+   if (batch) {
+      if (argc<3) {
+         cout << "Input error: Missing script file after " << argv[1] << "." << endl;
+         return 1;
+      }
+      int ret = 0;
+      try {
+         RITA::rita r;
+         if (r.setBatch(string(argv[2])))
+            return 1;
+         ret = r.run();
+      } CATCH_RITA_EXCEPTION
+      return ret;
+   }
    std::time_t t = std::time(0);
    std::tm* now = std::localtime(&t);
    cout << "\n     R I T A     1.0\n";
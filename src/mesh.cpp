@@ -27,6 +27,11 @@
 
 #include <iostream>
 #include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "mesh.h"
 #include "mesh/saveMesh.h"
 #include "rita.h"
@@ -2130,8 +2135,8 @@ void mesh::Read()
    int ret=0;
    ifstream ip;
    string dom_file, file, bamg_file, geo_file, out_file, Cmd, msh_file, fn="";
-   int mesh_ok=0, geo_ok=0, gmsh_ok=0;
-   static const vector<string> kw {"mesh","geo","gmsh"};
+   int mesh_ok=0, geo_ok=0, gmsh_ok=0, binary_ok=0;
+   static const vector<string> kw {"mesh","geo","gmsh","binary"};
    _cmd->set(kw);
    int nb_args = _cmd->getNbArgs();
    for (int i=0; i<nb_args; ++i) {
@@ -2153,6 +2158,11 @@ void mesh::Read()
             gmsh_ok++;
             break;
 
+         case   3:
+            file = _cmd->string_token();
+            binary_ok++;
+            break;
+
          default:
             _rita->msg("mesh>read>","Unknown argument: "+_kw[n]);
             _ret = 1;
@@ -2160,12 +2170,12 @@ void mesh::Read()
       }
    }
    if (nb_args>0) {
-      if (mesh_ok+geo_ok+gmsh_ok==0) {
+      if (mesh_ok+geo_ok+gmsh_ok+binary_ok==0) {
          _rita->msg("mesh>read>","No input file provided.");
          _ret = 1;
          return;
       }
-      if (mesh_ok+geo_ok+gmsh_ok>1) {
+      if (mesh_ok+geo_ok+gmsh_ok+binary_ok>1) {
          _rita->msg("mesh>read>","Only one input file must be provided.");
          _ret = 1;
          return;
@@ -2185,7 +2195,7 @@ void mesh::Read()
             _ret = 1;
             return;
          }
-         _theMesh = new OFELI::Mesh(file);
+         _theMesh = loadMesh(file,OFELI_FF);
          if (_theMesh->getNbNodes()==0) {
             _rita->msg("mesh>read>","Empty mesh");
             _ret = 1;
@@ -2224,13 +2234,25 @@ void mesh::Read()
             _ret = 1;
             return;
          }
-         _theMesh = new OFELI::Mesh;
-         _theMesh->get(file,GMSH);
+         _theMesh = loadMesh(file,GMSH);
          _data->addMesh(_theMesh,"M-"+to_string(_data->nb_meshes+1));
          _generator = 1;
          _generated = true;
          *_rita->ofh << "  gmsh=" << file;
       }
+      else if (binary_ok) {
+         _theMesh = readBinary(file);
+         if (_theMesh==nullptr) {
+            _rita->msg("mesh>read>","File "+file+" is not a valid rita binary mesh file.");
+            _ret = 1;
+            return;
+         }
+         _nb_dof = _theMesh->getNbDOF() / _theMesh->getNbNodes();
+         _data->addMesh(_theMesh,"M-"+to_string(_data->nb_meshes+1));
+         _generator = 1;
+         _generated = true;
+         *_rita->ofh << "  binary=" << file;
+      }
       *_rita->ofh << endl;
    }
    else {
@@ -2255,7 +2277,7 @@ void mesh::Read()
                ip.open(file);
                if (ip.is_open()) {
                   ip.close();
-                  _theMesh = new OFELI::Mesh(file);
+                  _theMesh = loadMesh(file,OFELI_FF);
                   *_rita->ofh << "  read mesh " << file << endl;
                   if (_theMesh->getNbNodes()==0) {
                      _rita->msg("mesh>read>mesh>","Empty mesh");
@@ -2317,8 +2339,7 @@ void mesh::Read()
                      _ret = 1;
                      break;
                   }
-                  _theMesh = new OFELI::Mesh;
-                  _theMesh->get(file,GMSH);
+                  _theMesh = loadMesh(file,GMSH);
                   _data->addMesh(_theMesh,"M-"+to_string(_data->nb_meshes+1));
                   *_rita->ofh << "  read gmsh " << file << endl;
                }
@@ -2327,13 +2348,35 @@ void mesh::Read()
                _ret = 90;
                return;
 
+            case 3:
+               if (_cmd->setNbArg(1,"Give binary mesh file name.")) {
+                  _rita->msg("mesh>read>binary>","Missing binary mesh file name.","",1);
+                  break;
+               }
+               if (_cmd->get(file))
+                  break;
+               _theMesh = readBinary(file);
+               if (_theMesh==nullptr) {
+                  _rita->msg("mesh>read>binary>","File "+file+" is not a valid rita binary mesh file.");
+                  _ret = 1;
+                  break;
+               }
+               *_rita->ofh << "  read binary " << file << endl;
+               _nb_dof = _theMesh->getNbDOF() / _theMesh->getNbNodes();
+               _data->addMesh(_theMesh,"M-"+to_string(_data->nb_meshes+1));
+               _generated = true;
+               _generator = 1;
+               _ret = 90;
+               return;
+
             case 100:
             case 101:
                _cmd->setNbArg(0);
                cout << "\nAvailable Commands\n";
                cout << "mesh     : Read mesh in OFELI mesh file\n";
                cout << "geo      : Read mesh in OFELI mesh file\n";
-               cout << "gmsh     : Read mesh in gmsh file" << endl;
+               cout << "gmsh     : Read mesh in gmsh file\n";
+               cout << "binary   : Read mesh in rita binary mesh file" << endl;
                break;
 
             case 102:
@@ -2370,7 +2413,7 @@ void mesh::Read()
 
             default:
                _rita->msg("mesh>read>","Unknown command "+_cmd->token(),
-                          "Available commands: mesh, geo, gmsh");
+                          "Available commands: mesh, geo, gmsh, binary");
                break;
          }
       }
@@ -2384,10 +2427,12 @@ void mesh::Save()
 {
    string domain_f="rita.dom", geo_f="rita.geo", mesh_f="rita.m", gmsh_f="rita.msh";
    string t="", vtk_f="rita.vtk", gnuplot_f="rita-gpl.dat", matlab_f="rita-matlab.m";
-   string tecplot_f="rita-tecplot.dat";
+   string tecplot_f="rita-tecplot.dat", binary_f="rita.rmb";
    int domain_ok=0, geo_ok=0, mesh_ok=0, gmsh_ok=0, vtk_ok=0, gnuplot_ok=0, matlab_ok=0, tecplot_ok=0;
+   int binary_ok=0;
    _ret = 0;
-   static const vector<string> kw {"domain","geo","mesh","gmsh","vtk","gnuplot","matlab","tecplot"};
+   static const vector<string> kw {"domain","geo","mesh","gmsh","vtk","gnuplot","matlab","tecplot",
+                                   "binary"};
    _cmd->set(kw,_rita->_gkw);
    int nb_args = _cmd->getNbArgs();
    for (int i=0; i<nb_args; ++i) {
@@ -2444,6 +2489,12 @@ void mesh::Save()
             tecplot_ok++;
             break;
 
+         case 8:
+            if ((t=_cmd->string_token())!="")
+               binary_f = t;
+            binary_ok++;
+            break;
+
          case 100:
          case 101:
             _cmd->setNbArg(0);
@@ -2455,7 +2506,8 @@ void mesh::Save()
             cout << "vtk:     Save mesh in vtk format\n";
             cout << "gnuplot: Save mesh in gnuplot format\n";
             cout << "matlab:  Save mesh in matlab format\n";
-            cout << "tecplot: Save mesh in tecplot format\n" << endl;
+            cout << "tecplot: Save mesh in tecplot format\n";
+            cout << "binary:  Save mesh in rita binary format\n" << endl;
             break;
 
          default:
@@ -2464,12 +2516,12 @@ void mesh::Save()
 	    break;
       }
    }
-   if (domain_ok+geo_ok+mesh_ok+gmsh_ok+vtk_ok+gnuplot_ok+matlab_ok+tecplot_ok==0) {
+   if (domain_ok+geo_ok+mesh_ok+gmsh_ok+vtk_ok+gnuplot_ok+matlab_ok+tecplot_ok+binary_ok==0) {
       _rita->msg("mesh>save>","Nothing to save.");
       _ret = 1;
       return;
    }
-   if (mesh_ok+gmsh_ok+vtk_ok+gnuplot_ok+matlab_ok+tecplot_ok>0 && !_generated) {
+   if (mesh_ok+gmsh_ok+vtk_ok+gnuplot_ok+matlab_ok+tecplot_ok+binary_ok>0 && !_generated) {
       _rita->msg("mesh>save>","No generated mesh to be saved");
       _ret = 1;
       return;
@@ -2508,10 +2560,277 @@ void mesh::Save()
       saveMesh(tecplot_f,*_theMesh,TECPLOT);
       *_rita->ofh << "  tecplot=" << tecplot_f;
    }
+   if (binary_ok) {
+      if (saveBinary(binary_f,*_theMesh)) {
+         _rita->msg("mesh>save>","Unable to write binary mesh file: "+binary_f);
+         _ret = 1;
+      }
+      *_rita->ofh << "  binary=" << binary_f;
+   }
    *_rita->ofh << endl;
    return;
 }
 
+
+/*
+ * rita binary mesh file (.rmb)
+ *
+ * The file is a header followed by flat arrays in native byte order, so that it
+ * can be mapped in memory and scanned without any parsing:
+ *   - node coordinates        : double[3*nb_nodes]
+ *   - node codes              : int32[nb_dof*nb_nodes]
+ *   - element shapes, codes   : int32[nb_elements], int32[nb_elements]
+ *   - element connectivity    : int32[nb_elements+1] (offsets), int32[elem_conn]
+ *   - side shapes             : int32[nb_sides]
+ *   - side codes              : int32[nb_dof*nb_sides]
+ *   - side connectivity       : int32[nb_sides+1] (offsets), int32[side_conn]
+ * The field 'hash' contains the hash of the text mesh file the binary file was
+ * generated from (0 if it was directly saved).
+ */
+
+namespace {
+
+const char RMB_MAGIC[8] = {'R','I','T','A','-','R','M','B'};
+const uint32_t RMB_VERSION = 1;
+const uint32_t RMB_ENDIAN = 0x01020304;
+
+struct RMBHeader {
+   char     magic[8];
+   uint32_t version, endian;
+   uint64_t hash;
+   uint32_t dim, nb_dof;
+   uint64_t nb_nodes, nb_elements, nb_sides;
+   uint64_t elem_conn, side_conn;
+};
+
+
+// Check that offsets of n entries are increasing from 0 to nb_conn and that
+// connectivities are node numbers in [1,nb_nodes]
+bool checkConnectivity(const int32_t *ptr,
+                       const int32_t *conn,
+                       size_t         n,
+                       size_t         nb_conn,
+                       size_t         nb_nodes)
+{
+   if (ptr[0]!=0 || size_t(ptr[n])!=nb_conn)
+      return false;
+   for (size_t i=0; i<n; ++i) {
+      if (ptr[i+1]<ptr[i])
+         return false;
+   }
+   for (size_t i=0; i<nb_conn; ++i) {
+      if (conn[i]<1 || size_t(conn[i])>nb_nodes)
+         return false;
+   }
+   return true;
+}
+
+}
+
+
+uint64_t mesh::hashFile(const string& file)
+{
+// 64-bit FNV-1a hash of file contents
+   uint64_t h = 14695981039346656037ULL;
+   int fd = open(file.c_str(),O_RDONLY);
+   if (fd<0)
+      return 0;
+   struct stat st;
+   if (fstat(fd,&st) || st.st_size==0) {
+      close(fd);
+      return 0;
+   }
+   size_t size = st.st_size;
+   void *p = mmap(nullptr,size,PROT_READ,MAP_PRIVATE,fd,0);
+   close(fd);
+   if (p==MAP_FAILED)
+      return 0;
+   const unsigned char *c = static_cast<const unsigned char *>(p);
+   for (size_t i=0; i<size; ++i) {
+      h ^= c[i];
+      h *= 1099511628211ULL;
+   }
+   munmap(p,size);
+   return h;
+}
+
+
+int mesh::saveBinary(const string&  file,
+                     OFELI::Mesh&   ms,
+                     uint64_t       hash)
+{
+   RMBHeader hd;
+   memset(&hd,0,sizeof(hd));
+   memcpy(hd.magic,RMB_MAGIC,8);
+   hd.version = RMB_VERSION;
+   hd.endian = RMB_ENDIAN;
+   hd.hash = hash;
+   hd.dim = ms.getDim();
+   hd.nb_nodes = ms.getNbNodes();
+   hd.nb_elements = ms.getNbElements();
+   hd.nb_sides = ms.getNbSides();
+   hd.nb_dof = (hd.nb_nodes>0) ? (*ms.getPtrNode(1)).getNbDOF() : 1;
+
+   vector<double> x(3*hd.nb_nodes);
+   vector<int32_t> ncode(hd.nb_dof*hd.nb_nodes), eshape, ecode, eptr(1,0), econn;
+   vector<int32_t> sshape, scode, sptr(1,0), sconn;
+   size_t k=0, l=0;
+   node_loop(&ms) {
+      x[k++] = The_node.getX();
+      x[k++] = The_node.getY();
+      x[k++] = The_node.getZ();
+      for (size_t i=1; i<=hd.nb_dof; ++i)
+         ncode[l++] = (i<=The_node.getNbDOF()) ? The_node.getCode(i) : 0;
+   }
+   eshape.reserve(hd.nb_elements), ecode.reserve(hd.nb_elements), eptr.reserve(hd.nb_elements+1);
+   element_loop(&ms) {
+      eshape.push_back(The_element.getShape());
+      ecode.push_back(The_element.getCode());
+      for (size_t i=1; i<=The_element.getNbNodes(); ++i)
+         econn.push_back(The_element(i)->n());
+      eptr.push_back(econn.size());
+   }
+   side_loop(&ms) {
+      sshape.push_back(The_side.getShape());
+      for (size_t i=1; i<=hd.nb_dof; ++i)
+         scode.push_back(The_side.getCode(i));
+      for (size_t i=1; i<=The_side.getNbNodes(); ++i)
+         sconn.push_back(The_side(i)->n());
+      sptr.push_back(sconn.size());
+   }
+   hd.elem_conn = econn.size();
+   hd.side_conn = sconn.size();
+
+   ofstream of(file,std::ios::binary|std::ios::trunc);
+   if (!of.is_open())
+      return 1;
+   of.write(reinterpret_cast<const char *>(&hd),sizeof(hd));
+   of.write(reinterpret_cast<const char *>(x.data()),x.size()*sizeof(double));
+   of.write(reinterpret_cast<const char *>(ncode.data()),ncode.size()*sizeof(int32_t));
+   of.write(reinterpret_cast<const char *>(eshape.data()),eshape.size()*sizeof(int32_t));
+   of.write(reinterpret_cast<const char *>(ecode.data()),ecode.size()*sizeof(int32_t));
+   of.write(reinterpret_cast<const char *>(eptr.data()),eptr.size()*sizeof(int32_t));
+   of.write(reinterpret_cast<const char *>(econn.data()),econn.size()*sizeof(int32_t));
+   of.write(reinterpret_cast<const char *>(sshape.data()),sshape.size()*sizeof(int32_t));
+   of.write(reinterpret_cast<const char *>(scode.data()),scode.size()*sizeof(int32_t));
+   of.write(reinterpret_cast<const char *>(sptr.data()),sptr.size()*sizeof(int32_t));
+   of.write(reinterpret_cast<const char *>(sconn.data()),sconn.size()*sizeof(int32_t));
+   if (!of.good())
+      return 1;
+   if (_verb>1)
+      cout << "Mesh saved in binary file: " << file << endl;
+   return 0;
+}
+
+
+OFELI::Mesh *mesh::readBinary(const string& file,
+                              uint64_t      hash)
+{
+   int fd = open(file.c_str(),O_RDONLY);
+   if (fd<0)
+      return nullptr;
+   struct stat st;
+   if (fstat(fd,&st) || size_t(st.st_size)<sizeof(RMBHeader)) {
+      close(fd);
+      return nullptr;
+   }
+   size_t size = st.st_size;
+   void *p = mmap(nullptr,size,PROT_READ,MAP_PRIVATE,fd,0);
+   close(fd);
+   if (p==MAP_FAILED)
+      return nullptr;
+
+   const char *c = static_cast<const char *>(p);
+   RMBHeader hd;
+   memcpy(&hd,c,sizeof(hd));
+   size_t nd=hd.nb_dof, nn=hd.nb_nodes, ne=hd.nb_elements, ns=hd.nb_sides;
+
+// Counts larger than the file are rejected first so that the expected size cannot overflow
+   if (memcmp(hd.magic,RMB_MAGIC,8) || hd.version!=RMB_VERSION || hd.endian!=RMB_ENDIAN ||
+       (hash && hd.hash!=hash) || nn==0 || nd==0 || nd>size || nn>size || ne>size || ns>size ||
+       hd.elem_conn>size || hd.side_conn>size) {
+      munmap(p,size);
+      return nullptr;
+   }
+   size_t expected = sizeof(hd) + 3*nn*sizeof(double)
+                     + (nd*nn + 2*ne + ne+1 + hd.elem_conn + ns + nd*ns + ns+1 + hd.side_conn)*sizeof(int32_t);
+   if (size!=expected) {
+      munmap(p,size);
+      return nullptr;
+   }
+
+   const double *x = reinterpret_cast<const double *>(c+sizeof(hd));
+   const int32_t *ncode = reinterpret_cast<const int32_t *>(x+3*nn);
+   const int32_t *eshape = ncode + nd*nn;
+   const int32_t *ecode = eshape + ne;
+   const int32_t *eptr = ecode + ne;
+   const int32_t *econn = eptr + ne + 1;
+   const int32_t *sshape = econn + hd.elem_conn;
+   const int32_t *scode = sshape + ns;
+   const int32_t *sptr = scode + nd*ns;
+   const int32_t *sconn = sptr + ns + 1;
+
+// A truncated or corrupted file must not index nodes out of range
+   if (!checkConnectivity(eptr,econn,ne,hd.elem_conn,nn) ||
+       !checkConnectivity(sptr,sconn,ns,hd.side_conn,nn)) {
+      munmap(p,size);
+      return nullptr;
+   }
+
+   OFELI::Mesh *ms = new OFELI::Mesh;
+   ms->setDim(hd.dim);
+   for (size_t n=0; n<nn; ++n) {
+      OFELI::Node *node = new OFELI::Node(n+1,OFELI::Point<double>(x[3*n],x[3*n+1],x[3*n+2]));
+      node->setNbDOF(nd);
+      for (size_t i=0; i<nd; ++i)
+         node->setCode(i+1,ncode[nd*n+i]);
+      ms->Add(node);
+   }
+   for (size_t n=0; n<ne; ++n) {
+      OFELI::Element *el = new OFELI::Element(n+1,eshape[n],ecode[n]);
+      for (int32_t i=eptr[n]; i<eptr[n+1]; ++i)
+         el->Add(ms->getPtrNode(econn[i]));
+      ms->Add(el);
+   }
+   for (size_t n=0; n<ns; ++n) {
+      OFELI::Side *sd = new OFELI::Side(n+1,sshape[n]);
+      for (int32_t i=sptr[n]; i<sptr[n+1]; ++i)
+         sd->Add(ms->getPtrNode(sconn[i]));
+      sd->setNbDOF(nd);
+      for (size_t i=0; i<nd; ++i)
+         sd->setCode(i+1,scode[nd*n+i]);
+      ms->Add(sd);
+   }
+   munmap(p,size);
+   ms->NumberEquations();
+   if (_verb>1)
+      cout << "Mesh read from binary file: " << file << endl;
+   return ms;
+}
+
+
+OFELI::Mesh *mesh::loadMesh(const string& file,
+                            int           ff)
+{
+   OFELI::Mesh *ms = nullptr;
+   uint64_t h = 0;
+   string cache_file = file + ".rmb";
+   if (_configure->getMeshCache()) {
+      h = hashFile(file);
+      if (h && (ms=readBinary(cache_file,h))!=nullptr)
+         return ms;
+   }
+   if (ff==OFELI_FF)
+      ms = new OFELI::Mesh(file);
+   else {
+      ms = new OFELI::Mesh;
+      ms->get(file,ff);
+   }
+   if (h && ms->getNbNodes()>0)
+      saveBinary(cache_file,*ms,h);
+   return ms;
+}
+
  /*
 void mesh::Save()
 {
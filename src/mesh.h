@@ -31,6 +31,7 @@
 
 #include <fstream>
 #include <map>
+#include <cstdint>
 #include "mesh/Mesh.h"
 #include "mesh/Domain.h"
 #include "configure.h"
@@ -109,6 +110,10 @@ class mesh
    void Save();
    void saveGeo(const string& file);
    void setConfigure();
+   OFELI::Mesh *loadMesh(const string& file, int ff);
+   OFELI::Mesh *readBinary(const string& file, uint64_t hash=0);
+   int saveBinary(const string& file, OFELI::Mesh& ms, uint64_t hash=0);
+   static uint64_t hashFile(const string& file);
 };
 
 } /* namespace RITA */
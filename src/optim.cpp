@@ -31,6 +31,7 @@
 #include "configure.h"
 #include "cmd.h"
 #include "data.h"
+#include <sstream>
 
 namespace RITA {
 
@@ -42,7 +43,8 @@ optim::optim(rita*      r,
    _verb = _rita->_verb;
    log = true;
    nb_lec = nb_gec = nb_eqc = 0;
-   G_ok = H_ok = solved = lp = false;
+   nb_starts = 1;
+   G_ok = H_ok = solved = lp = sparse = false;
    penal = 1./OFELI_TOLERANCE;
    _data = _rita->_data;
 }
@@ -53,10 +55,95 @@ optim::~optim()
 }
 
 
+void optim::clearSparse()
+{
+   s_le = s_ge = s_eq = CSR(size);
+   sb_le.clear(), sb_ge.clear(), sb_eq.clear();
+   _sp_hist.clear();
+   sparse = false;
+}
+
+
+int optim::setSparseRow(const string&   kw,
+                        CSR&  A,
+                        vector<double>& b)
+{
+   double x=0.;
+   vector<double> v;
+   while (!_cmd->get(x))
+      v.push_back(x);
+   if (v.size()%2==0) {
+      _rita->msg("optimization>sparse>","Pairs (index,value) and right-hand side to be given.");
+      return 1;
+   }
+   vector<int> col;
+   vector<double> val;
+   std::ostringstream h;
+   h << " " << kw << " ";
+   for (size_t k=0; k<v.size()-1; k+=2) {
+      int j = int(v[k]);
+      if (j<1 || j>size) {
+         _rita->msg("optimization>sparse>","Illegal variable index: "+to_string(j));
+         return 1;
+      }
+      col.push_back(j-1), val.push_back(v[k+1]);
+      h << j << " " << v[k+1] << " ";
+   }
+   if (A.nbRows()==0)
+      A.nb_cols = size;
+   A.addRow(col,val);
+   b.push_back(v.back());
+   h << v.back();
+   _sp_hist.push_back(h.str());
+   sparse = true;
+   return 0;
+}
+
+
+int optim::setSparseMatrix(const string&   kw,
+                           CSR&  A,
+                           vector<double>& b)
+{
+   string mn, vn;
+   if (_cmd->setNbArg(2,"Names of constraint matrix and right-hand side vector to be given.")) {
+      _rita->msg("optimization>matrix>","Missing matrix and vector names.","",1);
+      return 1;
+   }
+   _cmd->get(mn);
+   _cmd->get(vn);
+   int im=_data->checkName(mn,DataType::MATRIX), iv=_data->checkName(vn,DataType::VECTOR);
+   if (im<=0 || iv<=0) {
+      _rita->msg("optimization>matrix>","Undefined matrix "+mn+" or vector "+vn);
+      return 1;
+   }
+   OFELI::Matrix<double> *M = _data->theMatrix[im];
+   OFELI::Vect<double> *v = _data->theVector[iv];
+   int nr=M->getNbRows(), nc=M->getNbColumns();
+   if (nc!=size || int(v->size())!=nr) {
+      _rita->msg("optimization>matrix>","Matrix and vector sizes incompatible with problem size.");
+      return 1;
+   }
+   if (A.nbRows()==0)
+      A.nb_cols = size;
+   vector<double> row(nc);
+   for (int i=1; i<=nr; ++i) {
+      for (int j=1; j<=nc; ++j)
+         row[j-1] = (*M)(i,j);
+      A.addRow(&row[0]);
+      b.push_back((*v)[i-1]);
+   }
+   _sp_hist.push_back(" "+kw+" "+mn+" "+vn);
+   sparse = true;
+   return 0;
+}
+
+
 int optim::run()
 {
    _rita->_analysis_type = OPTIMIZATION;
    size = 1;
+   nb_starts = 1;
+   clearSparse();
    int ret=0, nb_le=0, nb_ge=0, nb_eq=0;
    int count_fct=0, count_obj=0, count_grad=0, count_hess=0, count_init=0, count_lp=0;
    int count_lec=0, count_gec=0, count_eqc=0, count_vector=0, penal_ok=0, nb=0, ind=0, key=0;
@@ -72,7 +159,9 @@ int optim::run()
 
    static const vector<string> kw {"size","func$tion","obj$ective","lp","grad$ient","hess$ian","low$-bound",
                                    "up$-bound","ge$-constraint","le$-constraint","eq$-constraint",
-                                   "penal$ty","var$iable","vect$or","init$ial","algo$rithm","summary","clear"};
+                                   "penal$ty","var$iable","vect$or","init$ial","algo$rithm","summary","clear",
+                                   "parallel-starts","sparse-le","sparse-ge","sparse-eq","le-matrix",
+                                   "ge-matrix","eq-matrix"};
    _cmd->set(kw,_rita->_gkw);
    int nb_args = _cmd->getNbArgs();
    for (int k=0; k<nb_args; ++k) {
@@ -138,11 +227,15 @@ int optim::run()
             method = _cmd->string_token(0);
             break;
 
+         case 18:
+            nb_starts = _cmd->int_token(0);
+            break;
+
          case 100:
          case 101:
             cout << "\nAvailable Commands:\n";
             cout << "size, function, objective, lp, gradient, hessian, low-bound, up-bound, ge-constraint\n";
-            cout << "le-constraint, eq-constraint, penalty, variable, init, algorithm\n";
+            cout << "le-constraint, eq-constraint, penalty, variable, init, algorithm, parallel-starts\n";
             break;
 
          default:
@@ -189,6 +282,11 @@ int optim::run()
          NO_OPT
          return 1;
       }
+      if (nb_starts<1) {
+         _rita->msg("optimization>","Illegal number of parallel starts.");
+         NO_OPT
+         return 1;
+      }
       *_rita->ofh << "optimization";
       if (count_fct>0) {
          ind = _data->checkName(name,DataType::FCT);
@@ -275,6 +373,8 @@ int optim::run()
             *_rita->ofh << "," << init[i+1];
          for (int i=0; i<size; ++i)
             _data->theVector[_data->iVector][i] = init[i];
+         if (nb_starts>1)
+            *_rita->ofh << " parallel-starts=" << nb_starts;
          *_rita->ofh << endl;
       }
       log = false;
@@ -565,9 +665,54 @@ int optim::run()
                _rita->_ret = 0;
                break;
 
+            case  18:
+               if (lp) {
+                  _rita->msg("optimization>parallel-starts>","Argument not necessary for linear programming.");
+                  _ret = 1;
+                  break;
+               }
+               if (_cmd->setNbArg(1,"Number of parallel starts to be given.")) {
+                  _rita->msg("optimization>parallel-starts>","Missing number of parallel starts.","",1);
+                  break;
+               }
+               if (_cmd->get(nb_starts) || nb_starts<1) {
+                  _rita->msg("optimization>parallel-starts>","Illegal number of parallel starts.");
+                  nb_starts = 1;
+                  break;
+               }
+               *_rita->ofh << "  parallel-starts " << nb_starts << endl;
+               _ret = 0;
+               break;
+
+            case  19:
+            case  20:
+            case  21:
+            case  22:
+            case  23:
+            case  24:
+               if (!lp) {
+                  _rita->msg("optimization>sparse>","This argument is valid for linear programming problems only.");
+                  _ret = 1;
+                  break;
+               }
+               if (key==19)
+                  _ret = setSparseRow(kw[key],s_le,sb_le);
+               else if (key==20)
+                  _ret = setSparseRow(kw[key],s_ge,sb_ge);
+               else if (key==21)
+                  _ret = setSparseRow(kw[key],s_eq,sb_eq);
+               else if (key==22)
+                  _ret = setSparseMatrix(kw[key],s_le,sb_le);
+               else if (key==23)
+                  _ret = setSparseMatrix(kw[key],s_ge,sb_ge);
+               else
+                  _ret = setSparseMatrix(kw[key],s_eq,sb_eq);
+               break;
+
             case  17:
                size = 0;
                G_ok = H_ok = 0;
+               clearSparse();
                *_rita->ofh << " clear" << endl;
                cout << "Optimization problem cleared." << endl;
                break;
@@ -580,8 +725,8 @@ int optim::run()
                cout << "function:      Give function (already defined) as objective (cost) function\n";
                cout << "objective:     Give objective (cost) function expression\n";
                cout << "lp:            Define linear programming objective (cost)\n";
-               cout << "gradient:      Define gradient of objective function\n";
-               cout << "hessian:       Define hessian of objective function\n";
+               cout << "gradient:      Define gradient of objective function (computed automatically if not given)\n";
+               cout << "hessian:       Define hessian of objective function (computed automatically if not given)\n";
                cout << "low-bound:     Define a lower bound for a given variable as constraint\n";
                cout << "up-bound:      Define an upper bound for a given variable as constraint\n";
                cout << "ge-constraint: Define a (>=) inequality constraint (for Linear Programming problems only)\n";
@@ -591,6 +736,12 @@ int optim::run()
                cout << "variable:      Variable name as unknown of the optimization problem\n";
                cout << "init:          Initial guess for iterations\n";
                cout << "algorithm:     Set optimization algorithm\n";
+               cout << "parallel-starts: Number of solver runs from Latin hypercube initial guesses\n";
+               cout << "               in the bounds, run concurrently. The best result is retained\n";
+               cout << "sparse-le:     Sparse (<=) constraint for linear programming: pairs (index,value)\n";
+               cout << "               followed by the right-hand side. Also sparse-ge, sparse-eq\n";
+               cout << "le-matrix:     Constraints (<=) for linear programming given by a matrix and a\n";
+               cout << "               right-hand side vector. Also ge-matrix, eq-matrix\n";
                cout << "summary:       Summary of optimization problem attributes\n";
                cout << "clear:         Clear optimization problem settings" << endl;
                break;
@@ -655,6 +806,8 @@ int optim::run()
                         *_rita->ofh << (*a_ge[i])[j] << " ";
                      *_rita->ofh << b_ge[i] << endl;
                   }
+                  for (const auto& h: _sp_hist)
+                     *_rita->ofh << h << endl;
                }
                else {
                   if (!count_obj && !count_fct) {
@@ -802,7 +955,8 @@ int optim::run()
                _rita->msg("optimization>","Unknown Command "+_cmd->token(),
                           "Available commands: size, objective, lp, gradient, hessian, low-bound, up-bound\n"
 	                       "                    ineq-constraint, eq-constraint, penalty, variable, init, algorithm\n"
-	                       "                    summary, clear");
+	                       "                    parallel-starts, sparse-le, sparse-ge, sparse-eq, le-matrix,\n"
+	                       "                    ge-matrix, eq-matrix, summary, clear");
                break;
          }
       }
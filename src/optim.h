@@ -32,6 +32,7 @@
 #include "rita.h"
 #include "solve.h"
 #include "io/Fct.h"
+#include "sparseLP.h"
 #include <map>
 
 namespace RITA {
@@ -47,14 +48,16 @@ class optim
     int set();
     int run();
     OFELI::OptSolver::OptMethod Alg;
-    int size, nb_eqc, nb_lec, nb_gec, igrad, ihess, iincons, ieqcons, verbose;
+    int size, nb_eqc, nb_lec, nb_gec, igrad, ihess, iincons, ieqcons, verbose, nb_starts;
     OFELI::Fct *J_Fct;
-    bool G_ok, H_ok, log, solved, lp;
+    bool G_ok, H_ok, log, solved, lp, sparse;
     double penal, b, obj;
     vector<OFELI::Fct *> G_Fct, H_Fct, inC_Fct, eqC_Fct;
     vector<double> init;
     vector<OFELI::Vect<double> *> a_le, a_ge, a_eq;
     OFELI::Vect<double> lb, ub, a, b_eq, b_ge, b_le;
+    CSR s_le, s_ge, s_eq;
+    vector<double> sb_le, sb_ge, sb_eq;
     void print(ostream& s) const;
 
  private:
@@ -65,6 +68,11 @@ class optim
     configure *_configure;
     cmd *_cmd;
     data *_data;
+    vector<string> _sp_hist;
+
+    int setSparseRow(const string& kw, CSR& A, vector<double>& b);
+    int setSparseMatrix(const string& kw, CSR& A, vector<double>& b);
+    void clearSparse();
 
     map<string,OFELI::OptSolver::OptMethod> Nopt = {{"gradient",OFELI::OptSolver::GRADIENT},
                                                     {"truncated-newton",OFELI::OptSolver::TRUNCATED_NEWTON},
@@ -0,0 +1,255 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                       Implementation of class 'profiler'
+
+  ==============================================================================*/
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include "profiler.h"
+
+namespace RITA {
+
+// Trace events kept at most, about 32 bytes each
+static const size_t max_events = 1000000;
+
+
+static string json_string(const string& s)
+{
+   string r = "\"";
+   for (char c: s) {
+      if (c=='"' || c=='\\')
+         r += '\\', r += c;
+      else if (c=='\n')
+         r += "\\n";
+      else if (c>=0 && c<' ')
+         r += ' ';
+      else
+         r += c;
+   }
+   return r + "\"";
+}
+
+
+profiler::profiler()
+         : _level(0), _start(Clock::now()), _dropped(0)
+{
+}
+
+
+profiler& profiler::get()
+{
+   static profiler prof;
+   return prof;
+}
+
+
+void profiler::setLevel(int level)
+{
+   clear();
+   _level.store(level<0 ? 0 : level,std::memory_order_relaxed);
+}
+
+
+void profiler::clear()
+{
+   std::lock_guard<std::mutex> guard(_lock);
+   _timer.clear(), _counter.clear(), _event.clear();
+   _timer_id.clear(), _counter_id.clear();
+   _dropped = 0;
+   _start = Clock::now();
+}
+
+
+int profiler::thread()
+{
+   auto it = _tid.find(std::this_thread::get_id());
+   if (it!=_tid.end())
+      return it->second;
+   int n = int(_tid.size()) + 1;
+   _tid[std::this_thread::get_id()] = n;
+   return n;
+}
+
+
+void profiler::count(const string& name,
+                     double        v)
+{
+   if (getLevel()==0)
+      return;
+   std::lock_guard<std::mutex> guard(_lock);
+   auto it = _counter_id.find(name);
+   if (it==_counter_id.end()) {
+      _counter_id[name] = _counter.size();
+      _counter.push_back(Counter {name,v});
+   }
+   else
+      _counter[it->second].value += v;
+}
+
+
+void profiler::add(const string&     name,
+                   Clock::time_point t0,
+                   Clock::time_point t1)
+{
+   int level = getLevel();
+   if (level==0)
+      return;
+   double dt = std::chrono::duration<double>(t1-t0).count();
+   std::lock_guard<std::mutex> guard(_lock);
+   size_t k;
+   auto it = _timer_id.find(name);
+   if (it==_timer_id.end()) {
+      k = _timer_id[name] = _timer.size();
+      _timer.push_back(Timer {name,0,0.,std::numeric_limits<double>::max(),0.});
+   }
+   else
+      k = it->second;
+   Timer &tm = _timer[k];
+   tm.calls++;
+   tm.total += dt;
+   tm.min = std::min(tm.min,dt);
+   tm.max = std::max(tm.max,dt);
+   if (level>1) {
+      if (_event.size()<max_events)
+         _event.push_back(Event {k,thread(),1.e6*std::chrono::duration<double>(t0-_start).count(),1.e6*dt});
+      else
+         _dropped++;
+   }
+}
+
+
+void profiler::report(std::ostream& s) const
+{
+   std::lock_guard<std::mutex> guard(_lock);
+   double wall = std::chrono::duration<double>(Clock::now()-_start).count();
+   size_t w = 8;
+   for (const auto& t: _timer)
+      w = std::max(w,t.name.size()+2);
+   for (const auto& c: _counter)
+      w = std::max(w,c.name.size()+2);
+   std::ios_base::fmtflags f = s.flags();
+   std::streamsize p = s.precision();
+   s << "Profile of session, wall time: " << wall << " s" << std::endl;
+   s << string(w+52,'-') << std::endl;
+   if (_timer.size()) {
+      s << std::left << std::setw(w) << "Timer" << std::right << std::setw(10) << "Calls"
+        << std::setw(14) << "Total (s)" << std::setw(14) << "Mean (ms)" << std::setw(14) << "Max (ms)" << std::endl;
+      s << std::fixed;
+      for (const auto& t: _timer)
+         s << std::left << std::setw(w) << t.name << std::right << std::setw(10) << t.calls
+           << std::setprecision(4) << std::setw(14) << t.total << std::setprecision(3)
+           << std::setw(14) << 1.e3*t.total/t.calls << std::setw(14) << 1.e3*t.max << std::endl;
+      s.flags(f);
+   }
+   if (_counter.size()) {
+      s << std::left << std::setw(w) << "Counter" << std::right << std::setw(10) << "Value" << std::endl;
+      s << std::setprecision(15);
+      for (const auto& c: _counter)
+         s << std::left << std::setw(w) << c.name << std::right << std::setw(10) << c.value << std::endl;
+   }
+   if (_dropped)
+      s << _dropped << " trace events not recorded (limit: " << max_events << ")" << std::endl;
+   s << string(w+52,'-') << std::endl;
+   s.flags(f);
+   s.precision(p);
+}
+
+
+int profiler::saveJSON(const string& file) const
+{
+   std::ofstream s(file);
+   if (!s.is_open())
+      return 1;
+   std::lock_guard<std::mutex> guard(_lock);
+   s << std::setprecision(12);
+   s << "{\n  \"wall\": " << std::chrono::duration<double>(Clock::now()-_start).count() << ",\n";
+   s << "  \"timers\": [";
+   for (size_t i=0; i<_timer.size(); ++i) {
+      const Timer &t = _timer[i];
+      s << (i ? ",\n" : "\n") << "    {\"name\": " << json_string(t.name) << ", \"calls\": " << t.calls
+        << ", \"total\": " << t.total << ", \"min\": " << t.min << ", \"max\": " << t.max << "}";
+   }
+   s << "\n  ],\n  \"counters\": [";
+   for (size_t i=0; i<_counter.size(); ++i)
+      s << (i ? ",\n" : "\n") << "    {\"name\": " << json_string(_counter[i].name)
+        << ", \"value\": " << _counter[i].value << "}";
+   s << "\n  ]\n}" << std::endl;
+   return s.fail() ? 1 : 0;
+}
+
+
+int profiler::saveTrace(const string& file) const
+{
+   std::ofstream s(file);
+   if (!s.is_open())
+      return 1;
+   std::lock_guard<std::mutex> guard(_lock);
+   s << std::setprecision(12);
+   s << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+   s << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"rita\"}}";
+   for (const auto& e: _event)
+      s << ",\n{\"name\": " << json_string(_timer[e.timer].name) << ", \"cat\": "
+        << json_string(_timer[e.timer].name.substr(0,_timer[e.timer].name.find(':')))
+        << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.tid << ", \"ts\": " << e.ts << ", \"dur\": " << e.dur << "}";
+
+// Counters are given with their final values
+   double ts = 1.e6*std::chrono::duration<double>(Clock::now()-_start).count();
+   for (const auto& c: _counter)
+      s << ",\n{\"name\": " << json_string(c.name) << ", \"ph\": \"C\", \"pid\": 1, \"ts\": " << ts
+        << ", \"args\": {\"value\": " << c.value << "}}";
+   s << "\n]}" << std::endl;
+   return s.fail() ? 1 : 0;
+}
+
+
+profiler::scope::scope(const string& name)
+                : _on(profiler::get().getLevel()>0)
+{
+   if (_on) {
+      _name = name;
+      _t0 = Clock::now();
+   }
+}
+
+
+profiler::scope::~scope()
+{
+   if (_on)
+      profiler::get().add(_name,_t0,Clock::now());
+}
+
+
+profiler::output::~output()
+{
+   if (profiler::get().getLevel()==0)
+      return;
+   std::ifstream f(_file,std::ios::binary|std::ios::ate);
+   if (f.is_open())
+      profiler::get().count("output:bytes-written",double(f.tellg()));
+}
+
+} /* namespace RITA */
@@ -0,0 +1,153 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                         Definition of class 'profiler'
+
+  ==============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+using std::string;
+using std::vector;
+
+namespace RITA {
+
+/*! \class profiler
+ *  \brief Process-wide timers and counters.
+ *
+ *  Timers accumulate the time spent in named phases (time steps, boundary
+ *  condition fills, linear solves, output, ...), counters accumulate named
+ *  quantities (Newton iterations, function evaluations, bytes written, ...).
+ *  Names are of the form "module:phase", per-equation phases carry the equation
+ *  number (e.g. "pde-1:solve"). Nothing is recorded at level 0, level 1 records
+ *  timers and counters, level 2 also keeps every timed interval as a trace
+ *  event. Results are printed as a table and can be saved in JSON format or as a
+ *  Chrome trace (chrome://tracing, Perfetto) for flame views.
+ *
+ * \author Rachid Touzani
+ * \copyright GNU Public License
+ */
+
+class profiler
+{
+
+ public:
+
+    typedef std::chrono::steady_clock Clock;
+
+/// \brief Return the profiler of the process
+    static profiler& get();
+
+/// \brief Set profiling level: 0 (none), 1 (timers and counters), 2 (also trace events)
+/// \details Changing the level clears recorded data.
+    void setLevel(int level);
+
+    int getLevel() const { return _level.load(std::memory_order_relaxed); }
+
+/// \brief Add value \c v to counter \c name
+    void count(const string& name, double v=1.);
+
+/// \brief Add interval [<tt>t0</tt>,<tt>t1</tt>] to timer \c name
+    void add(const string& name, Clock::time_point t0, Clock::time_point t1);
+
+/// \brief Remove all recorded data
+    void clear();
+
+/// \brief Print timers and counters as a table
+    void report(std::ostream& s) const;
+
+/// \brief Save timers and counters in JSON format
+    int saveJSON(const string& file) const;
+
+/// \brief Save trace events (level 2) and counters in Chrome trace format
+    int saveTrace(const string& file) const;
+
+/*! \class scope
+ *  \brief Timer of the enclosing block
+ */
+    class scope
+    {
+     public:
+       scope(const string& name);
+       ~scope();
+     private:
+       string _name;
+       Clock::time_point _t0;
+       bool _on;
+    };
+
+/*! \class output
+ *  \brief Counter of the bytes of a file written in the enclosing block
+ */
+    class output
+    {
+     public:
+       output(const string& file) : _file(file) { }
+       ~output();
+     private:
+       string _file;
+    };
+
+ private:
+
+    profiler();
+    int thread();
+
+    struct Timer {
+       string name;
+       size_t calls;
+       double total, min, max;
+    };
+    struct Counter {
+       string name;
+       double value;
+    };
+    struct Event {
+       size_t timer;
+       int tid;
+       double ts, dur;
+    };
+
+    std::atomic<int> _level;
+    Clock::time_point _start;
+    vector<Timer> _timer;
+    vector<Counter> _counter;
+    vector<Event> _event;
+    std::unordered_map<string,size_t> _timer_id, _counter_id;
+    std::map<std::thread::id,int> _tid;
+    size_t _dropped;
+    mutable std::mutex _lock;
+};
+
+} /* namespace RITA */
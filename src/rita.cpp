@@ -29,6 +29,7 @@
 
 #include <fstream>
 #include <ctime>
+#include <algorithm>
 
 #include "rita.h"
 #include "data.h"
@@ -41,7 +42,9 @@
 #include "eigen.h"
 #include "integration.h"
 #include "approximation.h"
+#include "sweep.h"
 #include "configure.h"
+#include "profiler.h"
 
 using std::cout;
 using std::exception;
@@ -59,8 +62,8 @@ const string currentDateTime() {
 namespace RITA {
 
 rita::rita()
-     : meshOK(false), solveOK(false), dataOK(false), _load(false), _ae(nullptr),
-       _script_file(""), _in(nullptr), _verb(1), _ret(0),
+     : meshOK(false), solveOK(false), dataOK(false), _load(false), _ae(nullptr), _pde(nullptr),
+       _script_file(""), _in(nullptr), _verb(1), _ret(0), _err_line(0),
        _default_vector(true), _analysis_type(NONE)
 {
    _cmd = new cmd(this);
@@ -77,6 +80,7 @@ rita::rita()
    _integration = new integration(this,_cmd,_configure);
    _approx = new approximation(this,_cmd,_configure);
    _eigen = new eigen(this,_cmd,_configure);
+   _sweep = new sweep(this,_cmd,_configure);
    _init_time = 0.;
    _final_time = 1.;
    _time_step = 0.1;
@@ -87,6 +91,12 @@ rita::rita()
 
 rita::~rita()
 {
+   flush();
+   std::ostream* os[3] = {&cout, ofh, ofl};
+   for (size_t i=0; i<_obuf.size(); ++i) {
+      os[i]->rdbuf(_obuf[i]->target());
+      delete _obuf[i];
+   }
    if (_in!=nullptr)
       delete _in;
    delete _cmd;
@@ -96,6 +106,7 @@ rita::~rita()
    delete _solve;
    delete _optim;
    delete _integration;
+   delete _sweep;
    delete _help;
    delete _configure;
    if (_ae!=nullptr)
@@ -114,13 +125,40 @@ void rita::setInput(string file,
 }
 
 
+int rita::setBatch(string file)
+{
+   if (_cmd->setBatch(file)) {
+      msg("batch>","Unable to open file: "+file);
+      return 1;
+   }
+
+// History, log and standard output are written block-wise until exit
+   std::ostream* os[3] = {&cout, ofh, ofl};
+   for (auto s: os) {
+      _obuf.push_back(new batchBuffer(s->rdbuf()));
+      s->rdbuf(_obuf.back());
+   }
+   return 0;
+}
+
+
+void rita::flush()
+{
+   for (auto b: _obuf)
+      b->flush();
+}
+
+
 int rita::run()
 {
    int key=0;
    string fn="", td="";
    for (;;) {
 
-      if (_cmd->readline(sPrompt+" ")<0)
+      int r = _cmd->readline(sPrompt+" ");
+      if (r==-5 && (_sweep->child() || _cmd->isBatch()))
+         finish();
+      if (r<0)
          continue;
       _nb_args = _cmd->getNbArgs();
       key = _cmd->getKW(_rita_kw,_gkw,_data_kw);
@@ -200,6 +238,10 @@ int rita::run()
             setClear();
             break;
 
+         case  13:
+            setSweep();
+            break;
+
          case 100:
             _help->run(0);
             break;
@@ -235,7 +277,23 @@ int rita::run()
 void rita::finish()
 {
    *ofh << "exit" << endl;
-   exit(0);
+   _sweep->send();
+
+// Profile of the session, not for runs of a sweep
+   profiler &prof = profiler::get();
+   if (prof.getLevel() && !_sweep->child()) {
+      prof.report(cout);
+      string file = _configure->getProfileJSON();
+      if (file!="" && prof.saveJSON(file))
+         msg("","Unable to write profile in file: "+file);
+      file = _configure->getProfileTrace();
+      if (file!="" && prof.saveTrace(file))
+         msg("","Unable to write profile trace in file: "+file);
+   }
+   if (_err_line)
+      cout << "Batch run: first error in line " << _err_line << " of script." << endl;
+   flush();
+   exit(_err_line ? 1 : 0);
 }
 
 
@@ -340,7 +398,8 @@ void rita::setTransient()
                            "   RK4 (Runge-Kutta, 4th Order), RK3-TVD (Runge-Kutta, 3rd order, TVD), BDF2 (Backward Difference\n"
                            "   Formula, 2nd Order), builtin (Any scheme built in the chosen PDE). The default value for this\n"
                            "   argument is backward-euler\n"
-                           "adapted: Toggle to choose (or not) adaptive time stepping.\n";
+                           "adapted: Toggle to choose (or not) adaptive time stepping. ODEs are then integrated with\n"
+                           "   error control by the RK45 scheme, or by the BDF scheme if the chosen scheme is implicit.\n";
    static const vector<string> kw_scheme {"forward-euler","backward-euler","crank-nicolson","heun","newmark",
                                           "leap-frog","AB2","RK4","RK3-TVD","BDF2","builtin"};
    static const vector<string> kw {"initial$-time","final$-time","time$-step","adapted","scheme","save-every"};
@@ -600,6 +659,13 @@ void rita::setApproximation()
 }
 
 
+void rita::setSweep()
+{
+   if (!_sweep->run())
+      _sweep->go();
+}
+
+
 void rita::setIntegration()
 {
    if (!_integration->run())
@@ -667,6 +733,19 @@ void rita::msg(const string& loc, const string& m1, const string& m2, int c)
          cout << m2 << endl;
    }
    *ofl << "In " + sPrompt+loc + ": " << m1 << endl;
+   error();
+}
+
+
+void rita::error()
+{
+// In batch mode, the first error gives the exit code and output written so far
+// is flushed so that messages are not held back until exit
+   if (!_cmd->isBatch())
+      return;
+   if (_err_line==0)
+      _err_line = std::max(1,_cmd->getScriptLineNb());
+   flush();
 }
 
 } /* namespace RITA */
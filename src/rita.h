@@ -59,6 +59,7 @@ namespace RITA {
  */
 
 class cmd;
+class batchBuffer;
 //class data;
 class calc;
 class configure;
@@ -72,6 +73,7 @@ class help;
 class solve;
 class mesh;
 class equa;
+class sweep;
 
 #define CATCH                                                   \
    catch(ritaException &e) {                                    \
@@ -117,7 +119,11 @@ class rita
     int run();
     void setVerbose(int verb) { _verb = verb; }
     void setInput(string file, int opt=1);
+    int setBatch(string file);
+    void flush();
+    void error();
     void initConfig();
+    data *getData() const { return _data; }
     bool meshOK, solveOK, dataOK;
     ofstream *ofh, *ofl, ocf;
     void finish();
@@ -134,6 +140,7 @@ class rita
     friend class data;
     friend class calc;
     friend class equa;
+    friend class sweep;
 
  private:
 
@@ -145,7 +152,7 @@ class rita
    string _script_file, _scheme, _sLine;
    ifstream _icf, *_in;
    cmd *_cmd;
-   int _verb, _ret, _opt;
+   int _verb, _ret, _opt, _err_line;
    mesh *_mesh;
    help *_help;
    configure *_configure;
@@ -156,6 +163,8 @@ class rita
    eigen *_eigen;
    approximation *_approx;
    integration *_integration;
+   sweep *_sweep;
+   vector<batchBuffer*> _obuf;
    double _init_time, _time_step, _final_time;
    int _adapted_time_step, _nb_eigv, _nb_args;
    bool _eigen_vectors, _default_vector;
@@ -167,6 +176,10 @@ class rita
    void set(data *d) { _data = d; }
    int runAE();
    int runODE();
+   int setAdaptive(odae* ode, string& scheme, double atol, double rtol, const string& steps);
+   void setJacobian(odae* ode, const vector<string>& jac);
+   int addCoupling(const vector<string>& def, const vector<string>& coupled, vector<string>& var,
+                   const string& prompt);
    int runPDE();
 
    void getLicense();
@@ -179,6 +192,7 @@ class rita
    void setOptim();
    void setApproximation();
    void setIntegration();
+   void setSweep();
    void setPDE();
    void setClear();
    void setMesh(OFELI::Mesh* ms);
@@ -195,7 +209,8 @@ class rita
    void msg(const string& loc, const string& m1, const string& m2="", int c=0);
 
    const vector<string> _rita_kw {"load","unload","stat$ionary","trans$ient","eigen","optim",
-                                  "approx$imation","integ$ration","algebraic","ode","pde","solve"};
+                                  "approx$imation","integ$ration","algebraic","ode","pde","solve","clear",
+                                  "sweep"};
    const vector<string> _gkw {"?","help","lic$ense","set","end","<"};
    const vector<string> _data_kw {"grid","mesh","vect$or","tab$ulation","func$tion","matr$ix","save",
                                   "remove","desc$ription","hist$ory","data","list","print","="};
@@ -31,6 +31,7 @@
 #include "calc.h"
 #include "cmd.h"
 #include "configure.h"
+#include "symDiff.h"
 
 using std::cout;
 using std::exception;
@@ -41,10 +42,11 @@ int rita::runAE()
 {
    string str = "", var_name = "x", nls = "newton", ae_name="";
    bool vector_ok = false;
-   int ret=0, size=1, ind=-1, n=0;
+   int ret=0, size=1, ind=-1, n=0, max_it=100;
+   double toler=1.e-8;
    int count_vector=0, count_fct=0, count_def=0, count_J=0, count_init=0;
    _ret = 0;
-   vector<string> def, var, name;
+   vector<string> def, var, name, coupled;
    vector<double> init;
    _ae = new odae;
    _ae->isSet = false;
@@ -55,7 +57,8 @@ int rita::runAE()
       _analysis_type = STEADY_STATE;
 
    const static vector<string> kw {"size","func$tion","def$inition","jacob$ian","init",
-                                   "var$iable","vect$or","nls","summary","clear","remove"};
+                                   "var$iable","vect$or","nls","summary","clear","remove","coupl$ed",
+                                   "max-it","tol$erance"};
    _cmd->set(kw,_gkw,_data_kw);
    for (int k=0; k<_nb_args; ++k) {
 
@@ -91,6 +94,18 @@ int rita::runAE()
             nls = _cmd->string_token();
             break;
 
+         case 11:
+            coupled.push_back(_cmd->string_token());
+            break;
+
+         case 12:
+            max_it = _cmd->int_token();
+            break;
+
+         case 13:
+            toler = _cmd->double_token();
+            break;
+
          default:
             msg("algebraic>:","Unknown argument: "+_cmd->Arg());
             return 1;
@@ -166,6 +181,10 @@ int rita::runAE()
             for (int i=0; i<size; ++i)
                var.push_back(var_name+to_string(i+1));
          }
+         if (addCoupling(def,coupled,var,"algebraic>"))
+            return 1;
+         for (const auto& v: coupled)
+            *ofh << " coupled=" << v;
          for (int i=0; i<size; ++i) {
             _data->addFunction(def[i],var);
             _ae->theFct[i].set(_data->NameFct[_data->iFct],def[i],var,1);
@@ -187,8 +206,9 @@ int rita::runAE()
          _ae->y.push_back(v);
       }
       _ae->nls = NLs[nls];
+      _ae->max_it = max_it, _ae->toler = toler;
       _ae->isFct = false;
-      *ofh << " nls=" << nls << endl;
+      *ofh << " max-it=" << max_it << " tolerance=" << toler << " nls=" << nls << endl;
       _ae->type = DataType::AE;
       _data->addAE(_ae,ae_name);
    }
@@ -287,6 +307,8 @@ int rita::runAE()
                   msg("algebraic>jacobian>","Missing partial derivatives of function defining equation.","",1);
                   break;
                }
+               if (count_J==0)
+                  J.setSize(size,size);
                for (int i=1; i<=size; ++i)
                   ret = _cmd->get(J(count_J+1,i));
                if (ret==0) {
@@ -428,6 +450,38 @@ int rita::runAE()
                _ret = 10;
                return _ret;
 
+            case  11:
+               if (_cmd->setNbArg(1,"Name of variable of another system to be given.")) {
+                  msg("algebraic>coupled>","Missing variable name.","",1);
+                  break;
+               }
+               if (!_cmd->get(str)) {
+                  coupled.push_back(str);
+                  *ofh << "  coupled " << str << endl;
+               }
+               _ret = 0;
+               break;
+
+            case  12:
+               if (_cmd->setNbArg(1,"Maximal number of iterations to be given.")) {
+                  msg("algebraic>max-it>","Missing maximal number of iterations.","",1);
+                  break;
+               }
+               if (!_cmd->get(max_it))
+                  *ofh << "  max-it " << max_it << endl;
+               _ret = 0;
+               break;
+
+            case  13:
+               if (_cmd->setNbArg(1,"Tolerance of iterations to be given.")) {
+                  msg("algebraic>tolerance>","Missing tolerance.","",1);
+                  break;
+               }
+               if (!_cmd->get(toler))
+                  *ofh << "  tolerance " << toler << endl;
+               _ret = 0;
+               break;
+
             case 100:
             case 101:
                _cmd->setNbArg(0);
@@ -439,6 +493,9 @@ int rita::runAE()
                cout << "variable:   Variable (vector) name as unknown of the equation\n";
                cout << "init:       Initial guess for iterations\n";
                cout << "nls:        Nonlinear equation iteration solver\n";
+               cout << "max-it:     Maximal number of nonlinear iterations\n";
+               cout << "tolerance:  Tolerance for convergence of nonlinear iterations\n";
+               cout << "coupled:    Variable of an algebraic or differential system defined later\n";
                cout << "summary:    Summary of Algebraic equation attributes\n";
                cout << "clear:      Remove equation from model" << endl;
                break;
@@ -482,18 +539,18 @@ int rita::runAE()
                   for (int i=1; i<=size; ++i)
                      var.push_back(var_name+to_string(i));
                }
+               if (addCoupling(def,coupled,var,"algebraic>end>")) {
+                  NO_AE
+                  return 1;
+               }
                if (!count_init) {
                   init.resize(size);
                   for (int i=0; i<size; ++i)
                      init[i] = 0.;
                }
                _ae->theFct.resize(size);
-               if (!count_J) {
-                  J.setSize(size,size);
-                  for (int i=1; i<=size; ++i)
-                     J(i,i) = 1.;
-               }
                _ae->size = size;
+               _ae->J.setSize(size,size);
                _ae->ind_fct = ind;
                _ae->isFct = count_fct;
                _ae->y.resize(size);
@@ -518,6 +575,7 @@ int rita::runAE()
                _ae->isSet = true;
                _ae->log = false;
                _ae->nls = NLs[nls];
+               _ae->max_it = max_it, _ae->toler = toler;
                _data->VectorEquation[_data->iVector] = _data->iEq;
                _ae->isFct = false;
                if (count_fct)
@@ -31,6 +31,8 @@
 #include "calc.h"
 #include "cmd.h"
 #include "configure.h"
+#include "symDiff.h"
+#include <algorithm>
 
 using std::cout;
 using std::exception;
@@ -45,14 +47,16 @@ int rita::runODE()
    int size=1, ret=0, count_fct=0, count_vector=0, count_def=0, count_init=0, ind=-1;
    _init_time = 0., _time_step=0.1, _final_time=1.;
 
-   vector<string> def, name, var;
+   vector<string> def, name, var, jac, coupled;
    vector<double> init;
    odae *ode = new odae;
    ode->isSet = false;
    _analysis_type = TRANSIENT;
-   string str="", var_name="y", scheme="forward-euler", fn="";
+   string str="", var_name="y", scheme="forward-euler", fn="", steps="";
+   double atol=1.e-6, rtol=1.e-4;
    static const vector<string> kw {"size","func$tion","def$inition","var$iable","vect$or","init$ial",
-                                   "final$-time","time-step","scheme","phase","summary","clear"};
+                                   "final$-time","time-step","scheme","phase","summary","clear",
+                                   "atol","rtol","steps","jacob$ian","coupl$ed"};
    _cmd->set(kw,_gkw);
    for (int k=0; k<_nb_args; ++k) {
 
@@ -101,6 +105,26 @@ int rita::runODE()
             phase = _cmd->string_token();
             break;
 
+         case 12:
+            atol = _cmd->double_token();
+            break;
+
+         case 13:
+            rtol = _cmd->double_token();
+            break;
+
+         case 14:
+            steps = _cmd->string_token();
+            break;
+
+         case 15:
+            jac.push_back(_cmd->string_token());
+            break;
+
+         case 16:
+            coupled.push_back(_cmd->string_token());
+            break;
+
          default:
             msg("ode>","Unknown argument: "+_cmd->Arg());
             return 1;
@@ -148,6 +172,10 @@ int rita::runODE()
          msg("ode>","The option 'function' is not available with an ODE system.");
          return 1;
       }
+      if (jac.size()>0 && jac.size()!=size_t(size*size)) {
+         msg("ode>","Number of jacobian entries must be equal to size*size.");
+         return 1;
+      }
       if (count_init<size) {
          for (int i=count_init; i<size; ++i)
             init.push_back(0.);
@@ -181,8 +209,14 @@ int rita::runODE()
          var[1] = var_name;
          if (size>1) {
             for (int i=1; i<=size; ++i)
-               var[i] = var_name + to_string(i+1);
+               var[i] = var_name + to_string(i);
          }
+
+//       Variables of other equations the system is coupled with
+         if (addCoupling(def,coupled,var,"ode>"))
+            return 1;
+         for (const auto& v: coupled)
+            *ofh << " coupled=" << v;
          for (int i=0; i<size; ++i) {
             if (ode->theFct[i].set(name[i],def[i],var,1)) {
                msg("ode>","Error in function evaluation: "+ode->theFct[i].getErrorMessage());
@@ -209,9 +243,19 @@ int rita::runODE()
          *ofh << " init=" << v;
          ode->y.push_back(v);
       }
-      ode->scheme = _sch[scheme];
       *ofh << " scheme=" << scheme;
-      *ofh << " time-step=" << _time_step << " final-time=" << _final_time << endl;
+      if (setAdaptive(ode,scheme,atol,rtol,steps))
+         return 1;
+      ode->scheme = _sch[scheme];
+      *ofh << " time-step=" << _time_step << " final-time=" << _final_time;
+      if (ode->adapt)
+         *ofh << " atol=" << atol << " rtol=" << rtol;
+      if (steps!="")
+         *ofh << " steps=" << steps;
+      setJacobian(ode,jac);
+      for (const auto& v: jac)
+         *ofh << " jacobian=" << v;
+      *ofh << endl;
       ode->type = DataType::ODE;
       _data->addODE(ode,ode_name);
    }
@@ -369,6 +413,71 @@ int rita::runODE()
                _ret = 0;
                break;
 
+            case  12:
+               if (_cmd->setNbArg(1,"Absolute tolerance to be given.")) {
+                  msg("ode>atol>","Missing absolute tolerance.","",1);
+                  break;
+               }
+               if (!_cmd->get(atol))
+                  *ofh << "    atol " << atol << endl;
+               _ret = 0;
+               break;
+
+            case  13:
+               if (_cmd->setNbArg(1,"Relative tolerance to be given.")) {
+                  msg("ode>rtol>","Missing relative tolerance.","",1);
+                  break;
+               }
+               if (!_cmd->get(rtol))
+                  *ofh << "    rtol " << rtol << endl;
+               _ret = 0;
+               break;
+
+            case  14:
+               if (_cmd->setNbArg(1,"Name of vector to contain time step data.")) {
+                  msg("ode>steps>","Missing vector name.","",1);
+                  break;
+               }
+               if (!_cmd->get(steps))
+                  *ofh << "    steps " << steps << endl;
+               _ret = 0;
+               break;
+
+            case  15:
+               if (_cmd->setNbArg(size,"Partial derivatives of functions defining system to be given.")) {
+                  msg("ode>jacobian>","Missing partial derivatives of functions defining system.","",1);
+                  break;
+               }
+               if (int(jac.size())==size*size) {
+                  msg("ode>jacobian>","Too many rows defining jacobian.");
+                  break;
+               }
+               ret = 0;
+               for (int i=0; i<size; ++i) {
+                  ret += _cmd->get(str);
+                  jac.push_back(str);
+               }
+               if (!ret) {
+                  *ofh << "    jacobian";
+                  for (int i=size; i>0; --i)
+                     *ofh << "  " << jac[jac.size()-i];
+                  *ofh << endl;
+               }
+               _ret = 0;
+               break;
+
+            case  16:
+               if (_cmd->setNbArg(1,"Name of variable of another system to be given.")) {
+                  msg("ode>coupled>","Missing variable name.","",1);
+                  break;
+               }
+               if (!_cmd->get(str)) {
+                  coupled.push_back(str);
+                  *ofh << "    coupled " << str << endl;
+               }
+               _ret = 0;
+               break;
+
             case  10:
                cout << "Summary of ODE attributes:\n";
                *ofh << "    summary" << endl;
@@ -415,8 +524,13 @@ int rita::runODE()
                cout << "initial:    Give an initial condition\n";
                cout << "final-time: Give final time\n";
                cout << "time-step:  Give time step\n";
-               cout << "scheme:     Time integration scheme\n";
+               cout << "scheme:     Time integration scheme (RK45 and BDF use adaptive time stepping)\n";
                cout << "phase:      Give name of a vector that will contain phase\n";
+               cout << "atol:       Absolute tolerance for adaptive schemes RK45 and BDF\n";
+               cout << "rtol:       Relative tolerance for adaptive schemes RK45 and BDF\n";
+               cout << "steps:      Give name of a vector that will contain time step data\n";
+               cout << "jacobian:   Give a row of the jacobian matrix of the system (BDF scheme)\n";
+               cout << "coupled:    Variable of an algebraic or differential system defined later\n";
                cout << "summary:    Summary of ODE attributes\n";
                cout << "clear:      Remove ODE from model\n" << endl;
                break;
@@ -463,6 +577,8 @@ int rita::runODE()
                   for (int i=1; i<=size; ++i)
                      var.push_back(var_name+to_string(i));
                }
+               if (addCoupling(def,coupled,var,"ode>end>"))
+                  return 1;
                if (!count_init) {
                   init.resize(size);
                   for (int i=0; i<size; ++i)
@@ -473,6 +589,13 @@ int rita::runODE()
                ode->ind_fct = ind;
                ode->isFct = count_fct;
                ode->y.resize(size);
+               if (setAdaptive(ode,scheme,atol,rtol,steps))
+                  break;
+               if (jac.size()>0 && jac.size()!=size_t(size*size)) {
+                  msg("ode>end>","Insufficient number of jacobian entries.");
+                  break;
+               }
+               setJacobian(ode,jac);
                ode->scheme = _sch[scheme];
                if (phase!="") {
                   ode->phase = phase;
@@ -515,4 +638,74 @@ int rita::runODE()
    return _ret;
 }
 
+
+void rita::setJacobian(odae*                 ode,
+                       const vector<string>& jac)
+{
+   if (jac.size()==0)
+      return;
+   ode->J.setSize(ode->size,ode->size);
+   for (int i=1; i<=ode->size; ++i)
+      for (int j=1; j<=ode->size; ++j)
+         ode->J(i,j) = jac[(i-1)*ode->size+j-1];
+}
+
+
+int rita::setAdaptive(odae*         ode,
+                      string&       scheme,
+                      double        atol,
+                      double        rtol,
+                      const string& steps)
+{
+// The embedded Runge-Kutta pair and the variable step BDF scheme are not OFELI
+// schemes. The OFELI scheme of same type is retained for other uses
+   ode->adapt = 0;
+   if (scheme=="RK45")
+      ode->adapt = 1, scheme = "RK4";
+   else if (scheme=="BDF")
+      ode->adapt = 2, scheme = "BDF2";
+   if (atol<0. || rtol<0. || atol+rtol<=0.) {
+      msg("ode>","Illegal tolerance values.");
+      return 1;
+   }
+   ode->atol = atol, ode->rtol = rtol;
+   ode->steps = steps;
+
+// Vector containing for each attempted step: time step, acceptance flag (1 or 0),
+// error norm and number of function evaluations
+   if (steps!="")
+      _data->addVector(steps,0.,4);
+   return 0;
+}
+
+
+int rita::addCoupling(const vector<string>& def,
+                      const vector<string>& coupled,
+                      vector<string>&       var,
+                      const string&         prompt)
+{
+// Names in definitions that are not unknowns of the system are variables of other
+// algebraic or differential systems (or time). They must be unknowns of a system
+// already defined, or be declared by 'coupled' if that system is defined later
+   for (const auto& v: freeVariables(def,var)) {
+      bool found = (v=="t" || find(coupled.begin(),coupled.end(),v)!=coupled.end());
+      for (int e=1; e<=_data->nb_ae+_data->nb_ode && !found; ++e) {
+         odae *q = (e<=_data->nb_ae) ? _data->theAE[e] : _data->theODE[e-_data->nb_ae];
+         if (q==nullptr)
+            continue;
+         for (int i=1; i<=q->size; ++i) {
+            if ((q->size==1 && v==q->fn) || v==q->fn+to_string(i))
+               found = true;
+         }
+      }
+      if (!found) {
+         msg(prompt,"Unknown variable "+v+" in definition.",
+             "If "+v+" is the unknown of a system defined later, declare it with: coupled="+v);
+         return 1;
+      }
+      var.push_back(v);
+   }
+   return 0;
+}
+
 } /* namespace RITA */
@@ -36,7 +36,16 @@
 #include "transient.h"
 #include "optim.h"
 #include "eigen.h"
+#include "symDiff.h"
+#include "fctCache.h"
+#include "profiler.h"
+#include "sparseLP.h"
+#include "sparseEigen.h"
 #include "util/macros.h"
+#include "solvers/MyOpt.h"
+#include <thread>
+#include <atomic>
+#include <random>
 
 namespace RITA {
 
@@ -136,12 +145,16 @@ int solve::run()
                if (_verb)
                   cout << "Running optimization problem solver ..." << endl;
                *_rita->ofh << "  run" << endl;
+               profiler::scope ps("solve:optimization");
                _ret = run_optim();
+               if (_ret==0)
+                  _data->obj = _optim->obj;
             }
             else if (_rita->_analysis_type==EIGEN) {
                if (_verb)
                   cout << "Running eigen problem solver ..." << endl;
                *_rita->ofh << "  run" << endl;
+               profiler::scope ps("solve:eigen");
                _ret = run_eigen();
             }
             else
@@ -266,6 +279,10 @@ int solve::run_eigen()
       _rita->msg("solve>run_eigen>","Eigenproblem undefined or improperly defined.");
       return 1;
    }
+   if (_eigen->pde!=nullptr)
+      return run_pde_eigen();
+   if (_eigen->sparse)
+      return run_sparse_eigen();
    EigenProblemSolver es;
    es.setMatrix(_eigen->M);
    if (_eigen->symm) {
@@ -292,6 +309,283 @@ int solve::run_eigen()
 }
 
 
+namespace {
+
+// Objective evaluated, with its derivatives, by automatic differentiation. Constraints
+// are penalized: a constraint c adds penal*c^2 to the objective, for an inequality
+// constraint c<=0 only where it is violated
+class optAD : public OFELI::MyOpt
+{
+ public:
+    int set(const optim* o);
+    real_t Objective(OFELI::Vect<real_t>& x) { return value(&x[0],nullptr); }
+    void Gradient(OFELI::Vect<real_t>& x, OFELI::Vect<real_t>& g) { value(&x[0],&g[0]); }
+    int Newton(OFELI::Vect<real_t>& x, const OFELI::Vect<real_t>& lb, const OFELI::Vect<real_t>& ub);
+    int getNbIter() const { return _nb_it; }
+
+ private:
+    size_t _n, _nb_le;
+    int _nb_it;
+    double _penal;
+    exprAD _J;
+    vector<exprAD> _C;
+    vector<double> _g, _e, _hv;
+    double value(const double* x, double* g);
+    void hessian(const double* x, vector<double>& H);
+};
+
+
+int optAD::set(const optim* o)
+{
+   const vector<string> &var = o->J_Fct->var;
+   _n = var.size(), _nb_le = o->nb_lec, _nb_it = 0;
+   _penal = o->penal;
+   _g.resize(_n), _e.assign(_n,0.), _hv.resize(_n);
+   _C.resize(o->nb_lec+o->nb_eqc);
+   if (_J.set(o->J_Fct->expr,var))
+      return 1;
+   for (int i=0; i<o->nb_lec; ++i) {
+      if (_C[i].set(o->inC_Fct[i]->expr,var))
+         return 1;
+   }
+   for (int i=0; i<o->nb_eqc; ++i) {
+      if (_C[_nb_le+i].set(o->eqC_Fct[i]->expr,var))
+         return 1;
+   }
+   return 0;
+}
+
+
+// Penalized objective at x and, if g is not null, its gradient in g
+double optAD::value(const double* x,
+                    double*       g)
+{
+   double y = g ? _J.gradient(x,g) : _J(x);
+   for (size_t k=0; k<_C.size(); ++k) {
+      double c = g ? _C[k].gradient(x,&_g[0]) : _C[k](x);
+      if (k<_nb_le && c<=0.)
+         continue;
+      y += _penal*c*c;
+      for (size_t i=0; i<_n && g; ++i)
+         g[i] += 2*_penal*c*_g[i];
+   }
+   return y;
+}
+
+
+// Hessian of the penalized objective, column j being the product by the j-th unit vector
+void optAD::hessian(const double*    x,
+                    vector<double>&  H)
+{
+   for (size_t j=0; j<_n; ++j) {
+      _e[j] = 1.;
+      _J.hessVec(x,&_e[0],&_hv[0]);
+      for (size_t i=0; i<_n; ++i)
+         H[_n*i+j] = _hv[i];
+      _e[j] = 0.;
+   }
+   for (size_t k=0; k<_C.size(); ++k) {
+      double c = _C[k].gradient(x,&_g[0]);
+      if (k<_nb_le && c<=0.)
+         continue;
+      for (size_t j=0; j<_n; ++j) {
+         _e[j] = 1.;
+         _C[k].hessVec(x,&_e[0],&_hv[0]);
+         for (size_t i=0; i<_n; ++i)
+            H[_n*i+j] += 2*_penal*(_g[i]*_g[j] + c*_hv[i]);
+         _e[j] = 0.;
+      }
+   }
+}
+
+
+// Newton method with backtracking line search, iterates being projected on the bounds.
+// The step falls back to steepest descent where the Hessian is singular or not positive
+// along the Newton direction. Return 0 on convergence
+int optAD::Newton(OFELI::Vect<real_t>&       x,
+                  const OFELI::Vect<real_t>& lb,
+                  const OFELI::Vect<real_t>& ub)
+{
+   const int max_it = 100;
+   const double toler = 1.e-10;
+   vector<double> g(_n), H(_n*_n), y(_n);
+   auto project = [&](double& z, size_t i) {
+      if (i<lb.size())
+         z = std::max(z,lb[i]);
+      if (i<ub.size())
+         z = std::min(z,ub[i]);
+   };
+   for (size_t i=0; i<_n; ++i)
+      project(x[i],i);
+   double f = value(&x[0],&g[0]);
+   for (_nb_it=1; _nb_it<=max_it; ++_nb_it) {
+      hessian(&x[0],H);
+      OFELI::DMatrix<real_t> A(_n,_n);
+      OFELI::Vect<real_t> d(_n);
+      double gd = 0.;
+      for (size_t i=0; i<_n; ++i) {
+         d[i] = -g[i];
+         for (size_t j=0; j<_n; ++j)
+            A(i+1,j+1) = H[_n*i+j];
+      }
+      if (A.solve(d)==0) {
+         for (size_t i=0; i<_n; ++i)
+            gd += g[i]*d[i];
+      }
+      if (gd>=0.) {
+         for (size_t i=0; i<_n; ++i)
+            d[i] = -g[i];
+      }
+      double s=1., fy=f, dg=0., dx=0., xn=0.;
+      for (int k=0; k<50; ++k, s*=0.5) {
+         dg = 0.;
+         for (size_t i=0; i<_n; ++i) {
+            y[i] = x[i] + s*d[i];
+            project(y[i],i);
+            dg += g[i]*(y[i]-x[i]);
+         }
+         if ((fy=value(&y[0],nullptr))<=f+1.e-4*dg)
+            break;
+      }
+      for (size_t i=0; i<_n; ++i) {
+         dx += (y[i]-x[i])*(y[i]-x[i]);
+         xn += y[i]*y[i];
+         x[i] = y[i];
+      }
+      f = value(&x[0],&g[0]);
+      if (sqrt(dx)<=toler*(1.+sqrt(xn)))
+         return 0;
+   }
+   return 1;
+}
+
+
+// Supply derivatives that were not given by automatic differentiation of the
+// penalized objective. As the Newton method needs the Hessian, it is run by ad with
+// Hessians built from Hessian-vector products. Return 0 if ad is not used, 1 if the
+// solver gets the objective from ad, 2 if ad runs the Newton method
+int setDerivatives(optim*            o,
+                   OFELI::OptSolver& s,
+                   optAD&            ad)
+{
+   bool newton = (o->Alg==OFELI::OptSolver::NEWTON);
+   if ((o->G_ok && (o->H_ok || !newton)) || ad.set(o))
+      return 0;
+   if (newton && !o->H_ok)
+      return 2;
+   s.setOptClass(ad);
+   return 1;
+}
+
+} /* namespace */
+
+
+int solve::run_sparse_eigen()
+{
+   int n = _eigen->size;
+   CSR A(n);
+   vector<double> row(n), re, im;
+   for (int i=1; i<=n; ++i) {
+      for (int j=1; j<=n; ++j)
+         row[j-1] = (*_eigen->M)(i,j);
+      A.addRow(&row[0]);
+   }
+   sparseEigen es(A);
+   es.setNbEigv(_eigen->nb_eigv);
+   es.setTolerance(_eigen->tol);
+   if (_eigen->shift_ok)
+      es.setShift(_eigen->shift);
+   int ret = es.run(_eigen->symm ? sparseEigen::LANCZOS : sparseEigen::ARNOLDI);
+   if (ret==2) {
+      _rita->msg("solve>run_eigen>","Shifted matrix is singular, change shift value.");
+      return 1;
+   }
+   if (_verb) {
+      cout << (_eigen->symm ? "Lanczos" : "Arnoldi") << " method: " << es.getNbRestarts() << " restarts, "
+           << es.getNbOp() << " operator applications" << endl;
+      if (_eigen->shift_ok)
+         cout << "Nonzero terms in factors of shifted matrix: " << es.getNnzFactor() << endl;
+      cout << "Time: " << es.getTime() << " s" << endl;
+   }
+   if (ret==1)
+      _rita->msg("solve>run_eigen>","Only "+to_string(es.getNbConverged())+" eigenvalues converged.");
+   for (int i=1; i<=_eigen->nb_eigv; ++i) {
+      (*_data->theVector[_data->VectorName[_eigen->eval+"-r"]])(i) = es.getEigenValue(i,1);
+      (*_data->theVector[_data->VectorName[_eigen->eval+"-i"]])(i) = es.getEigenValue(i,2);
+      if (_eigen->eig_vec) {
+         OFELI::Vect<double> &vr = *_data->theVector[_data->VectorName[_eigen->evect+"-"+to_string(i)+"r"]];
+         OFELI::Vect<double> &vi = *_data->theVector[_data->VectorName[_eigen->evect+"-"+to_string(i)+"i"]];
+         es.getEigenVector(i,re,im);
+         vr.setSize(n), vi.setSize(n);
+         for (int j=0; j<n; ++j)
+            vr[j] = re[j], vi[j] = im[j];
+      }
+   }
+   _eigen->solved = true;
+   cout << "Eigenvalues stored in vectors: " << _eigen->eval+"-r, " << _eigen->eval+"-i" << endl;
+   if (_eigen->eig_vec)
+      cout << "Eigenvectors stored in vectors: " << _eigen->evect+"-*r*, " << _eigen->evect+"-*i*, " << endl;
+   return 0;
+}
+
+
+int solve::run_pde_eigen()
+{
+   equa *e = _eigen->pde;
+   CSR K, M;
+   vector<int> eqn;
+   vector<double> re, im;
+   int nb_dof=1;
+   if (e->getOperators(K,M,eqn,nb_dof))
+      return 1;
+   int n=K.nbRows(), nn=int(eqn.size())/nb_dof, nb=std::min(_eigen->nb_eigv,n);
+   if (n==0) {
+      _rita->msg("solve>run_eigen>","No free degree of freedom in pde "+e->name);
+      return 1;
+   }
+   sparseEigen es(K);
+   es.setMass(M);
+   es.setShift(_eigen->shift);
+   es.setNbEigv(nb);
+   es.setTolerance(_eigen->tol);
+   int ret = es.run(sparseEigen::LANCZOS);
+   if (ret==2) {
+      _rita->msg("solve>run_eigen>","Shifted stiffness matrix is singular, change shift value.");
+      return 1;
+   }
+   if (_verb) {
+      cout << "Degrees of freedom: " << n << ", nonzero terms in stiffness matrix: " << K.nnz() << endl;
+      cout << "Lanczos method: " << es.getNbRestarts() << " restarts, " << es.getNbOp()
+           << " operator applications" << endl;
+      cout << "Nonzero terms in factors of shifted matrix: " << es.getNnzFactor() << endl;
+      cout << "Time: " << es.getTime() << " s" << endl;
+   }
+   if (ret==1)
+      _rita->msg("solve>run_eigen>","Only "+to_string(es.getNbConverged())+" eigenvalues converged.");
+   _data->theVector[_data->VectorName[_eigen->eval+"-r"]]->setSize(nb);
+   _data->theVector[_data->VectorName[_eigen->eval+"-i"]]->setSize(nb);
+   for (int i=1; i<=nb; ++i) {
+      (*_data->theVector[_data->VectorName[_eigen->eval+"-r"]])(i) = es.getEigenValue(i,1);
+      (*_data->theVector[_data->VectorName[_eigen->eval+"-i"]])(i) = 0.;
+      string vn = _eigen->evect + "-" + to_string(i);
+      int iv = _data->addMeshVector(vn,data::DataSize::NODES,nb_dof,e->getMesh());
+      if (iv<=0)
+         return 1;
+      OFELI::Vect<double> &v = *_data->theVector[iv];
+      es.getEigenVector(i,re,im);
+      for (int j=0; j<nn; ++j) {
+         for (int k=0; k<nb_dof; ++k)
+            v(j+1,k+1) = (eqn[j*nb_dof+k]>=0) ? re[eqn[j*nb_dof+k]] : 0.;
+      }
+   }
+   _eigen->nb_eigv = nb;
+   _eigen->solved = true;
+   cout << "Eigenvalues stored in vector: " << _eigen->eval+"-r" << endl;
+   cout << "Eigenmodes stored in vectors: " << _eigen->evect+"-1, ..., " << _eigen->evect+"-"+to_string(nb) << endl;
+   return 0;
+}
+
+
 int solve::run_optim()
 {
    _optim = _rita->_optim;
@@ -301,7 +595,9 @@ int solve::run_optim()
    }
    int size=_optim->size;
    try {
-      if (_optim->lp) {
+      if (_optim->lp && _optim->sparse)
+         return run_sparse_lp();
+      else if (_optim->lp) {
          OFELI::LPSolver s;
          s.setSize(size,_optim->nb_lec,_optim->nb_gec,_optim->nb_eqc);
          s.set(*_data->theVector[_data->iVector]);
@@ -317,10 +613,15 @@ int solve::run_optim()
          if (ret==0)
             _optim->solved = true;
       }
+      else if (_optim->nb_starts>1)
+         return run_multistart();
       else {
          OFELI::OptSolver s(*_data->theVector[_data->iVector]);
          s.setOptMethod(_optim->Alg);
-         s.setObjective(*_optim->J_Fct);
+         optAD ad;
+         int with_ad = setDerivatives(_optim,s,ad);
+         if (!with_ad)
+            s.setObjective(*_optim->J_Fct);
          if (_optim->G_ok) {
             for (int i=0; i<size; ++i)
                s.setGradient(*_data->theFct[_optim->igrad+i],i+1);
@@ -329,14 +630,18 @@ int solve::run_optim()
             for (int i=0; i<size*size; ++i)
                s.setHessian(*_data->theFct[_optim->ihess+i],i+1);
          }
-         for (int i=0; i<_optim->nb_lec; ++i)
+         for (int i=0; i<_optim->nb_lec && !with_ad; ++i)
             s.setIneqConstraint(*_optim->inC_Fct[i],_optim->penal);
-         for (int i=0; i<_optim->nb_eqc; ++i)
+         for (int i=0; i<_optim->nb_eqc && !with_ad; ++i)
             s.setEqConstraint(*_optim->eqC_Fct[i],_optim->penal);
          s.setLowerBounds(_optim->lb);
          s.setUpperBounds(_optim->ub);
-         if (!s.run()) {
-            _optim->obj = s.getObjective();
+         OFELI::Vect<real_t> &x = *_data->theVector[_data->iVector];
+         int ret = (with_ad==2) ? ad.Newton(x,_optim->lb,_optim->ub) : s.run();
+         if (with_ad==2 && _verb)
+            cout << "Newton method: " << ad.getNbIter() << " iterations" << endl;
+         if (!ret) {
+            _optim->obj = (with_ad==2) ? (*_optim->J_Fct)(x) : s.getObjective();
             _optim->solved = true;
             cout << "Optimization variable stored in vector: " << _data->Vector[_data->iVector] << endl;
          }
@@ -346,6 +651,193 @@ int solve::run_optim()
 }
 
 
+int solve::run_sparse_lp()
+{
+   int size=_optim->size;
+   sparseLP lp(size);
+   vector<double> c(size), x;
+   for (int i=0; i<size; ++i)
+      c[i] = _optim->a[i];
+   lp.setObjective(c,_optim->b);
+
+// Constraints given by full rows are stored in compressed form too
+   auto add = [&](sparseLP::Type t, const vector<OFELI::Vect<double> *>& a,
+                  const OFELI::Vect<double>& b, const CSR& sa, const vector<double>& sb) {
+      CSR A(size);
+      vector<double> bb;
+      for (size_t i=0; i<a.size(); ++i) {
+         A.addRow(&(*a[i])[0]);
+         bb.push_back(b[i]);
+      }
+      lp.addConstraints(t,A,bb);
+      lp.addConstraints(t,sa,sb);
+   };
+   add(sparseLP::LE,_optim->a_le,_optim->b_le,_optim->s_le,_optim->sb_le);
+   add(sparseLP::GE,_optim->a_ge,_optim->b_ge,_optim->s_ge,_optim->sb_ge);
+   add(sparseLP::EQ,_optim->a_eq,_optim->b_eq,_optim->s_eq,_optim->sb_eq);
+   int ret = lp.run(x);
+   if (_verb) {
+      cout << "Sparse interior point solver: " << lp.getNbIter() << " iterations" << endl;
+      cout << "Nonzero terms in constraints: " << lp.getNnzA() << ", in factor: " << lp.getNnzL() << endl;
+      cout << "Residuals: primal " << lp.getPrimalResidual() << ", dual " << lp.getDualResidual()
+           << ", gap " << lp.getGap() << endl;
+      cout << "Time: factorization " << lp.getFactorTime() << " s, solution " << lp.getSolveTime()
+           << " s, total " << lp.getTotalTime() << " s" << endl;
+   }
+   if (ret==2) {
+      _rita->msg("solve>run_optim>","Linear program is infeasible or unbounded.");
+      return 1;
+   }
+   if (ret==1) {
+      _rita->msg("solve>run_optim>","No convergence of interior point iterations.");
+      return 1;
+   }
+   for (int i=0; i<size; ++i)
+      (*_data->theVector[_data->iVector])[i] = x[i];
+   _optim->obj = lp.getObjective();
+   _optim->solved = true;
+   cout << "Optimization variable stored in vector: " << _data->Vector[_data->iVector] << endl;
+   return 0;
+}
+
+
+int solve::run_multistart()
+{
+   struct Start {
+      OFELI::Vect<double> x;
+      double obj;
+      int ret;
+   };
+   int size=_optim->size, nb=_optim->nb_starts;
+   vector<Start> st(nb);
+
+// Latin hypercube sampling of initial guesses: each interval of the subdivision of
+// [lb,ub] in nb parts contains exactly one starting point in each direction.
+// Unbounded directions are sampled around the given initial guess
+   std::mt19937 gen(1);
+   std::uniform_real_distribution<double> u(0.,1.);
+   double big = 0.1*std::numeric_limits<double>::max();
+   for (int k=0; k<nb; ++k)
+      st[k].x.setSize(size);
+   vector<int> perm(nb);
+   for (int i=0; i<size; ++i) {
+      double c = (i<int(_optim->init.size())) ? _optim->init[i] : 0.;
+      double lo = (i<int(_optim->lb.size())) ? _optim->lb[i] : -2*big;
+      double hi = (i<int(_optim->ub.size())) ? _optim->ub[i] : 2*big;
+      double w = std::max(1.,fabs(c));
+      if (lo<-big && hi>big)
+         lo = c - w, hi = c + w;
+      else if (lo<-big)
+         lo = std::min(c,hi) - 2*w;
+      else if (hi>big)
+         hi = std::max(c,lo) + 2*w;
+      for (int k=0; k<nb; ++k)
+         perm[k] = k;
+      std::shuffle(perm.begin(),perm.end(),gen);
+      for (int k=0; k<nb; ++k)
+         st[k].x[i] = lo + (perm[k]+u(gen))*(hi-lo)/nb;
+   }
+
+// Each start gets its own solver and its own copy of the functions so that
+// expressions are evaluated concurrently
+   std::atomic<int> next(0);
+   auto work = [&]() {
+      int k;
+      while ((k=next++)<nb) {
+         Start &r = st[k];
+         r.ret = 1;
+         try {
+            OFELI::Fct J;
+            J.set(_optim->J_Fct->expr,_optim->J_Fct->var);
+            vector<OFELI::Fct> G(_optim->G_Fct.size()), H(_optim->H_Fct.size());
+            vector<OFELI::Fct> inC(_optim->nb_lec), eqC(_optim->nb_eqc);
+            OFELI::OptSolver s(r.x);
+            s.setOptMethod(_optim->Alg);
+            optAD ad;
+            int with_ad = setDerivatives(_optim,s,ad);
+            if (!with_ad)
+               s.setObjective(J);
+            for (size_t i=0; i<G.size() && _optim->G_ok; ++i) {
+               G[i].set(_optim->G_Fct[i]->expr,_optim->G_Fct[i]->var);
+               s.setGradient(G[i],i+1);
+            }
+            for (size_t i=0; i<H.size() && _optim->H_ok; ++i) {
+               H[i].set(_optim->H_Fct[i]->expr,_optim->H_Fct[i]->var);
+               s.setHessian(H[i],i+1);
+            }
+            for (int i=0; i<_optim->nb_lec && !with_ad; ++i) {
+               inC[i].set(_optim->inC_Fct[i]->expr,_optim->inC_Fct[i]->var);
+               s.setIneqConstraint(inC[i],_optim->penal);
+            }
+            for (int i=0; i<_optim->nb_eqc && !with_ad; ++i) {
+               eqC[i].set(_optim->eqC_Fct[i]->expr,_optim->eqC_Fct[i]->var);
+               s.setEqConstraint(eqC[i],_optim->penal);
+            }
+            s.setLowerBounds(_optim->lb);
+            s.setUpperBounds(_optim->ub);
+            if (with_ad==2) {
+               r.ret = ad.Newton(r.x,_optim->lb,_optim->ub);
+               r.obj = J(r.x);
+            }
+            else {
+               r.ret = s.run();
+               r.obj = s.getObjective();
+            }
+         }
+         catch (...) {
+            r.ret = 1;
+         }
+      }
+   };
+   int nt = std::min(nb,std::max(1,int(std::thread::hardware_concurrency())));
+   vector<std::thread> th;
+   for (int i=1; i<nt; ++i)
+      th.push_back(std::thread(work));
+   work();
+   for (auto& t: th)
+      t.join();
+
+// Retain the best result and report spread of results
+   int best=-1, nb_ok=0;
+   double mean=0., dev=0., worst=0., dist=0.;
+   for (int k=0; k<nb; ++k) {
+      if (st[k].ret)
+         continue;
+      nb_ok++;
+      mean += st[k].obj;
+      if (best<0 || st[k].obj<st[best].obj)
+         best = k;
+      if (nb_ok==1 || st[k].obj>worst)
+         worst = st[k].obj;
+   }
+   if (best<0) {
+      _rita->msg("solve>run_optim>","No convergence from any of the "+to_string(nb)+" starting points.");
+      return 1;
+   }
+   mean /= nb_ok;
+   for (int k=0; k<nb; ++k) {
+      if (st[k].ret)
+         continue;
+      dev += (st[k].obj-mean)*(st[k].obj-mean);
+      double d = 0.;
+      for (int i=0; i<size; ++i)
+         d += (st[k].x[i]-st[best].x[i])*(st[k].x[i]-st[best].x[i]);
+      dist = std::max(dist,sqrt(d));
+   }
+   dev = sqrt(dev/nb_ok);
+   *_data->theVector[_data->iVector] = st[best].x;
+   _optim->obj = st[best].obj;
+   _optim->solved = true;
+   cout << "Multi-start optimization: " << nb_ok << " converged runs out of " << nb << " on "
+        << nt << " threads" << endl;
+   cout << "Objective: best " << st[best].obj << ", worst " << worst << ", mean " << mean
+        << ", standard deviation " << dev << endl;
+   cout << "Maximal distance of solutions to best one: " << dist << endl;
+   cout << "Optimization variable stored in vector: " << _data->Vector[_data->iVector] << endl;
+   return 0;
+}
+
+
 void solve::save()
 {
    int k=0, freq=1, eq=0, vector_ok=0;
@@ -589,8 +1081,12 @@ void solve::get_error(int eq, int i)
             _var[j] = _ae->fn+to_string(j+1);
             y[j] = _ae->y[j];
          }
-         _theFct.set(_ae->analytic[i],_var);
-         double u=_ae->y[i], v=_theFct(y);
+         std::shared_ptr<OFELI::Fct> f = fctCache::get().fct(_ae->analytic[i],_var);
+         if (f==nullptr) {
+            _rita->msg("solve>error>","Illegal expression of analytical solution: "+_ae->analytic[i]);
+            return;
+         }
+         double u=_ae->y[i], v=(*f)(y);
          errI += (u-v)*(u-v);
       }
       cout << "Error: " << sqrt(errI) << endl;
@@ -609,8 +1105,12 @@ void solve::get_error(int eq, int i)
             _var[j+1] = _ode->fn+to_string(j+1);
             y[j+1] = _ode->y[j];
          }
-         _theFct.set(_ode->analytic[i],_var);
-         double u=_ode->y[i], v=_theFct(y);
+         std::shared_ptr<OFELI::Fct> f = fctCache::get().fct(_ode->analytic[i],_var);
+         if (f==nullptr) {
+            _rita->msg("solve>error>","Illegal expression of analytical solution: "+_ode->analytic[i]);
+            return;
+         }
+         double u=_ode->y[i], v=(*f)(y);
          errI += (u-v)*(u-v);
       }
       cout << "Error: " << sqrt(errI) << endl;
@@ -627,10 +1127,14 @@ void solve::get_error(int eq, int i)
          neq = theMesh->getNbDOF();
          nb_dof = neq/theMesh->getNbNodes();
          for (int i=0; i<nb_dof; ++i) {
-            _theFct.set(_pde->analytic[i]);
+            std::shared_ptr<OFELI::Fct> f = fctCache::get().fct(_pde->analytic[i],{});
+            if (f==nullptr) {
+               _rita->msg("solve>error>","Illegal expression of analytical solution: "+_pde->analytic[i]);
+               return;
+            }
             for (int n=1; n<=int(theMesh->getNbNodes()); ++n) {
                double u = (*_data->theVector[eq])(n,i+1);
-               double v = _theFct((*theMesh)[n]->getCoord());
+               double v = (*f)((*theMesh)[n]->getCoord());
                err2 += (u-v)*(u-v);
                errI  = std::max(fabs(u-v),errI);
             }
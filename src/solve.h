@@ -74,7 +74,6 @@ class solve
     vector<string> _analytic_exp, _var;
     vector<int> _fformat, _isave;
     vector<string> _save_file, _phase_file;
-    OFELI::Fct _theFct;
     configure *_configure;
     data *_data;
     optim *_optim;
@@ -89,7 +88,11 @@ class solve
     int run_steady();
     int run_transient();
     int run_optim();
+    int run_multistart();
+    int run_sparse_lp();
     int run_eigen();
+    int run_sparse_eigen();
+    int run_pde_eigen();
     void get_error(int eq, int i);
     void setAnalytic();
 };
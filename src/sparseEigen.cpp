@@ -0,0 +1,630 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                     Implementation of class 'sparseEigen'
+
+  ==============================================================================*/
+
+#include "sparseEigen.h"
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <numeric>
+#include <algorithm>
+
+namespace RITA {
+
+namespace {
+
+typedef std::complex<double> cplx;
+
+// Eigenvalues and eigenvectors of a small symmetric matrix (cyclic Jacobi method).
+// Eigenvector i is column i of y
+void symEig(int                   m,
+            vector<double>        a,
+            vector<double>&       d,
+            vector<double>&       y)
+{
+   y.assign(m*m,0.);
+   for (int i=0; i<m; ++i)
+      y[i*m+i] = 1.;
+   for (int sweep=0; sweep<100; ++sweep) {
+      double off=0., tot=0.;
+      for (int i=0; i<m; ++i) {
+         for (int j=0; j<m; ++j)
+            (i==j ? tot : off) += a[i*m+j]*a[i*m+j];
+      }
+      if (off<=1.e-30*(tot+off))
+         break;
+      for (int p=0; p<m-1; ++p) {
+         for (int q=p+1; q<m; ++q) {
+            double apq = a[p*m+q];
+            if (apq==0.)
+               continue;
+            double th = 0.5*(a[q*m+q]-a[p*m+p])/apq;
+            double t = ((th>=0.) ? 1. : -1.)/(fabs(th)+sqrt(th*th+1.));
+            double c=1./sqrt(t*t+1.), s=t*c;
+            for (int k=0; k<m; ++k) {
+               double u=a[k*m+p], v=a[k*m+q];
+               a[k*m+p] = c*u - s*v, a[k*m+q] = s*u + c*v;
+            }
+            for (int k=0; k<m; ++k) {
+               double u=a[p*m+k], v=a[q*m+k];
+               a[p*m+k] = c*u - s*v, a[q*m+k] = s*u + c*v;
+            }
+            for (int k=0; k<m; ++k) {
+               double u=y[k*m+p], v=y[k*m+q];
+               y[k*m+p] = c*u - s*v, y[k*m+q] = s*u + c*v;
+            }
+         }
+      }
+   }
+   d.resize(m);
+   for (int i=0; i<m; ++i)
+      d[i] = a[i*m+i];
+}
+
+
+// Eigenvalues of a small upper Hessenberg matrix by the shifted QR method in
+// complex arithmetic with deflation
+int hessEig(int                m,
+            const vector<double>& h,
+            vector<cplx>&      ev)
+{
+   vector<cplx> H(h.begin(),h.end());
+   ev.resize(m);
+   int hi=m-1, it=0;
+   while (hi>=0) {
+      if (hi==0) {
+         ev[0] = H[0];
+         break;
+      }
+      int l = hi;
+      while (l>0 && std::abs(H[l*m+l-1])>1.e-15*(std::abs(H[l*m+l])+std::abs(H[(l-1)*m+l-1])))
+         l--;
+      if (l>0)
+         H[l*m+l-1] = 0.;
+      if (l==hi) {
+         ev[hi] = H[hi*m+hi];
+         hi--, it = 0;
+         continue;
+      }
+      if (++it>1000)
+         return 1;
+
+//    Wilkinson shift, with an exceptional shift from time to time
+      cplx a=H[(hi-1)*m+hi-1], b=H[(hi-1)*m+hi], c=H[hi*m+hi-1], d=H[hi*m+hi];
+      cplx tr=0.5*(a+d), disc=std::sqrt(tr*tr-(a*d-b*c));
+      cplx mu = (std::abs(tr+disc-d)<std::abs(tr-disc-d)) ? tr+disc : tr-disc;
+      if (it%11==10)
+         mu = d + std::abs(c);
+      for (int k=l; k<=hi; ++k)
+         H[k*m+k] -= mu;
+      vector<cplx> cs(hi-l), sn(hi-l);
+      for (int k=l; k<hi; ++k) {
+         cplx x=H[k*m+k], y=H[(k+1)*m+k];
+         double r = sqrt(std::norm(x)+std::norm(y));
+         cplx cc=(r>0.) ? x/r : 1., ss=(r>0.) ? y/r : 0.;
+         cs[k-l] = cc, sn[k-l] = ss;
+         for (int j=k; j<=hi; ++j) {
+            cplx t1=H[k*m+j], t2=H[(k+1)*m+j];
+            H[k*m+j] = std::conj(cc)*t1 + std::conj(ss)*t2;
+            H[(k+1)*m+j] = -ss*t1 + cc*t2;
+         }
+      }
+      for (int k=l; k<hi; ++k) {
+         cplx cc=cs[k-l], ss=sn[k-l];
+         for (int i=l; i<=std::min(k+2,hi); ++i) {
+            cplx t1=H[i*m+k], t2=H[i*m+k+1];
+            H[i*m+k] = t1*cc + t2*ss;
+            H[i*m+k+1] = -t1*std::conj(ss) + t2*std::conj(cc);
+         }
+      }
+      for (int k=l; k<=hi; ++k)
+         H[k*m+k] += mu;
+   }
+   return 0;
+}
+
+
+// Eigenvector of a small real matrix associated to eigenvalue e (inverse iteration)
+void eigVector(int                   m,
+               const vector<double>& h,
+               cplx                  e,
+               vector<cplx>&         y)
+{
+   double hn = 0.;
+   for (double v: h)
+      hn = std::max(hn,fabs(v));
+   e += 1.e-10*(hn+std::abs(e));
+   vector<cplx> a(m*m);
+   vector<int> p(m);
+   for (int i=0; i<m; ++i) {
+      for (int j=0; j<m; ++j)
+         a[i*m+j] = h[i*m+j] - ((i==j) ? e : 0.);
+   }
+   for (int k=0; k<m; ++k) {
+      int r = k;
+      for (int i=k+1; i<m; ++i) {
+         if (std::abs(a[i*m+k])>std::abs(a[r*m+k]))
+            r = i;
+      }
+      p[k] = r;
+      for (int j=0; j<m; ++j)
+         std::swap(a[k*m+j],a[r*m+j]);
+      if (std::abs(a[k*m+k])<1.e-300)
+         a[k*m+k] = 1.e-14*(hn+1.);
+      for (int i=k+1; i<m; ++i) {
+         cplx f = a[i*m+k] /= a[k*m+k];
+         for (int j=k+1; j<m; ++j)
+            a[i*m+j] -= f*a[k*m+j];
+      }
+   }
+   y.assign(m,1.);
+   for (int pass=0; pass<3; ++pass) {
+      for (int k=0; k<m; ++k) {
+         std::swap(y[k],y[p[k]]);
+         for (int i=k+1; i<m; ++i)
+            y[i] -= a[i*m+k]*y[k];
+      }
+      for (int k=m-1; k>=0; --k) {
+         for (int j=k+1; j<m; ++j)
+            y[k] -= a[k*m+j]*y[j];
+         y[k] /= a[k*m+k];
+      }
+      double s = 0.;
+      for (const cplx& v: y)
+         s += std::norm(v);
+      s = sqrt(s);
+      for (cplx& v: y)
+         v /= s;
+   }
+}
+
+
+// Householder QR factorization of a small square matrix a. Return orthogonal factor
+void qrFactor(int             m,
+              vector<double>  a,
+              vector<double>& q)
+{
+   q.assign(m*m,0.);
+   for (int i=0; i<m; ++i)
+      q[i*m+i] = 1.;
+   vector<double> v(m);
+   for (int k=0; k<m-1; ++k) {
+      double s = 0.;
+      for (int i=k; i<m; ++i)
+         s += a[i*m+k]*a[i*m+k];
+      s = sqrt(s);
+      if (s==0.)
+         continue;
+      double alpha = (a[k*m+k]>0.) ? -s : s;
+      for (int i=0; i<m; ++i)
+         v[i] = (i<k) ? 0. : a[i*m+k];
+      v[k] -= alpha;
+      double vv = 0.;
+      for (int i=k; i<m; ++i)
+         vv += v[i]*v[i];
+      if (vv==0.)
+         continue;
+      for (int j=0; j<m; ++j) {
+         double t = 0.;
+         for (int i=k; i<m; ++i)
+            t += v[i]*a[i*m+j];
+         t *= 2./vv;
+         for (int i=k; i<m; ++i)
+            a[i*m+j] -= t*v[i];
+      }
+      for (int i=0; i<m; ++i) {
+         double t = 0.;
+         for (int j=k; j<m; ++j)
+            t += q[i*m+j]*v[j];
+         t *= 2./vv;
+         for (int j=k; j<m; ++j)
+            q[i*m+j] -= t*v[j];
+      }
+   }
+}
+
+} /* namespace */
+
+
+sparseEigen::sparseEigen(const CSR& A)
+            : _A(A), _M(nullptr), _n(A.nbRows()), _nev(1), _m(0), _max_it(300), _nb_it(0),
+              _nconv(0), _shift_ok(false), _shift(0.), _tol(1.e-8), _time(0.), _nb_op(0), _nnz_f(0)
+{
+}
+
+
+void sparseEigen::op(const double* x,
+                     double*       y)
+{
+   _nb_op++;
+   if (_shift_ok) {
+      if (_M)
+         _M->mult(x,y);
+      else
+         std::copy(x,x+_n,y);
+      _lu.solve(y);
+   }
+   else {
+      _A.mult(x,y);
+      if (_M)
+         _lu.solve(y);
+   }
+}
+
+
+double sparseEigen::dot(const double* x,
+                        const double* y)
+{
+   double s = 0.;
+   for (int i=0; i<_n; ++i)
+      s += x[i]*y[i];
+   return s;
+}
+
+
+double sparseEigen::orthogonalize(int     j,
+                                  bool    Minner,
+                                  double* h)
+{
+// Classical Gram-Schmidt with reorthogonalization of _w against columns 0..j of _V
+   double *w=&_w[0], *z=(Minner) ? &_z[0] : w;
+   vector<double> c(j+1);
+   if (h)
+      std::fill(h,h+j+1,0.);
+   for (int pass=0; pass<2; ++pass) {
+      if (Minner)
+         _M->mult(w,z);
+      for (int i=0; i<=j; ++i)
+         c[i] = dot(&_V[i*_n],z);
+      for (int i=0; i<=j; ++i) {
+         const double *v = &_V[i*_n];
+         for (int l=0; l<_n; ++l)
+            w[l] -= c[i]*v[l];
+         if (h)
+            h[i] += c[i];
+      }
+   }
+   if (Minner)
+      _M->mult(w,z);
+   return sqrt(std::max(dot(w,z),0.));
+}
+
+
+void sparseEigen::startVector(double* v)
+{
+   std::mt19937 g(unsigned(1+_nb_op));
+   std::uniform_real_distribution<double> u(-1.,1.);
+   for (int i=0; i<_n; ++i)
+      v[i] = u(g);
+}
+
+
+sparseEigen::cplx sparseEigen::eigenvalue(cplx theta) const
+{
+   if (_shift_ok)
+      return _shift + 1./theta;
+   return theta;
+}
+
+
+int sparseEigen::run(Method m)
+{
+   std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+   _nb_op = 0, _nb_it = 0, _nconv = 0, _nnz_f = 0;
+   _lambda.clear(), _x.clear();
+   if (_n==0)
+      return 0;
+   _nev = std::max(1,std::min(_nev,_n));
+   if (_m<=_nev)
+      _m = std::max(2*_nev+1,_nev+20);
+   _m = std::min(_m,_n);
+   int ret = 0;
+   if (_shift_ok)
+      ret = _lu.factor(_A,_shift,_M);
+   else if (_M)
+      ret = _lu.factor(*_M);
+   if (ret)
+      return 2;
+   if (_shift_ok || _M)
+      _nnz_f = _lu.getNnz();
+   _w.resize(_n), _z.resize(_n);
+   ret = (m==LANCZOS) ? lanczos() : arnoldi();
+   _time = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+   return ret;
+}
+
+
+int sparseEigen::lanczos()
+{
+   int n=_n, m=_m;
+   bool Mi = (_M!=nullptr);
+   _V.assign(size_t(n)*(m+1),0.);
+   _H.assign(m*m,0.);
+   double *V=&_V[0], *w=&_w[0], *H=&_H[0], beta=0.;
+   vector<double> h(m+1), theta, Y, tmp;
+   startVector(w);
+   beta = orthogonalize(-1,Mi,nullptr);
+   for (int l=0; l<n; ++l)
+      V[l] = w[l]/beta;
+
+   int k=0, ret=1;
+   vector<int> idx(m);
+   for (_nb_it=0; _nb_it<_max_it; ++_nb_it) {
+
+//    Extend Lanczos basis from k to m vectors
+      for (int j=k; j<m; ++j) {
+         op(V+size_t(j)*n,w);
+         double w0 = sqrt(fabs(dot(w,w)));
+         beta = orthogonalize(j,Mi,&h[0]);
+         for (int i=0; i<=j; ++i)
+            H[i*m+j] = H[j*m+i] = h[i];
+         if (beta<=1.e-12*w0) {
+            startVector(w);
+            beta = orthogonalize(j,Mi,nullptr);
+            for (int l=0; l<n; ++l)
+               V[size_t(j+1)*n+l] = w[l]/beta;
+            beta = 0.;
+         }
+         else {
+            for (int l=0; l<n; ++l)
+               V[size_t(j+1)*n+l] = w[l]/beta;
+         }
+         if (j<m-1)
+            H[(j+1)*m+j] = H[j*m+j+1] = beta;
+      }
+
+//    Ritz pairs, sorted by decreasing magnitude
+      symEig(m,_H,theta,Y);
+      std::iota(idx.begin(),idx.end(),0);
+      std::sort(idx.begin(),idx.end(),[&](int a, int b) { return fabs(theta[a])>fabs(theta[b]); });
+      _nconv = 0;
+      for (int i=0; i<_nev; ++i) {
+         double t = theta[idx[i]];
+         if (fabs(beta*Y[(m-1)*m+idx[i]])<=_tol*std::max(fabs(t),1.e-300))
+            _nconv++;
+      }
+      if (_nconv==_nev || beta==0.) {
+         ret = 0;
+         break;
+      }
+      if (_nb_it==_max_it-1)
+         break;
+
+//    Thick restart: keep Ritz vectors of the largest Ritz values
+      int kk = std::min(m-1,_nev+(m-_nev)/2);
+      tmp.assign(size_t(n)*kk,0.);
+      for (int c=0; c<kk; ++c) {
+         for (int j=0; j<m; ++j) {
+            double y = Y[j*m+idx[c]];
+            const double *v = V + size_t(j)*n;
+            for (int l=0; l<n; ++l)
+               tmp[size_t(c)*n+l] += y*v[l];
+         }
+      }
+      std::copy(V+size_t(m)*n,V+size_t(m+1)*n,V+size_t(kk)*n);
+      std::copy(tmp.begin(),tmp.end(),V);
+      std::fill(_H.begin(),_H.end(),0.);
+      for (int c=0; c<kk; ++c)
+         H[c*m+c] = theta[idx[c]];
+      k = kk;
+   }
+
+   for (int i=0; i<_nev; ++i) {
+      _lambda.push_back(eigenvalue(theta[idx[i]]));
+      vector<cplx> x(n,0.);
+      for (int j=0; j<m; ++j) {
+         double y = Y[j*m+idx[i]];
+         for (int l=0; l<n; ++l)
+            x[l] += y*V[size_t(j)*n+l];
+      }
+      _x.push_back(x);
+   }
+   return ret;
+}
+
+
+int sparseEigen::arnoldi()
+{
+   int n=_n, m=_m;
+   _V.assign(size_t(n)*(m+1),0.);
+   _H.assign(m*m,0.);
+   double *V=&_V[0], *w=&_w[0], *H=&_H[0], beta=0.;
+   vector<double> h(m+1), Q, Q1, T(m*m), tmp;
+   vector<cplx> theta;
+   vector<vector<cplx> > y(_nev);
+   startVector(w);
+   beta = orthogonalize(-1,false,nullptr);
+   for (int l=0; l<n; ++l)
+      V[l] = w[l]/beta;
+
+   int k=0, ret=1;
+   for (_nb_it=0; _nb_it<_max_it; ++_nb_it) {
+
+//    Extend Arnoldi factorization from k to m vectors
+      for (int j=k; j<m; ++j) {
+         op(V+size_t(j)*n,w);
+         double w0 = sqrt(dot(w,w));
+         beta = orthogonalize(j,false,&h[0]);
+         for (int i=0; i<=j; ++i)
+            H[i*m+j] = h[i];
+         if (beta<=1.e-12*w0) {
+            startVector(w);
+            beta = orthogonalize(j,false,nullptr);
+            for (int l=0; l<n; ++l)
+               V[size_t(j+1)*n+l] = w[l]/beta;
+            beta = 0.;
+         }
+         else {
+            for (int l=0; l<n; ++l)
+               V[size_t(j+1)*n+l] = w[l]/beta;
+         }
+         if (j<m-1)
+            H[(j+1)*m+j] = beta;
+      }
+
+//    Ritz values sorted by decreasing magnitude, and Ritz estimates
+      if (hessEig(m,_H,theta))
+         break;
+      std::sort(theta.begin(),theta.end(),[](const cplx& a, const cplx& b) {
+                   return std::abs(a)>std::abs(b) || (std::abs(a)==std::abs(b) && a.imag()>b.imag()); });
+      _nconv = 0;
+      for (int i=0; i<_nev; ++i) {
+         eigVector(m,_H,theta[i],y[i]);
+         if (beta*std::abs(y[i][m-1])<=_tol*std::max(std::abs(theta[i]),1.e-300))
+            _nconv++;
+      }
+      if (_nconv==_nev || beta==0.) {
+         ret = 0;
+         break;
+      }
+      if (_nb_it==_max_it-1)
+         break;
+
+//    Implicit restart: unwanted Ritz values are used as shifts. A complex
+//    conjugate pair is applied as one real double shift
+      int kk = std::min(m-1,_nev+(m-_nev)/2);
+      auto pair = [&](int i) { return theta[i].imag()!=0. &&
+                               std::abs(theta[i+1]-std::conj(theta[i]))<=1.e-8*std::abs(theta[i]); };
+      if (pair(kk-1))
+         kk = (kk+1<m) ? kk+1 : kk-1;
+      Q.assign(m*m,0.);
+      for (int i=0; i<m; ++i)
+         Q[i*m+i] = 1.;
+      for (int s=kk; s<m; ++s) {
+         cplx mu = theta[s];
+         bool dbl = (s+1<m && pair(s));
+         for (int i=0; i<m; ++i) {
+            for (int j=0; j<m; ++j) {
+               double v = (dbl) ? -2*mu.real()*H[i*m+j] : H[i*m+j];
+               if (dbl) {
+                  for (int l=0; l<m; ++l)
+                     v += H[i*m+l]*H[l*m+j];
+               }
+               if (i==j)
+                  v += (dbl) ? std::norm(mu) : -mu.real();
+               T[i*m+j] = v;
+            }
+         }
+         qrFactor(m,T,Q1);
+         for (int i=0; i<m; ++i) {
+            for (int j=0; j<m; ++j) {
+               double v = 0.;
+               for (int l=0; l<m; ++l)
+                  v += H[i*m+l]*Q1[l*m+j];
+               T[i*m+j] = v;
+            }
+         }
+         for (int i=0; i<m; ++i) {
+            for (int j=0; j<m; ++j) {
+               double v = 0.;
+               if (i<=j+1) {
+                  for (int l=0; l<m; ++l)
+                     v += Q1[l*m+i]*T[l*m+j];
+               }
+               H[i*m+j] = v;
+            }
+         }
+         tmp.assign(Q.begin(),Q.end());
+         for (int i=0; i<m; ++i) {
+            for (int j=0; j<m; ++j) {
+               double v = 0.;
+               for (int l=0; l<m; ++l)
+                  v += tmp[i*m+l]*Q1[l*m+j];
+               Q[i*m+j] = v;
+            }
+         }
+         if (dbl)
+            s++;
+      }
+
+//    New residual and basis: f = V Q(:,kk) H(kk,kk-1) + f Q(m-1,kk-1)
+      double bk=H[kk*m+kk-1], sk=beta*Q[(m-1)*m+kk-1];
+      tmp.assign(size_t(n)*(kk+1),0.);
+      for (int c=0; c<=kk; ++c) {
+         for (int j=0; j<m; ++j) {
+            double q = Q[j*m+c];
+            const double *v = V + size_t(j)*n;
+            for (int l=0; l<n; ++l)
+               tmp[size_t(c)*n+l] += q*v[l];
+         }
+      }
+      for (int l=0; l<n; ++l)
+         w[l] = bk*tmp[size_t(kk)*n+l] + sk*V[size_t(m)*n+l];
+      std::copy(tmp.begin(),tmp.begin()+size_t(kk)*n,V);
+      for (int i=0; i<m; ++i) {
+         for (int j=0; j<m; ++j) {
+            if (i>=kk || j>=kk)
+               H[i*m+j] = 0.;
+         }
+      }
+      beta = sqrt(dot(w,w));
+      if (beta==0.) {
+         startVector(w);
+         beta = orthogonalize(kk-1,false,nullptr);
+      }
+      else
+         H[kk*m+kk-1] = beta;
+      for (int l=0; l<n; ++l)
+         V[size_t(kk)*n+l] = w[l]/beta;
+      k = kk;
+   }
+
+   for (int i=0; i<_nev; ++i) {
+      _lambda.push_back(eigenvalue(theta[i]));
+      vector<cplx> x(n,0.);
+      for (int j=0; j<m; ++j) {
+         cplx c = y[i][j];
+         for (int l=0; l<n; ++l)
+            x[l] += c*V[size_t(j)*n+l];
+      }
+      _x.push_back(x);
+   }
+   return ret;
+}
+
+
+double sparseEigen::getEigenValue(int i,
+                                  int part) const
+{
+   if (i<1 || i>int(_lambda.size()))
+      return 0.;
+   return (part==2) ? _lambda[i-1].imag() : _lambda[i-1].real();
+}
+
+
+void sparseEigen::getEigenVector(int             i,
+                                 vector<double>& re,
+                                 vector<double>& im) const
+{
+   re.assign(_n,0.), im.assign(_n,0.);
+   if (i<1 || i>int(_x.size()))
+      return;
+   for (int l=0; l<_n; ++l)
+      re[l] = _x[i-1][l].real(), im[l] = _x[i-1][l].imag();
+}
+
+} /* namespace RITA */
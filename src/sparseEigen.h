@@ -0,0 +1,123 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                       Definition of class 'sparseEigen'
+
+  ==============================================================================*/
+
+#pragma once
+
+#include "sparseLU.h"
+#include <vector>
+#include <complex>
+#include <cstddef>
+
+using std::vector;
+
+namespace RITA {
+
+/*! \class sparseEigen
+ *  \brief Iterative solver for a few eigenpairs of a large sparse matrix.
+ *
+ *  The eigenproblem is A x = lambda x or, if a mass matrix is given, the generalized
+ *  problem A x = lambda M x with M symmetric positive definite. Without shift, the
+ *  eigenvalues of largest magnitude are computed. With a shift s, the eigenvalues
+ *  closest to s are computed by applying the Krylov method to (A - s M)^{-1} M, whose
+ *  sparse LU factorization is computed once.
+ *
+ *  Symmetric problems use the Lanczos method with thick restarts in the M inner
+ *  product, general problems use the implicitly restarted Arnoldi method with exact
+ *  shifts. Krylov bases are kept fully orthogonal. Memory is that of the factors plus
+ *  a few tens of vectors.
+ *
+ * \author Rachid Touzani
+ * \copyright GNU Public License
+ */
+
+class sparseEigen
+{
+
+ public:
+
+    enum Method {
+       LANCZOS,
+       ARNOLDI
+    };
+
+    sparseEigen(const CSR& A);
+    ~sparseEigen() { }
+
+/// \brief Set mass matrix for the generalized eigenproblem
+    void setMass(const CSR& M) { _M = &M; }
+
+/// \brief Compute eigenvalues close to \c s
+    void setShift(double s) { _shift = s, _shift_ok = true; }
+
+    void setNbEigv(int nb) { _nev = nb; }
+    void setTolerance(double tol) { _tol = tol; }
+    void setMaxIter(int n) { _max_it = n; }
+
+/// \brief Set dimension of Krylov subspace. Default value is max(2*nb+1,nb+20)
+    void setSubspace(int m) { _m = m; }
+
+/// \brief Compute eigenpairs
+/// \return 0 if all requested eigenpairs converged, 1 if the maximal number of restarts
+/// is reached, 2 if the shifted matrix is singular
+    int run(Method m);
+
+/// \brief Return real (\c part=1) or imaginary (\c part=2) part of \c i-th eigenvalue (\c i>=1)
+    double getEigenValue(int i, int part=1) const;
+
+/// \brief Copy real and imaginary parts of \c i-th eigenvector (\c i>=1)
+    void getEigenVector(int i, vector<double>& re, vector<double>& im) const;
+
+    int getNbConverged() const { return _nconv; }
+    int getNbRestarts() const { return _nb_it; }
+    size_t getNbOp() const { return _nb_op; }
+    size_t getNnzFactor() const { return _nnz_f; }
+    double getTime() const { return _time; }
+
+ private:
+
+    typedef std::complex<double> cplx;
+    const CSR &_A, *_M;
+    int _n, _nev, _m, _max_it, _nb_it, _nconv;
+    bool _shift_ok;
+    double _shift, _tol, _time;
+    size_t _nb_op, _nnz_f;
+    sparseLU _lu;
+    vector<double> _V, _H, _w, _z;
+    vector<cplx> _lambda;
+    vector<vector<cplx> > _x;
+
+    void op(const double *x, double *y);
+    double dot(const double *x, const double *y);
+    double orthogonalize(int j, bool Minner, double *h);
+    void startVector(double *v);
+    cplx eigenvalue(cplx theta) const;
+    int lanczos();
+    int arnoldi();
+};
+
+} /* namespace RITA */
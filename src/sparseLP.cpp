@@ -0,0 +1,397 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                       Implementation of class 'sparseLP'
+
+  ==============================================================================*/
+
+#include "sparseLP.h"
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+
+using std::chrono::steady_clock;
+
+namespace RITA {
+
+namespace {
+
+double since(const steady_clock::time_point& t)
+{
+   return std::chrono::duration<double>(steady_clock::now()-t).count();
+}
+
+
+double dot(const vector<double>& x, const vector<double>& y)
+{
+   double s = 0.;
+   for (size_t i=0; i<x.size(); ++i)
+      s += x[i]*y[i];
+   return s;
+}
+
+
+double norm(const vector<double>& x) { return sqrt(dot(x,x)); }
+
+
+// Largest step in (0,1] keeping x + a*dx nonnegative
+double maxStep(const vector<double>& x,
+               const vector<double>& dx)
+{
+   double a = 1.;
+   for (size_t i=0; i<x.size(); ++i) {
+      if (dx[i]<0.)
+         a = std::min(a,-x[i]/dx[i]);
+   }
+   return a;
+}
+
+} /* namespace */
+
+
+sparseLP::sparseLP(int n)
+         : _n(n), _m(0), _nn(0), _max_it(100), _nb_it(0), _c0(0.), _tol(1.e-8), _obj(0.),
+           _t_fact(0.), _t_solve(0.), _t_total(0.), _res_p(0.), _res_d(0.), _gap(0.),
+           _nnz_a(0), _c(n,0.), _A(n)
+{
+}
+
+
+void sparseLP::setObjective(const vector<double>& c,
+                            double                c0)
+{
+   for (int i=0; i<_n && i<int(c.size()); ++i)
+      _c[i] = c[i];
+   _c0 = c0;
+}
+
+
+void sparseLP::addConstraints(Type                  t,
+                              const CSR&            A,
+                              const vector<double>& b)
+{
+   for (int i=0; i<A.nbRows(); ++i) {
+      for (int k=A.ptr[i]; k<A.ptr[i+1]; ++k)
+         _A.col.push_back(A.col[k]), _A.val.push_back(A.val[k]);
+      _A.ptr.push_back(int(_A.val.size()));
+      _b.push_back(b[i]);
+      _type.push_back(t);
+   }
+   _m = _A.nbRows();
+}
+
+
+void sparseLP::standardForm(vector<double>& c)
+{
+// Columns of original variables (transpose of CSR) followed by slack columns
+   int nb_slack = 0;
+   for (int i=0; i<_m; ++i)
+      nb_slack += (_type[i]!=EQ);
+   _nn = _n + nb_slack;
+   _Ap.assign(_nn+1,0);
+   for (size_t k=0; k<_A.nnz(); ++k)
+      _Ap[_A.col[k]+1]++;
+   for (int j=0; j<_n; ++j)
+      _Ap[j+1] += _Ap[j];
+   _Ai.resize(_A.nnz()+nb_slack);
+   _Ax.resize(_A.nnz()+nb_slack);
+   vector<int> pos(_Ap.begin(),_Ap.begin()+_n);
+   for (int i=0; i<_m; ++i) {
+      for (int k=_A.ptr[i]; k<_A.ptr[i+1]; ++k) {
+         int p = pos[_A.col[k]]++;
+         _Ai[p] = i, _Ax[p] = _A.val[k];
+      }
+   }
+   int j = _n, p = _Ap[_n];
+   for (int i=0; i<_m; ++i) {
+      if (_type[i]==EQ)
+         continue;
+      _Ai[p] = i, _Ax[p] = (_type[i]==LE) ? 1. : -1.;
+      _Ap[++j] = ++p;
+   }
+   _nnz_a = _A.nnz();
+   c.assign(_nn,0.);
+   for (int j=0; j<_n; ++j)
+      c[j] = _c[j];
+}
+
+
+void sparseLP::analyse()
+{
+// Graph of A*A^T, ordered by minimum degree. The neighbours of a node when it
+// is eliminated form the pattern of its column in the factor
+   vector<vector<int> > adj(_m), pat;
+   for (int j=0; j<_nn; ++j) {
+      for (int p=_Ap[j]; p<_Ap[j+1]; ++p) {
+         for (int q=_Ap[j]; q<_Ap[j+1]; ++q) {
+            if (p!=q)
+               adj[_Ai[p]].push_back(_Ai[q]);
+         }
+      }
+   }
+   minimumDegree(adj,_perm,&pat);
+   _iperm.resize(_m);
+   for (int k=0; k<_m; ++k)
+      _iperm[_perm[k]] = k;
+
+// Pattern of L by columns and by rows, in permuted numbering
+   _Lp.assign(_m+1,0);
+   _Li.clear();
+   for (int k=0; k<_m; ++k) {
+      vector<int> &c = pat[_perm[k]];
+      for (int &u: c)
+         u = _iperm[u];
+      std::sort(c.begin(),c.end());
+      _Li.insert(_Li.end(),c.begin(),c.end());
+      _Lp[k+1] = int(_Li.size());
+   }
+   _Lx.resize(_Li.size());
+   _Rp.assign(_m+1,0);
+   for (int i: _Li)
+      _Rp[i+1]++;
+   for (int i=0; i<_m; ++i)
+      _Rp[i+1] += _Rp[i];
+   _Ri.resize(_Li.size());
+   vector<int> pos(_Rp.begin(),_Rp.end()-1);
+   for (int k=0; k<_m; ++k) {
+      for (int p=_Lp[k]; p<_Lp[k+1]; ++p)
+         _Ri[pos[_Li[p]]++] = k;
+   }
+
+// Position in the factor of each product A(a,j)*A(b,j) of the normal matrix
+   _slot.clear();
+   for (int j=0; j<_nn; ++j) {
+      for (int p=_Ap[j]; p<_Ap[j+1]; ++p) {
+         for (int q=p; q<_Ap[j+1]; ++q) {
+            int ip=_iperm[_Ai[p]], iq=_iperm[_Ai[q]];
+            Slot s;
+            s.a = p, s.b = q, s.c = j;
+            if (ip==iq)
+               s.pos = -1 - ip;
+            else {
+               int lo=std::min(ip,iq), hi=std::max(ip,iq);
+               s.pos = int(std::lower_bound(_Li.begin()+_Lp[lo],_Li.begin()+_Lp[lo+1],hi) - _Li.begin());
+            }
+            _slot.push_back(s);
+         }
+      }
+   }
+   _D.resize(_m), _w.assign(_m,0.);
+}
+
+
+void sparseLP::factor(const vector<double>& d)
+{
+   steady_clock::time_point t0 = steady_clock::now();
+   std::fill(_Lx.begin(),_Lx.end(),0.);
+   std::fill(_D.begin(),_D.end(),0.);
+   for (const Slot& s: _slot) {
+      double v = _Ax[s.a]*d[s.c]*_Ax[s.b];
+      if (s.pos<0)
+         _D[-1-s.pos] += v;
+      else
+         _Lx[s.pos] += v;
+   }
+   double dmax = 0.;
+   for (int i=0; i<_m; ++i)
+      dmax = std::max(dmax,_D[i]);
+
+// Left looking LDL^T factorization. Tiny pivots, that come from dependent
+// constraints, are replaced by a huge value which cancels the corresponding unknown
+   vector<int> next(_Lp.begin(),_Lp.end()-1);
+   for (int j=0; j<_m; ++j) {
+      for (int p=_Lp[j]; p<_Lp[j+1]; ++p)
+         _w[_Li[p]] = _Lx[p];
+      double dj = _D[j];
+      for (int r=_Rp[j]; r<_Rp[j+1]; ++r) {
+         int k=_Ri[r], p=next[k]++;
+         double t = _Lx[p]*_D[k];
+         dj -= _Lx[p]*t;
+         for (int q=p+1; q<_Lp[k+1]; ++q)
+            _w[_Li[q]] -= _Lx[q]*t;
+      }
+      if (dj<=1.e-30*std::max(1.,dmax))
+         dj = 1.e128;
+      _D[j] = dj;
+      for (int p=_Lp[j]; p<_Lp[j+1]; ++p) {
+         _Lx[p] = _w[_Li[p]]/dj;
+         _w[_Li[p]] = 0.;
+      }
+   }
+   _t_fact += since(t0);
+}
+
+
+void sparseLP::solve(vector<double>& r)
+{
+   steady_clock::time_point t0 = steady_clock::now();
+   for (int k=0; k<_m; ++k)
+      _w[k] = r[_perm[k]];
+   for (int j=0; j<_m; ++j) {
+      for (int p=_Lp[j]; p<_Lp[j+1]; ++p)
+         _w[_Li[p]] -= _Lx[p]*_w[j];
+   }
+   for (int j=0; j<_m; ++j)
+      _w[j] /= _D[j];
+   for (int j=_m-1; j>=0; --j) {
+      for (int p=_Lp[j]; p<_Lp[j+1]; ++p)
+         _w[j] -= _Lx[p]*_w[_Li[p]];
+   }
+   for (int k=0; k<_m; ++k)
+      r[_perm[k]] = _w[k], _w[k] = 0.;
+   _t_solve += since(t0);
+}
+
+
+void sparseLP::Ax(const vector<double>& x,
+                  vector<double>&       y) const
+{
+   y.assign(_m,0.);
+   for (int j=0; j<_nn; ++j) {
+      for (int p=_Ap[j]; p<_Ap[j+1]; ++p)
+         y[_Ai[p]] += _Ax[p]*x[j];
+   }
+}
+
+
+void sparseLP::ATx(const vector<double>& y,
+                   vector<double>&       x) const
+{
+   x.assign(_nn,0.);
+   for (int j=0; j<_nn; ++j) {
+      for (int p=_Ap[j]; p<_Ap[j+1]; ++p)
+         x[j] += _Ax[p]*y[_Ai[p]];
+   }
+}
+
+
+int sparseLP::run(vector<double>& x)
+{
+   steady_clock::time_point t0 = steady_clock::now();
+   _nb_it = 0, _t_fact = _t_solve = 0.;
+   vector<double> c;
+   standardForm(c);
+   x.assign(_n,0.);
+   if (_m==0) {
+      _obj = _c0;
+      _t_total = since(t0);
+      for (int j=0; j<_n; ++j) {
+         if (_c[j]<0.)
+            return 2;
+      }
+      return 0;
+   }
+   analyse();
+
+// Starting point of Mehrotra: least squares solutions shifted to the interior
+   vector<double> z(_nn), s(_nn), y(_b), t, d(_nn,1.);
+   factor(d);
+   solve(y);
+   ATx(y,z);
+   Ax(c,y);
+   solve(y);
+   ATx(y,t);
+   for (int j=0; j<_nn; ++j)
+      s[j] = c[j] - t[j];
+   double hz = std::max(-1.5*(*std::min_element(z.begin(),z.end())),0.);
+   double hs = std::max(-1.5*(*std::min_element(s.begin(),s.end())),0.);
+   double zs=0., sz=0., ss=0.;
+   for (int j=0; j<_nn; ++j) {
+      z[j] += hz, s[j] += hs;
+      zs += z[j]*s[j], sz += z[j], ss += s[j];
+   }
+   for (int j=0; j<_nn; ++j) {
+      z[j] += (ss>0.) ? 0.5*zs/ss : 1.;
+      s[j] += (sz>0.) ? 0.5*zs/sz : 1.;
+   }
+
+   double nb = 1. + norm(_b), nc = 1. + norm(c);
+   vector<double> rp(_m), rd(_nn), rc(_nn), q(_nn), dx(_nn), dy(_m), ds(_nn);
+   auto direction = [&]() {
+      for (int j=0; j<_nn; ++j)
+         q[j] = rc[j]/s[j] - d[j]*rd[j];
+      Ax(q,dy);
+      for (int i=0; i<_m; ++i)
+         dy[i] = rp[i] - dy[i];
+      solve(dy);
+      ATx(dy,t);
+      for (int j=0; j<_nn; ++j) {
+         dx[j] = q[j] + d[j]*t[j];
+         ds[j] = rd[j] - t[j];
+      }
+   };
+
+   int ret = 1;
+   for (_nb_it=0; _nb_it<_max_it; ++_nb_it) {
+      Ax(z,t);
+      for (int i=0; i<_m; ++i)
+         rp[i] = _b[i] - t[i];
+      ATx(y,t);
+      for (int j=0; j<_nn; ++j)
+         rd[j] = c[j] - t[j] - s[j];
+      double pobj=dot(c,z), dobj=dot(_b,y), mu=dot(z,s)/_nn;
+      _res_p = norm(rp)/nb, _res_d = norm(rd)/nc;
+      _gap = fabs(pobj-dobj)/(1.+fabs(pobj));
+      if (_res_p<_tol && _res_d<_tol && _gap<_tol) {
+         ret = 0;
+         break;
+      }
+      if (norm(z)>1.e12*nb || norm(y)>1.e12*nc) {
+         ret = 2;
+         break;
+      }
+      for (int j=0; j<_nn; ++j)
+         d[j] = z[j]/s[j];
+      factor(d);
+
+//    Predictor (affine scaling) step
+      for (int j=0; j<_nn; ++j)
+         rc[j] = -z[j]*s[j];
+      direction();
+      double ap=maxStep(z,dx), ad=maxStep(s,ds), mua=0.;
+      for (int j=0; j<_nn; ++j)
+         mua += (z[j]+ap*dx[j])*(s[j]+ad*ds[j]);
+      mua /= _nn;
+      double sigma = pow(mua/mu,3);
+
+//    Corrector step
+      for (int j=0; j<_nn; ++j)
+         rc[j] = -z[j]*s[j] - dx[j]*ds[j] + sigma*mu;
+      direction();
+      ap = std::min(1.,0.995*maxStep(z,dx));
+      ad = std::min(1.,0.995*maxStep(s,ds));
+      for (int j=0; j<_nn; ++j)
+         z[j] += ap*dx[j], s[j] += ad*ds[j];
+      for (int i=0; i<_m; ++i)
+         y[i] += ad*dy[i];
+   }
+   for (int j=0; j<_n; ++j)
+      x[j] = z[j];
+   _obj = dot(_c,x) + _c0;
+   _t_total = since(t0);
+   return ret;
+}
+
+} /* namespace RITA */
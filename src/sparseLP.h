@@ -0,0 +1,116 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                         Definition of class 'sparseLP'
+
+  ==============================================================================*/
+
+#pragma once
+
+#include "sparseLU.h"
+#include <vector>
+#include <cstddef>
+
+using std::vector;
+
+namespace RITA {
+
+/*! \class sparseLP
+ *  \brief Interior point solver for linear programs with sparse constraints.
+ *
+ *  The problem is: minimize <c,x> + c0 subject to x >= 0 and to constraints
+ *  A_le x <= b_le, A_ge x >= b_ge, A_eq x = b_eq, where the constraint matrices
+ *  are stored in compressed sparse row (CSR) format. Inequalities are turned into
+ *  equalities with slack variables and the problem is solved by the Mehrotra
+ *  predictor-corrector primal-dual method. Each iteration solves normal equations
+ *  A D A^T dy = r by a sparse LDL^T factorization whose pattern and fill reducing
+ *  (minimum degree) ordering are computed once.
+ *
+ * \author Rachid Touzani
+ * \copyright GNU Public License
+ */
+
+class sparseLP
+{
+
+ public:
+
+    enum Type {
+       LE,
+       GE,
+       EQ
+    };
+
+    sparseLP(int n);
+    ~sparseLP() { }
+
+/// \brief Set objective function <c,x> + c0
+    void setObjective(const vector<double>& c, double c0=0.);
+
+/// \brief Add constraints of type \c t given by matrix \c A and right-hand side \c b
+    void addConstraints(Type t, const CSR& A, const vector<double>& b);
+
+    void setTolerance(double tol) { _tol = tol; }
+    void setMaxIter(int n) { _max_it = n; }
+
+/// \brief Solve problem. Solution is returned in \c x
+/// \return 0 if an optimal solution is found, 1 if the maximal number of iterations is
+/// reached, 2 if the problem is infeasible or unbounded
+    int run(vector<double>& x);
+
+    double getObjective() const { return _obj; }
+    int getNbIter() const { return _nb_it; }
+    size_t getNnzA() const { return _nnz_a; }
+    size_t getNnzL() const { return _Li.size(); }
+    double getFactorTime() const { return _t_fact; }
+    double getSolveTime() const { return _t_solve; }
+    double getTotalTime() const { return _t_total; }
+    double getPrimalResidual() const { return _res_p; }
+    double getDualResidual() const { return _res_d; }
+    double getGap() const { return _gap; }
+
+ private:
+
+    int _n, _m, _nn, _max_it, _nb_it;
+    double _c0, _tol, _obj, _t_fact, _t_solve, _t_total, _res_p, _res_d, _gap;
+    size_t _nnz_a;
+    vector<double> _c, _b;
+    vector<Type> _type;
+    CSR _A;
+
+// Standard form matrix by columns, and normal matrix factor by columns (permuted)
+    vector<int> _Ap, _Ai, _Lp, _Li, _Rp, _Ri, _perm, _iperm;
+    vector<double> _Ax, _Lx, _D, _w;
+    struct Slot { int pos, a, b, c; };
+    vector<Slot> _slot;
+
+    void standardForm(vector<double>& c);
+    void analyse();
+    void factor(const vector<double>& d);
+    void solve(vector<double>& r);
+    void Ax(const vector<double>& x, vector<double>& y) const;
+    void ATx(const vector<double>& y, vector<double>& x) const;
+};
+
+} /* namespace RITA */
@@ -0,0 +1,248 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                       Implementation of class 'sparseLU'
+
+  ==============================================================================*/
+
+#include "sparseLU.h"
+#include <set>
+#include <cmath>
+#include <iterator>
+#include <algorithm>
+
+namespace RITA {
+
+void CSR::addRow(const vector<int>&    c,
+                 const vector<double>& v)
+{
+   for (size_t i=0; i<c.size(); ++i) {
+      if (v[i]!=0.)
+         col.push_back(c[i]), val.push_back(v[i]);
+   }
+   ptr.push_back(int(val.size()));
+}
+
+
+void CSR::addRow(const double* a)
+{
+   for (int j=0; j<nb_cols; ++j) {
+      if (a[j]!=0.)
+         col.push_back(j), val.push_back(a[j]);
+   }
+   ptr.push_back(int(val.size()));
+}
+
+
+void CSR::mult(const double* x,
+               double*       y) const
+{
+   for (int i=0; i<nbRows(); ++i) {
+      double s = 0.;
+      for (int k=ptr[i]; k<ptr[i+1]; ++k)
+         s += val[k]*x[col[k]];
+      y[i] = s;
+   }
+}
+
+
+void minimumDegree(vector<vector<int> >  adj,
+                   vector<int>&          perm,
+                   vector<vector<int> >* pat)
+{
+   int n = int(adj.size());
+   for (auto& a: adj) {
+      std::sort(a.begin(),a.end());
+      a.erase(std::unique(a.begin(),a.end()),a.end());
+   }
+   std::set<std::pair<int,int> > q;
+   for (int i=0; i<n; ++i)
+      q.insert(std::make_pair(int(adj[i].size()),i));
+   perm.resize(n);
+   if (pat)
+      pat->resize(n);
+   vector<int> a, nb;
+   for (int k=0; k<n; ++k) {
+      int v = q.begin()->second;
+      q.erase(q.begin());
+      perm[k] = v;
+      nb.swap(adj[v]);
+      adj[v].clear();
+
+//    Neighbours of eliminated node become a clique
+      for (int u: nb) {
+         q.erase(std::make_pair(int(adj[u].size()),u));
+         a.clear();
+         std::set_union(adj[u].begin(),adj[u].end(),nb.begin(),nb.end(),std::back_inserter(a));
+         adj[u].clear();
+         for (int w: a) {
+            if (w!=u && w!=v)
+               adj[u].push_back(w);
+         }
+         q.insert(std::make_pair(int(adj[u].size()),u));
+      }
+      if (pat)
+         (*pat)[v] = nb;
+   }
+}
+
+
+int sparseLU::factor(const CSR&  A,
+                     double      s,
+                     const CSR*  B)
+{
+   _n = A.nbRows();
+   int n = _n;
+
+// Matrix A - s*B by columns
+   vector<vector<std::pair<int,double> > > c(n);
+   for (int i=0; i<n; ++i) {
+      for (int k=A.ptr[i]; k<A.ptr[i+1]; ++k)
+         c[A.col[k]].push_back(std::make_pair(i,A.val[k]));
+      if (B) {
+         for (int k=B->ptr[i]; k<B->ptr[i+1]; ++k)
+            c[B->col[k]].push_back(std::make_pair(i,-s*B->val[k]));
+      }
+      else if (s!=0.)
+         c[i].push_back(std::make_pair(i,-s));
+   }
+
+// Column ordering from the pattern of A+A^T
+   vector<vector<int> > adj(n);
+   for (int j=0; j<n; ++j) {
+      for (const auto& e: c[j]) {
+         if (e.first!=j)
+            adj[j].push_back(e.first), adj[e.first].push_back(j);
+      }
+   }
+   minimumDegree(adj,_q);
+   adj.clear();
+
+   _pinv.assign(n,-1);
+   _Lp.assign(1,0), _Up.assign(1,0);
+   _Li.clear(), _Lx.clear(), _Ui.clear(), _Ux.clear();
+   _Ud.resize(n), _w.assign(n,0.);
+   vector<int> mark(n,-1), reach, stack, pos(n);
+   vector<double> &x = _w;
+   for (int j=0; j<n; ++j) {
+
+//    Rows reached from the nonzero terms of column j through the graph of L,
+//    in topological order
+      reach.clear();
+      for (const auto& e: c[_q[j]]) {
+         if (mark[e.first]==j)
+            continue;
+         stack.assign(1,e.first);
+         mark[e.first] = j;
+         pos[e.first] = (_pinv[e.first]>=0) ? _Lp[_pinv[e.first]] : 0;
+         while (stack.size()) {
+            int i=stack.back(), k=_pinv[i];
+            bool done = true;
+            if (k>=0) {
+               for (int &p=pos[i]; p<_Lp[k+1]; ++p) {
+                  int r = _Li[p];
+                  if (mark[r]!=j) {
+                     mark[r] = j;
+                     stack.push_back(r);
+                     pos[r] = (_pinv[r]>=0) ? _Lp[_pinv[r]] : 0;
+                     done = false;
+                     break;
+                  }
+               }
+            }
+            if (done) {
+               reach.push_back(i);
+               stack.pop_back();
+            }
+         }
+      }
+      std::reverse(reach.begin(),reach.end());
+
+//    Sparse triangular solve
+      for (int i: reach)
+         x[i] = 0.;
+      for (const auto& e: c[_q[j]])
+         x[e.first] += e.second;
+      for (int i: reach) {
+         int k = _pinv[i];
+         if (k<0)
+            continue;
+         for (int p=_Lp[k]; p<_Lp[k+1]; ++p)
+            x[_Li[p]] -= _Lx[p]*x[i];
+      }
+
+//    Pivot: the diagonal term if not too small, the largest term otherwise
+      int piv = -1;
+      double amax = 0.;
+      for (int i: reach) {
+         if (_pinv[i]<0 && fabs(x[i])>amax)
+            amax = fabs(x[i]), piv = i;
+      }
+      if (piv<0 || amax==0.)
+         return 1;
+      int d = _q[j];
+      if (_pinv[d]<0 && mark[d]==j && fabs(x[d])>=0.1*amax)
+         piv = d;
+      _pinv[piv] = j;
+      _Ud[j] = x[piv];
+      for (int i: reach) {
+         if (i==piv)
+            continue;
+         if (_pinv[i]>=0 && _pinv[i]<j)
+            _Ui.push_back(_pinv[i]), _Ux.push_back(x[i]);
+         else if (x[i]!=0.)
+            _Li.push_back(i), _Lx.push_back(x[i]/_Ud[j]);
+         x[i] = 0.;
+      }
+      x[piv] = 0.;
+      _Lp.push_back(int(_Li.size()));
+      _Up.push_back(int(_Ui.size()));
+   }
+
+// Row indices of L in pivotal order
+   for (int &i: _Li)
+      i = _pinv[i];
+   return 0;
+}
+
+
+void sparseLU::solve(double* b) const
+{
+   vector<double> &z = _w;
+   for (int i=0; i<_n; ++i)
+      z[_pinv[i]] = b[i];
+   for (int j=0; j<_n; ++j) {
+      for (int p=_Lp[j]; p<_Lp[j+1]; ++p)
+         z[_Li[p]] -= _Lx[p]*z[j];
+   }
+   for (int j=_n-1; j>=0; --j) {
+      z[j] /= _Ud[j];
+      for (int p=_Up[j]; p<_Up[j+1]; ++p)
+         z[_Ui[p]] -= _Ux[p]*z[j];
+   }
+   for (int j=0; j<_n; ++j)
+      b[_q[j]] = z[j], z[j] = 0.;
+}
+
+} /* namespace RITA */
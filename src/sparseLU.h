@@ -0,0 +1,106 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                         Definition of class 'sparseLU'
+
+  ==============================================================================*/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+using std::vector;
+
+namespace RITA {
+
+/*! \struct CSR
+ *  \brief Sparse matrix in compressed row storage. Indices start from 0
+ */
+struct CSR {
+   int nb_cols;
+   vector<int> ptr, col;
+   vector<double> val;
+   CSR(int nc=0) : nb_cols(nc), ptr(1,0) { }
+   int nbRows() const { return int(ptr.size()) - 1; }
+   size_t nnz() const { return val.size(); }
+
+/// \brief Add a row given by column indices and values. Zero values are not stored
+   void addRow(const vector<int>& c, const vector<double>& v);
+
+/// \brief Add a row given by its \c nb_cols values. Zero values are not stored
+   void addRow(const double *a);
+
+/// \brief Compute y = A*x
+   void mult(const double *x, double *y) const;
+};
+
+
+/// \brief Minimum degree ordering of a symmetric graph given by its adjacency lists
+/// (without diagonal). Node eliminated at step \c k is stored in \c perm[k]. If \c pat
+/// is given, it receives for each node its neighbours when eliminated, i.e. the
+/// pattern of its column in the Cholesky factor
+void minimumDegree(vector<vector<int> > adj, vector<int>& perm, vector<vector<int> > *pat=nullptr);
+
+
+/*! \class sparseLU
+ *  \brief LU factorization of a sparse square matrix.
+ *
+ *  Columns are ordered by minimum degree on the pattern of A+A^T, and each column
+ *  is computed by a sparse triangular solve restricted to the nonzero terms it
+ *  reaches (left looking Gilbert-Peierls algorithm). Rows are chosen by threshold
+ *  partial pivoting that favours the diagonal, so that symmetric matrices keep the
+ *  fill of the ordering. Memory is proportional to the number of nonzero terms of
+ *  the factors.
+ *
+ * \author Rachid Touzani
+ * \copyright GNU Public License
+ */
+
+class sparseLU
+{
+
+ public:
+
+    sparseLU() : _n(0) { }
+    ~sparseLU() { }
+
+/// \brief Factorize matrix A - s*B (B = identity if not given)
+/// \return 0 on success, 1 if matrix is singular
+    int factor(const CSR& A, double s=0., const CSR *B=nullptr);
+
+/// \brief Solve linear system using computed factorization. \c b is overwritten by solution
+    void solve(double *b) const;
+
+    size_t getNnz() const { return _Li.size() + _Ui.size() + _n; }
+
+ private:
+
+    int _n;
+    vector<int> _q, _pinv, _Lp, _Li, _Up, _Ui;
+    vector<double> _Lx, _Ux, _Ud;
+    mutable vector<double> _w;
+};
+
+} /* namespace RITA */
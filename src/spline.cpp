@@ -0,0 +1,395 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                        Implementation of class 'spline'
+
+  ==============================================================================*/
+
+#include "spline.h"
+#include <cmath>
+#include <sstream>
+#include <algorithm>
+
+namespace RITA {
+
+namespace {
+
+// Gaussian elimination without pivoting of a band matrix with half bandwidth p.
+// Row i is stored in a[i*(2p+1)+j-i+p]. Collocation matrices of B-splines (totally
+// positive) and normal matrices (positive definite) do not require pivoting
+int bandSolve(vector<double>& a, vector<double>& b, int n, int p)
+{
+   int w = 2*p + 1;
+   for (int k=0; k<n; ++k) {
+      double piv = a[k*w+p];
+      if (std::fabs(piv)<1.e-14)
+         return 2;
+      for (int i=k+1; i<=std::min(n-1,k+p); ++i) {
+         double l = a[i*w+k-i+p]/piv;
+         if (l==0.)
+            continue;
+         for (int j=k; j<=std::min(n-1,k+p); ++j)
+            a[i*w+j-i+p] -= l*a[k*w+j-k+p];
+         b[i] -= l*b[k];
+      }
+   }
+   for (int k=n-1; k>=0; --k) {
+      for (int j=k+1; j<=std::min(n-1,k+p); ++j)
+         b[k] -= a[k*w+j-k+p]*b[j];
+      b[k] /= a[k*w+p];
+   }
+   return 0;
+}
+
+} /* namespace */
+
+
+spline::spline()
+       : _type(LAGRANGE), _deg(0), _res(0.)
+{
+}
+
+
+int spline::check(const vector<double>& x,
+                  const vector<double>& y) const
+{
+   if (x.size()!=y.size() || x.size()<2)
+      return 1;
+   for (size_t i=1; i<x.size(); ++i) {
+      if (x[i]<=x[i-1])
+         return 1;
+   }
+   return 0;
+}
+
+
+size_t spline::span(double x,
+                    size_t k) const
+{
+   size_t lo=0, hi=0;
+   if (_type==HERMITE)
+      hi = _t.size() - 2;
+   else
+      lo = _deg, hi = _c.size() - 1;
+   if (k>=lo && k<=hi && (_t[k]<=x || k==lo)) {
+      if (k==hi || x<_t[k+1])
+         return k;
+      if (k+1==hi || x<_t[k+2])
+         return k + 1;
+   }
+   return size_t(std::upper_bound(_t.begin()+lo+1,_t.begin()+hi+1,x) - _t.begin()) - 1;
+}
+
+
+void spline::basis(size_t k,
+                   double x,
+                   double *N) const
+{
+   vector<double> left(_deg+1), right(_deg+1);
+   N[0] = 1.;
+   for (int j=1; j<=_deg; ++j) {
+      left[j] = x - _t[k+1-j];
+      right[j] = _t[k+j] - x;
+      double saved = 0.;
+      for (int r=0; r<j; ++r) {
+         double tmp = N[r]/(right[r+1]+left[j-r]);
+         N[r] = saved + right[r+1]*tmp;
+         saved = left[j-r]*tmp;
+      }
+      N[j] = saved;
+   }
+}
+
+
+void spline::uniformKnots(double a,
+                          double b,
+                          size_t nc)
+{
+   _t.assign(nc+_deg+1,a);
+   for (size_t j=1; j+_deg<nc; ++j)
+      _t[j+_deg] = a + (b-a)*double(j)/double(nc-_deg);
+   for (size_t j=nc; j<_t.size(); ++j)
+      _t[j] = b;
+}
+
+
+int spline::setLagrange(const vector<double>& x,
+                        const vector<double>& y)
+{
+   if (check(x,y))
+      return 1;
+   _type = LAGRANGE;
+   size_t n = x.size();
+   _deg = int(n) - 1;
+   _t = x, _c = y;
+   for (size_t j=1; j<n; ++j) {
+      for (size_t i=n-1; i>=j; --i)
+         _c[i] = (_c[i]-_c[i-1])/(x[i]-x[i-j]);
+   }
+   return 0;
+}
+
+
+int spline::setHermite(const vector<double>& x,
+                       const vector<double>& y)
+{
+   if (check(x,y))
+      return 1;
+   _type = HERMITE;
+   _deg = 3;
+   size_t n = x.size();
+   vector<double> h(n-1), s(n-1), d(n);
+   for (size_t i=0; i<n-1; ++i)
+      h[i] = x[i+1] - x[i], s[i] = (y[i+1]-y[i])/h[i];
+   if (n==2)
+      d[0] = d[1] = s[0];
+   else {
+      for (size_t i=1; i<n-1; ++i) {
+         if (s[i-1]*s[i]<=0.)
+            d[i] = 0.;
+         else {
+            double w1=2*h[i]+h[i-1], w2=h[i]+2*h[i-1];
+            d[i] = (w1+w2)/(w1/s[i-1]+w2/s[i]);
+         }
+      }
+      for (size_t e=0; e<2; ++e) {
+         size_t i=(e==0) ? 0 : n-2, j=(e==0) ? 1 : n-3, k=(e==0) ? 0 : n-1;
+         double dd = ((2*h[i]+h[j])*s[i] - h[i]*s[j])/(h[i]+h[j]);
+         if (dd*s[i]<=0.)
+            dd = 0.;
+         else if (s[i]*s[j]<=0. && std::fabs(dd)>3*std::fabs(s[i]))
+            dd = 3*s[i];
+         d[k] = dd;
+      }
+   }
+   _t = x;
+   _c.resize(4*(n-1));
+   for (size_t i=0; i<n-1; ++i) {
+      _c[4*i  ] = y[i];
+      _c[4*i+1] = d[i];
+      _c[4*i+2] = (3*s[i]-2*d[i]-d[i+1])/h[i];
+      _c[4*i+3] = (d[i]+d[i+1]-2*s[i])/(h[i]*h[i]);
+   }
+   return 0;
+}
+
+
+int spline::setBSpline(const vector<double>& x,
+                       const vector<double>& y,
+                       int                   p)
+{
+   if (check(x,y) || p<1)
+      return 1;
+   _type = BSPLINE;
+   int n = int(x.size());
+   _deg = p = std::min(p,n-1);
+   _t.assign(n+p+1,x[0]);
+   for (int j=1; j<n-p; ++j) {
+      double a = 0.;
+      for (int i=j; i<j+p; ++i)
+         a += x[i];
+      _t[j+p] = a/p;
+   }
+   for (int j=n; j<n+p+1; ++j)
+      _t[j] = x[n-1];
+   _c = y;
+   _w.clear();
+
+   int w = 2*p + 1;
+   vector<double> a(n*w,0.), N(p+1);
+   size_t k = p;
+   for (int i=0; i<n; ++i) {
+      k = span(x[i],k);
+      basis(k,x[i],&N[0]);
+      for (int r=0; r<=p; ++r) {
+         int j = int(k) - p + r;
+         if (std::abs(j-i)<=p)
+            a[i*w+j-i+p] = N[r];
+         else if (N[r]!=0.)
+            return 2;
+      }
+   }
+   return bandSolve(a,_c,n,p);
+}
+
+
+int spline::setFitting(const vector<double>& x,
+                       const vector<double>& y,
+                       int                   nc,
+                       int                   p)
+{
+   if (check(x,y) || p<1 || nc<2 || nc>int(x.size()))
+      return 1;
+   _type = FITTING;
+   int n = int(x.size());
+   _deg = p = std::min(p,nc-1);
+   _c.assign(nc,0.);
+   _w.clear();
+   uniformKnots(x[0],x[n-1],nc);
+
+// Normal equations B^T B c = B^T y
+   int w = 2*p + 1;
+   vector<double> a(nc*w,0.), N(p+1);
+   size_t k = p;
+   for (int i=0; i<n; ++i) {
+      k = span(x[i],k);
+      basis(k,x[i],&N[0]);
+      int j0 = int(k) - p;
+      for (int r=0; r<=p; ++r) {
+         _c[j0+r] += N[r]*y[i];
+         for (int s=0; s<=p; ++s)
+            a[(j0+r)*w+s-r+p] += N[r]*N[s];
+      }
+   }
+   if (bandSolve(a,_c,nc,p))
+      return 2;
+   _res = 0.;
+   for (int i=0; i<n; ++i) {
+      double r = (*this)(x[i]) - y[i];
+      _res += r*r;
+   }
+   _res = std::sqrt(_res/n);
+   return 0;
+}
+
+
+int spline::setBezier(const vector<double>& x,
+                      const vector<double>& y)
+{
+   if (check(x,y))
+      return 1;
+   _type = BEZIER;
+   size_t n = x.size();
+   _deg = int(n) - 1;
+   _t.assign(2*n,x[0]);
+   std::fill(_t.begin()+n,_t.end(),x[n-1]);
+   _c = y;
+   _w.clear();
+   return 0;
+}
+
+
+int spline::setNURBS(const vector<double>& x,
+                     const vector<double>& y,
+                     const vector<double>& w,
+                     int                   p)
+{
+   if (check(x,y) || p<1 || w.size()!=x.size())
+      return 1;
+   for (double v: w) {
+      if (v<=0.)
+         return 1;
+   }
+   _type = NURBS;
+   _deg = std::min(p,int(x.size())-1);
+   uniformKnots(x[0],x.back(),x.size());
+   _c = y, _w = w;
+   return 0;
+}
+
+
+double spline::value(size_t k,
+                     double x,
+                     double *d) const
+{
+   if (_type==LAGRANGE) {
+      double v = _c[_deg];
+      for (int i=_deg-1; i>=0; --i)
+         v = v*(x-_t[i]) + _c[i];
+      return v;
+   }
+   if (_type==HERMITE) {
+      const double *c = &_c[4*k];
+      double s = x - _t[k];
+      return c[0] + s*(c[1] + s*(c[2] + s*c[3]));
+   }
+
+// de Boor algorithm, in homogeneous coordinates for rational splines
+   int p=_deg, j0=int(k)-p;
+   double *e = d + p + 1;
+   for (int j=0; j<=p; ++j) {
+      e[j] = _w.size() ? _w[j0+j] : 1.;
+      d[j] = e[j]*_c[j0+j];
+   }
+   for (int r=1; r<=p; ++r) {
+      for (int j=p; j>=r; --j) {
+         size_t i = j0 + j;
+         double a = (x-_t[i])/(_t[i+p-r+1]-_t[i]);
+         d[j] = (1.-a)*d[j-1] + a*d[j];
+         if (_w.size())
+            e[j] = (1.-a)*e[j-1] + a*e[j];
+      }
+   }
+   return d[p]/e[p];
+}
+
+
+double spline::operator()(double x) const
+{
+   double buf[64];
+   size_t k = (_type==LAGRANGE) ? 0 : span(x,0);
+   if (_type==LAGRANGE || _type==HERMITE || 2*_deg+2<=64)
+      return value(k,x,buf);
+   vector<double> d(2*_deg+2);
+   return value(k,x,&d[0]);
+}
+
+
+void spline::eval(const double* x,
+                  double*       y,
+                  size_t        n) const
+{
+   vector<double> d(2*_deg+2);
+   if (_type==LAGRANGE) {
+      for (size_t i=0; i<n; ++i)
+         y[i] = value(0,x[i],&d[0]);
+      return;
+   }
+   size_t k = span(x[0],0);
+   for (size_t i=0; i<n; ++i) {
+      k = span(x[i],k);
+      y[i] = value(k,x[i],&d[0]);
+   }
+}
+
+string spline::getExpression(const string& x) const
+{
+   if (_type!=LAGRANGE || _c.size()==0)
+      return "";
+   auto num = [](double v) {
+      std::ostringstream s;
+      s.precision(17);
+      if (v<0.)
+         s << "(" << v << ")";
+      else
+         s << v;
+      return s.str();
+   };
+   string e = num(_c[_deg]);
+   for (int i=_deg-1; i>=0; --i)
+      e = num(_c[i]) + "+(" + x + "-" + num(_t[i]) + ")*(" + e + ")";
+   return e;
+}
+
+} /* namespace RITA */
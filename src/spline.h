@@ -0,0 +1,122 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                          Definition of class 'spline'
+
+  ==============================================================================*/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+using std::vector;
+using std::string;
+
+namespace RITA {
+
+/*! \class spline
+ *  \brief One-variable approximation of tabulated data stored by its coefficients.
+ *
+ *  Lagrange interpolants are stored in Newton form, Hermite interpolants as
+ *  piecewise cubic polynomials and all other approximations (B-spline interpolation
+ *  and least squares fitting, Bezier and NURBS) in B-spline form. The linear systems
+ *  of interpolation and fitting are banded and solved in O(n) operations. Evaluation
+ *  uses Horner or de Boor schemes after a binary search of the knot interval.
+ *
+ * \author Rachid Touzani
+ * \copyright GNU Public License
+ */
+
+class spline
+{
+
+ public:
+
+    enum Type {
+       LAGRANGE,
+       HERMITE,
+       BSPLINE,
+       FITTING,
+       BEZIER,
+       NURBS
+    };
+
+    spline();
+
+/// \brief Lagrange interpolating polynomial of all points
+    int setLagrange(const vector<double>& x, const vector<double>& y);
+
+/// \brief Monotone piecewise cubic Hermite interpolation. Derivatives are estimated
+/// from the data so that monotonic data give a monotonic interpolant
+    int setHermite(const vector<double>& x, const vector<double>& y);
+
+/// \brief Interpolating B-spline of degree \c p with knots obtained by averaging
+/// the abscissae (cubic spline with not-a-knot conditions for p=3)
+    int setBSpline(const vector<double>& x, const vector<double>& y, int p=3);
+
+/// \brief Least squares fitting by a B-spline of degree \c p with \c nc coefficients
+/// on uniform knots
+    int setFitting(const vector<double>& x, const vector<double>& y, int nc, int p=3);
+
+/// \brief Bezier curve whose control values are the data
+    int setBezier(const vector<double>& x, const vector<double>& y);
+
+/// \brief Rational B-spline of degree \c p on uniform knots whose control values are
+/// the data, with weights \c w
+    int setNURBS(const vector<double>& x, const vector<double>& y, const vector<double>& w, int p=3);
+
+/// \brief Evaluate at \c x
+    double operator()(double x) const;
+
+/// \brief Evaluate at \c n points. Knot intervals are searched from the previous
+/// one, so that increasing abscissae (grids) are evaluated in O(n) operations
+    void eval(const double* x, double* y, size_t n) const;
+
+/// \brief Expression of the Lagrange interpolant in Newton form, of variable \c x.
+/// Empty for other approximations
+    string getExpression(const string& x="x") const;
+
+    Type getType() const { return _type; }
+    int getDegree() const { return _deg; }
+    size_t getNbCoef() const { return _c.size(); }
+
+/// \brief Root mean square of the residual of least squares fitting
+    double getResidual() const { return _res; }
+
+ private:
+
+    Type _type;
+    int _deg;
+    double _res;
+    vector<double> _t, _c, _w;
+    int check(const vector<double>& x, const vector<double>& y) const;
+    size_t span(double x, size_t k) const;
+    double value(size_t k, double x, double* d) const;
+    void basis(size_t k, double x, double* N) const;
+    void uniformKnots(double a, double b, size_t nc);
+};
+
+} /* namespace RITA */
@@ -30,6 +30,7 @@
 #include "io/IOField.h"
 #include "io/saveField.h"
 #include "equa.h"
+#include "profiler.h"
 #include <iostream>
 
 using std::map;
@@ -65,6 +66,7 @@ int stationary::run()
    vector<ofstream> fs(_nb_vectors+1), ffs(_nb_vectors+1), pfs(_nb_vectors+1);
    vector<OFELI::IOField> ff(_nb_vectors+1);
    vector<string> fn(_nb_vectors+1);
+   profiler::scope ps("stationary");
 
    try {
 /*      for (int e=1; e<=_data->nb_ae; ++e) {
@@ -138,8 +140,16 @@ int stationary::run()
       }*/
 
       for (int e=1; e<=_data->nb_ae; ++e) {
+         profiler::scope pse("stationary:ae");
          _ae_eq = _data->theAE[e];
+         if (_ae_eq->theFct[0].var.size()>size_t(_ae_eq->size)) {
+            _rita->msg("stationary>","Algebraic system "+_ae_eq->name+" is coupled with other equations.",
+                       "Such a system can only be solved in a transient analysis.");
+            return 1;
+         }
          NLASSolver nls(_ae_eq->nls,_ae_eq->size);
+         nls.setMaxIter(_ae_eq->max_it);
+         nls.setTolerance(_ae_eq->toler);
          if (_ae_eq->size==1)
             nls.setInitial(_ae_eq->y[0]);
          else
@@ -147,13 +157,16 @@ int stationary::run()
          for (int i=0; i<_ae_eq->size; ++i)
             nls.setf(_ae_eq->theFct[i]);
          nls.run();
+         profiler::get().count("ae:newton-iterations",nls.getNbIter());
          *_data->theVector[_ae_eq->vect] = _ae_eq->y;
       }
 
       for (int e=1; e<=_data->nb_pde; ++e) {
          _pde_eq = _data->thePDE[e];
+         string pde_name = "pde-" + to_string(e);
          _pde_eq->theEquation->setInput(SOLUTION,*_data->theVector[_pde_eq->fd[0].vect]);
          _pde_eq->theEquation->setSolver(_pde_eq->ls,_pde_eq->prec);
+         auto t0 = profiler::Clock::now();
          if (_pde_eq->set_bc) {
             if (_pde_eq->bc.withRegex(1)) {
                for (auto const& v: _pde_eq->bc_data.cexp)
@@ -173,7 +186,10 @@ int stationary::run()
             }
             _pde_eq->theEquation->setInput(BOUNDARY_FORCE,_pde_eq->sf);
          }
+         auto t1 = profiler::Clock::now();
          ret = _pde_eq->theEquation->run();
+         profiler::get().add(pde_name+":setup",t0,t1);
+         profiler::get().add(pde_name+":solve",t1,profiler::Clock::now());
 
 /*         for (int i=0; i<_pde_eq->nb_vectors; ++i) {
             int f = _pde_eq->fd[i].vect;
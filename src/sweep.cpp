@@ -0,0 +1,351 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                        Implementation of class 'sweep'
+
+  ==============================================================================*/
+
+#include "sweep.h"
+#include "data.h"
+#include "calc.h"
+#include "configure.h"
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <climits>
+#include <cstdlib>
+#include <cstdio>
+#include <sstream>
+#include <map>
+
+namespace RITA {
+
+sweep::sweep(rita*      r,
+             cmd*       command,
+             configure* config)
+      : _rita(r), _configure(config), _cmd(command), _jobs(1), _fd(-1)
+{
+   _data = _rita->_data;
+   _verb = _rita->_verb;
+}
+
+
+sweep::~sweep()
+{
+}
+
+
+int sweep::run()
+{
+   int nb=0;
+   double a=0., b=0.;
+   int n=0;
+   _script = "";
+   _output = "sweep";
+   _jobs = 1;
+   _var.clear(), _val.clear(), _res.clear();
+   vector<double> vmin, vmax;
+   vector<int> nv;
+   static const string H = "Command: sweep script=file var=name [values=v1,v2,...] [min=a] [max=b] [nb=n]\n"
+                           "              [var=name ...] [jobs=p] [result=r1,r2,...] [output=name]\n\n"
+                           "file: Script to run for each case\n"
+                           "name: Name of parameter that takes successively the given values, or n values\n"
+                           "      uniformly distributed in [a,b]. If several parameters are given, all\n"
+                           "      combinations of their values are run\n"
+                           "p: Number of cases run simultaneously (default: 1)\n"
+                           "r1,r2,...: Parameters whose values at the end of each case are gathered\n"
+                           "           in addition to objective and integral values\n"
+                           "output: Each case runs in directory output-n and results are stored in\n"
+                           "        file output.dat (default output: sweep)";
+   static const vector<string> kw {"script","var","values","min","max","nb","jobs","result","output"};
+   _cmd->set(kw,_rita->_gkw);
+   int nb_args = _cmd->getNbArgs();
+   if (nb_args<1) {
+      _rita->msg("sweep>","No argument for command.");
+      return 1;
+   }
+   for (int k=0; k<nb_args; ++k) {
+
+      int key = _cmd->getArgs(nb);
+      if (key>=2 && key<=5 && _var.size()==0) {
+         _rita->msg("sweep>","Argument "+_cmd->Arg()+" must follow a var argument.");
+         return 1;
+      }
+      switch (key) {
+
+         case 100:
+         case 101:
+            cout << H << endl;
+            return 0;
+
+         case   0:
+            _script = _cmd->string_token(0);
+            break;
+
+         case   1:
+            _var.push_back(_cmd->string_token(0));
+            _val.push_back(vector<double>());
+            vmin.push_back(0.), vmax.push_back(0.), nv.push_back(0);
+            break;
+
+         case   2:
+            for (int i=0; i<nb; ++i) {
+               if (_data->getPar(i,"sweep>",a))
+                  return 1;
+               _val.back().push_back(a);
+            }
+            break;
+
+         case   3:
+            if (_data->getPar(0,"sweep>",vmin.back()))
+               return 1;
+            break;
+
+         case   4:
+            if (_data->getPar(0,"sweep>",vmax.back()))
+               return 1;
+            break;
+
+         case   5:
+            if (_data->getPar(0,"sweep>",nv.back()))
+               return 1;
+            break;
+
+         case   6:
+            if (_data->getPar(0,"sweep>",_jobs))
+               return 1;
+            break;
+
+         case   7:
+            for (int i=0; i<nb; ++i)
+               _res.push_back(_cmd->string_token(i));
+            break;
+
+         case   8:
+            _output = _cmd->string_token(0);
+            break;
+
+         default:
+            _rita->msg("sweep>","Unknown argument: "+_cmd->Arg());
+            return 1;
+      }
+   }
+
+   if (_script=="") {
+      _rita->msg("sweep>","No script file given.");
+      return 1;
+   }
+   if (_var.size()==0) {
+      _rita->msg("sweep>","No parameter to sweep.");
+      return 1;
+   }
+   for (size_t i=0; i<_var.size(); ++i) {
+      if (_val[i].size()==0) {
+         if ((n=nv[i])<1) {
+            _rita->msg("sweep>","No values given for parameter "+_var[i]);
+            return 1;
+         }
+         a = vmin[i], b = vmax[i];
+         for (int j=0; j<n; ++j)
+            _val[i].push_back((n==1) ? a : a+j*(b-a)/(n-1));
+      }
+   }
+   if (_jobs<1)
+      _jobs = 1;
+
+   *_rita->ofh << "sweep script=" << _script;
+   for (size_t i=0; i<_var.size(); ++i) {
+      *_rita->ofh << " var=" << _var[i] << " values=";
+      for (size_t j=0; j<_val[i].size(); ++j)
+         *_rita->ofh << ((j==0) ? "" : ",") << _val[i][j];
+   }
+   if (_jobs>1)
+      *_rita->ofh << " jobs=" << _jobs;
+   for (size_t i=0; i<_res.size(); ++i)
+      *_rita->ofh << ((i==0) ? " result=" : ",") << _res[i];
+   *_rita->ofh << " output=" << _output << endl;
+   return 0;
+}
+
+
+// Run case c in child process: set parameters, redirect outputs in case directory
+// and run script. The process ends by the exit command of the script or at its end.
+// Lines of a batch script inherited from the parent are not run by the child
+void sweep::runCase(size_t                c,
+                    const vector<double>& v)
+{
+   string dir = _output + "-" + to_string(c+1);
+   mkdir(dir.c_str(),0755);
+   if (chdir(dir.c_str())) {
+      cout << "Unable to create directory " << dir << endl;
+      _exit(1);
+   }
+   if (!freopen("rita.log","w",stdout))
+      _exit(1);
+   _rita->ofh = new ofstream("rita.his");
+   _rita->ofl = new ofstream("rita.err");
+   for (size_t i=0; i<_var.size(); ++i) {
+      _data->addParam(_var[i],v[i]);
+      _rita->_calc->setParam(_var[i],v[i]);
+      *_rita->ofh << _var[i] << "=" << v[i] << endl;
+   }
+   _cmd->endBatch();
+   _rita->setInput(_script,1);
+   _rita->finish();
+}
+
+
+void sweep::send()
+{
+   if (_fd<0)
+      return;
+   std::ostringstream s;
+   s.precision(15);
+   s << _data->obj << " " << _data->integral;
+   for (const auto& r: _res) {
+      double v = 0.;
+      if (_data->checkParam(r,v)<0)
+         s << " nan";
+      else
+         s << " " << v;
+   }
+   s << "\n";
+   string m = s.str();
+   if (write(_fd,m.c_str(),m.size())<0)
+      _exit(1);
+   close(_fd);
+   _fd = -1;
+}
+
+
+int sweep::go()
+{
+   char path[PATH_MAX];
+   if (realpath(_script.c_str(),path)==nullptr) {
+      _rita->msg("sweep>","Unable to open file: "+_script);
+      return 1;
+   }
+   string script = _script;
+   _script = path;
+   size_t nc = 1;
+   for (const auto& v: _val)
+      nc *= v.size();
+   vector<vector<double> > val(nc,vector<double>(_var.size()));
+   for (size_t c=0; c<nc; ++c) {
+      size_t k = c;
+      for (int i=int(_var.size())-1; i>=0; --i) {
+         val[c][i] = _val[i][k%_val[i].size()];
+         k /= _val[i].size();
+      }
+   }
+   vector<string> res(nc,"");
+   vector<int> status(nc,-1);
+   std::map<pid_t,std::pair<size_t,int> > running;
+
+   auto wait_one = [&]() {
+      int st = 0;
+      pid_t pid = wait(&st);
+      if (pid<=0 || running.count(pid)==0)
+         return;
+      size_t c = running[pid].first;
+      int fd = running[pid].second;
+      char buf[4096];
+      ssize_t n = 0;
+      while ((n=read(fd,buf,sizeof(buf)))>0)
+         res[c].append(buf,n);
+      close(fd);
+      status[c] = (WIFEXITED(st) && res[c].size()) ? WEXITSTATUS(st) : 1;
+      running.erase(pid);
+      if (_verb)
+         cout << "Case " << c+1 << " of " << nc << (status[c] ? " failed" : " completed") << endl;
+   };
+
+   for (size_t c=0; c<nc; ++c) {
+      while (int(running.size())>=_jobs)
+         wait_one();
+      int p[2];
+      if (pipe(p)) {
+         _rita->msg("sweep>","Unable to create pipe.");
+         break;
+      }
+      cout.flush();
+      _rita->flush();
+      _rita->ofh->flush();
+      pid_t pid = fork();
+      if (pid==0) {
+         close(p[0]);
+         _fd = p[1];
+         runCase(c,val[c]);
+         _exit(0);
+      }
+      close(p[1]);
+      if (pid<0) {
+         close(p[0]);
+         _rita->msg("sweep>","Unable to create process for case "+to_string(c+1));
+         continue;
+      }
+      running[pid] = std::make_pair(c,p[0]);
+   }
+   while (running.size())
+      wait_one();
+   _script = script;
+
+// Summary table
+   ofstream ff(_output+".dat");
+   ff << "# case";
+   cout << "\nSweep of script " << _script << ": " << nc << " cases\n";
+   cout << "case";
+   for (const auto& v: _var)
+      ff << "  " << v, cout << "  " << v;
+   ff << "  objective  integral";
+   cout << "  objective  integral";
+   for (const auto& r: _res)
+      ff << "  " << r, cout << "  " << r;
+   ff << "  status" << endl;
+   cout << "  status" << endl;
+   int nb_failed = 0;
+   for (size_t c=0; c<nc; ++c) {
+      std::ostringstream s;
+      s << c+1;
+      for (double v: val[c])
+         s << "  " << v;
+      std::istringstream is(res[c]);
+      string w;
+      size_t nr = 0;
+      while (is >> w)
+         s << "  " << w, nr++;
+      for (; nr<_res.size()+2; ++nr)
+         s << "  nan";
+      s << "  " << status[c];
+      nb_failed += (status[c]!=0);
+      ff << s.str() << endl;
+      cout << s.str() << endl;
+   }
+   cout << "Results stored in file " << _output << ".dat" << endl;
+   if (nb_failed)
+      _rita->msg("sweep>",to_string(nb_failed)+" case(s) failed.");
+   return 0;
+}
+
+} /* namespace RITA */
@@ -0,0 +1,78 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                          Definition of class 'sweep'
+
+  ==============================================================================*/
+
+#pragma once
+
+#include "rita.h"
+#include "cmd.h"
+
+namespace RITA {
+
+/*! \class sweep
+ *  \brief Run a script for a list or a grid of parameter values.
+ *
+ *  Each case is run in a child process created by fork, so that cases are isolated
+ *  and data defined before the sweep (meshes, functions, ...) are shared without
+ *  being read again. A case runs in its own directory <output>-<n> where its
+ *  output files, log and history are written, and sends at exit its scalar
+ *  results to the parent that gathers them in the table <output>.dat.
+ *
+ * \author Rachid Touzani
+ * \copyright GNU Public License
+ */
+
+class sweep
+{
+
+ public:
+
+    sweep(rita *r, cmd* command, configure* config);
+    ~sweep();
+    int run();
+    int go();
+
+/// \brief Send results of a case to parent process. Does nothing in parent process
+    void send();
+
+/// \brief Return true in the process of a case
+    bool child() const { return _fd>=0; }
+
+ private:
+
+    rita *_rita;
+    configure *_configure;
+    cmd *_cmd;
+    data *_data;
+    int _verb, _jobs, _fd;
+    string _script, _output;
+    vector<string> _var, _res;
+    vector<vector<double> > _val;
+    void runCase(size_t c, const vector<double>& v);
+};
+
+} /* namespace RITA */
@@ -0,0 +1,777 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                   Implementation of functions on expressions
+
+  ==============================================================================*/
+
+#include "symDiff.h"
+#include <memory>
+#include <vector>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <cmath>
+
+using std::shared_ptr;
+
+namespace RITA {
+
+namespace {
+
+struct Node;
+typedef shared_ptr<Node> pNode;
+
+struct Node {
+   enum Type { NUM, VAR, NEG, ADD, SUB, MUL, DIV, POW, CALL } type;
+   double val;
+   string name;
+   pNode a, b;
+};
+
+
+pNode num(double v)
+{
+   pNode n = std::make_shared<Node>();
+   n->type = Node::NUM, n->val = v;
+   return n;
+}
+
+
+bool isNum(const pNode& n, double v) { return n->type==Node::NUM && n->val==v; }
+
+
+// Construction of nodes with elementary simplifications
+pNode make(Node::Type t, pNode a, pNode b=nullptr, const string& name="")
+{
+   switch (t) {
+
+      case Node::NEG:
+         if (a->type==Node::NUM)
+            return num(-a->val);
+         if (a->type==Node::NEG)
+            return a->a;
+         break;
+
+      case Node::ADD:
+         if (isNum(a,0.))
+            return b;
+         if (isNum(b,0.))
+            return a;
+         if (a->type==Node::NUM && b->type==Node::NUM)
+            return num(a->val+b->val);
+         break;
+
+      case Node::SUB:
+         if (isNum(b,0.))
+            return a;
+         if (isNum(a,0.))
+            return make(Node::NEG,b);
+         if (a->type==Node::NUM && b->type==Node::NUM)
+            return num(a->val-b->val);
+         break;
+
+      case Node::MUL:
+         if (isNum(a,0.) || isNum(b,0.))
+            return num(0.);
+         if (isNum(a,1.))
+            return b;
+         if (isNum(b,1.))
+            return a;
+         if (a->type==Node::NUM && b->type==Node::NUM)
+            return num(a->val*b->val);
+         break;
+
+      case Node::DIV:
+         if (isNum(a,0.))
+            return num(0.);
+         if (isNum(b,1.))
+            return a;
+         break;
+
+      case Node::POW:
+         if (isNum(b,0.))
+            return num(1.);
+         if (isNum(b,1.))
+            return a;
+         break;
+
+      default:
+         break;
+   }
+   pNode n = std::make_shared<Node>();
+   n->type = t, n->a = a, n->b = b, n->name = name, n->val = 0.;
+   return n;
+}
+
+
+class Parser
+{
+
+ public:
+
+    Parser(const string& s) : _s(s), _p(0), _err(false) { }
+
+    pNode parse()
+    {
+       pNode n = expr();
+       skip();
+       if (_p!=_s.size())
+          _err = true;
+       return _err ? nullptr : n;
+    }
+
+ private:
+
+    const string& _s;
+    size_t _p;
+    bool _err;
+
+    void skip()
+    {
+       while (_p<_s.size() && isspace(_s[_p]))
+          _p++;
+    }
+
+    bool accept(char c)
+    {
+       skip();
+       if (_p<_s.size() && _s[_p]==c) {
+          _p++;
+          return true;
+       }
+       return false;
+    }
+
+    pNode expr()
+    {
+       pNode n = term();
+       while (!_err) {
+          if (accept('+'))
+             n = make(Node::ADD,n,term());
+          else if (accept('-'))
+             n = make(Node::SUB,n,term());
+          else
+             break;
+       }
+       return n;
+    }
+
+    pNode term()
+    {
+       pNode n = unary();
+       while (!_err) {
+          if (accept('*'))
+             n = make(Node::MUL,n,unary());
+          else if (accept('/'))
+             n = make(Node::DIV,n,unary());
+          else
+             break;
+       }
+       return n;
+    }
+
+    pNode unary()
+    {
+       if (accept('-'))
+          return make(Node::NEG,unary());
+       if (accept('+'))
+          return unary();
+       return power();
+    }
+
+// Exponentiation is right associative and binds tighter than unary minus
+    pNode power()
+    {
+       pNode n = primary();
+       if (!_err && accept('^'))
+          n = make(Node::POW,n,unary());
+       return n;
+    }
+
+    pNode primary()
+    {
+       skip();
+       if (_p>=_s.size()) {
+          _err = true;
+          return num(0.);
+       }
+       if (accept('(')) {
+          pNode n = expr();
+          if (!accept(')'))
+             _err = true;
+          return n;
+       }
+       char c = _s[_p];
+       if (isdigit(c) || c=='.') {
+          const char *b = _s.c_str() + _p;
+          char *e = nullptr;
+          double v = strtod(b,&e);
+          _p += e - b;
+          return num(v);
+       }
+       if (isalpha(c) || c=='_') {
+          size_t q = _p;
+          while (_p<_s.size() && (isalnum(_s[_p]) || _s[_p]=='_'))
+             _p++;
+          string id = _s.substr(q,_p-q);
+          if (accept('(')) {
+             pNode a = expr();
+             if (accept(',')) {
+                pNode b = expr();
+                if (!accept(')') || id!="pow")
+                   _err = true;
+                return make(Node::POW,a,b);
+             }
+             if (!accept(')'))
+                _err = true;
+             return make(Node::CALL,a,nullptr,id);
+          }
+          if (id=="pi")
+             return num(3.14159265358979323846);
+          pNode n = std::make_shared<Node>();
+          n->type = Node::VAR, n->name = id, n->val = 0.;
+          return n;
+       }
+       _err = true;
+       return num(0.);
+    }
+};
+
+
+bool depends(const pNode& n, const string& x)
+{
+   if (n==nullptr)
+      return false;
+   if (n->type==Node::VAR)
+      return n->name==x;
+   return depends(n->a,x) || depends(n->b,x);
+}
+
+
+pNode call(const string& f, pNode a) { return make(Node::CALL,a,nullptr,f); }
+
+
+// Derivative of node n with respect to x. Set err for unsupported functions
+pNode D(const pNode& n, const string& x, bool& err)
+{
+   if (!depends(n,x))
+      return num(0.);
+   pNode u=n->a, v=n->b;
+   switch (n->type) {
+
+      case Node::VAR:
+         return num(1.);
+
+      case Node::NEG:
+         return make(Node::NEG,D(u,x,err));
+
+      case Node::ADD:
+         return make(Node::ADD,D(u,x,err),D(v,x,err));
+
+      case Node::SUB:
+         return make(Node::SUB,D(u,x,err),D(v,x,err));
+
+      case Node::MUL:
+         return make(Node::ADD,make(Node::MUL,D(u,x,err),v),make(Node::MUL,u,D(v,x,err)));
+
+      case Node::DIV:
+         if (!depends(v,x))
+            return make(Node::DIV,D(u,x,err),v);
+         return make(Node::DIV,make(Node::SUB,make(Node::MUL,D(u,x,err),v),make(Node::MUL,u,D(v,x,err))),
+                     make(Node::POW,v,num(2.)));
+
+      case Node::POW:
+         if (!depends(v,x))
+            return make(Node::MUL,make(Node::MUL,v,make(Node::POW,u,make(Node::SUB,v,num(1.)))),D(u,x,err));
+         return make(Node::MUL,n,make(Node::ADD,make(Node::MUL,D(v,x,err),call("log",u)),
+                                      make(Node::DIV,make(Node::MUL,v,D(u,x,err)),u)));
+
+      case Node::CALL: {
+         pNode g, du=D(u,x,err);
+         const string& f = n->name;
+         if (f=="sin")
+            g = call("cos",u);
+         else if (f=="cos")
+            g = make(Node::NEG,call("sin",u));
+         else if (f=="tan")
+            g = make(Node::DIV,num(1.),make(Node::POW,call("cos",u),num(2.)));
+         else if (f=="exp")
+            g = n;
+         else if (f=="log" || f=="ln")
+            g = make(Node::DIV,num(1.),u);
+         else if (f=="sqrt")
+            g = make(Node::DIV,num(0.5),n);
+         else if (f=="sinh")
+            g = call("cosh",u);
+         else if (f=="cosh")
+            g = call("sinh",u);
+         else if (f=="tanh")
+            g = make(Node::DIV,num(1.),make(Node::POW,call("cosh",u),num(2.)));
+         else if (f=="asin")
+            g = make(Node::DIV,num(1.),call("sqrt",make(Node::SUB,num(1.),make(Node::POW,u,num(2.)))));
+         else if (f=="acos")
+            g = make(Node::DIV,num(-1.),call("sqrt",make(Node::SUB,num(1.),make(Node::POW,u,num(2.)))));
+         else if (f=="atan")
+            g = make(Node::DIV,num(1.),make(Node::ADD,num(1.),make(Node::POW,u,num(2.))));
+         else {
+            err = true;
+            return num(0.);
+         }
+         return make(Node::MUL,g,du);
+      }
+
+      default:
+         return num(0.);
+   }
+}
+
+
+void print(const pNode& n, std::ostringstream& s)
+{
+   static const char op[] = {' ',' ',' ','+','-','*','/','^'};
+   switch (n->type) {
+
+      case Node::NUM:
+         if (n->val<0)
+            s << "(" << n->val << ")";
+         else
+            s << n->val;
+         break;
+
+      case Node::VAR:
+         s << n->name;
+         break;
+
+      case Node::NEG:
+         s << "(-";
+         print(n->a,s);
+         s << ")";
+         break;
+
+      case Node::CALL:
+         s << n->name << "(";
+         print(n->a,s);
+         s << ")";
+         break;
+
+      default:
+         s << "(";
+         print(n->a,s);
+         s << op[n->type];
+         print(n->b,s);
+         s << ")";
+         break;
+   }
+}
+
+
+// Split expression into identifiers and other characters. Numbers are kept as a
+// whole so that exponents like 1.e-4 are not taken for identifiers
+template<typename F>
+void scan(const string& s, F id, string* out)
+{
+   size_t i = 0;
+   while (i<s.size()) {
+      char c = s[i];
+      if (isalpha(c) || c=='_') {
+         size_t j = i;
+         while (j<s.size() && (isalnum(s[j]) || s[j]=='_'))
+            j++;
+         size_t k = j;
+         while (k<s.size() && isspace(s[k]))
+            k++;
+         string name = s.substr(i,j-i);
+         if (k<s.size() && s[k]=='(') {
+            if (out)
+               *out += name;
+         }
+         else
+            id(name);
+         i = j;
+      }
+      else if (isdigit(c) || c=='.') {
+         size_t j = i;
+         while (j<s.size() && (isdigit(s[j]) || s[j]=='.'))
+            j++;
+         if (j<s.size() && (s[j]=='e' || s[j]=='E')) {
+            size_t k = j + 1;
+            if (k<s.size() && (s[k]=='+' || s[k]=='-'))
+               k++;
+            if (k<s.size() && isdigit(s[k])) {
+               j = k;
+               while (j<s.size() && isdigit(s[j]))
+                  j++;
+            }
+         }
+         if (out)
+            *out += s.substr(i,j-i);
+         i = j;
+      }
+      else {
+         if (out)
+            *out += c;
+         i++;
+      }
+   }
+}
+
+} /* namespace */
+
+
+vector<string> freeVariables(const vector<string>& expr,
+                             const vector<string>& var)
+{
+   static const vector<string> cst {"pi","epsilon","inf","true","false","and","or","not",
+                                    "nand","nor","xor","if","else"};
+   vector<string> v;
+   for (const auto& e: expr) {
+      scan(e,[&](const string& name) {
+                if (find(var.begin(),var.end(),name)==var.end() &&
+                    find(cst.begin(),cst.end(),name)==cst.end() &&
+                    find(v.begin(),v.end(),name)==v.end())
+                   v.push_back(name);
+             },nullptr);
+   }
+   return v;
+}
+
+
+int differentiate(const string& expr,
+                  const string& var,
+                  string&       der)
+{
+   Parser p(expr);
+   pNode n = p.parse();
+   if (n==nullptr)
+      return 1;
+   bool err = false;
+   pNode d = D(n,var,err);
+   if (err)
+      return 1;
+   std::ostringstream s;
+   s.precision(17);
+   print(d,s);
+   der = s.str();
+   return 0;
+}
+
+
+namespace {
+
+// Operation codes of the tape
+enum { AD_NUM, AD_VAR, AD_NEG, AD_ADD, AD_SUB, AD_MUL, AD_DIV, AD_POW, AD_SIN, AD_COS, AD_TAN,
+       AD_EXP, AD_LOG, AD_SQRT, AD_SINH, AD_COSH, AD_TANH, AD_ASIN, AD_ACOS, AD_ATAN, AD_ABS };
+
+int emit(const pNode&                   n,
+         const vector<string>&          var,
+         vector<exprAD::Op>&            tape,
+         std::map<const Node*,int>&     done)
+{
+   static const std::map<string,int> fct {{"sin",AD_SIN},{"cos",AD_COS},{"tan",AD_TAN},{"exp",AD_EXP},
+                                          {"log",AD_LOG},{"ln",AD_LOG},{"sqrt",AD_SQRT},{"sinh",AD_SINH},
+                                          {"cosh",AD_COSH},{"tanh",AD_TANH},{"asin",AD_ASIN},
+                                          {"acos",AD_ACOS},{"atan",AD_ATAN},{"abs",AD_ABS}};
+   auto it = done.find(n.get());
+   if (it!=done.end())
+      return it->second;
+   exprAD::Op op;
+   op.a = op.b = -1, op.c = 0.;
+   switch (n->type) {
+
+      case Node::NUM:
+         op.code = AD_NUM, op.c = n->val;
+         break;
+
+      case Node::VAR: {
+         auto k = find(var.begin(),var.end(),n->name);
+         if (k==var.end())
+            return -1;
+         op.code = AD_VAR, op.a = int(k-var.begin());
+         break;
+      }
+
+      case Node::CALL: {
+         auto f = fct.find(n->name);
+         if (f==fct.end())
+            return -1;
+         op.code = f->second;
+         break;
+      }
+
+      default:
+         op.code = AD_NEG + (n->type-Node::NEG);
+         break;
+   }
+   if (n->type!=Node::NUM && n->type!=Node::VAR) {
+      if ((op.a=emit(n->a,var,tape,done))<0)
+         return -1;
+      if (n->b!=nullptr && (op.b=emit(n->b,var,tape,done))<0)
+         return -1;
+   }
+   tape.push_back(op);
+   return done[n.get()] = int(tape.size()) - 1;
+}
+
+} /* namespace */
+
+
+int exprAD::set(const string&         expr,
+                const vector<string>& var)
+{
+   Parser p(expr);
+   pNode n = p.parse();
+   _tape.clear();
+   if (n==nullptr)
+      return 1;
+   std::map<const Node*,int> done;
+   if (emit(n,var,_tape,done)<0) {
+      _tape.clear();
+      return 1;
+   }
+   _nb_var = int(var.size());
+   size_t m = _tape.size();
+   _v.resize(m), _d.resize(m), _w.resize(m), _dw.resize(m);
+   _pa.resize(m), _pb.resize(m), _paa.resize(m), _pab.resize(m), _pbb.resize(m);
+   return 0;
+}
+
+
+void exprAD::forward(const double* x,
+                     const double* v)
+{
+// Values and, if v is given, tangents in direction v
+   for (size_t k=0; k<_tape.size(); ++k) {
+      const Op &o = _tape[k];
+      double a = (o.a>=0 && o.code!=AD_VAR) ? _v[o.a] : 0., b = (o.b>=0) ? _v[o.b] : 0., z = 0.;
+      switch (o.code) {
+         case AD_NUM:  z = o.c;          break;
+         case AD_VAR:  z = x[o.a];       break;
+         case AD_NEG:  z = -a;           break;
+         case AD_ADD:  z = a + b;        break;
+         case AD_SUB:  z = a - b;        break;
+         case AD_MUL:  z = a*b;          break;
+         case AD_DIV:  z = a/b;          break;
+         case AD_POW:  z = pow(a,b);     break;
+         case AD_SIN:  z = sin(a);       break;
+         case AD_COS:  z = cos(a);       break;
+         case AD_TAN:  z = tan(a);       break;
+         case AD_EXP:  z = exp(a);       break;
+         case AD_LOG:  z = log(a);       break;
+         case AD_SQRT: z = sqrt(a);      break;
+         case AD_SINH: z = sinh(a);      break;
+         case AD_COSH: z = cosh(a);      break;
+         case AD_TANH: z = tanh(a);      break;
+         case AD_ASIN: z = asin(a);      break;
+         case AD_ACOS: z = acos(a);      break;
+         case AD_ATAN: z = atan(a);      break;
+         case AD_ABS:  z = fabs(a);      break;
+      }
+      _v[k] = z;
+   }
+   partials();
+   if (v==nullptr)
+      return;
+   for (size_t k=0; k<_tape.size(); ++k) {
+      const Op &o = _tape[k];
+      if (o.code==AD_NUM)
+         _d[k] = 0.;
+      else if (o.code==AD_VAR)
+         _d[k] = v[o.a];
+      else
+         _d[k] = _pa[k]*_d[o.a] + ((o.b>=0) ? _pb[k]*_d[o.b] : 0.);
+   }
+}
+
+
+void exprAD::partials()
+{
+// First and second local partial derivatives of each operation
+   for (size_t k=0; k<_tape.size(); ++k) {
+      const Op &o = _tape[k];
+      double a = (o.a>=0 && o.code!=AD_VAR) ? _v[o.a] : 0., b = (o.b>=0) ? _v[o.b] : 0., z = _v[k];
+      double pa=0., pb=0., paa=0., pab=0., pbb=0.;
+      switch (o.code) {
+
+         case AD_NEG:
+            pa = -1.;
+            break;
+
+         case AD_ADD:
+            pa = pb = 1.;
+            break;
+
+         case AD_SUB:
+            pa = 1., pb = -1.;
+            break;
+
+         case AD_MUL:
+            pa = b, pb = a, pab = 1.;
+            break;
+
+         case AD_DIV:
+            pa = 1./b, pb = -a/(b*b), pab = -1./(b*b), pbb = 2*a/(b*b*b);
+            break;
+
+         case AD_POW:
+            pa = (a==0. && b==1.) ? 1. : b*pow(a,b-1.);
+            paa = b*(b-1.)*pow(a,b-2.);
+            if (a>0.) {
+               double l = log(a);
+               pb = z*l, pbb = z*l*l, pab = pow(a,b-1.)*(1.+b*l);
+            }
+            break;
+
+         case AD_SIN:
+            pa = cos(a), paa = -z;
+            break;
+
+         case AD_COS:
+            pa = -sin(a), paa = -z;
+            break;
+
+         case AD_TAN:
+            pa = 1. + z*z, paa = 2*z*pa;
+            break;
+
+         case AD_EXP:
+            pa = paa = z;
+            break;
+
+         case AD_LOG:
+            pa = 1./a, paa = -pa*pa;
+            break;
+
+         case AD_SQRT:
+            pa = 0.5/z, paa = -0.25/(z*a);
+            break;
+
+         case AD_SINH:
+            pa = cosh(a), paa = z;
+            break;
+
+         case AD_COSH:
+            pa = sinh(a), paa = z;
+            break;
+
+         case AD_TANH:
+            pa = 1. - z*z, paa = -2*z*pa;
+            break;
+
+         case AD_ASIN:
+            pa = 1./sqrt(1.-a*a), paa = a*pa*pa*pa;
+            break;
+
+         case AD_ACOS:
+            pa = -1./sqrt(1.-a*a), paa = a*pa*pa*pa;
+            break;
+
+         case AD_ATAN:
+            pa = 1./(1.+a*a), paa = -2*a*pa*pa;
+            break;
+
+         case AD_ABS:
+            pa = (a>0.) ? 1. : ((a<0.) ? -1. : 0.);
+            break;
+      }
+      _pa[k] = pa, _pb[k] = pb, _paa[k] = paa, _pab[k] = pab, _pbb[k] = pbb;
+   }
+}
+
+
+void exprAD::reverse(bool second)
+{
+// Adjoints, and if second is true, their tangents (forward over reverse)
+   size_t m = _tape.size();
+   std::fill(_w.begin(),_w.end(),0.);
+   std::fill(_dw.begin(),_dw.end(),0.);
+   _w[m-1] = 1.;
+   for (size_t k=m; k-->0;) {
+      const Op &o = _tape[k];
+      if (o.code==AD_NUM || o.code==AD_VAR)
+         continue;
+      double w=_w[k], dw=_dw[k];
+      _w[o.a] += w*_pa[k];
+      if (o.b>=0)
+         _w[o.b] += w*_pb[k];
+      if (second) {
+         double da=_d[o.a], db=(o.b>=0) ? _d[o.b] : 0.;
+         _dw[o.a] += dw*_pa[k] + w*(_paa[k]*da + _pab[k]*db);
+         if (o.b>=0)
+            _dw[o.b] += dw*_pb[k] + w*(_pab[k]*da + _pbb[k]*db);
+      }
+   }
+}
+
+
+double exprAD::operator()(const double* x)
+{
+   forward(x,nullptr);
+   return _v.back();
+}
+
+
+double exprAD::derivative(const double* x,
+                          const double* v,
+                          double&       dv)
+{
+   forward(x,v);
+   dv = _d.back();
+   return _v.back();
+}
+
+
+double exprAD::gradient(const double* x,
+                        double*       g)
+{
+   forward(x,nullptr);
+   reverse(false);
+   for (int i=0; i<_nb_var; ++i)
+      g[i] = 0.;
+   for (size_t k=0; k<_tape.size(); ++k) {
+      if (_tape[k].code==AD_VAR)
+         g[_tape[k].a] += _w[k];
+   }
+   return _v.back();
+}
+
+
+double exprAD::hessVec(const double* x,
+                       const double* v,
+                       double*       hv)
+{
+   forward(x,v);
+   reverse(true);
+   for (int i=0; i<_nb_var; ++i)
+      hv[i] = 0.;
+   for (size_t k=0; k<_tape.size(); ++k) {
+      if (_tape[k].code==AD_VAR)
+         hv[_tape[k].a] += _dw[k];
+   }
+   return _v.back();
+}
+
+} /* namespace RITA */
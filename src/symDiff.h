@@ -0,0 +1,110 @@
+/*==============================================================================
+
+                                 r  i  t  a
+
+            An environment for Modelling and Numerical Simulation
+
+  ==============================================================================
+
+    Copyright (C) 2021 - 2023 Rachid Touzani
+
+    This file is part of rita.
+
+    rita is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    rita is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+  ==============================================================================
+
+                     Definition of functions on expressions
+
+  ==============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace RITA {
+
+/** \fn int differentiate(const string& expr, const string& var, string& der)
+ *  \brief Compute symbolically the derivative of an expression
+ *  \details The expression may contain numbers, variables, operators <tt>+ - * / ^</tt>,
+ *  parentheses and the functions <tt>sin, cos, tan, exp, log, ln, sqrt, sinh, cosh, tanh,
+ *  asin, acos, atan</tt>.
+ *  @param [in] expr Expression to differentiate
+ *  @param [in] var Name of the variable with respect to which the derivative is computed
+ *  @param [out] der Expression of the derivative
+ *  @return 0 on success, 1 if the expression contains an unsupported construct
+ */
+int differentiate(const string& expr, const string& var, string& der);
+
+/** \fn vector<string> freeVariables(const vector<string>& expr, const vector<string>& var)
+ *  \brief Return names used as variables in expressions and not contained in a list
+ *  \details Function names and usual constants are not considered as variables.
+ *  @param [in] expr Expressions to scan
+ *  @param [in] var List of known variables
+ *  @return Names of the unknown variables, in order of first appearance
+ */
+vector<string> freeVariables(const vector<string>& expr, const vector<string>& var);
+
+/*! \class exprAD
+ *  \brief Automatic differentiation of an expression.
+ *
+ *  The expression is parsed once into a sequence of elementary operations. Forward
+ *  mode (dual numbers) gives directional derivatives, reverse mode gives the value
+ *  and the whole gradient in one sweep, and forward over reverse mode gives
+ *  Hessian-vector products. Supported operations are those of differentiate().
+ */
+
+class exprAD
+{
+
+ public:
+
+    exprAD() : _nb_var(0) { }
+
+/// \brief Parse expression \c expr of variables \c var
+/// \return 0 on success, 1 if the expression contains an unsupported construct
+    int set(const string& expr, const vector<string>& var);
+
+/// \brief Return value at \c x
+    double operator()(const double *x);
+
+/// \brief Return value at \c x and directional derivative in direction \c v in \c dv
+    double derivative(const double *x, const double *v, double& dv);
+
+/// \brief Return value at \c x and its gradient in \c g
+    double gradient(const double *x, double *g);
+
+/// \brief Compute product of Hessian at \c x by \c v in \c hv. Return value at \c x
+    double hessVec(const double *x, const double *v, double *hv);
+
+    int getNbVar() const { return _nb_var; }
+
+    struct Op {
+       int code, a, b;
+       double c;
+    };
+
+ private:
+
+    int _nb_var;
+    vector<Op> _tape;
+    vector<double> _v, _d, _w, _dw, _pa, _pb, _paa, _pab, _pbb;
+
+    void forward(const double *x, const double *v);
+    void partials();
+    void reverse(bool second);
+};
+
+} /* namespace RITA */
@@ -34,6 +34,14 @@
 
 #include "transient.h"
 #include "equa.h"
+#include "batchODE.h"
+#include "adaptODE.h"
+#include "symDiff.h"
+#include "profiler.h"
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
 #include "solvers/ODESolver.h"
 #include "solvers/NLASSolver.h"
 
@@ -96,28 +104,380 @@ void transient::setSave(vector<int>&    isave,
 }
 
 
+int transient::setJacobian(adaptODE*               a,
+                           odae*                   eq,
+                           const vector<Coupling>& c)
+{
+// The Jacobian matrix is given by expressions in the ode command or obtained by
+// symbolic differentiation of the functions defining the system. If none of these
+// is available, the integrator uses finite differences.
+// Jacobian expressions have the same variables as the system: time, unknowns
+// and coupling variables
+   int n = eq->size;
+   vector<string> jx(n*n);
+   if (eq->J.size()==size_t(n*n)) {
+      for (int i=0; i<n; ++i)
+         for (int j=0; j<n; ++j)
+            jx[i*n+j] = eq->J(i+1,j+1);
+   }
+   else {
+      for (int i=0; i<n; ++i) {
+         const vector<string> &var = eq->theFct[i].var;
+         if (var.size()<size_t(n+1))
+            return 1;
+         for (int j=0; j<n; ++j) {
+            if (differentiate(eq->theFct[i].expr,var[j+1],jx[i*n+j]))
+               return 1;
+         }
+      }
+   }
+   auto jf = std::make_shared<vector<OFELI::Fct> >(n*n);
+   for (int k=0; k<n*n; ++k) {
+      if ((*jf)[k].set(jx[k],eq->theFct[0].var,1)) {
+         _rita->msg("transient>","Error in jacobian expression: "+jx[k]);
+         return 1;
+      }
+   }
+   data *d = _data;
+   vector<double> x(n+1+c.size());
+   a->setJacobian([jf,x,n,c,d](double t, const double *y, double *J) mutable {
+                     x[0] = t;
+                     for (int i=0; i<n; ++i)
+                        x[i+1] = y[i];
+                     for (size_t k=0; k<c.size(); ++k)
+                        x[n+1+k] = (c[k].vect<0) ? t : (*d->theVector[c[k].vect])[c[k].comp];
+                     for (int k=0; k<n*n; ++k)
+                        J[k] = (*jf)[k](x);
+                  });
+   return 0;
+}
+
+
+int transient::bind(odae*             eq,
+                    size_t            nv,
+                    vector<Coupling>& c)
+{
+   const vector<string> &var = eq->theFct[0].var;
+   c.clear();
+   for (size_t k=nv; k<var.size(); ++k) {
+      Coupling cp;
+      cp.vect = -1, cp.comp = 0;
+      if (var[k]!="t") {
+         for (int e=1; e<=_nb_ae+_nb_ode && cp.vect<0; ++e) {
+            odae *q = (e<=_nb_ae) ? _data->theAE[e] : _data->theODE[e-_nb_ae];
+            if (q==eq)
+               continue;
+            for (int i=1; i<=q->size; ++i) {
+               if ((q->size==1 && var[k]==q->fn) || var[k]==q->fn+to_string(i))
+                  cp.vect = q->vect, cp.comp = i - 1;
+            }
+         }
+         if (cp.vect<0) {
+            _rita->msg("transient>","Undefined variable "+var[k]+" in equation "+eq->name+".");
+            return 1;
+         }
+      }
+      c.push_back(cp);
+   }
+   return 0;
+}
+
+
+int transient::setCoupling()
+{
+// Find for each algebraic or differential system the variables of other systems
+// it depends on
+   _ode_cpl.resize(_nb_ode+1), _ae_cpl.resize(_nb_ae+1);
+   _ae_jac.clear();
+   _ae_jac.resize(_nb_ae+1);
+   for (int e=1; e<=_nb_ode; ++e) {
+      if (bind(_data->theODE[e],_data->theODE[e]->size+1,_ode_cpl[e]))
+         return 1;
+   }
+   for (int e=1; e<=_nb_ae; ++e) {
+      _ae_eq = _data->theAE[e];
+      if (bind(_ae_eq,_ae_eq->size,_ae_cpl[e]))
+         return 1;
+      if (_ae_cpl[e].empty())
+         continue;
+      if (_ae_eq->nls!=NEWTON && _rita->_verb)
+         cout << "Algebraic system " << _ae_eq->name << " is coupled with other equations and is solved by Newton's method." << endl;
+
+//    Jacobian of a coupled system: given expressions or symbolic derivatives with
+//    respect to the unknowns, finite differences if none of these is available
+      int n = _ae_eq->size;
+      const vector<string> &var = _ae_eq->theFct[0].var;
+      vector<string> jx(n*n);
+      bool ok = (_ae_eq->J.size()==size_t(n*n));
+      for (int i=0; i<n && ok; ++i) {
+         for (int j=0; j<n && ok; ++j) {
+            jx[i*n+j] = _ae_eq->J(i+1,j+1);
+            if (jx[i*n+j]=="")
+               ok = !differentiate(_ae_eq->theFct[i].expr,var[j],jx[i*n+j]);
+         }
+      }
+      if (!ok) {
+         if (_rita->_verb)
+            cout << "Jacobian of algebraic system " << _ae_eq->name << " approximated by finite differences." << endl;
+         continue;
+      }
+      _ae_jac[e].resize(n*n);
+      for (int k=0; k<n*n; ++k) {
+         if (_ae_jac[e][k].set(jx[k],var,1)) {
+            _rita->msg("transient>","Error in jacobian expression: "+jx[k]);
+            return 1;
+         }
+      }
+   }
+
+// Algebraic systems are solved in an order such that each system is solved after
+// the ones it depends on. Differential systems are advanced before algebraic ones
+// and use their values at the beginning of the time step.
+// Dependency cycles are kept in order of definition
+   _ae_order.clear();
+   vector<int> done(_nb_ae+1,0);
+   while (int(_ae_order.size())<_nb_ae) {
+      int next = 0;
+      for (int e=1; e<=_nb_ae && !next; ++e) {
+         if (done[e])
+            continue;
+         bool ready = true;
+         for (const auto& c: _ae_cpl[e]) {
+            for (int q=1; q<=_nb_ae; ++q) {
+               if (q!=e && !done[q] && c.vect==_data->theAE[q]->vect)
+                  ready = false;
+            }
+         }
+         if (ready)
+            next = e;
+      }
+      if (!next) {
+         for (int e=1; e<=_nb_ae && !next; ++e)
+            if (!done[e])
+               next = e;
+      }
+      done[next] = 1;
+      _ae_order.push_back(next);
+   }
+   if (_rita->_verb>1 && _nb_ae) {
+      cout << "Order of resolution of algebraic equations:";
+      for (auto e: _ae_order)
+         cout << " " << _data->theAE[e]->name;
+      cout << endl;
+   }
+   return 0;
+}
+
+
+batchODE::RHS transient::setRHS(odae*                   eq,
+                                const vector<Coupling>& c)
+{
+   data *d = _data;
+   vector<double> x(eq->size+1+c.size());
+   return [eq,c,d,x](double t, const double *y, double *f) mutable {
+             x[0] = t;
+             for (int i=0; i<eq->size; ++i)
+                x[i+1] = y[i];
+             for (size_t k=0; k<c.size(); ++k)
+                x[eq->size+1+k] = (c[k].vect<0) ? t : (*d->theVector[c[k].vect])[c[k].comp];
+             for (int i=0; i<eq->size; ++i)
+                f[i] = eq->theFct[i](x);
+          };
+}
+
+
+namespace {
+
+// Solve a*x = b by Gauss elimination with partial pivoting. b is overwritten by x
+int gaussSolve(int             n,
+               vector<double>& a,
+               vector<double>& b)
+{
+   for (int k=0; k<n; ++k) {
+      int p = k;
+      for (int i=k+1; i<n; ++i)
+         if (fabs(a[i*n+k])>fabs(a[p*n+k]))
+            p = i;
+      if (a[p*n+k]==0.)
+         return 1;
+      if (p!=k) {
+         for (int j=0; j<n; ++j)
+            std::swap(a[k*n+j],a[p*n+j]);
+         std::swap(b[k],b[p]);
+      }
+      for (int i=k+1; i<n; ++i) {
+         double m = a[i*n+k]/a[k*n+k];
+         for (int j=k+1; j<n; ++j)
+            a[i*n+j] -= m*a[k*n+j];
+         b[i] -= m*b[k];
+      }
+   }
+   for (int i=n-1; i>=0; --i) {
+      for (int j=i+1; j<n; ++j)
+         b[i] -= a[i*n+j]*b[j];
+      b[i] /= a[i*n+i];
+   }
+   return 0;
+}
+
+}
+
+
+int transient::NewtonAE(int    e,
+                        double t,
+                        int&   nb_it)
+{
+// Newton iterations for an algebraic system coupled with other equations. As for
+// coupled differential systems, the values of coupling variables follow the
+// unknowns in the variables of functions, so that expressions are parsed once
+   odae *eq = _data->theAE[e];
+   const vector<Coupling> &c = _ae_cpl[e];
+   vector<OFELI::Fct> &jf = _ae_jac[e];
+   int n = eq->size;
+   vector<double> x(n+c.size()), f(n), a(n*n);
+   for (int i=0; i<n; ++i)
+      x[i] = eq->y[i];
+   for (size_t k=0; k<c.size(); ++k)
+      x[n+k] = (c[k].vect<0) ? t : (*_data->theVector[c[k].vect])[c[k].comp];
+   for (int it=0; it<eq->max_it; ++it) {
+      nb_it++;
+      for (int i=0; i<n; ++i)
+         f[i] = eq->theFct[i](x);
+      if (jf.size()) {
+         for (int k=0; k<n*n; ++k)
+            a[k] = jf[k](x);
+      }
+      else {
+         for (int j=0; j<n; ++j) {
+            double xj = x[j], d = 1.e-8*std::max(1.,fabs(xj));
+            x[j] += d;
+            for (int i=0; i<n; ++i)
+               a[i*n+j] = (eq->theFct[i](x) - f[i])/d;
+            x[j] = xj;
+         }
+      }
+      if (gaussSolve(n,a,f)) {
+         _rita->msg("transient>","Singular jacobian matrix in Newton iterations for algebraic system "+eq->name+".");
+         return 1;
+      }
+      double dn=0., xn=0.;
+      for (int i=0; i<n; ++i) {
+         x[i] -= f[i];
+         dn = std::max(dn,fabs(f[i])), xn = std::max(xn,fabs(x[i]));
+      }
+      if (dn<=eq->toler*(1.+xn)) {
+         for (int i=0; i<n; ++i)
+            eq->y[i] = x[i];
+         return 0;
+      }
+   }
+   _rita->msg("transient>","No convergence of Newton iterations for algebraic system "+eq->name+".");
+   return 1;
+}
+
+
+int transient::solveAE(vector<std::unique_ptr<OFELI::NLASSolver> >& nls,
+                       double                                        t,
+                       int&                                          nb_it)
+{
+   nb_it = 0;
+   for (auto e: _ae_order) {
+      _ae_eq = _data->theAE[e];
+
+//    The solution of previous time step is the initial guess
+      if (_ae_cpl[e].size()) {
+         if (NewtonAE(e,t,nb_it))
+            return 1;
+      }
+      else {
+         if (_ae_eq->size==1)
+            nls[e]->setInitial(_ae_eq->y[0]);
+         else
+            nls[e]->setInitial(_ae_eq->y);
+         nls[e]->run();
+         nb_it += nls[e]->getNbIter();
+      }
+      *_data->theVector[_ae_eq->vect] = _ae_eq->y;
+      string fh = _data->vect_hist[_ae_eq->fn];
+      if (fh!="%$§&")
+         _data->theHVector[_data->checkName(fh,DataType::HVECTOR)]->set(_ae_eq->y,t);
+   }
+   return 0;
+}
+
+
 int transient::run()
 {
    OFELI::Verbosity = 1;
    vector<ofstream> fs(_nb_vectors), ffs(_nb_vectors), pfs(_nb_vectors);
    vector<OFELI::IOField> ff(_nb_vectors);
    vector<string> fn(_nb_vectors);
-   OFELI::ODESolver ode;
-   OFELI::NLASSolver nlas;
+   batchODE bode;
+   vector<std::unique_ptr<OFELI::ODESolver> > ode(_nb_ode+1);
+   vector<std::unique_ptr<adaptODE> > aode(_nb_ode+1);
+   vector<int> ib(_nb_ode+1,-1);
+   vector<std::unique_ptr<OFELI::NLASSolver> > nls(_nb_ae+1);
    OFELI::TimeStepping ts;
+   if (setCoupling())
+      return 1;
 
+// ODEs with adaptive time stepping get their own error controlled integrator,
+// ODEs with an explicit one-step scheme are advanced together by the batched
+// integrator, other ones get their own OFELI solver
+   bode.setTime(_init_time);
    for (int e=1; e<=_nb_ode; ++e) {
       _ode_eq = _data->theODE[e];
-      ode.set(_ode_eq->scheme,_time_step,_final_time);
-      ode.setNbEq(_ode_eq->size);
-//      int f = _ode_eq->vect;
-//      fn[f-1] = "rita-" + to_string(10*e+f) + ".sol";
+      auto it = _bsch.find(_ode_eq->scheme);
+      int m = _ode_eq->adapt;
+      if (m==0 && _rita->_adapted_time_step)
+         m = (_ode_eq->scheme==OFELI::BACKWARD_EULER || _ode_eq->scheme==OFELI::CRANK_NICOLSON ||
+              _ode_eq->scheme==OFELI::BDF2) ? 2 : 1;
+      if (m) {
+         odae *eq = _ode_eq;
+         aode[e].reset(new adaptODE(eq->size,m==1 ? adaptODE::RK45 : adaptODE::BDF,setRHS(eq,_ode_cpl[e])));
+         aode[e]->setTolerance(eq->atol,eq->rtol);
+         aode[e]->setInitial(_init_time,&(eq->y[0]));
+         if (m==2 && setJacobian(aode[e].get(),eq,_ode_cpl[e]) && _rita->_verb)
+            cout << "Jacobian of ODE " << eq->name << " approximated by finite differences." << endl;
+         if (eq->steps!="") {
+            data *d = _data;
+            adaptODE *a = aode[e].get();
+            string sn = eq->steps;
+            int k = _data->checkName(sn,DataType::VECTOR);
+            aode[e]->setMonitor([d,a,sn,k](double t, double h, double err, bool ok) {
+                                   OFELI::Vect<double> &v = *d->theVector[k];
+                                   v[0] = h, v[1] = ok, v[2] = err, v[3] = double(a->getNbEval());
+                                   string fh = d->vect_hist[sn];
+                                   if (fh!="%$§&")
+                                      d->theHVector[d->checkName(fh,DataType::HVECTOR)]->set(v,t+h);
+                                });
+         }
+      }
+      else if (it!=_bsch.end())
+         ib[e] = bode.add(_ode_eq->size,it->second,&(_ode_eq->y[0]),setRHS(_ode_eq,_ode_cpl[e]));
+      else if (_ode_cpl[e].size()) {
+         _rita->msg("transient>","ODE "+_ode_eq->name+" is coupled with other equations. This requires\n"
+                    "one of the schemes forward-euler, heun, RK4, RK45 or BDF.");
+         return 1;
+      }
+      else {
+         ode[e].reset(new OFELI::ODESolver);
+         ode[e]->set(_ode_eq->scheme,_time_step,_final_time);
+         ode[e]->setNbEq(_ode_eq->size);
+      }
    }
 
-  for (int e=1; e<=_nb_ae; ++e) {
+   for (int e=1; e<=_nb_ae; ++e) {
       _ae_eq = _data->theAE[e];
-      nlas.set(_ae_eq->nls);
-      nlas.setNbEq(_ae_eq->size);
+      if (_ae_cpl[e].empty()) {
+         nls[e].reset(new OFELI::NLASSolver(_ae_eq->nls,_ae_eq->size));
+         nls[e]->setMaxIter(_ae_eq->max_it);
+         nls[e]->setTolerance(_ae_eq->toler);
+         for (int i=0; i<_ae_eq->size; ++i)
+            nls[e]->setf(_ae_eq->theFct[i]);
+      }
+      _data->theVector[_ae_eq->vect]->resize(_ae_eq->size);
+      *_data->theVector[_ae_eq->vect] = _ae_eq->y;
 //      int f = _data->theAE[e]->vect;
 //      fn[f-1] = "rita-" + to_string(10*e+f) + ".sol";
    }
@@ -156,10 +516,12 @@ int transient::run()
                pfs[f-1] << "# Saved by rita: Phase portrait of ODE, equation: 1" << endl;
             }
          }*/
-         if (_ode_eq->size==1)
-            ode.setInitial(_ode_eq->y[0]);
-         else
-            ode.setInitial(_ode_eq->y);
+         if (ode[e]!=nullptr) {
+            if (_ode_eq->size==1)
+               ode[e]->setInitial(_ode_eq->y[0]);
+            else
+               ode[e]->setInitial(_ode_eq->y);
+         }
          string fh = _data->vect_hist[_ode_eq->fn];
          if (fh!="%$§&")
             _data->theHVector[_data->checkName(fh,DataType::HVECTOR)]->set(_ode_eq->y,theTime);
@@ -222,15 +584,10 @@ int transient::run()
       }
    }*/
    theStep = 1;
-   for (int e=1; e<=_nb_ae; ++e) {
-      _ae_eq = _data->theAE[e];
-      for (int i=0; i<_ae_eq->size; ++i)
-         nlas.setf(_ae_eq->theFct[i]);
-   }
    for (int e=1; e<=_nb_ode; ++e) {
       _ode_eq = _data->theODE[e];
-      for (int i=0; i<_ode_eq->size; ++i)
-         ode.setF(_ode_eq->theFct[i]);
+      for (int i=0; i<_ode_eq->size && ode[e]!=nullptr; ++i)
+         ode[e]->setF(_ode_eq->theFct[i]);
    }
    for (int e=1; e<=_nb_pde; ++e) {
       _pde_eq = _data->thePDE[e];
@@ -238,38 +595,72 @@ int transient::run()
    }
 
 // Loop on time steps
+   typedef std::chrono::steady_clock Clock;
+   double ode_time=0., ae_time=0., pde_time=0.;
+   int nb_it=0, nb_it_total=0;
+   profiler& prof = profiler::get();
+   profiler::scope ps("transient");
+   vector<string> pde_name(_nb_pde+1);
+   for (int e=1; e<=_nb_pde; ++e)
+      pde_name[e] = "pde-" + to_string(e);
    try {
+
+//    Consistent initial values of algebraic variables
+      if (_nb_ae && solveAE(nls,theTime,nb_it))
+         return 1;
+
       TimeLoop {
 
          if (_rita->_verb)
             cout << "Performing time step " << theStep <<", Time = " << theTime << endl;
 
-         for (int e=1; e<=_nb_ae; ++e) {
-            cout << "No algebraic equation solver implemented." << endl;
-         }
-
+         profiler::scope pst("transient:step");
+         auto t0 = Clock::now();
+         if (bode.getNbSystems())
+            bode.step(theTimeStep);
          for (int e=1; e<=_nb_ode; ++e) {
             _ode_eq = _data->theODE[e];
             int f = _ode_eq->vect;
-            ode.runOneTimeStep();
-            if (_ode_eq->size==1)
-               _ode_eq->y[0] = ode.get();
+            if (aode[e]!=nullptr) {
+               if (aode[e]->advance(theTime))
+                  throw runtime_error("Time step too small in adaptive integration of ODE "+_ode_eq->name+".");
+               aode[e]->get(&(_ode_eq->y[0]));
+            }
+            else if (ode[e]==nullptr)
+               bode.get(ib[e],&(_ode_eq->y[0]));
+            else {
+               ode[e]->runOneTimeStep();
+               if (_ode_eq->size==1)
+                  _ode_eq->y[0] = ode[e]->get();
+            }
             *_data->theVector[f] = _ode_eq->y;
             string fh = _data->vect_hist[_ode_eq->fn];
             if (fh!="%$§&")
                _data->theHVector[_data->checkName(fh,DataType::HVECTOR)]->set(_ode_eq->y,theTime);
             if (_ode_eq->phase!="") {
                _ode_eq->ph.setSize(_ode_eq->size);
-               ode.getTimeDerivative(_ode_eq->ph);
+               if (aode[e]!=nullptr)
+                  aode[e]->getDerivative(&(_ode_eq->ph[0]));
+               else if (ode[e]==nullptr)
+                  bode.getDerivative(ib[e],&(_ode_eq->ph[0]));
+               else
+                  ode[e]->getTimeDerivative(_ode_eq->ph);
                string fh = _data->vect_hist[_ode_eq->phase];
                if (fh!="%$§&")
                   _data->theHVector[_data->checkName(fh,DataType::HVECTOR)]->set(_ode_eq->ph,theTime);
             }
          }
+         auto t1 = Clock::now();
+
+         if (_nb_ae && solveAE(nls,theTime,nb_it))
+            return 1;
+         nb_it_total += nb_it;
+         auto t2 = Clock::now();
 
          for (int e=1; e<=_nb_pde; ++e) {
             _pde_eq = _data->thePDE[e];
 
+            auto s0 = Clock::now();
             if (_pde_eq->set_bf) {
                _pde_eq->bf.setTime(theTime);
                if (_pde_eq->bf.withRegex(1))
@@ -277,6 +668,7 @@ int transient::run()
                ts.setRHS(_pde_eq->bf);
                _pde_eq->theEquation->setInput(BODY_FORCE,_pde_eq->bf);
             }
+            auto s1 = Clock::now();
 
             if (_pde_eq->set_bc) {
                _pde_eq->bc.setTime(theTime);
@@ -286,6 +678,7 @@ int transient::run()
                }
                ts.setBC(_pde_eq->bc);
             }
+            auto s2 = Clock::now();
 
             if (_pde_eq->set_sf) {
                _pde_eq->sf.setTime(theTime);
@@ -295,8 +688,10 @@ int transient::run()
                }
             //            ts.setSF(_data->sf[i]);
             }
+            auto s3 = Clock::now();
 
             ts.runOneTimeStep();
+            auto s4 = Clock::now();
 
             for (int i=0; i<_pde_eq->nb_vectors; ++i) {
                int f = _pde_eq->fd[i].vect;
@@ -306,10 +701,60 @@ int transient::run()
                if (fh!="%$§&")
                   _data->theHVector[_data->checkName(fh,DataType::HVECTOR)]->set(*(_data->theVector[f]),theTime);
             }
+            if (prof.getLevel()) {
+               prof.add(pde_name[e]+":body-force",s0,s1);
+               prof.add(pde_name[e]+":bc",s1,s2);
+               prof.add(pde_name[e]+":boundary-force",s2,s3);
+               prof.add(pde_name[e]+":solve",s3,s4);
+               prof.add(pde_name[e]+":history",s4,Clock::now());
+            }
+         }
+         auto t3 = Clock::now();
+         if (prof.getLevel()) {
+            prof.add("transient:ode",t0,t1);
+            prof.add("transient:ae",t1,t2);
+            prof.add("transient:pde",t2,t3);
+            prof.count("transient:steps");
+            prof.count("ae:newton-iterations",nb_it);
+         }
+
+         double dt1 = std::chrono::duration<double>(t1-t0).count(),
+                dt2 = std::chrono::duration<double>(t2-t1).count(),
+                dt3 = std::chrono::duration<double>(t3-t2).count();
+         ode_time += dt1, ae_time += dt2, pde_time += dt3;
+         if (_rita->_verb>1) {
+            if (_nb_ae)
+               cout << "   Algebraic equations: " << nb_it << " Newton iterations, " << dt2 << " s" << endl;
+            if (_nb_ode)
+               cout << "   Differential equations: " << dt1 << " s" << endl;
+            if (_nb_pde)
+               cout << "   Partial differential equations: " << dt3 << " s" << endl;
          }
       }
    } CATCH
 
+   if (_rita->_verb>1) {
+      cout << "Total time in ODE: " << ode_time << " s, AE: " << ae_time << " s (" << nb_it_total
+           << " Newton iterations), PDE: " << pde_time << " s" << endl;
+   }
+   for (int e=1; e<=_nb_ode; ++e) {
+      if (aode[e]!=nullptr) {
+         if (_rita->_verb)
+            cout << "ODE " << _data->theODE[e]->name << ": " << aode[e]->getNbAccepted() << " accepted steps, "
+                 << aode[e]->getNbRejected() << " rejected steps, " << aode[e]->getNbEval()
+                 << " function evaluations, " << aode[e]->getNbJacobian() << " jacobian evaluations, "
+                 << aode[e]->getNbFactor() << " factorizations." << endl;
+         prof.count("ode:accepted-steps",aode[e]->getNbAccepted());
+         prof.count("ode:rejected-steps",aode[e]->getNbRejected());
+         prof.count("ode:function-evaluations",aode[e]->getNbEval());
+         prof.count("ode:jacobian-evaluations",aode[e]->getNbJacobian());
+         prof.count("ode:factorizations",aode[e]->getNbFactor());
+      }
+   }
+   if (_rita->_verb && bode.getNbSystems())
+      cout << "Explicit ODE schemes: " << bode.getNbEval() << " function evaluations." << endl;
+   if (bode.getNbSystems())
+      prof.count("ode:function-evaluations",bode.getNbEval());
    return 0;
 }
 
@@ -34,7 +34,10 @@
 #include "OFELI.h"
 #include "rita.h"
 #include "solve.h"
+#include "batchODE.h"
+#include "adaptODE.h"
 #include <map>
+#include <memory>
 
 namespace RITA {
 
@@ -65,6 +68,22 @@ class transient
     odae *_ae_eq, *_ode_eq;
     equa *_pde_eq;
     int setPDE(OFELI::TimeStepping& ts, int e);
+
+//  Variable of another equation used in the definition of a system: component
+//  comp of vector vect, or time if vect<0
+    struct Coupling { int vect, comp; };
+    int setJacobian(adaptODE* a, odae* eq, const vector<Coupling>& c);
+    vector<vector<Coupling> > _ode_cpl, _ae_cpl;
+    vector<vector<OFELI::Fct> > _ae_jac;
+    vector<int> _ae_order;
+    int setCoupling();
+    int bind(odae* eq, size_t nv, vector<Coupling>& c);
+    batchODE::RHS setRHS(odae* eq, const vector<Coupling>& c);
+    int solveAE(vector<std::unique_ptr<OFELI::NLASSolver> >& nls, double t, int& nb_it);
+    int NewtonAE(int e, double t, int& nb_it);
+    map<OFELI::TimeScheme,batchODE::Scheme> _bsch = {{OFELI::FORWARD_EULER,batchODE::FORWARD_EULER},
+                                                     {OFELI::HEUN,batchODE::HEUN},
+                                                     {OFELI::RK4,batchODE::RK4}};
 };
 
 } /* namespace RITA */